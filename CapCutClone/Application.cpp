@@ -87,14 +87,28 @@ void Application::Run() {
         return;
     }
 
+    // Frames drawn after an event before the loop may block again: ImGui
+    // needs a few to settle hover, focus and layout changes
+    constexpr int kSettleFrames = 3;
+    // Redraw interval while a text field has focus (caret blink)
+    constexpr double kTextInputRedraw = 0.5;
+    // Longest step Update sees: the time spent blocked while idle is not
+    // playback time (starting playback after a long wait must not jump)
+    constexpr float kMaxDeltaTime = 0.1f;
+
     float lastFrame = 0.0f;
+    int settleFrames = kSettleFrames;
 
-    // Main loop
+    // Main loop: renders only when there is input, a frame due or background
+    // progress to show, and blocks otherwise
     while (!glfwWindowShouldClose(m_Window) && m_IsRunning) {
         // Calculate delta time
         float currentFrame = static_cast<float>(glfwGetTime());
         float deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        if (deltaTime > kMaxDeltaTime) {
+            deltaTime = kMaxDeltaTime;
+        }
 
         // Process input
         ProcessInput();
@@ -105,9 +119,32 @@ void Application::Run() {
         // Render
         Render();
 
-        // Swap buffers and poll events
         glfwSwapBuffers(m_Window);
-        glfwPollEvents();
+
+        if (settleFrames > 0) {
+            settleFrames--;
+            glfwPollEvents();
+            continue;
+        }
+
+        double timeout = m_UIManager ? m_UIManager->GetIdleTimeout() : -1.0;
+        if (ImGui::GetIO().WantTextInput && (timeout < 0.0 || timeout > kTextInputRedraw)) {
+            timeout = kTextInputRedraw;
+        }
+
+        double waitStart = glfwGetTime();
+        if (timeout < 0.0) {
+            glfwWaitEvents();
+        } else if (timeout > 0.0) {
+            glfwWaitEventsTimeout(timeout);
+        } else {
+            glfwPollEvents();
+        }
+
+        // Woken before the timeout: an event arrived
+        if (timeout < 0.0 || glfwGetTime() - waitStart < timeout) {
+            settleFrames = kSettleFrames;
+        }
     }
 }
 
@@ -396,6 +433,17 @@ void Application::KeyCallback(GLFWwindow* window, int key, int scancode, int act
         if (key == GLFW_KEY_SPACE) {
             app->m_UIManager->OnSpacePressed();
         }
+
+        // Ctrl+Z undo, Ctrl+Y / Ctrl+Shift+Z redo
+        if ((mods & GLFW_MOD_CONTROL) && key == GLFW_KEY_Z) {
+            if (mods & GLFW_MOD_SHIFT) {
+                app->m_UIManager->OnRedoPressed();
+            } else {
+                app->m_UIManager->OnUndoPressed();
+            }
+        } else if ((mods & GLFW_MOD_CONTROL) && key == GLFW_KEY_Y) {
+            app->m_UIManager->OnRedoPressed();
+        }
     }
 }
 
@@ -423,7 +471,7 @@ void Application::OpenVideoFile() {
     if (GetOpenFileNameA(&ofn)) {
         std::cout << "Selected file: " << szFile << std::endl;
         if (m_VideoPlayer) {
-            if (m_VideoPlayer->LoadVideo(szFile)) {
+            if (m_VideoPlayer->LoadVideo(szFile, false)) {
                 // Create texture for video
                 if (m_TextureRenderer) {
                     m_TextureRenderer->CreateTexture(
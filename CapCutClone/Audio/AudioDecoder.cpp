@@ -0,0 +1,215 @@
+#include "AudioDecoder.h"
+#include "AudioEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+AudioDecoder::AudioDecoder()
+    : m_FormatContext(nullptr), m_CodecContext(nullptr),
+      m_SwrContext(nullptr), m_Packet(nullptr), m_Frame(nullptr),
+      m_StreamIndex(-1), m_PendingRead(0), m_PendingFrames(0),
+      m_NextTime(0.0), m_SkipUntil(0.0), m_Draining(false), m_Ended(false) {}
+
+AudioDecoder::~AudioDecoder() { Close(); }
+
+bool AudioDecoder::Open(const std::string &filepath) {
+  Close();
+
+  if (avformat_open_input(&m_FormatContext, filepath.c_str(), nullptr,
+                          nullptr) < 0) {
+    std::cerr << "[AudioDecoder] Could not open " << filepath << std::endl;
+    return false;
+  }
+  if (avformat_find_stream_info(m_FormatContext, nullptr) < 0) {
+    Close();
+    return false;
+  }
+
+  for (unsigned int i = 0; i < m_FormatContext->nb_streams; i++) {
+    if (m_FormatContext->streams[i]->codecpar->codec_type ==
+        AVMEDIA_TYPE_AUDIO) {
+      m_StreamIndex = i;
+      break;
+    }
+  }
+  if (m_StreamIndex == -1) {
+    Close();
+    return false; // Silent media; not an error
+  }
+
+  AVCodecParameters *params = m_FormatContext->streams[m_StreamIndex]->codecpar;
+  const AVCodec *codec = avcodec_find_decoder(params->codec_id);
+  if (codec)
+    m_CodecContext = avcodec_alloc_context3(codec);
+  if (!m_CodecContext ||
+      avcodec_parameters_to_context(m_CodecContext, params) < 0 ||
+      avcodec_open2(m_CodecContext, codec, nullptr) < 0) {
+    std::cerr << "[AudioDecoder] Could not open the audio codec of "
+              << filepath << std::endl;
+    Close();
+    return false;
+  }
+
+  m_Packet = av_packet_alloc();
+  m_Frame = av_frame_alloc();
+  if (!m_Packet || !m_Frame) {
+    Close();
+    return false;
+  }
+
+  m_Path = filepath;
+  return true;
+}
+
+void AudioDecoder::Close() {
+  if (m_SwrContext)
+    swr_free(&m_SwrContext);
+  if (m_Frame)
+    av_frame_free(&m_Frame);
+  if (m_Packet)
+    av_packet_free(&m_Packet);
+  if (m_CodecContext)
+    avcodec_free_context(&m_CodecContext);
+  if (m_FormatContext)
+    avformat_close_input(&m_FormatContext);
+
+  m_Path.clear();
+  m_StreamIndex = -1;
+  m_PendingRead = 0;
+  m_PendingFrames = 0;
+  m_NextTime = 0.0;
+  m_SkipUntil = 0.0;
+  m_Draining = false;
+  m_Ended = false;
+}
+
+bool AudioDecoder::Seek(double seconds) {
+  if (!IsOpen())
+    return false;
+
+  AVStream *stream = m_FormatContext->streams[m_StreamIndex];
+  int64_t target =
+      static_cast<int64_t>(std::max(0.0, seconds) / av_q2d(stream->time_base));
+  if (av_seek_frame(m_FormatContext, m_StreamIndex, target,
+                    AVSEEK_FLAG_BACKWARD) < 0) {
+    std::cerr << "[AudioDecoder] Seek failed in " << m_Path << std::endl;
+    return false;
+  }
+
+  avcodec_flush_buffers(m_CodecContext);
+  if (m_SwrContext) {
+    swr_close(m_SwrContext);
+    swr_init(m_SwrContext);
+  }
+  m_PendingRead = 0;
+  m_PendingFrames = 0;
+  m_NextTime = seconds;
+  m_SkipUntil = seconds;
+  m_Draining = false;
+  m_Ended = false;
+  return true;
+}
+
+int AudioDecoder::Read(float *interleaved, int maxFrames) {
+  int written = 0;
+  while (written < maxFrames) {
+    if (m_PendingRead == m_PendingFrames) {
+      m_PendingRead = 0;
+      m_PendingFrames = 0;
+      if (!DecodeFrame())
+        break;
+      continue; // The frame may have been pre-roll only
+    }
+    int count = std::min(maxFrames - written, m_PendingFrames - m_PendingRead);
+    std::memcpy(interleaved + written * AudioEngine::kChannels,
+                m_Pending.data() + m_PendingRead * AudioEngine::kChannels,
+                static_cast<size_t>(count) * AudioEngine::kChannels *
+                    sizeof(float));
+    m_PendingRead += count;
+    written += count;
+  }
+  return written;
+}
+
+bool AudioDecoder::DecodeFrame() {
+  while (!m_Ended) {
+    int ret = avcodec_receive_frame(m_CodecContext, m_Frame);
+    if (ret == 0) {
+      Convert(m_Frame);
+      av_frame_unref(m_Frame);
+      return true;
+    }
+    if (ret != AVERROR(EAGAIN) || m_Draining) {
+      // End of stream (or a broken one): flush what the resampler holds
+      Convert(nullptr);
+      m_Ended = true;
+      return true;
+    }
+
+    if (av_read_frame(m_FormatContext, m_Packet) < 0) {
+      avcodec_send_packet(m_CodecContext, nullptr);
+      m_Draining = true;
+      continue;
+    }
+    if (m_Packet->stream_index == m_StreamIndex)
+      avcodec_send_packet(m_CodecContext, m_Packet);
+    av_packet_unref(m_Packet);
+  }
+  return false;
+}
+
+void AudioDecoder::Convert(const AVFrame *frame) {
+  if (!m_SwrContext) {
+    if (!frame)
+      return;
+    AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+    AVChannelLayout unspecified;
+    const AVChannelLayout *input = &m_CodecContext->ch_layout;
+    if (input->order == AV_CHANNEL_ORDER_UNSPEC) {
+      av_channel_layout_default(&unspecified, input->nb_channels);
+      input = &unspecified;
+    }
+    swr_alloc_set_opts2(&m_SwrContext, &stereo, AV_SAMPLE_FMT_FLT,
+                        AudioEngine::kSampleRate, input,
+                        m_CodecContext->sample_fmt,
+                        m_CodecContext->sample_rate, 0, nullptr);
+    if (!m_SwrContext || swr_init(m_SwrContext) < 0) {
+      std::cerr << "[AudioDecoder] Unsupported audio format in " << m_Path
+                << std::endl;
+      m_Ended = true;
+      return;
+    }
+  }
+
+  int inSamples = frame ? frame->nb_samples : 0;
+  int capacity = static_cast<int>(av_rescale_rnd(
+      swr_get_delay(m_SwrContext, m_CodecContext->sample_rate) + inSamples,
+      AudioEngine::kSampleRate, m_CodecContext->sample_rate, AV_ROUND_UP));
+  size_t size = static_cast<size_t>(capacity) * AudioEngine::kChannels;
+  if (m_Pending.size() < size)
+    m_Pending.resize(size);
+
+  if (frame && frame->pts != AV_NOPTS_VALUE) {
+    AVStream *stream = m_FormatContext->streams[m_StreamIndex];
+    m_NextTime = frame->pts * av_q2d(stream->time_base);
+  }
+
+  uint8_t *out = reinterpret_cast<uint8_t *>(m_Pending.data());
+  int converted = swr_convert(
+      m_SwrContext, &out, capacity,
+      frame ? (const uint8_t **)frame->data : nullptr, inSamples);
+  if (converted <= 0)
+    return;
+
+  // Drop the pre-roll in front of a seek target
+  int skip = 0;
+  if (m_NextTime < m_SkipUntil) {
+    skip = static_cast<int>(std::lround((m_SkipUntil - m_NextTime) *
+                                        AudioEngine::kSampleRate));
+    skip = std::min(skip, converted);
+  }
+  m_NextTime += static_cast<double>(converted) / AudioEngine::kSampleRate;
+  m_PendingRead = skip;
+  m_PendingFrames = converted;
+}
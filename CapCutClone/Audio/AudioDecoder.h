@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswresample/swresample.h>
+}
+
+/**
+ * @brief Pull-style decode of a file's first audio stream
+ *
+ * Reads the container sequentially and returns audio in the engine format
+ * (48 kHz stereo interleaved float) as fast as it decodes, with no threads
+ * and no audio output: for offline work such as loudness analysis and the
+ * export mix. Seek() is sample accurate; the pre-roll from the keyframe
+ * before the target is decoded and dropped. Not thread safe.
+ */
+class AudioDecoder {
+public:
+  AudioDecoder();
+  ~AudioDecoder();
+
+  AudioDecoder(const AudioDecoder &) = delete;
+  AudioDecoder &operator=(const AudioDecoder &) = delete;
+
+  /**
+   * @return False if the file cannot be opened or has no decodable audio
+   */
+  bool Open(const std::string &filepath);
+  void Close();
+
+  bool IsOpen() const { return m_CodecContext != nullptr; }
+  const std::string &GetPath() const { return m_Path; }
+
+  /**
+   * @brief Make the next Read() start at @p seconds
+   */
+  bool Seek(double seconds);
+
+  /**
+   * @return Frames written to @p interleaved; fewer than @p maxFrames only
+   * at the end of the stream
+   */
+  int Read(float *interleaved, int maxFrames);
+
+private:
+  bool DecodeFrame(); // Into m_Pending, false at the end of the stream
+  void Convert(const AVFrame *frame); // Null drains the resampler
+
+  std::string m_Path;
+  AVFormatContext *m_FormatContext;
+  AVCodecContext *m_CodecContext;
+  SwrContext *m_SwrContext;
+  AVPacket *m_Packet;
+  AVFrame *m_Frame;
+  int m_StreamIndex;
+
+  std::vector<float> m_Pending; // Converted, not read yet
+  int m_PendingRead;            // Frames
+  int m_PendingFrames;
+  double m_NextTime;  // Source time of the next converted frame
+  double m_SkipUntil; // Converted audio before this is dropped
+  bool m_Draining;    // Decoder sent the end of stream
+  bool m_Ended;
+};
@@ -0,0 +1,501 @@
+#include "AudioEffectChain.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIOEFFECTS_SSE 1
+#endif
+
+namespace {
+
+constexpr int kChannels = AudioEngine::kChannels;
+constexpr double kSampleRate = AudioEngine::kSampleRate;
+constexpr int kControlFrames = AudioEffectChain::kControlFrames;
+constexpr int kGateHoldFrames = AudioEngine::kSampleRate / 20; // 50 ms
+constexpr int kStatsWindow = AudioEngine::kSampleRate / 4;     // 250 ms
+constexpr float kMinLevel = -120.0f;                            // dB
+constexpr double kPi = 3.14159265358979323846;
+
+float DbToGain(float db) { return std::pow(10.0f, db / 20.0f); }
+
+float LevelDb(float peak) {
+  return peak > 1e-6f ? 20.0f * std::log10(peak) : kMinLevel;
+}
+
+// Frames needed to move @p ms; at least one
+float MsToFrames(float ms) {
+  return std::max(1.0f, ms * static_cast<float>(kSampleRate) / 1000.0f);
+}
+
+float FadeGain(FadeCurve curve, double progress) {
+  float x = static_cast<float>(std::clamp(progress, 0.0, 1.0));
+  switch (curve) {
+  case FadeCurve::EqualPower:
+    return std::sin(x * static_cast<float>(kPi) * 0.5f);
+  case FadeCurve::Exponential:
+    return x * x * x;
+  default:
+    return x;
+  }
+}
+
+// RBJ cookbook biquads, normalized to a0 = 1: {b0, b1, b2, a1, a2}
+enum class BandShape { LowShelf, Peak, HighShelf };
+
+void DesignBand(BandShape shape, float freq, float gainDb, float q,
+                double c[5]) {
+  double f = std::clamp(static_cast<double>(freq), 20.0, kSampleRate * 0.45);
+  double a = std::pow(10.0, gainDb / 40.0);
+  double w0 = 2.0 * kPi * f / kSampleRate;
+  double cosW = std::cos(w0);
+  double sinW = std::sin(w0);
+
+  double b0, b1, b2, a0, a1, a2;
+  if (shape == BandShape::Peak) {
+    double alpha = sinW / (2.0 * std::max(0.1, static_cast<double>(q)));
+    b0 = 1.0 + alpha * a;
+    b1 = -2.0 * cosW;
+    b2 = 1.0 - alpha * a;
+    a0 = 1.0 + alpha / a;
+    a1 = -2.0 * cosW;
+    a2 = 1.0 - alpha / a;
+  } else {
+    // Shelf slope 1
+    double beta = 2.0 * std::sqrt(a) * sinW / std::sqrt(2.0);
+    double sign = shape == BandShape::LowShelf ? 1.0 : -1.0;
+    b0 = a * ((a + 1.0) - sign * (a - 1.0) * cosW + beta);
+    b1 = sign * 2.0 * a * ((a - 1.0) - sign * (a + 1.0) * cosW);
+    b2 = a * ((a + 1.0) - sign * (a - 1.0) * cosW - beta);
+    a0 = (a + 1.0) + sign * (a - 1.0) * cosW + beta;
+    a1 = -sign * 2.0 * ((a - 1.0) + sign * (a + 1.0) * cosW);
+    a2 = (a + 1.0) + sign * (a - 1.0) * cosW - beta;
+  }
+  c[0] = b0 / a0;
+  c[1] = b1 / a0;
+  c[2] = b2 / a0;
+  c[3] = a1 / a0;
+  c[4] = a2 / a0;
+}
+
+// Gain change in dB (<= 0) for a detector level, soft knee around the
+// threshold
+float CompressorCurve(float level, float threshold, float ratio,
+                      float knee) {
+  float over = level - threshold;
+  float slope = 1.0f / std::max(1.0f, ratio) - 1.0f;
+  if (2.0f * over <= -knee)
+    return 0.0f;
+  if (2.0f * std::abs(over) < knee) {
+    float x = over + knee * 0.5f;
+    return slope * x * x / (2.0f * knee);
+  }
+  return slope * over;
+}
+
+#ifdef AUDIOEFFECTS_SSE
+int PeakSSE(const float *samples, int count, float &peak) {
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 maxAbs = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+    maxAbs = _mm_max_ps(maxAbs, _mm_andnot_ps(sign, _mm_loadu_ps(samples + i)));
+  float lanes[4];
+  _mm_storeu_ps(lanes, maxAbs);
+  peak = std::max({peak, lanes[0], lanes[1], lanes[2], lanes[3]});
+  return i;
+}
+
+// Two frames per vector, as AudioEngine::MixStereo
+int RampSSE(float *interleaved, int frames, float gain, float step) {
+  const __m128 start = _mm_set1_ps(gain);
+  const __m128 steps = _mm_set1_ps(step);
+  __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+
+  int frame = 0;
+  for (; frame + 2 <= frames; frame += 2) {
+    __m128 g = _mm_add_ps(start, _mm_mul_ps(steps, index));
+    float *p = interleaved + frame * kChannels;
+    _mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), g));
+    index = _mm_add_ps(index, two);
+  }
+  return frame;
+}
+
+// Both channels of a frame share a register; the biquads are recursive in
+// time, so the channels are the only lanes available
+int EQSSE(float *interleaved, int frames, const double (*c)[5],
+          const int *bands, int bandCount, double (*z1)[2],
+          double (*z2)[2]) {
+  __m128d s1[3], s2[3];
+  for (int b = 0; b < bandCount; ++b) {
+    s1[b] = _mm_loadu_pd(z1[bands[b]]);
+    s2[b] = _mm_loadu_pd(z2[bands[b]]);
+  }
+  for (int f = 0; f < frames; ++f) {
+    float *p = interleaved + f * kChannels;
+    __m128d x = _mm_cvtps_pd(
+        _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i *>(p))));
+    for (int b = 0; b < bandCount; ++b) {
+      const double *k = c[bands[b]];
+      __m128d y = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(k[0]), x), s1[b]);
+      s1[b] = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(k[1]), x),
+                                    _mm_mul_pd(_mm_set1_pd(k[3]), y)),
+                         s2[b]);
+      s2[b] = _mm_sub_pd(_mm_mul_pd(_mm_set1_pd(k[2]), x),
+                         _mm_mul_pd(_mm_set1_pd(k[4]), y));
+      x = y;
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(p),
+                     _mm_castps_si128(_mm_cvtpd_ps(x)));
+  }
+  for (int b = 0; b < bandCount; ++b) {
+    _mm_storeu_pd(z1[bands[b]], s1[b]);
+    _mm_storeu_pd(z2[bands[b]], s2[b]);
+  }
+  return frames;
+}
+#endif
+
+float BlockPeak(const float *interleaved, int frames) {
+  const int count = frames * kChannels;
+  float peak = 0.0f;
+  int done = 0;
+#ifdef AUDIOEFFECTS_SSE
+  if (AudioEngine::IsSIMDEnabled())
+    done = PeakSSE(interleaved, count, peak);
+#endif
+  for (int i = done; i < count; ++i)
+    peak = std::max(peak, std::abs(interleaved[i]));
+  return peak;
+}
+
+// Gain goes from @p from to @p to across the block (reaching @p to on the
+// first frame after it)
+void ScaleBlock(float *interleaved, int frames, float from, float to) {
+  if (from == 1.0f && to == 1.0f)
+    return;
+  if (from == 0.0f && to == 0.0f) {
+    std::memset(interleaved, 0, sizeof(float) * frames * kChannels);
+    return;
+  }
+
+  float step = (to - from) / frames;
+  int done = 0;
+#ifdef AUDIOEFFECTS_SSE
+  if (AudioEngine::IsSIMDEnabled())
+    done = RampSSE(interleaved, frames, from, step);
+#endif
+  for (int f = done; f < frames; ++f) {
+    float gain = from + step * static_cast<float>(f);
+    interleaved[f * kChannels] *= gain;
+    interleaved[f * kChannels + 1] *= gain;
+  }
+}
+
+int64_t NanosSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+AudioEffectChain::AudioEffectChain()
+    : m_Active(false), m_GateThreshold(0.0f), m_GateAttackStep(1.0f),
+      m_GateReleaseStep(1.0f), m_Bands(0), m_AttackCoef(0.0f),
+      m_ReleaseCoef(0.0f), m_Ceiling(1.0f), m_LimiterReleaseStep(1.0f),
+      m_TotalFrames(0) {
+  for (int s = 0; s < kStageCount; ++s) {
+    m_Load[s] = 0.0f;
+    m_TotalNanos[s] = 0;
+  }
+  SetSettings(AudioEffectSettings());
+  Reset();
+}
+
+void AudioEffectChain::SetSettings(const AudioEffectSettings &settings) {
+  const AudioEffectSettings previous = m_Settings;
+  m_Settings = settings;
+  m_Active = settings.HasChainEffects();
+
+  const AudioEffectSettings::Gate &gate = settings.gate;
+  m_GateThreshold = DbToGain(gate.threshold);
+  m_GateAttackStep = 1.0f / MsToFrames(gate.attack);
+  m_GateReleaseStep = 1.0f / MsToFrames(gate.release);
+  if (gate.enabled && !previous.gate.enabled) {
+    m_GateGain = 1.0f;
+    m_GateHold = kGateHoldFrames;
+  }
+
+  // A band with no gain is skipped; one coming back starts from rest
+  const AudioEffectSettings::EQ &eq = settings.eq;
+  const float gains[kMaxBands] = {eq.lowGain, eq.midGain, eq.highGain};
+  const float wasGains[kMaxBands] = {previous.eq.lowGain, previous.eq.midGain,
+                                     previous.eq.highGain};
+  DesignBand(BandShape::LowShelf, eq.lowFreq, eq.lowGain, 0.0f,
+             m_Coefficients[0]);
+  DesignBand(BandShape::Peak, eq.midFreq, eq.midGain, eq.midQ,
+             m_Coefficients[1]);
+  DesignBand(BandShape::HighShelf, eq.highFreq, eq.highGain, 0.0f,
+             m_Coefficients[2]);
+  m_Bands = 0;
+  for (int b = 0; b < kMaxBands; ++b) {
+    bool active = std::abs(gains[b]) >= 0.01f;
+    bool wasActive = previous.eq.enabled && std::abs(wasGains[b]) >= 0.01f;
+    if (active && (!wasActive || !eq.enabled)) {
+      m_Z1[b][0] = m_Z1[b][1] = 0.0;
+      m_Z2[b][0] = m_Z2[b][1] = 0.0;
+    }
+    if (active)
+      m_Band[m_Bands++] = b;
+  }
+
+  const AudioEffectSettings::Compressor &compressor = settings.compressor;
+  m_AttackCoef = std::exp(-kControlFrames / MsToFrames(compressor.attack));
+  m_ReleaseCoef = std::exp(-kControlFrames / MsToFrames(compressor.release));
+  if (compressor.enabled && !previous.compressor.enabled) {
+    m_Reduction = 0.0f;
+    m_CompressorGain = DbToGain(compressor.makeup);
+  }
+
+  const AudioEffectSettings::Limiter &limiter = settings.limiter;
+  m_Ceiling = DbToGain(std::min(0.0f, limiter.ceiling));
+  m_LimiterReleaseStep = 1.0f / MsToFrames(limiter.release);
+  if (limiter.enabled && !previous.limiter.enabled) {
+    m_LimiterGain = 1.0f;
+    std::memset(m_Lookahead, 0, sizeof(m_Lookahead));
+  }
+
+  // Disabled stages stop reporting right away
+  const bool enabled[kStageCount] = {gate.enabled, eq.enabled,
+                                     compressor.enabled, limiter.enabled};
+  for (int s = 0; s < kStageCount; ++s) {
+    if (!enabled[s])
+      m_Load[s].store(0.0f, std::memory_order_relaxed);
+  }
+}
+
+void AudioEffectChain::Reset() {
+  m_GateGain = 1.0f;
+  m_GateHold = kGateHoldFrames;
+  for (int b = 0; b < kMaxBands; ++b) {
+    m_Z1[b][0] = m_Z1[b][1] = 0.0;
+    m_Z2[b][0] = m_Z2[b][1] = 0.0;
+  }
+  m_Reduction = 0.0f;
+  m_CompressorGain = DbToGain(m_Settings.compressor.makeup);
+  m_LimiterGain = 1.0f;
+  std::memset(m_Lookahead, 0, sizeof(m_Lookahead));
+
+  for (int s = 0; s < kStageCount; ++s) {
+    m_WindowNanos[s] = 0;
+    m_Load[s].store(0.0f, std::memory_order_relaxed);
+    m_TotalNanos[s].store(0, std::memory_order_relaxed);
+  }
+  m_WindowFrames = 0;
+  m_TotalFrames.store(0, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Processing
+// ============================================================================
+
+void AudioEffectChain::Process(float *interleaved, int frames) {
+  if (!m_Active || frames <= 0)
+    return;
+
+  using Clock = std::chrono::steady_clock;
+  if (m_Settings.gate.enabled) {
+    Clock::time_point start = Clock::now();
+    ProcessGate(interleaved, frames);
+    AddTime(Gate, NanosSince(start));
+  }
+  if (m_Settings.eq.enabled && m_Bands > 0) {
+    Clock::time_point start = Clock::now();
+    ProcessEQ(interleaved, frames);
+    AddTime(EQ, NanosSince(start));
+  }
+  if (m_Settings.compressor.enabled) {
+    Clock::time_point start = Clock::now();
+    ProcessCompressor(interleaved, frames);
+    AddTime(Compressor, NanosSince(start));
+  }
+  if (m_Settings.limiter.enabled) {
+    Clock::time_point start = Clock::now();
+    ProcessLimiter(interleaved, frames);
+    AddTime(Limiter, NanosSince(start));
+  }
+  PublishStats(frames);
+}
+
+void AudioEffectChain::ProcessGate(float *interleaved, int frames) {
+  for (int done = 0; done < frames; done += kControlFrames) {
+    int n = std::min(kControlFrames, frames - done);
+    float *block = interleaved + done * kChannels;
+
+    if (BlockPeak(block, n) >= m_GateThreshold)
+      m_GateHold = kGateHoldFrames;
+    else
+      m_GateHold = std::max(0, m_GateHold - n);
+
+    float gain = m_GateHold > 0
+                     ? std::min(1.0f, m_GateGain + n * m_GateAttackStep)
+                     : std::max(0.0f, m_GateGain - n * m_GateReleaseStep);
+    ScaleBlock(block, n, m_GateGain, gain);
+    m_GateGain = gain;
+  }
+}
+
+void AudioEffectChain::ProcessEQ(float *interleaved, int frames) {
+  int done = 0;
+#ifdef AUDIOEFFECTS_SSE
+  if (AudioEngine::IsSIMDEnabled())
+    done = EQSSE(interleaved, frames, m_Coefficients, m_Band, m_Bands, m_Z1,
+                 m_Z2);
+#endif
+  for (int b = 0; b < m_Bands && done < frames; ++b) {
+    const double *c = m_Coefficients[m_Band[b]];
+    double *z1 = m_Z1[m_Band[b]];
+    double *z2 = m_Z2[m_Band[b]];
+    for (int f = done; f < frames; ++f) {
+      for (int ch = 0; ch < kChannels; ++ch) {
+        float &sample = interleaved[f * kChannels + ch];
+        double x = sample;
+        double y = c[0] * x + z1[ch];
+        z1[ch] = c[1] * x - c[3] * y + z2[ch];
+        z2[ch] = c[2] * x - c[4] * y;
+        sample = static_cast<float>(y);
+      }
+    }
+  }
+}
+
+void AudioEffectChain::ProcessCompressor(float *interleaved, int frames) {
+  const AudioEffectSettings::Compressor &settings = m_Settings.compressor;
+  const float makeup = settings.makeup;
+  for (int done = 0; done < frames; done += kControlFrames) {
+    int n = std::min(kControlFrames, frames - done);
+    float *block = interleaved + done * kChannels;
+
+    float target =
+        CompressorCurve(LevelDb(BlockPeak(block, n)), settings.threshold,
+                        settings.ratio, settings.knee);
+    float coef = target < m_Reduction ? m_AttackCoef : m_ReleaseCoef;
+    if (n != kControlFrames)
+      coef = std::pow(coef, static_cast<float>(n) / kControlFrames);
+    m_Reduction = target + (m_Reduction - target) * coef;
+
+    float gain = DbToGain(m_Reduction + makeup);
+    ScaleBlock(block, n, m_CompressorGain, gain);
+    m_CompressorGain = gain;
+  }
+}
+
+void AudioEffectChain::ProcessLimiter(float *interleaved, int frames) {
+  // m_Lookahead holds the last kLookaheadFrames of input; each block is
+  // appended, the oldest frames go out with a gain that already covers
+  // every frame still in the window
+  constexpr int kHeld = kLookaheadFrames * kChannels;
+  for (int done = 0; done < frames; done += kControlFrames) {
+    int n = std::min(kControlFrames, frames - done);
+    float *block = interleaved + done * kChannels;
+    const size_t bytes = sizeof(float) * n * kChannels;
+
+    std::memcpy(m_Lookahead + kHeld, block, bytes);
+    float peak = BlockPeak(m_Lookahead, kLookaheadFrames + n);
+    float target = peak > m_Ceiling ? m_Ceiling / peak : 1.0f;
+    float gain = std::min(target, m_LimiterGain + n * m_LimiterReleaseStep);
+
+    std::memcpy(block, m_Lookahead, bytes);
+    ScaleBlock(block, n, m_LimiterGain, gain);
+    std::memmove(m_Lookahead, m_Lookahead + n * kChannels,
+                 sizeof(float) * kHeld);
+    m_LimiterGain = gain;
+  }
+}
+
+void AudioEffectChain::ApplyFades(float *interleaved, int frames,
+                                  double clipTime, double timeStep,
+                                  double clipLength,
+                                  const AudioEffectSettings::Fades &fades) {
+  double endTime = clipTime + frames * timeStep;
+  bool inFadeIn = fades.in > 0.0f && clipTime < fades.in;
+  bool inFadeOut = fades.out > 0.0f && endTime > clipLength - fades.out;
+  if (!inFadeIn && !inFadeOut)
+    return;
+
+  auto gainAt = [&](double time) {
+    float gain = 1.0f;
+    if (fades.in > 0.0f && time < fades.in)
+      gain = FadeGain(fades.curve, time / fades.in);
+    if (fades.out > 0.0f && time > clipLength - fades.out)
+      gain = std::min(gain,
+                      FadeGain(fades.curve, (clipLength - time) / fades.out));
+    return gain;
+  };
+
+  float from = gainAt(clipTime);
+  for (int done = 0; done < frames; done += kControlFrames) {
+    int n = std::min(kControlFrames, frames - done);
+    float to = gainAt(clipTime + (done + n) * timeStep);
+    ScaleBlock(interleaved + done * kChannels, n, from, to);
+    from = to;
+  }
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+void AudioEffectChain::AddTime(Stage stage, int64_t nanoseconds) {
+  m_WindowNanos[stage] += nanoseconds;
+  m_TotalNanos[stage].fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void AudioEffectChain::PublishStats(int frames) {
+  m_TotalFrames.fetch_add(frames, std::memory_order_relaxed);
+  m_WindowFrames += frames;
+  if (m_WindowFrames < kStatsWindow)
+    return;
+
+  double audioNanos = m_WindowFrames * 1e9 / kSampleRate;
+  for (int s = 0; s < kStageCount; ++s) {
+    m_Load[s].store(static_cast<float>(m_WindowNanos[s] / audioNanos),
+                    std::memory_order_relaxed);
+    m_WindowNanos[s] = 0;
+  }
+  m_WindowFrames = 0;
+}
+
+AudioEffectChain::Stats AudioEffectChain::GetStats() const {
+  Stats stats{};
+  int64_t frames = m_TotalFrames.load(std::memory_order_relaxed);
+  double audioNanos = frames * 1e9 / kSampleRate;
+  for (int s = 0; s < kStageCount; ++s) {
+    stats.load[s] = m_Load[s].load(std::memory_order_relaxed);
+    if (frames > 0)
+      stats.averageLoad[s] = static_cast<float>(
+          m_TotalNanos[s].load(std::memory_order_relaxed) / audioNanos);
+  }
+  return stats;
+}
+
+const char *AudioEffectChain::GetStageName(Stage stage) {
+  switch (stage) {
+  case Gate:
+    return "Noise Gate";
+  case EQ:
+    return "EQ";
+  case Compressor:
+    return "Compressor";
+  case Limiter:
+    return "Limiter";
+  default:
+    return "";
+  }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "AudioEffectSettings.h"
+#include "AudioEngine.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief One track's audio effects: gate, EQ, compressor, limiter
+ *
+ * Processes interleaved engine-format blocks in place. The stages are
+ * fixed members called in order (no virtual dispatch) and the chain owns
+ * all its state, so Process() never allocates or locks: the same object
+ * type runs on a bus in the device callback and per track in the export
+ * mixer, with identical output.
+ *
+ * The EQ runs three transposed direct form II biquads with both channels
+ * in one SSE2 register. The dynamics stages measure each 16-frame control
+ * block with SSE (peak of both channels) and apply a per-frame gain ramp
+ * to it, so level detection and gain math run once per block. The
+ * limiter looks ahead one control block (16 frames of latency while it is
+ * enabled) and never lets a sample past its ceiling. SIMD follows
+ * AudioEngine::SetSIMDEnabled().
+ *
+ * Each stage's processing time is measured per call and reported as a
+ * fraction of the audio's real-time duration (GetStats()), readable from
+ * any thread.
+ */
+class AudioEffectChain {
+public:
+  enum Stage { Gate, EQ, Compressor, Limiter, kStageCount };
+
+  static constexpr int kControlFrames = 16;
+  static constexpr int kLookaheadFrames = kControlFrames; ///< Limiter
+
+  struct Stats {
+    float load[kStageCount];        ///< CPU / audio time, last ~250 ms
+    float averageLoad[kStageCount]; ///< Since Reset()
+  };
+
+  AudioEffectChain();
+
+  AudioEffectChain(const AudioEffectChain &) = delete;
+  AudioEffectChain &operator=(const AudioEffectChain &) = delete;
+
+  /**
+   * @brief Take new parameters; keeps filter and envelope state
+   */
+  void SetSettings(const AudioEffectSettings &settings);
+
+  /**
+   * @brief Clear filter, envelope, lookahead and statistics
+   */
+  void Reset();
+
+  bool IsActive() const { return m_Active; } ///< Any stage enabled
+
+  void Process(float *interleaved, int frames);
+
+  Stats GetStats() const;
+  static const char *GetStageName(Stage stage);
+
+  /**
+   * @brief Apply a clip's fade in/out to the samples starting at
+   * @p clipTime seconds into the clip, advancing @p timeStep per frame
+   */
+  static void ApplyFades(float *interleaved, int frames, double clipTime,
+                         double timeStep, double clipLength,
+                         const AudioEffectSettings::Fades &fades);
+
+private:
+  static constexpr int kMaxBands = 3;
+
+  void ProcessGate(float *interleaved, int frames);
+  void ProcessEQ(float *interleaved, int frames);
+  void ProcessCompressor(float *interleaved, int frames);
+  void ProcessLimiter(float *interleaved, int frames);
+  void AddTime(Stage stage, int64_t nanoseconds);
+  void PublishStats(int frames);
+
+  AudioEffectSettings m_Settings;
+  bool m_Active;
+
+  // Gate
+  float m_GateThreshold; // Linear
+  float m_GateAttackStep, m_GateReleaseStep; // Gain per frame
+  float m_GateGain;
+  int m_GateHold; // Frames the gate stays open after the last peak
+
+  // EQ: {b0, b1, b2, a1, a2} and state [band][channel] for low, mid, high
+  double m_Coefficients[kMaxBands][5];
+  double m_Z1[kMaxBands][2];
+  double m_Z2[kMaxBands][2];
+  int m_Band[kMaxBands]; // Bands with gain, in order
+  int m_Bands;
+
+  // Compressor, in dB
+  float m_AttackCoef, m_ReleaseCoef; // Per full control block
+  float m_Reduction;                 // Smoothed, <= 0
+  float m_CompressorGain;            // Linear, end of the last block
+
+  // Limiter
+  float m_Ceiling; // Linear
+  float m_LimiterReleaseStep;
+  float m_LimiterGain;
+  float m_Lookahead[(kLookaheadFrames + kControlFrames) *
+                    AudioEngine::kChannels];
+
+  // Statistics; the window is written by the processing thread only
+  int64_t m_WindowNanos[kStageCount];
+  int64_t m_WindowFrames;
+  std::atomic<float> m_Load[kStageCount];
+  std::atomic<int64_t> m_TotalNanos[kStageCount];
+  std::atomic<int64_t> m_TotalFrames;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @brief Shape of a fade, gain as a function of its progress 0..1
+ */
+enum class FadeCurve : int {
+  Linear = 0,
+  EqualPower = 1, ///< sin, constant power across a crossfade
+  Exponential = 2 ///< Cubic, slow start (close to linear in dB)
+};
+
+/**
+ * @brief Parameters of a track's audio effect chain
+ *
+ * Plain data stored on the Track and saved with the project; an
+ * AudioEffectChain turns it into filter coefficients. The chain runs in
+ * a fixed order: gate, EQ, compressor, limiter. Fades apply to each clip
+ * on the track, before the chain.
+ */
+struct AudioEffectSettings {
+  struct Gate {
+    bool enabled = false;
+    float threshold = -50.0f; ///< dBFS, opens above
+    float attack = 1.0f;      ///< ms to open fully
+    float release = 100.0f;   ///< ms to close fully
+  };
+
+  // Low shelf, peak, high shelf; 0 dB bypasses a band
+  struct EQ {
+    bool enabled = false;
+    float lowGain = 0.0f; ///< dB
+    float lowFreq = 120.0f;
+    float midGain = 0.0f;
+    float midFreq = 1000.0f;
+    float midQ = 1.0f;
+    float highGain = 0.0f;
+    float highFreq = 8000.0f;
+  };
+
+  struct Compressor {
+    bool enabled = false;
+    float threshold = -18.0f; ///< dBFS
+    float ratio = 4.0f;
+    float knee = 6.0f;      ///< dB
+    float attack = 10.0f;   ///< ms
+    float release = 120.0f; ///< ms
+    float makeup = 0.0f;    ///< dB
+  };
+
+  struct Limiter {
+    bool enabled = false;
+    float ceiling = -1.0f; ///< dBFS, sample peak
+    float release = 50.0f; ///< ms to recover 1.0 of linear gain
+  };
+
+  // At both ends of every clip, in timeline seconds
+  struct Fades {
+    float in = 0.0f;
+    float out = 0.0f;
+    FadeCurve curve = FadeCurve::EqualPower;
+  };
+
+  Gate gate;
+  EQ eq;
+  Compressor compressor;
+  Limiter limiter;
+  Fades fades;
+
+  bool HasChainEffects() const {
+    return gate.enabled || eq.enabled || compressor.enabled ||
+           limiter.enabled;
+  }
+  bool HasFades() const { return fades.in > 0.0f || fades.out > 0.0f; }
+};
@@ -0,0 +1,563 @@
+#define MINIAUDIO_IMPLEMENTATION
+#include "AudioEngine.h"
+#include "AudioEffectChain.h"
+#include "miniaudio.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#if defined(__SSE__) || defined(_M_X64) ||                                     \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AUDIOENGINE_SSE 1
+#endif
+
+namespace {
+
+constexpr int kChannels = AudioEngine::kChannels;
+constexpr int kQueueFrames = AudioEngine::kQueueFrames;
+constexpr int kDeclickFrames = 64; // Fade-in after a flush (~1.3 ms)
+constexpr int kBusFrames = 512;    // Callback blocks are split to this
+
+struct Voice {
+  std::atomic<bool> inUse{false};
+  std::atomic<bool> playing{false};
+  std::atomic<bool> paused{false};
+  std::atomic<uint32_t> generation{0}; // Bumped by AcquireVoice()
+  std::unique_ptr<float[]> ring;       // Allocated on first acquire, kept
+
+  std::atomic<uint64_t> writePos{0}; // Producer
+  std::atomic<uint64_t> readPos{0};  // Callback
+  std::atomic<uint64_t> flushPos{0}; // Producer: callback skips up to here
+  std::atomic<uint64_t> startClock{0};
+  std::atomic<float> gain{1.0f};
+  std::atomic<float> pan{0.0f};
+  std::atomic<int> fadeRequest{0}; // > 0 fade in, < 0 fade out (frames)
+  std::atomic<int> bus{0};
+
+  // Callback only
+  uint32_t seenGeneration = 0;
+  float gainL = 1.0f;
+  float gainR = 1.0f;
+  float envelope = 1.0f;
+  float envelopeStep = 0.0f;
+  bool pausing = false;    // Fading out for SetPaused(), then held
+  bool resumeFade = false; // Fade back in on unpause
+};
+
+struct Bus {
+  AudioEffectChain chain; // Callback only, apart from GetStats()
+  std::mutex mutex;       // Guards pending
+  AudioEffectSettings pending;
+  std::atomic<bool> dirty{false};
+  float buffer[kBusFrames * kChannels];
+};
+
+std::array<Voice, AudioEngine::kMaxVoices> g_Voices;
+std::array<Bus, AudioEngine::kMaxBuses> g_Buses;
+std::mutex g_Mutex; // Start/Stop and voice allocation
+ma_device g_Device;
+bool g_Running = false;
+std::atomic<uint64_t> g_Clock{0};
+std::mutex g_WaitMutex;               // WaitWritable() only
+std::condition_variable g_Consumed;   // Queue space freed (or a wake-up)
+std::atomic<bool> g_SIMDEnabled{true};
+
+Voice *GetVoice(int voice) {
+  if (voice < 0 || voice >= AudioEngine::kMaxVoices)
+    return nullptr;
+  return &g_Voices[voice];
+}
+
+Bus *GetBus(int bus) {
+  if (bus < 0 || bus >= AudioEngine::kMaxBuses)
+    return nullptr;
+  return &g_Buses[bus];
+}
+
+// Balance law: unity in the center, the far side fades out
+void PanGains(float gain, float pan, float &left, float &right) {
+  pan = std::clamp(pan, -1.0f, 1.0f);
+  left = gain * std::min(1.0f, 1.0f - pan);
+  right = gain * std::min(1.0f, 1.0f + pan);
+}
+
+#ifdef AUDIOENGINE_SSE
+int MixStereoSSE(float *dst, const float *src, int frames, float gainL,
+                 float gainR, float stepL, float stepR) {
+  // Two frames per vector; gain = start + step * frame index
+  const __m128 start = _mm_setr_ps(gainL, gainR, gainL, gainR);
+  const __m128 step = _mm_setr_ps(stepL, stepR, stepL, stepR);
+  __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+
+  int frame = 0;
+  for (; frame + 2 <= frames; frame += 2) {
+    __m128 gain = _mm_add_ps(start, _mm_mul_ps(step, index));
+    __m128 in = _mm_loadu_ps(src + frame * kChannels);
+    __m128 out = _mm_loadu_ps(dst + frame * kChannels);
+    _mm_storeu_ps(dst + frame * kChannels,
+                  _mm_add_ps(out, _mm_mul_ps(in, gain)));
+    index = _mm_add_ps(index, two);
+  }
+  return frame;
+}
+
+int ClampSSE(float *samples, int count) {
+  const __m128 lo = _mm_set1_ps(-1.0f);
+  const __m128 hi = _mm_set1_ps(1.0f);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_loadu_ps(samples + i);
+    _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(v, lo), hi));
+  }
+  return i;
+}
+#endif
+
+void ClampSamples(float *samples, int count) {
+  int done = 0;
+#ifdef AUDIOENGINE_SSE
+  if (g_SIMDEnabled.load(std::memory_order_relaxed))
+    done = ClampSSE(samples, count);
+#endif
+  for (int i = done; i < count; ++i)
+    samples[i] = std::clamp(samples[i], -1.0f, 1.0f);
+}
+
+// False if nothing was mixed (paused, held back or starved)
+bool MixVoice(Voice &voice, float *out, int frameCount, uint64_t clock) {
+  uint32_t generation = voice.generation.load(std::memory_order_acquire);
+  if (generation != voice.seenGeneration) {
+    // Newly acquired: start at the set gain, no ramp from the last owner
+    voice.seenGeneration = generation;
+    PanGains(voice.gain.load(std::memory_order_relaxed),
+             voice.pan.load(std::memory_order_relaxed), voice.gainL,
+             voice.gainR);
+    voice.envelope = 1.0f;
+    voice.envelopeStep = 0.0f;
+    voice.pausing = false;
+  }
+
+  uint64_t read = voice.readPos.load(std::memory_order_relaxed);
+  uint64_t flush = voice.flushPos.load(std::memory_order_acquire);
+  if (flush > read) {
+    read = flush;
+    // Declick the jump unless the voice was faded out on purpose
+    if (voice.envelope > 0.0f || voice.envelopeStep > 0.0f) {
+      voice.envelope = 0.0f;
+      voice.envelopeStep = 1.0f / kDeclickFrames;
+    }
+  }
+
+  int fade = voice.fadeRequest.exchange(0, std::memory_order_acq_rel);
+  if (fade > 0)
+    voice.envelopeStep = 1.0f / fade;
+  else if (fade < 0)
+    voice.envelopeStep = 1.0f / fade; // Negative
+
+  // Pause: fade out over one declick, then hold the queue where it is
+  bool paused = voice.paused.load(std::memory_order_relaxed);
+  if (paused && !voice.pausing) {
+    voice.pausing = true;
+    voice.resumeFade = voice.envelope > 0.0f || voice.envelopeStep > 0.0f;
+    voice.envelopeStep = -1.0f / kDeclickFrames;
+  } else if (!paused && voice.pausing) {
+    voice.pausing = false;
+    voice.envelopeStep = voice.resumeFade ? 1.0f / kDeclickFrames : 0.0f;
+  }
+  if (voice.pausing && voice.envelope <= 0.0f) {
+    voice.readPos.store(read, std::memory_order_release);
+    return false;
+  }
+
+  // Held back by StartAt()
+  int offset = 0;
+  uint64_t start = voice.startClock.load(std::memory_order_relaxed);
+  if (start > clock) {
+    if (start >= clock + frameCount) {
+      voice.readPos.store(read, std::memory_order_release);
+      return false;
+    }
+    offset = static_cast<int>(start - clock);
+  }
+
+  uint64_t write = voice.writePos.load(std::memory_order_acquire);
+  int frames = static_cast<int>(
+      std::min<uint64_t>(write - read, frameCount - offset));
+  if (frames <= 0) {
+    voice.readPos.store(read, std::memory_order_release);
+    return false;
+  }
+
+  // Ramp gain/pan and the fade envelope across this block
+  float targetL, targetR;
+  PanGains(voice.gain.load(std::memory_order_relaxed),
+           voice.pan.load(std::memory_order_relaxed), targetL, targetR);
+  float envelopeEnd = std::clamp(
+      voice.envelope + voice.envelopeStep * frames, 0.0f, 1.0f);
+  float startL = voice.gainL * voice.envelope;
+  float startR = voice.gainR * voice.envelope;
+  float stepL = (targetL * envelopeEnd - startL) / frames;
+  float stepR = (targetR * envelopeEnd - startR) / frames;
+
+  // The ring wraps at most once per block
+  int index = static_cast<int>(read % kQueueFrames);
+  int first = std::min(frames, kQueueFrames - index);
+  AudioEngine::MixStereo(out + offset * kChannels,
+                         voice.ring.get() + index * kChannels, first, startL,
+                         startR, stepL, stepR);
+  if (first < frames)
+    AudioEngine::MixStereo(out + (offset + first) * kChannels,
+                           voice.ring.get(), frames - first,
+                           startL + stepL * first, startR + stepR * first,
+                           stepL, stepR);
+
+  voice.gainL = targetL;
+  voice.gainR = targetR;
+  voice.envelope = envelopeEnd;
+  if (envelopeEnd <= 0.0f || envelopeEnd >= 1.0f)
+    voice.envelopeStep = 0.0f;
+  voice.readPos.store(read + frames, std::memory_order_release);
+  return true;
+}
+
+// Voices on a bus without effects go straight to the output; the others
+// are summed per bus, run through the bus chain and then added
+void MixBlock(float *out, int frames, uint64_t clock) {
+  uint32_t cleared = 0; // Bus buffers zeroed for this block
+  uint32_t mixed = 0;   // Bus buffers holding audio
+  for (Voice &voice : g_Voices) {
+    if (!voice.playing.load(std::memory_order_acquire))
+      continue;
+    int index = std::clamp(voice.bus.load(std::memory_order_relaxed), 0,
+                           AudioEngine::kMaxBuses - 1);
+    Bus &bus = g_Buses[index];
+    if (!bus.chain.IsActive()) {
+      MixVoice(voice, out, frames, clock);
+      continue;
+    }
+    if (!(cleared & (1u << index))) {
+      std::memset(bus.buffer, 0, sizeof(float) * frames * kChannels);
+      cleared |= 1u << index;
+    }
+    if (MixVoice(voice, bus.buffer, frames, clock))
+      mixed |= 1u << index;
+  }
+
+  for (int index = 0; mixed; ++index, mixed >>= 1) {
+    if (!(mixed & 1u))
+      continue;
+    Bus &bus = g_Buses[index];
+    bus.chain.Process(bus.buffer, frames);
+    AudioEngine::MixStereo(out, bus.buffer, frames, 1.0f, 1.0f, 0.0f, 0.0f);
+  }
+}
+
+// Settings set since the last block; skipped while a setter holds the lock
+void UpdateBuses() {
+  for (Bus &bus : g_Buses) {
+    if (!bus.dirty.load(std::memory_order_acquire))
+      continue;
+    std::unique_lock<std::mutex> lock(bus.mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+      continue;
+    bus.chain.SetSettings(bus.pending);
+    bus.dirty.store(false, std::memory_order_relaxed);
+  }
+}
+
+void DataCallback(ma_device *device, void *output, const void *input,
+                  ma_uint32 frameCount) {
+  (void)device;
+  (void)input;
+  float *out = static_cast<float *>(output);
+  std::memset(out, 0, frameCount * kChannels * sizeof(float));
+
+  UpdateBuses();
+  uint64_t clock = g_Clock.load(std::memory_order_relaxed);
+  for (int done = 0; done < static_cast<int>(frameCount); done += kBusFrames) {
+    int frames = std::min(kBusFrames, static_cast<int>(frameCount) - done);
+    MixBlock(out + done * kChannels, frames, clock + done);
+  }
+
+  ClampSamples(out, static_cast<int>(frameCount) * kChannels);
+  g_Clock.store(clock + frameCount, std::memory_order_release);
+
+  // Without the lock: a producer that misses this catches the next block
+  g_Consumed.notify_all();
+}
+
+} // namespace
+
+// ============================================================================
+// Device
+// ============================================================================
+
+bool AudioEngine::Start() {
+  std::lock_guard<std::mutex> lock(g_Mutex);
+  if (g_Running)
+    return true;
+
+  ma_device_config config = ma_device_config_init(ma_device_type_playback);
+  config.playback.format = ma_format_f32;
+  config.playback.channels = kChannels;
+  config.sampleRate = kSampleRate;
+  config.dataCallback = DataCallback;
+
+  if (ma_device_init(nullptr, &config, &g_Device) != MA_SUCCESS) {
+    std::cerr << "[AudioEngine] Failed to initialize playback device"
+              << std::endl;
+    return false;
+  }
+  if (ma_device_start(&g_Device) != MA_SUCCESS) {
+    std::cerr << "[AudioEngine] Failed to start playback device" << std::endl;
+    ma_device_uninit(&g_Device);
+    return false;
+  }
+
+  g_Running = true;
+  std::cout << "[AudioEngine] Output running: " << kSampleRate << "Hz, "
+            << kChannels << " channels" << std::endl;
+  return true;
+}
+
+void AudioEngine::Stop() {
+  std::lock_guard<std::mutex> lock(g_Mutex);
+  if (!g_Running)
+    return;
+  ma_device_uninit(&g_Device);
+  g_Running = false;
+}
+
+bool AudioEngine::IsRunning() {
+  std::lock_guard<std::mutex> lock(g_Mutex);
+  return g_Running;
+}
+
+uint64_t AudioEngine::GetClock() {
+  return g_Clock.load(std::memory_order_acquire);
+}
+
+// ============================================================================
+// Voices
+// ============================================================================
+
+int AudioEngine::AcquireVoice() {
+  std::lock_guard<std::mutex> lock(g_Mutex);
+  for (int i = 0; i < kMaxVoices; ++i) {
+    Voice &voice = g_Voices[i];
+    if (voice.inUse.load(std::memory_order_relaxed))
+      continue;
+
+    if (!voice.ring)
+      voice.ring = std::make_unique<float[]>(kQueueFrames * kChannels);
+
+    // Counters only move forward: skip whatever the last owner left, so a
+    // callback still finishing the old owner's block stays consistent
+    voice.flushPos.store(voice.writePos.load(std::memory_order_relaxed),
+                         std::memory_order_release);
+    voice.startClock.store(0, std::memory_order_relaxed);
+    voice.gain.store(1.0f, std::memory_order_relaxed);
+    voice.pan.store(0.0f, std::memory_order_relaxed);
+    voice.fadeRequest.store(0, std::memory_order_relaxed);
+    voice.paused.store(false, std::memory_order_relaxed);
+    voice.bus.store(0, std::memory_order_relaxed);
+    voice.generation.fetch_add(1, std::memory_order_release);
+    voice.inUse.store(true, std::memory_order_relaxed);
+    voice.playing.store(true, std::memory_order_release);
+    return i;
+  }
+  std::cerr << "[AudioEngine] All " << kMaxVoices << " voices in use"
+            << std::endl;
+  return -1;
+}
+
+void AudioEngine::ReleaseVoice(int voice) {
+  std::lock_guard<std::mutex> lock(g_Mutex);
+  if (Voice *v = GetVoice(voice)) {
+    v->playing.store(false, std::memory_order_release);
+    v->inUse.store(false, std::memory_order_relaxed);
+  }
+}
+
+void AudioEngine::SetGain(int voice, float gain) {
+  if (Voice *v = GetVoice(voice))
+    v->gain.store(gain, std::memory_order_relaxed);
+}
+
+void AudioEngine::SetPan(int voice, float pan) {
+  if (Voice *v = GetVoice(voice))
+    v->pan.store(pan, std::memory_order_relaxed);
+}
+
+void AudioEngine::FadeIn(int voice, int frames) {
+  if (Voice *v = GetVoice(voice))
+    v->fadeRequest.store(std::max(1, frames), std::memory_order_release);
+}
+
+void AudioEngine::FadeOut(int voice, int frames) {
+  if (Voice *v = GetVoice(voice))
+    v->fadeRequest.store(-std::max(1, frames), std::memory_order_release);
+}
+
+void AudioEngine::SetPaused(int voice, bool paused) {
+  if (Voice *v = GetVoice(voice))
+    v->paused.store(paused, std::memory_order_relaxed);
+}
+
+void AudioEngine::StartAt(int voice, uint64_t clockFrame) {
+  if (Voice *v = GetVoice(voice))
+    v->startClock.store(clockFrame, std::memory_order_relaxed);
+}
+
+void AudioEngine::SetVoiceBus(int voice, int bus) {
+  if (Voice *v = GetVoice(voice))
+    v->bus.store(std::clamp(bus, 0, kMaxBuses - 1), std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Buses
+// ============================================================================
+
+void AudioEngine::SetBusEffects(int bus, const AudioEffectSettings &settings) {
+  Bus *b = GetBus(bus);
+  if (!b)
+    return;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->pending = settings;
+  b->dirty.store(true, std::memory_order_release);
+}
+
+const AudioEffectChain *AudioEngine::GetBusChain(int bus) {
+  Bus *b = GetBus(bus);
+  return b ? &b->chain : nullptr;
+}
+
+// ============================================================================
+// Producer
+// ============================================================================
+
+int AudioEngine::GetWritable(int voice) {
+  Voice *v = GetVoice(voice);
+  if (!v || !v->ring)
+    return 0;
+  uint64_t write = v->writePos.load(std::memory_order_relaxed);
+  uint64_t read = std::max(v->readPos.load(std::memory_order_acquire),
+                           v->flushPos.load(std::memory_order_relaxed));
+  return kQueueFrames - static_cast<int>(write - read);
+}
+
+float *AudioEngine::AcquireWrite(int voice, int &frames) {
+  frames = 0;
+  Voice *v = GetVoice(voice);
+  if (!v || !v->ring)
+    return nullptr;
+
+  int writable = GetWritable(voice);
+  if (writable <= 0)
+    return nullptr;
+  int index =
+      static_cast<int>(v->writePos.load(std::memory_order_relaxed) %
+                       kQueueFrames);
+  frames = std::min(writable, kQueueFrames - index);
+  return v->ring.get() + index * kChannels;
+}
+
+void AudioEngine::CommitWrite(int voice, int frames) {
+  Voice *v = GetVoice(voice);
+  if (!v || frames <= 0)
+    return;
+  v->writePos.fetch_add(frames, std::memory_order_release);
+}
+
+int AudioEngine::Write(int voice, const float *interleaved, int frames) {
+  // What does not fit is dropped, as the device cannot wait
+  int written = 0;
+  while (written < frames) {
+    int span = 0;
+    float *dst = AcquireWrite(voice, span);
+    if (!dst)
+      break;
+    span = std::min(span, frames - written);
+    std::memcpy(dst, interleaved + written * kChannels,
+                span * kChannels * sizeof(float));
+    CommitWrite(voice, span);
+    written += span;
+  }
+  return written;
+}
+
+void AudioEngine::Flush(int voice) {
+  Voice *v = GetVoice(voice);
+  if (!v)
+    return;
+  // The mark only moves forward, so a call from a thread other than the
+  // producer can never undo a later flush
+  uint64_t write = v->writePos.load(std::memory_order_acquire);
+  uint64_t flush = v->flushPos.load(std::memory_order_relaxed);
+  while (flush < write &&
+         !v->flushPos.compare_exchange_weak(flush, write,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+  }
+  WakeWaiters();
+}
+
+bool AudioEngine::WaitWritable(int voice, int frames,
+                               const std::function<bool()> &cancelled) {
+  std::unique_lock<std::mutex> lock(g_WaitMutex);
+  while (GetWritable(voice) < frames) {
+    if (cancelled())
+      return false;
+    g_Consumed.wait(lock);
+  }
+  return true;
+}
+
+void AudioEngine::WakeWaiters() {
+  // Under the lock, so a waiter between its check and its wait is not missed
+  {
+    std::lock_guard<std::mutex> lock(g_WaitMutex);
+  }
+  g_Consumed.notify_all();
+}
+
+// ============================================================================
+// Mixing
+// ============================================================================
+
+void AudioEngine::MixStereo(float *dst, const float *src, int frames,
+                            float gainL, float gainR, float stepL,
+                            float stepR) {
+  int done = 0;
+#ifdef AUDIOENGINE_SSE
+  if (g_SIMDEnabled.load(std::memory_order_relaxed))
+    done = MixStereoSSE(dst, src, frames, gainL, gainR, stepL, stepR);
+#endif
+  for (int frame = done; frame < frames; ++frame) {
+    float index = static_cast<float>(frame);
+    dst[frame * kChannels] += src[frame * kChannels] * (gainL + stepL * index);
+    dst[frame * kChannels + 1] +=
+        src[frame * kChannels + 1] * (gainR + stepR * index);
+  }
+}
+
+void AudioEngine::SetSIMDEnabled(bool enabled) { g_SIMDEnabled = enabled; }
+
+bool AudioEngine::IsSIMDEnabled() {
+  return g_SIMDEnabled.load(std::memory_order_relaxed);
+}
+
+bool AudioEngine::IsSIMDAvailable() {
+#ifdef AUDIOENGINE_SSE
+  return true;
+#else
+  return false;
+#endif
+}
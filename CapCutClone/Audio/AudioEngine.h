@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+class AudioEffectChain;
+struct AudioEffectSettings;
+
+/**
+ * @brief The application's one audio output and its mixer
+ *
+ * A single miniaudio device runs for the life of the process at a fixed
+ * engine format (48 kHz, stereo, float). Sources never touch the device:
+ * each one holds a voice, resamples its decoded audio to the engine format
+ * and writes it into the voice's queue. The device callback sums every
+ * playing voice with its gain, pan and fade envelope.
+ *
+ * Voice queues are single-producer/single-consumer rings with 64-bit read
+ * and write counters. The callback takes no lock and never allocates; a
+ * voice's queue is allocated when it is first acquired and then reused.
+ * Producers can decode straight into the queue with AcquireWrite() and
+ * CommitWrite(). Flush() publishes a "skip to" mark that the callback
+ * honors on its next block instead of touching the ring, so a seek (or
+ * every step of a fast scrub) never locks or stops the device.
+ *
+ * Cuts are seamless because a voice outlives the decoder feeding it: the
+ * next clip's samples are queued right behind the previous clip's. A voice
+ * can also be held back until an exact engine frame with StartAt().
+ *
+ * Gain and pan changes are ramped over one callback block (no zipper
+ * noise); fades run over the requested number of frames.
+ *
+ * Every voice plays into a bus (one per timeline track). A bus with
+ * effects mixes its voices into its own buffer, runs its AudioEffectChain
+ * on it and adds the result to the output; a bus without effects costs
+ * nothing extra. New bus settings are picked up by the callback with a
+ * try-lock, so setting them never blocks the device.
+ */
+class AudioEngine {
+public:
+  static constexpr int kSampleRate = 48000;
+  static constexpr int kChannels = 2;
+  static constexpr int kMaxVoices = 32;
+  static constexpr int kQueueFrames = kSampleRate; ///< 1 s per voice
+  static constexpr int kMaxBuses = 16;
+
+  /**
+   * @brief Open the output device; later calls are no-ops
+   */
+  static bool Start();
+  static void Stop();
+  static bool IsRunning();
+
+  /**
+   * @return Voice index, or -1 if all voices are in use
+   */
+  static int AcquireVoice();
+  static void ReleaseVoice(int voice);
+
+  static void SetGain(int voice, float gain); ///< Linear
+  static void SetPan(int voice, float pan);   ///< -1 left .. 1 right
+  static void FadeIn(int voice, int frames);
+  static void FadeOut(int voice, int frames); ///< Stays silent afterwards
+
+  /**
+   * @brief Stop consuming the queue (with a short fade) until unpaused
+   */
+  static void SetPaused(int voice, bool paused);
+
+  /**
+   * @brief Hold the voice until the engine clock reaches @p clockFrame
+   */
+  static void StartAt(int voice, uint64_t clockFrame);
+
+  static void SetVoiceBus(int voice, int bus); ///< Bus 0 when acquired
+
+  /**
+   * @brief Effects of @p bus from the next callback block on
+   */
+  static void SetBusEffects(int bus, const AudioEffectSettings &settings);
+
+  /**
+   * @brief The bus's chain, for its statistics (GetStats() is thread safe)
+   */
+  static const AudioEffectChain *GetBusChain(int bus);
+
+  // Producer side (one thread per voice)
+  static int Write(int voice, const float *interleaved, int frames);
+  static int GetWritable(int voice);
+  static void Flush(int voice); ///< Drop everything queued; any thread
+
+  /**
+   * @brief Block until @p voice has room for @p frames
+   *
+   * Re-checked after every callback block, Flush() and WakeWaiters(); the
+   * callback only signals, it never takes the waiters' lock.
+   * @param cancelled Checked on each wake-up, e.g. a stop or a newer seek
+   * @return False if cancelled
+   */
+  static bool WaitWritable(int voice, int frames,
+                           const std::function<bool()> &cancelled);
+
+  /**
+   * @brief Wake every WaitWritable() to re-check its cancel predicate
+   */
+  static void WakeWaiters();
+
+  /**
+   * @brief Free space at the write position, for decoding in place
+   * @param frames Receives the contiguous frame count; less than
+   * GetWritable() when the free space wraps around the ring end
+   * @return Null if the queue is full
+   */
+  static float *AcquireWrite(int voice, int &frames);
+
+  /**
+   * @brief Publish @p frames written into the AcquireWrite() region
+   */
+  static void CommitWrite(int voice, int frames);
+
+  /**
+   * @brief Frames the device has played since Start()
+   */
+  static uint64_t GetClock();
+
+  /**
+   * @brief dst += src * gain, interleaved stereo, gain ramped per frame
+   *
+   * Left gain goes from @p gainL by @p stepL per frame, right likewise.
+   * SSE on x86, scalar elsewhere.
+   */
+  static void MixStereo(float *dst, const float *src, int frames,
+                        float gainL, float gainR, float stepL, float stepR);
+
+  /**
+   * @brief Disable the SIMD path (benchmarks and comparisons)
+   */
+  static void SetSIMDEnabled(bool enabled);
+  static bool IsSIMDEnabled(); ///< Also followed by TimeStretch
+  static bool IsSIMDAvailable();
+};
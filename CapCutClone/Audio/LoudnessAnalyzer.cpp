@@ -0,0 +1,145 @@
+#include "LoudnessAnalyzer.h"
+#include "AudioDecoder.h"
+#include "AudioEngine.h"
+#include "LoudnessMeter.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr int kChunkFrames = 4096;
+
+struct State {
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::thread worker;
+  std::deque<std::string> queue;
+  std::string current; // In progress, empty while idle
+  std::unordered_map<std::string, LoudnessAnalyzer::Result> cache;
+  std::atomic<bool> stop{false}; // Also polled during an analysis
+
+  ~State() { Shutdown(); }
+
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+      queue.clear();
+    }
+    wake.notify_one();
+    if (worker.joinable())
+      worker.join();
+    stop = false;
+  }
+};
+
+State &GetState() {
+  static State state;
+  return state;
+}
+
+// False if stopped before the end of the file
+bool Analyze(const std::string &filepath, const std::atomic<bool> &stop,
+             LoudnessAnalyzer::Result &result) {
+  auto startTime = std::chrono::steady_clock::now();
+
+  // No audio stream (or an unreadable file) measures as silence, which
+  // normalizes with unity gain
+  LoudnessMeter meter;
+  AudioDecoder decoder;
+  if (decoder.Open(filepath)) {
+    std::vector<float> chunk(kChunkFrames * AudioEngine::kChannels);
+    int frames = 0;
+    while ((frames = decoder.Read(chunk.data(), kChunkFrames)) > 0) {
+      if (stop)
+        return false;
+      meter.Process(chunk.data(), frames);
+    }
+  }
+
+  result.loudness = meter.GetIntegratedLoudness();
+  result.truePeak = meter.GetTruePeak();
+
+  auto elapsed = std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - startTime)
+                     .count();
+  std::cout << "[LoudnessAnalyzer] " << filepath << ": " << result.loudness
+            << " LUFS, " << result.truePeak << " dBTP (" << elapsed << " ms)"
+            << std::endl;
+  return true;
+}
+
+void WorkerFunc(State &state) {
+  std::unique_lock<std::mutex> lock(state.mutex);
+  while (true) {
+    state.wake.wait(lock, [&] { return state.stop || !state.queue.empty(); });
+    if (state.stop)
+      break;
+
+    state.current = std::move(state.queue.front());
+    state.queue.pop_front();
+    std::string filepath = state.current;
+
+    lock.unlock();
+    LoudnessAnalyzer::Result result{};
+    bool finished = Analyze(filepath, state.stop, result);
+    lock.lock();
+
+    if (finished)
+      state.cache[filepath] = result;
+    state.current.clear();
+  }
+}
+
+} // namespace
+
+void LoudnessAnalyzer::Request(const std::string &filepath) {
+  State &state = GetState();
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.cache.count(filepath) || state.current == filepath)
+      return;
+    for (const std::string &queued : state.queue) {
+      if (queued == filepath)
+        return;
+    }
+    state.queue.push_back(filepath);
+
+    if (!state.worker.joinable())
+      state.worker = std::thread(WorkerFunc, std::ref(state));
+  }
+  state.wake.notify_one();
+}
+
+bool LoudnessAnalyzer::Lookup(const std::string &filepath, Result &result) {
+  State &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto it = state.cache.find(filepath);
+  if (it == state.cache.end())
+    return false;
+  result = it->second;
+  return true;
+}
+
+void LoudnessAnalyzer::Store(const std::string &filepath,
+                             const Result &result) {
+  State &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.cache[filepath] = result;
+}
+
+int LoudnessAnalyzer::GetPendingCount() {
+  State &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  int pending = static_cast<int>(state.queue.size());
+  return state.current.empty() ? pending : pending + 1;
+}
+
+void LoudnessAnalyzer::Stop() { GetState().Shutdown(); }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Background loudness analysis of imported media, cached per file
+ *
+ * Request() queues a file for a worker thread that decodes its audio once
+ * (AudioDecoder) and measures it (LoudnessMeter). Results stay in a
+ * process-wide cache keyed by path; projects save and restore them so a
+ * file is analyzed once, not on every open. Export reads the cache to
+ * give each clip its normalization gain without decoding anything twice.
+ *
+ * Files are analyzed one at a time in request order. All functions are
+ * thread safe; the worker starts on the first request.
+ */
+class LoudnessAnalyzer {
+public:
+  struct Result {
+    float loudness; ///< Integrated, LUFS (LoudnessMeter::kSilence if silent)
+    float truePeak; ///< dBTP
+  };
+
+  /**
+   * @brief Queue @p filepath unless it is cached, queued or in progress
+   */
+  static void Request(const std::string &filepath);
+
+  /**
+   * @return False while @p filepath has not been analyzed yet
+   */
+  static bool Lookup(const std::string &filepath, Result &result);
+
+  /**
+   * @brief Seed the cache with a result measured earlier (project load)
+   */
+  static void Store(const std::string &filepath, const Result &result);
+
+  static int GetPendingCount(); ///< Queued plus in progress
+
+  /**
+   * @brief Drop queued work and join the worker; later requests restart it
+   */
+  static void Stop();
+};
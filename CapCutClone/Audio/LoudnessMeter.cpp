@@ -0,0 +1,250 @@
+#include "LoudnessMeter.h"
+#include "AudioEngine.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOUDNESS_SSE 1
+#endif
+
+namespace {
+
+constexpr int kChannels = AudioEngine::kChannels;
+constexpr int kStepFrames = AudioEngine::kSampleRate / 10; // 100 ms
+constexpr int kStepsPerBlock = 4;                          // 400 ms blocks
+constexpr double kRelativeGate = -10.0;                    // LU
+
+// BS.1770-4 K-weighting at 48 kHz: {b0, b1, b2, a1, a2} per stage
+constexpr double kStages[2][5] = {
+    {1.53512485958697, -2.69169618940638, 1.19839281085285,
+     -1.69065929318241, 0.73248077421585},
+    {1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621}};
+
+constexpr int kTaps = 12;  // Per phase
+constexpr int kPhases = 4; // 4x oversampling
+
+// Phase p interpolates 6 - p/4 samples behind the newest tap, so phase 0
+// is the plain sample; Hann-windowed sinc, unity gain at DC per phase
+struct PeakFilter {
+  alignas(16) float taps[kTaps][kPhases];
+
+  PeakFilter() {
+    const double pi = 3.14159265358979323846;
+    for (int p = 0; p < kPhases; ++p) {
+      double sum = 0.0;
+      double coefficients[kTaps];
+      for (int k = 0; k < kTaps; ++k) {
+        double d = (kTaps / 2) - k - static_cast<double>(p) / kPhases;
+        double sinc = d == 0.0 ? 1.0 : std::sin(pi * d) / (pi * d);
+        double window = 0.5 * (1.0 + std::cos(pi * d / (kTaps / 2 + 0.5)));
+        coefficients[k] = sinc * window;
+        sum += coefficients[k];
+      }
+      for (int k = 0; k < kTaps; ++k)
+        taps[k][p] = static_cast<float>(coefficients[k] / sum);
+    }
+  }
+};
+
+const PeakFilter &GetPeakFilter() {
+  static const PeakFilter filter;
+  return filter;
+}
+
+double BlockLoudness(double meanSquare) {
+  return -0.691 + 10.0 * std::log10(meanSquare);
+}
+
+#ifdef LOUDNESS_SSE
+// Both channels of a frame share a register; the biquads are recursive in
+// time, so the channels are the only lanes available
+int WeightSSE(const float *interleaved, int frames, double z1[2][2],
+              double z2[2][2], double &energy) {
+  __m128d s1[2] = {_mm_loadu_pd(z1[0]), _mm_loadu_pd(z1[1])};
+  __m128d s2[2] = {_mm_loadu_pd(z2[0]), _mm_loadu_pd(z2[1])};
+  __m128d sum = _mm_setzero_pd();
+  for (int f = 0; f < frames; ++f) {
+    __m128d x = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(
+        reinterpret_cast<const __m128i *>(interleaved + f * kChannels))));
+    for (int s = 0; s < 2; ++s) {
+      const double *c = kStages[s];
+      __m128d y = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(c[0]), x), s1[s]);
+      s1[s] = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(c[1]), x),
+                                    _mm_mul_pd(_mm_set1_pd(c[3]), y)),
+                         s2[s]);
+      s2[s] = _mm_sub_pd(_mm_mul_pd(_mm_set1_pd(c[2]), x),
+                         _mm_mul_pd(_mm_set1_pd(c[4]), y));
+      x = y;
+    }
+    sum = _mm_add_pd(sum, _mm_mul_pd(x, x));
+  }
+  for (int s = 0; s < 2; ++s) {
+    _mm_storeu_pd(z1[s], s1[s]);
+    _mm_storeu_pd(z2[s], s2[s]);
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, sum);
+  energy += lanes[0] + lanes[1];
+  return frames;
+}
+
+// All four phases of one input sample in one register
+int PeakSSE(const float *samples, int count, float &peak) {
+  const PeakFilter &filter = GetPeakFilter();
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 maxAbs = _mm_setzero_ps();
+  for (int i = 0; i < count; ++i) {
+    __m128 acc = _mm_setzero_ps();
+    for (int k = 0; k < kTaps; ++k)
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load_ps(filter.taps[k]),
+                                       _mm_set1_ps(samples[i - k])));
+    maxAbs = _mm_max_ps(maxAbs, _mm_andnot_ps(sign, acc));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, maxAbs);
+  peak = std::max({peak, lanes[0], lanes[1], lanes[2], lanes[3]});
+  return count;
+}
+#endif
+
+} // namespace
+
+LoudnessMeter::LoudnessMeter() { Reset(); }
+
+void LoudnessMeter::Reset() {
+  for (int s = 0; s < 2; ++s) {
+    for (int ch = 0; ch < kChannels; ++ch) {
+      m_Z1[s][ch] = 0.0;
+      m_Z2[s][ch] = 0.0;
+    }
+  }
+  m_StepEnergy = 0.0;
+  m_StepFrames = 0;
+  m_Steps.clear();
+  for (std::vector<float> &history : m_Peak)
+    history.assign(kHistory, 0.0f);
+  m_MaxPeak = 0.0f;
+}
+
+void LoudnessMeter::Process(const float *interleaved, int frames) {
+  if (frames <= 0)
+    return;
+  ProcessWeighting(interleaved, frames);
+  ProcessPeak(interleaved, frames);
+}
+
+void LoudnessMeter::ProcessWeighting(const float *interleaved, int frames) {
+  while (frames > 0) {
+    int run = std::min(frames, kStepFrames - m_StepFrames);
+    int done = 0;
+#ifdef LOUDNESS_SSE
+    if (AudioEngine::IsSIMDEnabled())
+      done = WeightSSE(interleaved, run, m_Z1, m_Z2, m_StepEnergy);
+#endif
+    for (int f = done; f < run; ++f) {
+      for (int ch = 0; ch < kChannels; ++ch) {
+        double x = interleaved[f * kChannels + ch];
+        for (int s = 0; s < 2; ++s) {
+          const double *c = kStages[s];
+          double y = c[0] * x + m_Z1[s][ch];
+          m_Z1[s][ch] = c[1] * x - c[3] * y + m_Z2[s][ch];
+          m_Z2[s][ch] = c[2] * x - c[4] * y;
+          x = y;
+        }
+        m_StepEnergy += x * x;
+      }
+    }
+
+    interleaved += run * kChannels;
+    frames -= run;
+    m_StepFrames += run;
+    if (m_StepFrames == kStepFrames) {
+      m_Steps.push_back(m_StepEnergy / kStepFrames);
+      m_StepEnergy = 0.0;
+      m_StepFrames = 0;
+    }
+  }
+}
+
+void LoudnessMeter::ProcessPeak(const float *interleaved, int frames) {
+  const PeakFilter &filter = GetPeakFilter();
+  for (int ch = 0; ch < kChannels; ++ch) {
+    std::vector<float> &samples = m_Peak[ch];
+    samples.resize(kHistory + frames);
+    for (int f = 0; f < frames; ++f)
+      samples[kHistory + f] = interleaved[f * kChannels + ch];
+
+    const float *input = samples.data() + kHistory;
+    int done = 0;
+#ifdef LOUDNESS_SSE
+    if (AudioEngine::IsSIMDEnabled())
+      done = PeakSSE(input, frames, m_MaxPeak);
+#endif
+    for (int i = done; i < frames; ++i) {
+      for (int p = 0; p < kPhases; ++p) {
+        float acc = 0.0f;
+        for (int k = 0; k < kTaps; ++k)
+          acc += filter.taps[k][p] * input[i - k];
+        m_MaxPeak = std::max(m_MaxPeak, std::fabs(acc));
+      }
+    }
+
+    // Keep the newest samples as the next call's history
+    std::copy(samples.end() - kHistory, samples.end(), samples.begin());
+    samples.resize(kHistory);
+  }
+}
+
+float LoudnessMeter::GetIntegratedLoudness() const {
+  // 400 ms blocks overlapping by 75%: four consecutive 100 ms steps
+  int blocks = static_cast<int>(m_Steps.size()) - kStepsPerBlock + 1;
+  if (blocks <= 0)
+    return kSilence;
+
+  std::vector<double> passed;
+  passed.reserve(blocks);
+  double sum = 0.0;
+  for (int b = 0; b < blocks; ++b) {
+    double meanSquare = 0.0;
+    for (int s = 0; s < kStepsPerBlock; ++s)
+      meanSquare += m_Steps[b + s];
+    meanSquare /= kStepsPerBlock;
+    if (meanSquare > 0.0 && BlockLoudness(meanSquare) > kSilence) {
+      passed.push_back(meanSquare);
+      sum += meanSquare;
+    }
+  }
+  if (passed.empty())
+    return kSilence;
+
+  double relativeGate = BlockLoudness(sum / passed.size()) + kRelativeGate;
+  double gatedSum = 0.0;
+  int gatedCount = 0;
+  for (double meanSquare : passed) {
+    if (BlockLoudness(meanSquare) > relativeGate) {
+      gatedSum += meanSquare;
+      ++gatedCount;
+    }
+  }
+  if (gatedCount == 0)
+    return kSilence;
+  return static_cast<float>(BlockLoudness(gatedSum / gatedCount));
+}
+
+float LoudnessMeter::GetTruePeak() const {
+  if (m_MaxPeak <= 0.0f)
+    return kSilence;
+  return std::max(kSilence, 20.0f * std::log10(m_MaxPeak));
+}
+
+float LoudnessMeter::GetNormalizationGain(float loudness, float truePeak,
+                                          float target, float ceiling) {
+  if (loudness <= kSilence)
+    return 1.0f;
+  float gainDb = target - loudness;
+  if (truePeak > kSilence)
+    gainDb = std::min(gainDb, ceiling - truePeak);
+  return std::pow(10.0f, gainDb / 20.0f);
+}
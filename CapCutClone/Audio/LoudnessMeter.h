@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Integrated loudness and true peak (EBU R128 / ITU-R BS.1770-4)
+ *
+ * Measures interleaved audio in the engine format (48 kHz stereo float).
+ * Samples are K-weighted (high shelf, then high pass) and their mean
+ * square is kept per 100 ms step; the integrated loudness gates the 400 ms
+ * blocks built from four steps at -70 LUFS and then 10 LU below their
+ * mean. True peak is the largest magnitude of the signal upsampled 4x
+ * with a 48-tap interpolator.
+ *
+ * The K-weighting biquads run both channels in one SSE2 register and the
+ * four interpolation phases of the true-peak filter run as one SSE vector;
+ * both follow AudioEngine::SetSIMDEnabled(). Memory grows by one double
+ * per 100 ms of input. Not thread safe.
+ */
+class LoudnessMeter {
+public:
+  static constexpr float kSilence = -70.0f; ///< Absolute gate, LUFS
+
+  LoudnessMeter();
+
+  void Reset();
+  void Process(const float *interleaved, int frames);
+
+  /**
+   * @return LUFS; kSilence if no block passed the absolute gate
+   */
+  float GetIntegratedLoudness() const;
+
+  /**
+   * @return dBTP; kSilence for digital silence
+   */
+  float GetTruePeak() const;
+
+  /**
+   * @brief Linear gain that brings @p loudness to @p target LUFS
+   *
+   * Capped so the true peak stays at or below @p ceiling dBTP. Unity for
+   * silent media.
+   */
+  static float GetNormalizationGain(float loudness, float truePeak,
+                                    float target, float ceiling);
+
+private:
+  static constexpr int kHistory = 11; // Interpolator taps minus one
+
+  void ProcessWeighting(const float *interleaved, int frames);
+  void ProcessPeak(const float *interleaved, int frames);
+
+  // Biquad state, [stage][channel], transposed direct form II
+  double m_Z1[2][2];
+  double m_Z2[2][2];
+
+  double m_StepEnergy = 0.0; // Sum of weighted L^2 + R^2 in this step
+  int m_StepFrames = 0;
+  std::vector<double> m_Steps; // Mean square per completed 100 ms step
+
+  std::vector<float> m_Peak[2]; // History, then this call's samples
+  float m_MaxPeak = 0.0f;       // Linear
+};
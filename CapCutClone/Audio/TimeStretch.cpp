@@ -0,0 +1,188 @@
+#include "TimeStretch.h"
+#include "AudioEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) ||                                     \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TIMESTRETCH_SSE 1
+#endif
+
+namespace {
+
+constexpr int kChannels = AudioEngine::kChannels;
+constexpr int kGrain = 1024;       // ~21 ms
+constexpr int kHop = kGrain / 2;   // Output frames per grain
+constexpr int kSeek = 256;         // Search radius around the nominal start
+constexpr int kCoarseStep = 4;     // Coarse search stride, then refined
+constexpr int kCompactFrames = 16384;
+
+#ifdef TIMESTRETCH_SSE
+int CorrelateSSE(const float *a, const float *b, int count, float &dot,
+                 float &energy) {
+  __m128 dotSum = _mm_setzero_ps();
+  __m128 energySum = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 va = _mm_loadu_ps(a + i);
+    __m128 vb = _mm_loadu_ps(b + i);
+    dotSum = _mm_add_ps(dotSum, _mm_mul_ps(va, vb));
+    energySum = _mm_add_ps(energySum, _mm_mul_ps(va, va));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, dotSum);
+  dot = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  _mm_storeu_ps(lanes, energySum);
+  energy = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  return i;
+}
+#endif
+
+// Normalized cross-correlation of a candidate grain with the target; the
+// target's own energy is the same for every candidate and left out
+float Similarity(const float *candidate, const float *target, int count) {
+  float dot = 0.0f;
+  float energy = 0.0f;
+  int done = 0;
+#ifdef TIMESTRETCH_SSE
+  if (AudioEngine::IsSIMDEnabled())
+    done = CorrelateSSE(candidate, target, count, dot, energy);
+#endif
+  for (int i = done; i < count; ++i) {
+    dot += candidate[i] * target[i];
+    energy += candidate[i] * candidate[i];
+  }
+  return dot / std::sqrt(energy + 1e-9f);
+}
+
+} // namespace
+
+TimeStretch::TimeStretch()
+    : m_Tail(kHop * kChannels), m_Output(kHop * kChannels) {}
+
+void TimeStretch::SetTempo(float tempo) {
+  m_Tempo = std::clamp(tempo, kMinTempo, kMaxTempo);
+}
+
+void TimeStretch::Reset() {
+  m_InputStart = 0;
+  m_InputFrames = 0;
+  m_Position = 0.0;
+  m_OutputRead = 0;
+  m_OutputFrames = 0;
+  m_HasTail = false;
+}
+
+void TimeStretch::Push(const float *interleaved, int frames) {
+  if (frames <= 0)
+    return;
+  size_t needed =
+      static_cast<size_t>(m_InputStart + m_InputFrames + frames) * kChannels;
+  if (m_Input.size() < needed)
+    m_Input.resize(needed);
+  std::memcpy(m_Input.data() +
+                  static_cast<size_t>(m_InputStart + m_InputFrames) * kChannels,
+              interleaved, static_cast<size_t>(frames) * kChannels * sizeof(float));
+  m_InputFrames += frames;
+}
+
+int TimeStretch::Pull(float *interleaved, int maxFrames) {
+  int written = 0;
+  while (written < maxFrames) {
+    if (m_OutputRead == m_OutputFrames && !NextGrain())
+      break;
+    int count = std::min(maxFrames - written, m_OutputFrames - m_OutputRead);
+    std::memcpy(interleaved + written * kChannels,
+                m_Output.data() + m_OutputRead * kChannels,
+                static_cast<size_t>(count) * kChannels * sizeof(float));
+    m_OutputRead += count;
+    written += count;
+  }
+  return written;
+}
+
+bool TimeStretch::NextGrain() {
+  int nominal = static_cast<int>(m_Position);
+  const float *input = m_Input.data() +
+                       static_cast<size_t>(m_InputStart) * kChannels;
+  float *output = m_Output.data();
+
+  int start = nominal;
+  if (!m_HasTail) {
+    // First grain: nothing to match or crossfade with
+    if (nominal + kGrain > m_InputFrames)
+      return false;
+    std::memcpy(output, input + start * kChannels,
+                kHop * kChannels * sizeof(float));
+  } else {
+    if (nominal + kSeek + kGrain > m_InputFrames)
+      return false;
+    start = FindBestOffset(nominal);
+
+    // Linear crossfade: the matched halves are in phase, so their sum
+    // keeps a constant level
+    const float step = 1.0f / kHop;
+    std::fill(m_Output.begin(), m_Output.end(), 0.0f);
+    AudioEngine::MixStereo(output, m_Tail.data(), kHop, 1.0f, 1.0f, -step,
+                           -step);
+    AudioEngine::MixStereo(output, input + start * kChannels, kHop, 0.0f,
+                           0.0f, step, step);
+  }
+
+  std::memcpy(m_Tail.data(), input + (start + kHop) * kChannels,
+              kHop * kChannels * sizeof(float));
+  m_HasTail = true;
+  m_OutputRead = 0;
+  m_OutputFrames = kHop;
+  m_Position += static_cast<double>(m_Tempo) * kHop;
+  Compact();
+  return true;
+}
+
+int TimeStretch::FindBestOffset(int nominal) const {
+  const float *input = m_Input.data() +
+                       static_cast<size_t>(m_InputStart) * kChannels;
+  const int samples = kHop * kChannels;
+  int first = std::max(0, nominal - kSeek);
+  int last = nominal + kSeek;
+
+  int best = nominal;
+  float bestScore = Similarity(input + nominal * kChannels, m_Tail.data(),
+                               samples);
+  auto consider = [&](int candidate) {
+    float score =
+        Similarity(input + candidate * kChannels, m_Tail.data(), samples);
+    if (score > bestScore) {
+      bestScore = score;
+      best = candidate;
+    }
+  };
+
+  for (int candidate = first; candidate <= last; candidate += kCoarseStep)
+    consider(candidate);
+  int coarse = best;
+  for (int candidate = std::max(first, coarse - kCoarseStep + 1);
+       candidate <= std::min(last, coarse + kCoarseStep - 1); ++candidate)
+    consider(candidate);
+  return best;
+}
+
+void TimeStretch::Compact() {
+  // Nothing before the next search window is read again
+  int drop = std::min(static_cast<int>(m_Position) - kSeek, m_InputFrames);
+  if (drop > 0) {
+    m_InputStart += drop;
+    m_InputFrames -= drop;
+    m_Position -= drop;
+  }
+
+  if (m_InputStart >= kCompactFrames) {
+    std::memmove(m_Input.data(),
+                 m_Input.data() + static_cast<size_t>(m_InputStart) * kChannels,
+                 static_cast<size_t>(m_InputFrames) * kChannels *
+                     sizeof(float));
+    m_InputStart = 0;
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Tempo change without a pitch change, in the engine format
+ *
+ * WSOLA (waveform similarity overlap-add) on interleaved 48 kHz stereo
+ * float. Output is built from 1024-frame grains overlapping by half; each
+ * grain is taken near its nominal input position (advanced by tempo x
+ * hop) at the offset whose first half best matches the previous grain's
+ * second half, then crossfaded in. At tempo 1 the best match is the
+ * nominal position and the input passes through unchanged.
+ *
+ * The similarity search and the crossfade use SSE on x86 and follow
+ * AudioEngine::SetSIMDEnabled(). Push() may grow the input buffer; Pull()
+ * never allocates. One instance per stream, not thread safe.
+ */
+class TimeStretch {
+public:
+  static constexpr float kMinTempo = 0.25f;
+  static constexpr float kMaxTempo = 4.0f;
+
+  TimeStretch();
+
+  /**
+   * @brief Input frames consumed per output frame, clamped to 0.25 .. 4
+   */
+  void SetTempo(float tempo);
+  float GetTempo() const { return m_Tempo; }
+
+  /**
+   * @brief Drop buffered input and the pending grain
+   */
+  void Reset();
+
+  void Push(const float *interleaved, int frames);
+
+  /**
+   * @return Frames written to @p interleaved, at most @p maxFrames; fewer
+   * when more input is needed
+   */
+  int Pull(float *interleaved, int maxFrames);
+
+private:
+  bool NextGrain(); // Into m_Output, false if short of input
+  int FindBestOffset(int nominal) const;
+  void Compact();
+
+  std::vector<float> m_Input;  // Interleaved, from m_InputStart on is live
+  int m_InputStart = 0;        // Frames
+  int m_InputFrames = 0;       // Live frames after m_InputStart
+  double m_Position = 0.0;     // Nominal grain start, frames after start
+  std::vector<float> m_Tail;   // Previous grain's second half
+  std::vector<float> m_Output; // Finished hop not pulled yet
+  int m_OutputRead = 0;
+  int m_OutputFrames = 0;
+  bool m_HasTail = false;
+  float m_Tempo = 1.0f;
+};
@@ -0,0 +1,845 @@
+/**
+ * @brief capcut_bench - repeatable per-stage performance numbers
+ *
+ * Generates its own test media (no downloads), then measures:
+ * - decode: VideoPlayer::DecodeNextFrame throughput
+ * - seek: VideoPlayer::Seek latency, exact and fast mode
+ * - convert: RGB24 -> NV12 with swscale, ColorConvert (SIMD and scalar)
+ *   and the Vulkan compute converter
+ * - audio_fx: AudioEffectChain with every effect on, on every engine bus
+ *   (SIMD and scalar), as CPU milliseconds per second of audio
+ * - lut_bake: ColorLUT bake of a filter plus every color adjustment (SIMD
+ *   and scalar), paid once per parameter change
+ * - effects: the TextureRenderer shader chain into an FBO, and the cached
+ *   preview of a paused frame
+ * - export: end-to-end HardwareExportManager frames per second
+ * - encode (--encoder-matrix): FPS and bitrate of the CPU encoder profiles
+ *   (x264/x265/SVT-AV1 x preset x CRF/VBR)
+ *
+ * Results go to stdout and to a JSON file so runs can be diffed.
+ *
+ * Usage:
+ *   capcut_bench [--out results.json] [--media-dir dir] [--quick]
+ *                [--uhd] [--software-gl] [--vulkan-icd path]
+ *                [--encoder-matrix] [--software-decode]
+ *
+ * --software-gl asks Mesa for llvmpipe, --vulkan-icd selects a Vulkan
+ * driver manifest (e.g. lavapipe's lvp_icd.x86_64.json), so the GPU stages
+ * also run on machines without a GPU. --software-decode disables hardware
+ * decode and decoder threading, so decode and seek numbers compare across
+ * machines.
+ */
+
+#include "../Audio/AudioEffectChain.h"
+#include "../Core/ColorConvert.h"
+#include "../Encoder/HardwareExportManager.h"
+#include "../Rendering/ColorLUT.h"
+#include "../Rendering/TextureRenderer.h"
+#include "../Timeline/TimelineManager.h"
+#include "../Video/DecoderBackend.h"
+#include "../Video/VideoPlayer.h"
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef USE_VULKAN
+#include "../Vulkan/VulkanExportManager.h"
+#endif
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// ============================================================================
+// Options and results
+// ============================================================================
+
+struct Options {
+  std::string outputPath = "capcut_bench.json";
+  std::string mediaDir = "bench_media";
+  std::string vulkanICD;
+  bool quick = false;          ///< Fewer frames and iterations (smoke test)
+  bool uhd = false;            ///< Add 3840x2160 media
+  bool softwareGL = false;     ///< Force Mesa llvmpipe
+  bool encoderMatrix = false;  ///< CPU encoder profile sweep (slow)
+  bool softwareDecode = false; ///< DecoderBackend::Mode::SoftwareOnly
+};
+
+struct TestMedia {
+  std::string path;
+  std::string codec; ///< "h264" / "hevc"
+  int width = 0;
+  int height = 0;
+  int frames = 0;
+  int fps = 30;
+};
+
+struct Result {
+  std::string name;  ///< e.g. "decode", "convert.sws"
+  std::string media; ///< e.g. "1920x1080 h264"
+  double value = 0.0;
+  std::string unit; ///< "fps", "ms"
+  int samples = 0;
+};
+
+std::vector<Result> g_Results;
+
+void AddResult(const std::string &name, const std::string &media, double value,
+               const std::string &unit, int samples) {
+  g_Results.push_back({name, media, value, unit, samples});
+  std::cout << "[Bench] " << name << " (" << media << "): " << value << " "
+            << unit << " [" << samples << " samples]" << std::endl;
+}
+
+std::string Describe(int width, int height, const std::string &codec = "") {
+  std::string text = std::to_string(width) + "x" + std::to_string(height);
+  return codec.empty() ? text : text + " " + codec;
+}
+
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty())
+    return 0.0;
+  size_t n = static_cast<size_t>(p * (values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + n, values.end());
+  return values[n];
+}
+
+void SetEnv(const char *name, const std::string &value) {
+#ifdef _WIN32
+  _putenv_s(name, value.c_str());
+#else
+  setenv(name, value.c_str(), 1);
+#endif
+}
+
+// ============================================================================
+// Test media (testsrc-like pattern: bars, moving gradient, moving box)
+// ============================================================================
+
+void FillPattern(uint8_t *rgb, int width, int height, int frame) {
+  static const uint8_t bars[7][3] = {{191, 191, 191}, {191, 191, 0},
+                                     {0, 191, 191},   {0, 191, 0},
+                                     {191, 0, 191},   {191, 0, 0},
+                                     {0, 0, 191}};
+  int barsHeight = height * 2 / 3;
+  int boxSize = height / 8;
+  int boxX = (frame * 8) % std::max(1, width - boxSize);
+  int boxY = barsHeight + (height - barsHeight - boxSize) / 2;
+
+  for (int y = 0; y < height; ++y) {
+    uint8_t *row = rgb + static_cast<size_t>(y) * width * 3;
+    for (int x = 0; x < width; ++x) {
+      uint8_t *p = row + x * 3;
+      if (y < barsHeight) {
+        const uint8_t *bar = bars[x * 7 / width];
+        p[0] = bar[0];
+        p[1] = bar[1];
+        p[2] = bar[2];
+      } else {
+        // Scrolling gradient keeps every frame different for the encoder
+        uint8_t v = static_cast<uint8_t>((x + y + frame * 4) & 0xFF);
+        p[0] = v;
+        p[1] = static_cast<uint8_t>(255 - v);
+        p[2] = static_cast<uint8_t>((v * 3) & 0xFF);
+      }
+      if (x >= boxX && x < boxX + boxSize && y >= boxY && y < boxY + boxSize)
+        p[0] = p[1] = p[2] = static_cast<uint8_t>((frame * 16) & 0xFF);
+    }
+  }
+}
+
+bool WritePackets(AVCodecContext *codecCtx, AVFormatContext *formatCtx,
+                  AVStream *stream, AVFrame *frame, AVPacket *packet) {
+  if (avcodec_send_frame(codecCtx, frame) < 0)
+    return false;
+  while (avcodec_receive_packet(codecCtx, packet) >= 0) {
+    av_packet_rescale_ts(packet, codecCtx->time_base, stream->time_base);
+    packet->stream_index = stream->index;
+    av_interleaved_write_frame(formatCtx, packet);
+    av_packet_unref(packet);
+  }
+  return true;
+}
+
+/**
+ * @brief Encode media.frames of the test pattern to media.path
+ */
+bool GenerateTestMedia(const TestMedia &media) {
+  AVCodecID codecId =
+      media.codec == "hevc" ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264;
+  const AVCodec *codec = avcodec_find_encoder(codecId);
+  if (!codec) {
+    std::cerr << "[Bench] No encoder for " << media.codec << std::endl;
+    return false;
+  }
+
+  AVFormatContext *formatCtx = nullptr;
+  avformat_alloc_output_context2(&formatCtx, nullptr, nullptr,
+                                 media.path.c_str());
+  if (!formatCtx)
+    return false;
+
+  AVStream *stream = avformat_new_stream(formatCtx, nullptr);
+  AVCodecContext *codecCtx = avcodec_alloc_context3(codec);
+  codecCtx->width = media.width;
+  codecCtx->height = media.height;
+  codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+  codecCtx->time_base = {1, media.fps};
+  codecCtx->framerate = {media.fps, 1};
+  codecCtx->gop_size = media.fps * 2; // Same keyframe spacing as exports
+  codecCtx->max_b_frames = 2;
+  codecCtx->bit_rate = static_cast<int64_t>(media.width) * media.height * 4;
+  if (formatCtx->oformat->flags & AVFMT_GLOBALHEADER)
+    codecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  av_opt_set(codecCtx->priv_data, "preset", "veryfast", 0);
+
+  bool ok = avcodec_open2(codecCtx, codec, nullptr) >= 0 &&
+            avcodec_parameters_from_context(stream->codecpar, codecCtx) >= 0;
+  stream->time_base = codecCtx->time_base;
+  ok = ok &&
+       avio_open(&formatCtx->pb, media.path.c_str(), AVIO_FLAG_WRITE) >= 0;
+  ok = ok && avformat_write_header(formatCtx, nullptr) >= 0;
+
+  AVFrame *frame = av_frame_alloc();
+  AVPacket *packet = av_packet_alloc();
+  SwsContext *sws = sws_getContext(media.width, media.height, AV_PIX_FMT_RGB24,
+                                   media.width, media.height,
+                                   AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr,
+                                   nullptr, nullptr);
+  if (ok) {
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = media.width;
+    frame->height = media.height;
+    ok = av_frame_get_buffer(frame, 32) >= 0 && sws;
+  }
+
+  std::vector<uint8_t> rgb(static_cast<size_t>(media.width) * media.height *
+                           3);
+  for (int i = 0; ok && i < media.frames; ++i) {
+    FillPattern(rgb.data(), media.width, media.height, i);
+    const uint8_t *src[1] = {rgb.data()};
+    int srcStride[1] = {media.width * 3};
+    av_frame_make_writable(frame);
+    sws_scale(sws, src, srcStride, 0, media.height, frame->data,
+              frame->linesize);
+    frame->pts = i;
+    ok = WritePackets(codecCtx, formatCtx, stream, frame, packet);
+  }
+  if (ok) {
+    WritePackets(codecCtx, formatCtx, stream, nullptr, packet); // Flush
+    av_write_trailer(formatCtx);
+  }
+
+  sws_freeContext(sws);
+  av_packet_free(&packet);
+  av_frame_free(&frame);
+  avcodec_free_context(&codecCtx);
+  if (formatCtx->pb)
+    avio_closep(&formatCtx->pb);
+  avformat_free_context(formatCtx);
+
+  if (!ok)
+    std::cerr << "[Bench] Failed to generate " << media.path << std::endl;
+  return ok;
+}
+
+std::vector<TestMedia> PrepareMedia(const Options &options) {
+  struct Size {
+    int width, height;
+  };
+  std::vector<Size> sizes = {{1280, 720}, {1920, 1080}};
+  if (options.uhd)
+    sizes.push_back({3840, 2160});
+  int seconds = options.quick ? 2 : 10;
+
+#ifdef _WIN32
+  std::string mkdir = "mkdir \"" + options.mediaDir + "\" 2> nul";
+#else
+  std::string mkdir = "mkdir -p \"" + options.mediaDir + "\"";
+#endif
+  std::system(mkdir.c_str());
+
+  std::vector<TestMedia> media;
+  for (const Size &size : sizes) {
+    for (const char *codec : {"h264", "hevc"}) {
+      TestMedia item;
+      item.codec = codec;
+      item.width = size.width;
+      item.height = size.height;
+      item.frames = seconds * item.fps;
+      item.path = options.mediaDir + "/testsrc_" +
+                  Describe(size.width, size.height) + "_" + codec + "_" +
+                  std::to_string(seconds) + "s.mp4";
+
+      // Reuse media from earlier runs
+      bool exists = std::ifstream(item.path).good();
+      if (!exists) {
+        std::cout << "[Bench] Generating " << item.path << std::endl;
+        exists = GenerateTestMedia(item);
+      }
+      if (exists)
+        media.push_back(item);
+    }
+  }
+  return media;
+}
+
+// ============================================================================
+// Decode and seek
+// ============================================================================
+
+void BenchDecode(const TestMedia &media) {
+  VideoPlayer player;
+  if (!player.LoadVideo(media.path))
+    return;
+
+  int frames = 0;
+  auto start = Clock::now();
+  while (player.DecodeNextFrame())
+    frames++;
+  double seconds = SecondsSince(start);
+  if (frames > 0 && seconds > 0.0)
+    AddResult("decode", Describe(media.width, media.height, media.codec),
+              frames / seconds, "fps", frames);
+}
+
+void BenchSeek(const TestMedia &media, bool fastMode, int count) {
+  VideoPlayer player;
+  if (!player.LoadVideo(media.path))
+    return;
+
+  // Fixed seed: the same positions on every run
+  std::mt19937 rng(1234);
+  double duration = std::max(0.1, player.GetDuration() - 0.1);
+  std::uniform_real_distribution<double> position(0.0, duration);
+
+  std::vector<double> latencies;
+  for (int i = 0; i < count; ++i) {
+    double target = position(rng);
+    auto start = Clock::now();
+    player.Seek(target, fastMode);
+    latencies.push_back(SecondsSince(start) * 1000.0);
+  }
+
+  std::string name = fastMode ? "seek.fast" : "seek.exact";
+  std::string label = Describe(media.width, media.height, media.codec);
+  AddResult(name + ".p50", label, Percentile(latencies, 0.50), "ms", count);
+  AddResult(name + ".p95", label, Percentile(latencies, 0.95), "ms", count);
+}
+
+// ============================================================================
+// RGB -> NV12 conversion
+// ============================================================================
+
+template <typename Convert>
+void TimeConvert(const std::string &name, int width, int height,
+                 int iterations, Convert convert) {
+  // Warm-up (scratch buffers, GPU pipelines)
+  if (!convert())
+    return;
+
+  auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+    convert();
+  double ms = SecondsSince(start) * 1000.0 / iterations;
+  AddResult(name, Describe(width, height), ms, "ms", iterations);
+}
+
+void BenchConvert(int width, int height, int iterations) {
+  std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+  FillPattern(rgb.data(), width, height, 0);
+  std::vector<uint8_t> y(static_cast<size_t>(width) * height);
+  std::vector<uint8_t> uv(static_cast<size_t>(width) * height / 2);
+
+  // Same flags as the export pipeline
+  SwsContext *sws = sws_getContext(width, height, AV_PIX_FMT_RGB24, width,
+                                   height, AV_PIX_FMT_NV12, SWS_FAST_BILINEAR,
+                                   nullptr, nullptr, nullptr);
+  if (sws) {
+    TimeConvert("convert.sws", width, height, iterations, [&]() {
+      const uint8_t *src[1] = {rgb.data()};
+      int srcStride[1] = {width * 3};
+      uint8_t *dst[2] = {y.data(), uv.data()};
+      int dstStride[2] = {width, width};
+      return sws_scale(sws, src, srcStride, 0, height, dst, dstStride) > 0;
+    });
+    sws_freeContext(sws);
+  }
+
+  auto colorConvert = [&]() {
+    ColorConvert::RGB24ToNV12(rgb.data(), width * 3, y.data(), width,
+                              uv.data(), width, width, height);
+    return true;
+  };
+  if (ColorConvert::IsSIMDAvailable())
+    TimeConvert("convert.simd", width, height, iterations, colorConvert);
+  ColorConvert::SetSIMDEnabled(false);
+  TimeConvert("convert.scalar", width, height, iterations, colorConvert);
+  ColorConvert::SetSIMDEnabled(true);
+
+#ifdef USE_VULKAN
+  VulkanExportManager vulkan;
+  if (vulkan.Initialize(width, height)) {
+    TimeConvert("convert.vulkan", width, height, iterations, [&]() {
+      return vulkan.ConvertRGBToNV12(rgb.data(), y.data(), uv.data(), width,
+                                     height);
+    });
+    vulkan.Cleanup();
+  } else {
+    std::cout << "[Bench] Vulkan converter unavailable, skipped"
+              << std::endl;
+  }
+#endif
+}
+
+// ============================================================================
+// Audio effect chains
+// ============================================================================
+
+void TimeAudioEffects(const std::string &name, int seconds) {
+  AudioEffectSettings settings;
+  settings.gate.enabled = true;
+  settings.eq.enabled = true;
+  settings.eq.lowGain = 3.0f;
+  settings.eq.midGain = -2.0f;
+  settings.eq.highGain = 4.0f;
+  settings.compressor.enabled = true;
+  settings.limiter.enabled = true;
+
+  // Device-callback sized blocks of noise around the compressor threshold
+  constexpr int kBlockFrames = 512;
+  std::vector<float> source(kBlockFrames * AudioEngine::kChannels);
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+  for (float &sample : source)
+    sample = noise(random);
+  std::vector<float> block(source.size());
+
+  const int tracks = AudioEngine::kMaxBuses;
+  std::vector<std::unique_ptr<AudioEffectChain>> chains;
+  for (int t = 0; t < tracks; ++t) {
+    chains.push_back(std::make_unique<AudioEffectChain>());
+    chains.back()->SetSettings(settings);
+  }
+
+  const int blocks = seconds * AudioEngine::kSampleRate / kBlockFrames;
+  auto start = Clock::now();
+  for (int b = 0; b < blocks; ++b) {
+    for (auto &chain : chains) {
+      block = source;
+      chain->Process(block.data(), kBlockFrames);
+    }
+  }
+  double audioSeconds =
+      static_cast<double>(blocks) * kBlockFrames / AudioEngine::kSampleRate;
+  AddResult(name, std::to_string(tracks) + " tracks",
+            SecondsSince(start) * 1000.0 / audioSeconds, "ms/s", blocks);
+
+  // Per effect on one track, from the chain's own accounting
+  static const char *kStageKeys[] = {"gate", "eq", "compressor", "limiter"};
+  AudioEffectChain::Stats stats = chains[0]->GetStats();
+  for (int s = 0; s < AudioEffectChain::kStageCount; ++s)
+    AddResult(name + "." + kStageKeys[s], "1 track",
+              stats.averageLoad[s] * 1000.0, "ms/s", blocks);
+}
+
+void BenchAudioEffects(int seconds) {
+  if (AudioEngine::IsSIMDAvailable())
+    TimeAudioEffects("audio_fx.simd", seconds);
+  AudioEngine::SetSIMDEnabled(false);
+  TimeAudioEffects("audio_fx.scalar", seconds);
+  AudioEngine::SetSIMDEnabled(true);
+}
+
+// ============================================================================
+// Effect shader chain
+// ============================================================================
+
+void TimeLUTBake(const std::string &name, int iterations) {
+  ColorLUT::Grade grade;
+  grade.filterType = 4;
+  grade.brightness = 0.1f;
+  grade.contrast = 1.2f;
+  grade.saturation = 1.3f;
+  grade.sepia = true;
+
+  const int size = ColorLUT::kSize;
+  std::vector<float> table(static_cast<size_t>(size) * size * size * 3);
+  auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+    ColorLUT::Bake(grade, nullptr, table.data());
+  double ms = SecondsSince(start) * 1000.0 / iterations;
+  AddResult(name, std::to_string(size) + "^3", ms, "ms", iterations);
+}
+
+void BenchLUTBake(int iterations) {
+  if (ColorLUT::IsSIMDAvailable())
+    TimeLUTBake("lut_bake.simd", iterations);
+  ColorLUT::SetSIMDEnabled(false);
+  TimeLUTBake("lut_bake.scalar", iterations);
+  ColorLUT::SetSIMDEnabled(true);
+}
+
+void BenchEffects(int width, int height, int iterations) {
+  TextureRenderer renderer;
+  if (!renderer.Initialize()) {
+    std::cerr << "[Bench] TextureRenderer init failed" << std::endl;
+    return;
+  }
+
+  std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+  FillPattern(rgb.data(), width, height, 0);
+  renderer.CreateTexture(width, height);
+  renderer.CreateFramebuffer(width, height);
+  renderer.SetFlipY(false);
+
+  auto renderFrames = [&](const std::string &name) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      renderer.UpdateTexture(rgb.data(), width, height);
+      renderer.BindFramebuffer();
+      glViewport(0, 0, width, height);
+      glClear(GL_COLOR_BUFFER_BIT);
+      renderer.RenderTexture(0, 0, static_cast<float>(width),
+                             static_cast<float>(height));
+      renderer.UnbindFramebuffer();
+    }
+    glFinish(); // Count GPU time, not just submission
+    double ms = SecondsSince(start) * 1000.0 / iterations;
+    AddResult(name, Describe(width, height), ms, "ms", iterations);
+  };
+
+  renderFrames("effects.passthrough");
+
+  // Every per-pixel effect the export can enable, plus a filter and blur
+  renderer.SetFilterParams(0.1f, 1.2f, 1.3f);
+  renderer.SetEffectParams(0.5f, 0.3f, 0.4f, true);
+  renderer.SetFilterType(1);
+  renderFrames("effects.full");
+
+  renderer.SetBlurEffect(0.5f, 0);
+  renderFrames("effects.full+blur");
+
+  // Paused preview: the same frame and settings every UI frame (no grain,
+  // which animates), so only the first call renders
+  renderer.SetEffectParams(0.5f, 0.0f, 0.4f, true);
+  uint64_t rendersBefore = renderer.GetPreviewRenderCount();
+  auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+    renderer.GetFilteredTextureID(width, height);
+  glFinish();
+  AddResult("effects.preview_idle", Describe(width, height),
+            SecondsSince(start) * 1000.0 / iterations, "ms", iterations);
+  AddResult("effects.preview_idle.renders", Describe(width, height),
+            static_cast<double>(renderer.GetPreviewRenderCount() -
+                                rendersBefore),
+            "renders", iterations);
+
+  renderer.Cleanup();
+}
+
+// ============================================================================
+// End-to-end export
+// ============================================================================
+
+struct ExportRun {
+  double fps = 0.0;
+  int frames = 0;
+  double kbps = 0.0; ///< Achieved bitrate of the output file
+  std::string encoder;
+};
+
+/**
+ * @brief Export media (one clip, no effects) with config, wait for the end
+ */
+bool RunExport(const TestMedia &media, GLFWwindow *window,
+               HardwareExportManager::Config config, ExportRun &run) {
+  VideoPlayer probe;
+  TimelineManager timeline;
+  timeline.SetVideoPlayer(&probe); // Clip duration comes from the probe
+  timeline.AddClipToTrack(media.path, 0, 0.0);
+
+  HardwareExportManager exporter(&timeline, &probe);
+  exporter.SetMainWindow(window);
+
+  config.width = media.width;
+  config.height = media.height;
+  config.fps = media.fps;
+  config.exportAudio = false; // Video throughput and bitrate only
+
+  if (!exporter.Initialize(config) || !exporter.StartExport()) {
+    std::cerr << "[Bench] Export failed to start: "
+              << exporter.GetErrorMessage() << std::endl;
+    return false;
+  }
+  while (!exporter.IsFinished())
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  if (!exporter.GetErrorMessage().empty()) {
+    std::cerr << "[Bench] Export failed: " << exporter.GetErrorMessage()
+              << std::endl;
+    return false;
+  }
+
+  run.fps = exporter.GetEncodeFPS();
+  run.frames = static_cast<int>(exporter.GetEncodedFrames());
+  run.encoder = exporter.GetEncoderDescription();
+
+  std::ifstream output(config.outputFile, std::ios::binary | std::ios::ate);
+  double seconds = static_cast<double>(run.frames) / media.fps;
+  if (output.is_open() && seconds > 0.0)
+    run.kbps = static_cast<double>(output.tellg()) * 8.0 / 1000.0 / seconds;
+  return true;
+}
+
+void BenchExport(const TestMedia &media, GLFWwindow *window,
+                 const std::string &outputDir) {
+  HardwareExportManager::Config config;
+  config.outputFile = outputDir + "/export_" +
+                      Describe(media.width, media.height) + "_" + media.codec +
+                      ".mp4";
+
+  ExportRun run;
+  if (RunExport(media, window, config, run))
+    AddResult("export", Describe(media.width, media.height, media.codec),
+              run.fps, "fps", run.frames);
+}
+
+/**
+ * @brief CPU encoder profiles: FPS and bitrate per encoder, preset and
+ * rate control mode (see EncoderProfiles)
+ */
+void BenchEncoderMatrix(const TestMedia &media, GLFWwindow *window,
+                        const std::string &outputDir, bool quick) {
+  using Codec = HardwareExportManager::Codec;
+  using RateControl = HardwareExportManager::RateControl;
+  struct Encoder {
+    Codec codec;
+    const char *name;
+  };
+  const Encoder encoders[] = {
+      {Codec::H264, "x264"}, {Codec::H265, "x265"}, {Codec::AV1, "svtav1"}};
+  std::vector<int> presets =
+      quick ? std::vector<int>{1} : std::vector<int>{1, 4, 7};
+
+  for (const Encoder &encoder : encoders) {
+    for (int preset : presets) {
+      for (RateControl rateControl : {RateControl::CQP, RateControl::VBR}) {
+        HardwareExportManager::Config config;
+        config.codec = encoder.codec;
+        config.enableHardwareAccel = false; // CPU encoders only
+        config.preset = preset;
+        config.rateControl = rateControl;
+        config.quality = 23;
+        config.bitrate = 8000000;
+
+        std::string mode = rateControl == RateControl::CQP ? "crf23" : "vbr8M";
+        std::string name = std::string("encode.") + encoder.name + ".p" +
+                           std::to_string(preset) + "." + mode;
+        config.outputFile = outputDir + "/" + name + ".mp4";
+
+        ExportRun run;
+        if (!RunExport(media, window, config, run))
+          continue;
+        std::cout << "[Bench] " << name << ": " << run.encoder << std::endl;
+
+        std::string label = Describe(media.width, media.height, media.codec);
+        AddResult(name + ".fps", label, run.fps, "fps", run.frames);
+        AddResult(name + ".bitrate", label, run.kbps, "kbps", run.frames);
+      }
+    }
+  }
+}
+
+// ============================================================================
+// JSON output
+// ============================================================================
+
+std::string Escape(const std::string &text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      escaped += c;
+  }
+  return escaped;
+}
+
+bool WriteJSON(const std::string &path, const std::string &glRenderer,
+               const Options &options) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    std::cerr << "[Bench] Could not open " << path << std::endl;
+    return false;
+  }
+
+  file << "{\n  \"system\": {\n"
+       << "    \"threads\": " << std::thread::hardware_concurrency() << ",\n"
+       << "    \"glRenderer\": \"" << Escape(glRenderer) << "\",\n"
+       << "    \"simd\": "
+       << (ColorConvert::IsSIMDAvailable() ? "true" : "false") << ",\n"
+       << "    \"quick\": " << (options.quick ? "true" : "false") << ",\n"
+       << "    \"softwareDecode\": "
+       << (options.softwareDecode ? "true" : "false") << ",\n"
+       << "    \"ffmpeg\": \"" << Escape(av_version_info()) << "\"\n"
+       << "  },\n  \"results\": [\n";
+  for (size_t i = 0; i < g_Results.size(); ++i) {
+    const Result &result = g_Results[i];
+    file << "    {\"name\": \"" << Escape(result.name) << "\", \"media\": \""
+         << Escape(result.media) << "\", \"value\": " << result.value
+         << ", \"unit\": \"" << result.unit
+         << "\", \"samples\": " << result.samples << "}"
+         << (i + 1 < g_Results.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n}\n";
+
+  std::cout << "[Bench] Wrote " << g_Results.size() << " results to " << path
+            << std::endl;
+  return file.good();
+}
+
+bool ParseOptions(int argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--out" && hasValue) {
+      options.outputPath = argv[++i];
+    } else if (arg == "--media-dir" && hasValue) {
+      options.mediaDir = argv[++i];
+    } else if (arg == "--vulkan-icd" && hasValue) {
+      options.vulkanICD = argv[++i];
+    } else if (arg == "--quick") {
+      options.quick = true;
+    } else if (arg == "--uhd") {
+      options.uhd = true;
+    } else if (arg == "--software-gl") {
+      options.softwareGL = true;
+    } else if (arg == "--encoder-matrix") {
+      options.encoderMatrix = true;
+    } else if (arg == "--software-decode") {
+      options.softwareDecode = true;
+    } else {
+      std::cerr << "Usage: capcut_bench [--out file.json] [--media-dir dir] "
+                   "[--quick] [--uhd] [--software-gl] [--vulkan-icd path] "
+                   "[--encoder-matrix] [--software-decode]"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, options))
+    return 1;
+
+  // Driver selection must happen before the first GL/Vulkan call
+  if (options.softwareGL)
+    SetEnv("LIBGL_ALWAYS_SOFTWARE", "1");
+  if (options.softwareDecode)
+    DecoderBackend::SetMode(DecoderBackend::Mode::SoftwareOnly);
+  if (!options.vulkanICD.empty()) {
+    SetEnv("VK_DRIVER_FILES", options.vulkanICD);
+    SetEnv("VK_ICD_FILENAMES", options.vulkanICD); // Older loaders
+  }
+
+  std::vector<TestMedia> media = PrepareMedia(options);
+  if (media.empty()) {
+    std::cerr << "[Bench] No test media available" << std::endl;
+    return 1;
+  }
+
+  int seekCount = options.quick ? 10 : 50;
+  int iterations = options.quick ? 10 : 100;
+
+  for (const TestMedia &item : media) {
+    BenchDecode(item);
+    BenchSeek(item, false, seekCount);
+    BenchSeek(item, true, seekCount);
+  }
+
+  // Conversion and effects depend on resolution only
+  std::vector<std::pair<int, int>> sizes;
+  for (const TestMedia &item : media) {
+    auto size = std::make_pair(item.width, item.height);
+    if (std::find(sizes.begin(), sizes.end(), size) == sizes.end())
+      sizes.push_back(size);
+  }
+  for (const auto &size : sizes)
+    BenchConvert(size.first, size.second, iterations);
+  BenchAudioEffects(options.quick ? 2 : 10);
+  BenchLUTBake(iterations);
+
+  // GL stages need a context; a hidden window is enough
+  std::string glRenderer = "unavailable";
+  if (glfwInit()) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow *window =
+        glfwCreateWindow(64, 64, "capcut_bench", nullptr, nullptr);
+
+    if (window) {
+      glfwMakeContextCurrent(window);
+      if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        const GLubyte *name = glGetString(GL_RENDERER);
+        glRenderer = name ? reinterpret_cast<const char *>(name) : "unknown";
+        std::cout << "[Bench] GL renderer: " << glRenderer << std::endl;
+
+        for (const auto &size : sizes)
+          BenchEffects(size.first, size.second, iterations);
+      }
+
+      // The export thread shares this context from its own window
+      glfwMakeContextCurrent(nullptr);
+      for (const TestMedia &item : media)
+        BenchExport(item, window, options.mediaDir);
+
+      // One source is enough: the sweep compares encoders, not inputs
+      if (options.encoderMatrix) {
+        for (const TestMedia &item : media) {
+          if (item.height == 1080 && item.codec == "h264") {
+            BenchEncoderMatrix(item, window, options.mediaDir, options.quick);
+            break;
+          }
+        }
+      }
+      glfwDestroyWindow(window);
+    } else {
+      std::cerr << "[Bench] Could not create GL context, skipping effects "
+                   "and export"
+                << std::endl;
+    }
+    glfwTerminate();
+  }
+
+  return WriteJSON(options.outputPath, glRenderer, options) ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Bounded multi-producer multi-consumer queue for pipeline stages
+ *
+ * Lock-free ring buffer (per-cell sequence numbers, D. Vyukov's bounded
+ * MPMC design) with blocking Push/Pop on top. The fast path never takes a
+ * lock; a thread only sleeps when the ring is full (producer) or empty
+ * (consumer), and the other side wakes it through a condition variable
+ * only if someone is actually waiting.
+ *
+ * Close() ends the stream: blocked producers return false, consumers drain
+ * what is left and then get false. This replaces in-band stop markers.
+ * The blocking calls also take a cancel predicate for stops that do not
+ * end the stream (a seek, a pause); Wake() makes them re-check it.
+ *
+ * Occupancy and the time producers/consumers spent blocked are tracked so
+ * a stalled stage can be spotted from the outside.
+ */
+template <typename T> class BoundedQueue {
+public:
+  struct Stats {
+    size_t size = 0;
+    size_t capacity = 0;
+    size_t highWater = 0; ///< Largest size seen since Reopen()
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    double pushStallSeconds = 0.0; ///< Producers blocked on a full queue
+    double popStallSeconds = 0.0;  ///< Consumers blocked on an empty queue
+  };
+
+  /**
+   * @param capacity Rounded up to a power of two (at least 2)
+   */
+  explicit BoundedQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity)
+      size <<= 1;
+    m_Capacity = size;
+    m_Mask = size - 1;
+    m_Cells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i)
+      m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+    m_EnqueuePos.store(0, std::memory_order_relaxed);
+    m_DequeuePos.store(0, std::memory_order_relaxed);
+  }
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  // ==========================================================================
+  // Non-blocking
+  // ==========================================================================
+
+  /**
+   * @brief Enqueue if there is room; value is only moved from on success
+   */
+  bool TryPush(T &value) {
+    if (m_Closed.load(std::memory_order_acquire))
+      return false;
+    if (!Enqueue(value))
+      return false;
+    OnPushed();
+    return true;
+  }
+
+  bool TryPop(T &out) {
+    if (!Dequeue(out))
+      return false;
+    OnPopped();
+    return true;
+  }
+
+  // ==========================================================================
+  // Blocking
+  // ==========================================================================
+
+  /**
+   * @brief Enqueue, sleeping while the queue is full
+   * @return false if the queue was closed (value is left untouched)
+   */
+  bool Push(T &value) {
+    return Push(value, [] { return false; });
+  }
+
+  /**
+   * @brief Push() that also gives up once @p cancelled() returns true
+   *
+   * Whoever makes cancelled() true must call Wake() afterwards.
+   */
+  template <typename Cancelled> bool Push(T &value, Cancelled cancelled) {
+    if (TryPush(value))
+      return true;
+    if (m_Closed.load(std::memory_order_acquire) || cancelled())
+      return false;
+
+    auto start = std::chrono::steady_clock::now();
+    bool pushed = false;
+    m_PushWaiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      // Enqueue() rather than TryPush(): the wake-up in OnPushed() needs
+      // the lock we are holding
+      std::unique_lock<std::mutex> lock(m_WaitMutex);
+      while (!m_Closed.load(std::memory_order_acquire) && !cancelled() &&
+             !(pushed = Enqueue(value)))
+        m_NotFull.wait(lock);
+    }
+    m_PushWaiters.fetch_sub(1);
+    AddStall(m_PushStallNs, start);
+    if (pushed)
+      OnPushed();
+    return pushed;
+  }
+
+  bool Push(T &&value) { return Push(value); }
+
+  /**
+   * @brief Dequeue, sleeping while the queue is empty
+   * @return false once the queue is closed and drained
+   */
+  bool Pop(T &out) {
+    return Pop(out, [] { return false; });
+  }
+
+  /**
+   * @brief Pop() that also gives up once @p cancelled() returns true
+   *
+   * Whoever makes cancelled() true must call Wake() afterwards.
+   */
+  template <typename Cancelled> bool Pop(T &out, Cancelled cancelled) {
+    if (TryPop(out))
+      return true;
+    if (cancelled())
+      return false;
+
+    auto start = std::chrono::steady_clock::now();
+    bool popped = false;
+    m_PopWaiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lock(m_WaitMutex);
+      while (!(popped = Dequeue(out)) &&
+             !m_Closed.load(std::memory_order_acquire) && !cancelled())
+        m_NotEmpty.wait(lock);
+    }
+    m_PopWaiters.fetch_sub(1);
+    AddStall(m_PopStallNs, start);
+    if (popped)
+      OnPopped();
+
+    // Closed or cancelled: pick up anything pushed right before
+    return popped || TryPop(out);
+  }
+
+  // ==========================================================================
+  // Lifetime / Metrics
+  // ==========================================================================
+
+  /**
+   * @brief End of stream; wakes every blocked producer and consumer
+   */
+  void Close() {
+    m_Closed.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_WaitMutex);
+    m_NotFull.notify_all();
+    m_NotEmpty.notify_all();
+  }
+
+  /**
+   * @brief Wake every blocked call to re-check its cancel predicate
+   */
+  void Wake() {
+    std::lock_guard<std::mutex> lock(m_WaitMutex);
+    m_NotFull.notify_all();
+    m_NotEmpty.notify_all();
+  }
+
+  /**
+   * @brief Accept pushes again and reset the metrics
+   *
+   * Only call while no other thread uses the queue; drain it first with
+   * TryPop() if it may still hold items.
+   */
+  void Reopen() {
+    m_Closed.store(false, std::memory_order_release);
+    m_HighWater = 0;
+    m_Pushed = 0;
+    m_Popped = 0;
+    m_PushStallNs = 0;
+    m_PopStallNs = 0;
+  }
+
+  bool IsClosed() const { return m_Closed.load(std::memory_order_acquire); }
+  size_t GetCapacity() const { return m_Capacity; }
+
+  /**
+   * @brief Approximate number of queued items (exact when quiescent)
+   */
+  size_t Size() const {
+    uint64_t pushed = m_Pushed.load(std::memory_order_relaxed);
+    uint64_t popped = m_Popped.load(std::memory_order_relaxed);
+    size_t size =
+        pushed > popped ? static_cast<size_t>(pushed - popped) : 0;
+    return std::min(size, m_Capacity);
+  }
+
+  Stats GetStats() const {
+    Stats stats;
+    stats.size = Size();
+    stats.capacity = m_Capacity;
+    stats.highWater = m_HighWater;
+    stats.pushed = m_Pushed;
+    stats.popped = m_Popped;
+    stats.pushStallSeconds = m_PushStallNs * 1e-9;
+    stats.popStallSeconds = m_PopStallNs * 1e-9;
+    return stats;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  bool Enqueue(T &value) {
+    size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &m_Cells[pos & m_Mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // Full
+      } else {
+        pos = m_EnqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Dequeue(T &out) {
+    size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &m_Cells[pos & m_Mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (m_DequeuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // Empty
+      } else {
+        pos = m_DequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    out = std::move(cell->data);
+    cell->sequence.store(pos + m_Mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  void OnPushed() {
+    uint64_t pushed = m_Pushed.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint64_t popped = m_Popped.load(std::memory_order_relaxed);
+    size_t size = pushed > popped ? static_cast<size_t>(pushed - popped) : 0;
+    size = std::min(size, m_Capacity); // Counters lag the ring slightly
+    size_t highWater = m_HighWater.load(std::memory_order_relaxed);
+    while (size > highWater &&
+           !m_HighWater.compare_exchange_weak(highWater, size,
+                                              std::memory_order_relaxed)) {
+    }
+
+    // Pairs with the fence in Pop(): either the consumer sees the item
+    // or we see the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_PopWaiters.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(m_WaitMutex);
+      m_NotEmpty.notify_one();
+    }
+  }
+
+  void OnPopped() {
+    m_Popped.fetch_add(1, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_PushWaiters.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(m_WaitMutex);
+      m_NotFull.notify_one();
+    }
+  }
+
+  static void AddStall(std::atomic<int64_t> &total,
+                       std::chrono::steady_clock::time_point start) {
+    total += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now() - start)
+                 .count();
+  }
+
+  std::unique_ptr<Cell[]> m_Cells;
+  size_t m_Capacity;
+  size_t m_Mask;
+
+  // Producer and consumer positions on separate cache lines
+  alignas(64) std::atomic<size_t> m_EnqueuePos;
+  alignas(64) std::atomic<size_t> m_DequeuePos;
+
+  // Sleeping (slow path only)
+  alignas(64) std::atomic<int> m_PushWaiters{0};
+  std::atomic<int> m_PopWaiters{0};
+  std::atomic<bool> m_Closed{false};
+  std::mutex m_WaitMutex;
+  std::condition_variable m_NotFull;
+  std::condition_variable m_NotEmpty;
+
+  // Metrics
+  std::atomic<size_t> m_HighWater{0};
+  std::atomic<uint64_t> m_Pushed{0};
+  std::atomic<uint64_t> m_Popped{0};
+  std::atomic<int64_t> m_PushStallNs{0};
+  std::atomic<int64_t> m_PopStallNs{0};
+};
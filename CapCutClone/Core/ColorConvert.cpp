@@ -0,0 +1,233 @@
+#include "ColorConvert.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLORCONVERT_SSE2 1
+#endif
+
+namespace {
+
+// BT.709 limited range, 8.8 fixed point (rows sum to 0 for chroma, so gray
+// maps to exactly 128)
+constexpr int kYR = 47, kYG = 157, kYB = 16;
+constexpr int kUR = -26, kUG = -86, kUB = 112;
+constexpr int kVR = 112, kVG = -102, kVB = -10;
+
+std::atomic<bool> g_SIMDEnabled{true};
+
+// Planar scratch rows, reused across calls on the same thread
+struct Scratch {
+  std::vector<uint8_t> r[2], g[2], b[2];
+  std::vector<uint8_t> u, v;
+};
+
+void Deinterleave(const uint8_t *rgb, uint8_t *r, uint8_t *g, uint8_t *b,
+                  int width) {
+  for (int x = 0; x < width; ++x) {
+    r[x] = rgb[x * 3 + 0];
+    g[x] = rgb[x * 3 + 1];
+    b[x] = rgb[x * 3 + 2];
+  }
+}
+
+void LumaRowScalar(const uint8_t *r, const uint8_t *g, const uint8_t *b,
+                   uint8_t *y, int start, int width) {
+  for (int x = start; x < width; ++x)
+    y[x] = static_cast<uint8_t>(
+        ((kYR * r[x] + kYG * g[x] + kYB * b[x] + 128) >> 8) + 16);
+}
+
+inline uint8_t Clamp8(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// One chroma sample per 2x2 block: average first, then convert
+void ChromaRowScalar(const uint8_t *const r[2], const uint8_t *const g[2],
+                     const uint8_t *const b[2], uint8_t *u, uint8_t *v,
+                     int start, int chromaWidth) {
+  for (int i = start; i < chromaWidth; ++i) {
+    int x = i * 2;
+    int rs = (r[0][x] + r[0][x + 1] + r[1][x] + r[1][x + 1] + 2) >> 2;
+    int gs = (g[0][x] + g[0][x + 1] + g[1][x] + g[1][x + 1] + 2) >> 2;
+    int bs = (b[0][x] + b[0][x + 1] + b[1][x] + b[1][x + 1] + 2) >> 2;
+    u[i] = Clamp8(((kUR * rs + kUG * gs + kUB * bs + 128) >> 8) + 128);
+    v[i] = Clamp8(((kVR * rs + kVG * gs + kVB * bs + 128) >> 8) + 128);
+  }
+}
+
+#ifdef COLORCONVERT_SSE2
+
+// 16 pixels per iteration, 16-bit lanes (max 220 * 255 fits unsigned)
+int LumaRowSSE2(const uint8_t *r, const uint8_t *g, const uint8_t *b,
+                uint8_t *y, int width) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i cr = _mm_set1_epi16(kYR);
+  const __m128i cg = _mm_set1_epi16(kYG);
+  const __m128i cb = _mm_set1_epi16(kYB);
+  const __m128i round = _mm_set1_epi16(128);
+  const __m128i offset = _mm_set1_epi16(16);
+
+  auto luma = [&](__m128i r16, __m128i g16, __m128i b16) {
+    __m128i sum = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(r16, cr), _mm_mullo_epi16(g16, cg)),
+        _mm_add_epi16(_mm_mullo_epi16(b16, cb), round));
+    return _mm_add_epi16(_mm_srli_epi16(sum, 8), offset);
+  };
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m128i r8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + x));
+    __m128i g8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+    __m128i b8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+
+    __m128i lo =
+        luma(_mm_unpacklo_epi8(r8, zero), _mm_unpacklo_epi8(g8, zero),
+             _mm_unpacklo_epi8(b8, zero));
+    __m128i hi =
+        luma(_mm_unpackhi_epi8(r8, zero), _mm_unpackhi_epi8(g8, zero),
+             _mm_unpackhi_epi8(b8, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(y + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+  return x;
+}
+
+// 2x2 averages of 16 pixels -> 8 chroma values
+inline __m128i Average2x2(const uint8_t *row0, const uint8_t *row1) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1));
+  __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                             _mm_unpacklo_epi8(b, zero));
+  __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                             _mm_unpackhi_epi8(b, zero));
+  // Horizontal pairs: madd against 1 adds neighbours into 32-bit lanes
+  __m128i sum = _mm_packs_epi32(_mm_madd_epi16(lo, ones),
+                                _mm_madd_epi16(hi, ones));
+  return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+// 8 chroma samples per iteration, signed 16-bit (|sum| <= 112 * 255 + 128)
+int ChromaRowSSE2(const uint8_t *const r[2], const uint8_t *const g[2],
+                  const uint8_t *const b[2], uint8_t *u, uint8_t *v,
+                  int chromaWidth) {
+  const __m128i round = _mm_set1_epi16(128);
+  const __m128i bias = _mm_set1_epi16(128);
+
+  auto convert = [&](__m128i rs, __m128i gs, __m128i bs, int kr, int kg,
+                     int kb) {
+    __m128i sum = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(rs, _mm_set1_epi16(kr)),
+                      _mm_mullo_epi16(gs, _mm_set1_epi16(kg))),
+        _mm_add_epi16(_mm_mullo_epi16(bs, _mm_set1_epi16(kb)), round));
+    return _mm_add_epi16(_mm_srai_epi16(sum, 8), bias);
+  };
+
+  int i = 0;
+  for (; i + 8 <= chromaWidth; i += 8) {
+    int x = i * 2;
+    __m128i rs = Average2x2(r[0] + x, r[1] + x);
+    __m128i gs = Average2x2(g[0] + x, g[1] + x);
+    __m128i bs = Average2x2(b[0] + x, b[1] + x);
+
+    __m128i u16 = convert(rs, gs, bs, kUR, kUG, kUB);
+    __m128i v16 = convert(rs, gs, bs, kVR, kVG, kVB);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(u + i),
+                     _mm_packus_epi16(u16, u16));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(v + i),
+                     _mm_packus_epi16(v16, v16));
+  }
+  return i;
+}
+
+#endif
+
+/**
+ * @brief Shared row-pair loop; writeChroma stores one row of U/V samples
+ */
+template <typename WriteChroma>
+void Convert(const uint8_t *rgb, int rgbStride, uint8_t *yPlane, int yStride,
+             int width, int height, WriteChroma writeChroma) {
+  thread_local Scratch scratch;
+  for (int k = 0; k < 2; ++k) {
+    scratch.r[k].resize(width);
+    scratch.g[k].resize(width);
+    scratch.b[k].resize(width);
+  }
+  int chromaWidth = width / 2;
+  scratch.u.resize(chromaWidth);
+  scratch.v.resize(chromaWidth);
+
+  bool simd = g_SIMDEnabled.load(std::memory_order_relaxed);
+  const uint8_t *r[2] = {scratch.r[0].data(), scratch.r[1].data()};
+  const uint8_t *g[2] = {scratch.g[0].data(), scratch.g[1].data()};
+  const uint8_t *b[2] = {scratch.b[0].data(), scratch.b[1].data()};
+
+  for (int row = 0; row + 1 < height; row += 2) {
+    for (int k = 0; k < 2; ++k) {
+      Deinterleave(rgb + (row + k) * rgbStride, scratch.r[k].data(),
+                   scratch.g[k].data(), scratch.b[k].data(), width);
+
+      int done = 0;
+#ifdef COLORCONVERT_SSE2
+      if (simd)
+        done = LumaRowSSE2(r[k], g[k], b[k], yPlane + (row + k) * yStride,
+                           width);
+#endif
+      LumaRowScalar(r[k], g[k], b[k], yPlane + (row + k) * yStride, done,
+                    width);
+    }
+
+    int done = 0;
+#ifdef COLORCONVERT_SSE2
+    if (simd)
+      done = ChromaRowSSE2(r, g, b, scratch.u.data(), scratch.v.data(),
+                           chromaWidth);
+#endif
+    ChromaRowScalar(r, g, b, scratch.u.data(), scratch.v.data(), done,
+                    chromaWidth);
+    writeChroma(row / 2, scratch.u.data(), scratch.v.data(), chromaWidth);
+  }
+  (void)simd;
+}
+
+} // namespace
+
+void ColorConvert::RGB24ToNV12(const uint8_t *rgb, int rgbStride, uint8_t *y,
+                               int yStride, uint8_t *uv, int uvStride,
+                               int width, int height) {
+  Convert(rgb, rgbStride, y, yStride, width, height,
+          [&](int row, const uint8_t *u, const uint8_t *v, int count) {
+            uint8_t *dst = uv + row * uvStride;
+            for (int i = 0; i < count; ++i) {
+              dst[i * 2] = u[i];
+              dst[i * 2 + 1] = v[i];
+            }
+          });
+}
+
+void ColorConvert::RGB24ToYUV420P(const uint8_t *rgb, int rgbStride,
+                                  uint8_t *y, int yStride, uint8_t *u,
+                                  int uStride, uint8_t *v, int vStride,
+                                  int width, int height) {
+  Convert(rgb, rgbStride, y, yStride, width, height,
+          [&](int row, const uint8_t *us, const uint8_t *vs, int count) {
+            std::copy(us, us + count, u + row * uStride);
+            std::copy(vs, vs + count, v + row * vStride);
+          });
+}
+
+void ColorConvert::SetSIMDEnabled(bool enabled) { g_SIMDEnabled = enabled; }
+
+bool ColorConvert::IsSIMDAvailable() {
+#ifdef COLORCONVERT_SSE2
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief CPU RGB24 -> YUV 4:2:0 conversion (BT.709, limited range)
+ *
+ * Same matrix as the CUDA kernel, in 8.8 fixed point. Chroma is the
+ * average of each 2x2 block. The SSE2 path (x86) and the scalar path give
+ * identical output; other architectures use the scalar loop, which is
+ * written so the compiler can vectorize it.
+ *
+ * Width and height must be even.
+ */
+class ColorConvert {
+public:
+  /**
+   * @param uv Interleaved U/V plane (NV12)
+   */
+  static void RGB24ToNV12(const uint8_t *rgb, int rgbStride, uint8_t *y,
+                          int yStride, uint8_t *uv, int uvStride, int width,
+                          int height);
+
+  static void RGB24ToYUV420P(const uint8_t *rgb, int rgbStride, uint8_t *y,
+                             int yStride, uint8_t *u, int uStride, uint8_t *v,
+                             int vStride, int width, int height);
+
+  /**
+   * @brief Disable the SIMD path (benchmarks and comparisons)
+   */
+  static void SetSIMDEnabled(bool enabled);
+  static bool IsSIMDAvailable();
+};
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/mem.h>
+}
+
+/**
+ * @brief How FramePool creates, destroys and tags pooled objects
+ *
+ * Every specialization provides:
+ * - Params: what one object looks like (size, format, ...)
+ * - Allocate(params) / Free(object)
+ * - SetIndex/GetIndex: store the pool slot inside the object itself, so
+ *   Release() needs no lookup table
+ */
+template <typename T> struct PoolTraits;
+
+/**
+ * @brief Raw plane buffer (pixels, samples), SIMD-aligned by av_malloc
+ */
+struct PlaneBuffer {
+  uint8_t *data = nullptr;
+  size_t size = 0;
+  uint32_t poolIndex = 0;
+};
+
+template <> struct PoolTraits<PlaneBuffer> {
+  struct Params {
+    size_t size = 0;
+  };
+
+  static PlaneBuffer *Allocate(const Params &params) {
+    uint8_t *data = static_cast<uint8_t *>(av_malloc(params.size));
+    if (!data)
+      return nullptr;
+    PlaneBuffer *buffer = new PlaneBuffer();
+    buffer->data = data;
+    buffer->size = params.size;
+    return buffer;
+  }
+  static void Free(PlaneBuffer *buffer) {
+    av_free(buffer->data);
+    delete buffer;
+  }
+  static void SetIndex(PlaneBuffer *buffer, uint32_t index) {
+    buffer->poolIndex = index;
+  }
+  static uint32_t GetIndex(const PlaneBuffer *buffer) {
+    return buffer->poolIndex;
+  }
+};
+
+/**
+ * @brief Video frames in host memory, or GPU surfaces when hwFramesCtx is
+ * set (same pool, same hand-off through the encoder queue)
+ */
+template <> struct PoolTraits<AVFrame> {
+  struct Params {
+    int format = -1; ///< AVPixelFormat (host frames)
+    int width = 0;
+    int height = 0;
+    int align = 32;
+    AVBufferRef *hwFramesCtx = nullptr; ///< Not owned; outlives the pool
+  };
+
+  static AVFrame *Allocate(const Params &params) {
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+      return nullptr;
+    if (!GetBuffer(frame, params)) {
+      av_frame_free(&frame);
+      return nullptr;
+    }
+    return frame;
+  }
+  static void Free(AVFrame *frame) { av_frame_free(&frame); }
+
+  /**
+   * @brief Make sure nobody else (the encoder) still references the pixels
+   *
+   * Host frames are copied only if they are shared. A shared GPU surface
+   * is swapped for a fresh one from the hwframe pool instead: frames are
+   * always fully rewritten, so there is nothing to copy.
+   */
+  static bool MakeWritable(AVFrame *frame, const Params &params) {
+    if (!frame->hw_frames_ctx)
+      return av_frame_make_writable(frame) >= 0;
+    if (av_frame_is_writable(frame))
+      return true;
+
+    uint32_t index = GetIndex(frame);
+    av_frame_unref(frame);
+    bool ok = GetBuffer(frame, params);
+    SetIndex(frame, index);
+    return ok;
+  }
+
+  // opaque is ours: the encoder only reads it with AV_CODEC_FLAG_COPY_OPAQUE
+  static void SetIndex(AVFrame *frame, uint32_t index) {
+    frame->opaque = reinterpret_cast<void *>(static_cast<uintptr_t>(index));
+  }
+  static uint32_t GetIndex(const AVFrame *frame) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(frame->opaque));
+  }
+
+private:
+  static bool GetBuffer(AVFrame *frame, const Params &params) {
+    if (params.hwFramesCtx)
+      return av_hwframe_get_buffer(params.hwFramesCtx, frame, 0) >= 0;
+    frame->format = params.format;
+    frame->width = params.width;
+    frame->height = params.height;
+    return av_frame_get_buffer(frame, params.align) >= 0;
+  }
+};
+
+/**
+ * @brief Fixed-capacity object pool with a lock-free free list
+ *
+ * All slots are reserved up front; `initialSize` objects are allocated in
+ * the constructor and the pool grows lazily up to `maxSize`. Past that,
+ * Acquire() blocks until another thread releases an object. In steady
+ * state Acquire/Release allocate nothing and take no lock: the free list
+ * is a Treiber stack of slot indices with an ABA tag, and the slot index
+ * travels inside the object (PoolTraits::SetIndex).
+ *
+ * Objects are handed out as raw pointers so they can cross queues between
+ * threads; Handle is the RAII wrapper for scoped use.
+ */
+template <typename T> class FramePool {
+public:
+  using Traits = PoolTraits<T>;
+  using Params = typename Traits::Params;
+
+  struct Stats {
+    size_t allocated = 0; ///< Objects created so far (<= maxSize)
+    size_t maxSize = 0;
+    size_t inUse = 0;
+    size_t peakInUse = 0;
+    double waitSeconds = 0.0; ///< Time Acquire() spent on an empty pool
+  };
+
+  /**
+   * @brief Scoped ownership of one pooled object
+   */
+  class Handle {
+  public:
+    Handle() = default;
+    Handle(FramePool *pool, T *object) : m_Pool(pool), m_Object(object) {}
+    Handle(Handle &&other) noexcept
+        : m_Pool(other.m_Pool), m_Object(other.m_Object) {
+      other.m_Object = nullptr;
+    }
+    Handle &operator=(Handle &&other) noexcept {
+      if (this != &other) {
+        Reset();
+        m_Pool = other.m_Pool;
+        m_Object = other.m_Object;
+        other.m_Object = nullptr;
+      }
+      return *this;
+    }
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+    ~Handle() { Reset(); }
+
+    T *Get() const { return m_Object; }
+    T *operator->() const { return m_Object; }
+    explicit operator bool() const { return m_Object != nullptr; }
+
+    /**
+     * @brief Give up ownership without returning the object to the pool
+     */
+    T *Detach() {
+      T *object = m_Object;
+      m_Object = nullptr;
+      return object;
+    }
+
+    void Reset() {
+      if (m_Object)
+        m_Pool->Release(m_Object);
+      m_Object = nullptr;
+    }
+
+  private:
+    FramePool *m_Pool = nullptr;
+    T *m_Object = nullptr;
+  };
+
+  FramePool(size_t initialSize, size_t maxSize, const Params &params)
+      : m_Params(params), m_MaxSize(std::max<size_t>(1, maxSize)),
+        m_Slots(new Slot[m_MaxSize]) {
+    // Chain all slots, lowest index on top so preallocated ones go first
+    for (size_t i = 0; i < m_MaxSize; ++i)
+      m_Slots[i].next.store(i + 1 < m_MaxSize ? static_cast<uint32_t>(i + 1)
+                                              : kEmpty,
+                            std::memory_order_relaxed);
+    m_FreeHead.store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < std::min(initialSize, m_MaxSize); ++i) {
+      T *object = Traits::Allocate(m_Params);
+      if (!object)
+        break;
+      Traits::SetIndex(object, static_cast<uint32_t>(i));
+      m_Slots[i].object = object;
+      m_Allocated++;
+    }
+  }
+
+  ~FramePool() {
+    // Objects still out are freed too; their holders must be done by now
+    for (size_t i = 0; i < m_MaxSize; ++i) {
+      if (m_Slots[i].object)
+        Traits::Free(m_Slots[i].object);
+    }
+  }
+
+  FramePool(const FramePool &) = delete;
+  FramePool &operator=(const FramePool &) = delete;
+
+  /**
+   * @brief Take an object without blocking
+   * @return nullptr if the pool is exhausted (or allocation failed)
+   */
+  T *TryAcquire() {
+    bool exhausted = false;
+    return Take(exhausted);
+  }
+
+  /**
+   * @brief Take an object, sleeping while all maxSize objects are in use
+   * @return nullptr after Shutdown() (or if allocation failed)
+   */
+  T *Acquire() {
+    bool exhausted = false;
+    T *object = Take(exhausted);
+    if (object || !exhausted || m_Shutdown.load(std::memory_order_acquire))
+      return object;
+
+    auto start = std::chrono::steady_clock::now();
+    m_Waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lock(m_WaitMutex);
+      while (!(object = Take(exhausted)) && exhausted &&
+             !m_Shutdown.load(std::memory_order_acquire))
+        m_Available.wait(lock);
+    }
+    m_Waiters.fetch_sub(1);
+    m_WaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    return object;
+  }
+
+  Handle AcquireHandle() { return Handle(this, Acquire()); }
+
+  /**
+   * @brief Return an object obtained from this pool
+   */
+  void Release(T *object) {
+    if (!object)
+      return;
+    m_InUse.fetch_sub(1, std::memory_order_relaxed);
+    PushFree(Traits::GetIndex(object));
+
+    // Pairs with the fence in Acquire(): either the waiter sees the slot
+    // or we see the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_Waiters.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(m_WaitMutex);
+      m_Available.notify_one();
+    }
+  }
+
+  /**
+   * @brief Wake blocked Acquire() calls; they return nullptr from now on
+   * instead of waiting for an object
+   */
+  void Shutdown() {
+    m_Shutdown.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_WaitMutex);
+    m_Available.notify_all();
+  }
+
+  const Params &GetParams() const { return m_Params; }
+
+  Stats GetStats() const {
+    Stats stats;
+    stats.allocated = m_Allocated;
+    stats.maxSize = m_MaxSize;
+    stats.inUse = m_InUse;
+    stats.peakInUse = m_PeakInUse;
+    stats.waitSeconds = m_WaitNs * 1e-9;
+    return stats;
+  }
+
+private:
+  static constexpr uint32_t kEmpty = 0xFFFFFFFFu;
+
+  struct Slot {
+    T *object = nullptr;
+    std::atomic<uint32_t> next{kEmpty};
+  };
+
+  T *Take(bool &exhausted) {
+    uint32_t index = PopFree();
+    exhausted = index == kEmpty;
+    if (exhausted)
+      return nullptr;
+
+    Slot &slot = m_Slots[index];
+    if (!slot.object) {
+      // Growth: first use of a reserved slot
+      T *object = Traits::Allocate(m_Params);
+      if (!object) {
+        PushFree(index);
+        return nullptr;
+      }
+      Traits::SetIndex(object, index);
+      slot.object = object;
+      m_Allocated++;
+    }
+
+    size_t inUse = m_InUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t peak = m_PeakInUse.load(std::memory_order_relaxed);
+    while (inUse > peak &&
+           !m_PeakInUse.compare_exchange_weak(peak, inUse,
+                                              std::memory_order_relaxed)) {
+    }
+    return slot.object;
+  }
+
+  // Head = (tag << 32) | index; the tag changes on every pop/push (ABA)
+  uint32_t PopFree() {
+    uint64_t head = m_FreeHead.load(std::memory_order_acquire);
+    while (true) {
+      uint32_t index = static_cast<uint32_t>(head);
+      if (index == kEmpty)
+        return kEmpty;
+      uint32_t next = m_Slots[index].next.load(std::memory_order_relaxed);
+      uint64_t newHead = ((head >> 32) + 1) << 32 | next;
+      if (m_FreeHead.compare_exchange_weak(head, newHead,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+        return index;
+    }
+  }
+
+  void PushFree(uint32_t index) {
+    uint64_t head = m_FreeHead.load(std::memory_order_relaxed);
+    while (true) {
+      m_Slots[index].next.store(static_cast<uint32_t>(head),
+                                std::memory_order_relaxed);
+      uint64_t newHead = ((head >> 32) + 1) << 32 | index;
+      if (m_FreeHead.compare_exchange_weak(head, newHead,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed))
+        return;
+    }
+  }
+
+  Params m_Params;
+  size_t m_MaxSize;
+  std::unique_ptr<Slot[]> m_Slots;
+  alignas(64) std::atomic<uint64_t> m_FreeHead{0};
+
+  alignas(64) std::atomic<size_t> m_Allocated{0};
+  std::atomic<size_t> m_InUse{0};
+  std::atomic<size_t> m_PeakInUse{0};
+  std::atomic<int64_t> m_WaitNs{0};
+
+  // Sleeping (exhausted pool only)
+  std::atomic<int> m_Waiters{0};
+  std::atomic<bool> m_Shutdown{false};
+  std::mutex m_WaitMutex;
+  std::condition_variable m_Available;
+};
@@ -0,0 +1,114 @@
+#include "MappedFile.h"
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+  *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Close();
+    std::swap(m_Data, other.m_Data);
+    std::swap(m_Size, other.m_Size);
+#ifdef _WIN32
+    std::swap(m_File, other.m_File);
+    std::swap(m_Mapping, other.m_Mapping);
+#endif
+  }
+  return *this;
+}
+
+bool MappedFile::Open(const std::string &path) {
+  Close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    std::cerr << "[MappedFile] Cannot open " << path << std::endl;
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    std::cerr << "[MappedFile] Empty or unreadable file: " << path
+              << std::endl;
+    return false;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                       : nullptr;
+  if (!view) {
+    if (mapping)
+      CloseHandle(mapping);
+    CloseHandle(file);
+    std::cerr << "[MappedFile] Cannot map " << path << std::endl;
+    return false;
+  }
+
+  m_File = file;
+  m_Mapping = mapping;
+  m_Data = static_cast<const uint8_t *>(view);
+  m_Size = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "[MappedFile] Cannot open " << path << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    std::cerr << "[MappedFile] Empty or unreadable file: " << path
+              << std::endl;
+    return false;
+  }
+
+  void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                    MAP_PRIVATE, fd, 0);
+  ::close(fd); // The mapping keeps its own reference
+  if (view == MAP_FAILED) {
+    std::cerr << "[MappedFile] Cannot map " << path << std::endl;
+    return false;
+  }
+
+  m_Data = static_cast<const uint8_t *>(view);
+  m_Size = static_cast<size_t>(st.st_size);
+#endif
+  return true;
+}
+
+void MappedFile::Close() {
+  if (!m_Data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_Data);
+  CloseHandle(static_cast<HANDLE>(m_Mapping));
+  CloseHandle(static_cast<HANDLE>(m_File));
+  m_File = nullptr;
+  m_Mapping = nullptr;
+#else
+  munmap(const_cast<uint8_t *>(m_Data), m_Size);
+#endif
+  m_Data = nullptr;
+  m_Size = 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * MapViewOfFile on Windows, mmap elsewhere. Pages are faulted in on first
+ * access, so opening a large file costs the same as opening a small one.
+ * Move-only; the mapping is released on Close() or destruction.
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  bool Open(const std::string &path);
+  void Close();
+
+  bool IsOpen() const { return m_Data != nullptr; }
+  const uint8_t *GetData() const { return m_Data; }
+  size_t GetSize() const { return m_Size; }
+
+private:
+  const uint8_t *m_Data = nullptr;
+  size_t m_Size = 0;
+#ifdef _WIN32
+  void *m_File = nullptr;    // HANDLE
+  void *m_Mapping = nullptr; // HANDLE
+#endif
+};
@@ -0,0 +1,359 @@
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TRACE_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_HAS_TSC 1
+#endif
+
+namespace {
+
+constexpr uint64_t kRingSize = 1 << 16; // Events per thread (power of two)
+
+struct Event {
+  uint64_t start;
+  uint64_t end; ///< Counter events: the value
+  int64_t frameId;
+  uint8_t isCounter;
+  uint8_t id; ///< TraceStage or TraceCounter
+};
+
+struct ThreadRing {
+  std::vector<Event> events = std::vector<Event>(kRingSize);
+  std::atomic<uint64_t> writeIndex{0};
+  std::atomic<bool> alive{true};
+  uint64_t clearIndex = 0; // Registry mutex
+  std::string name;        // Registry mutex
+  int tid = 0;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadRing>> rings;
+  int nextTid = 1;
+
+  // Reference point for converting ticks to time
+  uint64_t baseTicks = Trace::Now();
+  std::chrono::steady_clock::time_point baseTime =
+      std::chrono::steady_clock::now();
+};
+
+Registry &GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+// Keeps the ring alive for dumping after its thread exits
+struct RingOwner {
+  std::shared_ptr<ThreadRing> ring;
+  ~RingOwner() {
+    if (ring)
+      ring->alive = false;
+  }
+};
+thread_local RingOwner t_RingOwner;
+
+ThreadRing &GetThreadRing() {
+  if (!t_RingOwner.ring) {
+    auto ring = std::make_shared<ThreadRing>();
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ring->tid = registry.nextTid++;
+    ring->name = "Thread " + std::to_string(ring->tid);
+    registry.rings.push_back(ring);
+    t_RingOwner.ring = ring;
+  }
+  return *t_RingOwner.ring;
+}
+
+void PushEvent(const Event &event) {
+  ThreadRing &ring = GetThreadRing();
+  uint64_t index = ring.writeIndex.load(std::memory_order_relaxed);
+  ring.events[index & (kRingSize - 1)] = event;
+  ring.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+double TicksPerMicrosecond() {
+#ifdef TRACE_HAS_TSC
+  // Calibrate against steady_clock over the whole recording
+  Registry &registry = GetRegistry();
+  uint64_t ticks = Trace::Now() - registry.baseTicks;
+  double us = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - registry.baseTime)
+                  .count();
+  return us > 0.0 && ticks > 0 ? ticks / us : 1000.0;
+#else
+  return 1000.0; // Ticks are nanoseconds
+#endif
+}
+
+struct RingSnapshot {
+  int tid;
+  std::string name;
+  std::vector<Event> events;
+};
+
+std::vector<RingSnapshot> Snapshot() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::vector<RingSnapshot> snapshots;
+  for (const auto &ring : registry.rings) {
+    uint64_t end = ring->writeIndex.load(std::memory_order_acquire);
+    uint64_t begin = end > kRingSize ? end - kRingSize : 0;
+    begin = std::max(begin, ring->clearIndex);
+
+    RingSnapshot snapshot;
+    snapshot.tid = ring->tid;
+    snapshot.name = ring->name;
+    snapshot.events.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t i = begin; i < end; ++i)
+      snapshot.events.push_back(ring->events[i & (kRingSize - 1)]);
+
+    // Drop events the writer overwrote while we were copying
+    uint64_t after = ring->writeIndex.load(std::memory_order_acquire);
+    if (after > kRingSize && after - kRingSize > begin) {
+      size_t overwritten = static_cast<size_t>(
+          std::min(after - kRingSize - begin, end - begin));
+      snapshot.events.erase(snapshot.events.begin(),
+                            snapshot.events.begin() + overwritten);
+    }
+    snapshots.push_back(std::move(snapshot));
+  }
+  return snapshots;
+}
+
+std::string EscapeJSON(const std::string &text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      escaped += c;
+  }
+  return escaped;
+}
+
+} // namespace
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+uint64_t Trace::Now() {
+#ifdef TRACE_HAS_TSC
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+void Trace::SetThreadName(const std::string &name) {
+  ThreadRing &ring = GetThreadRing();
+  std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+  ring.name = name;
+}
+
+void Trace::Record(TraceStage stage, uint64_t start, uint64_t end,
+                   int64_t frameId) {
+  if (!IsEnabled())
+    return;
+  PushEvent({start, end, frameId, 0, static_cast<uint8_t>(stage)});
+}
+
+void Trace::RecordCounter(TraceCounter counter, int64_t value) {
+  if (!IsEnabled())
+    return;
+  uint64_t now = Now();
+  PushEvent({now, static_cast<uint64_t>(value), -1, 1,
+             static_cast<uint8_t>(counter)});
+}
+
+void Trace::Clear() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  auto &rings = registry.rings;
+  rings.erase(std::remove_if(rings.begin(), rings.end(),
+                             [](const std::shared_ptr<ThreadRing> &ring) {
+                               return !ring->alive;
+                             }),
+              rings.end());
+  for (auto &ring : rings)
+    ring->clearIndex = ring->writeIndex.load(std::memory_order_acquire);
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+Trace::Summary Trace::GetSummary() {
+  const size_t stageCount = static_cast<size_t>(TraceStage::Count);
+  const size_t counterCount = static_cast<size_t>(TraceCounter::Count);
+
+  std::vector<std::vector<uint64_t>> durations(stageCount);
+  std::vector<CounterStats> counters(counterCount);
+  std::vector<uint64_t> counterTime(counterCount, 0);
+  std::vector<bool> counterSeen(counterCount, false);
+
+  for (const auto &snapshot : Snapshot()) {
+    for (const Event &event : snapshot.events) {
+      if (event.isCounter) {
+        if (event.id >= counterCount)
+          continue;
+        CounterStats &stats = counters[event.id];
+        int64_t value = static_cast<int64_t>(event.end);
+        if (!counterSeen[event.id] || event.start >= counterTime[event.id]) {
+          stats.last = value;
+          counterTime[event.id] = event.start;
+        }
+        stats.max = counterSeen[event.id] ? std::max(stats.max, value) : value;
+        counterSeen[event.id] = true;
+      } else if (event.id < stageCount && event.end >= event.start) {
+        durations[event.id].push_back(event.end - event.start);
+      }
+    }
+  }
+
+  double ticksPerMs = TicksPerMicrosecond() * 1000.0;
+  auto percentile = [](std::vector<uint64_t> &values, double p) {
+    size_t n = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return values[n];
+  };
+
+  Summary summary;
+  for (size_t s = 0; s < stageCount; ++s) {
+    auto &values = durations[s];
+    if (values.empty())
+      continue;
+
+    StageStats stats;
+    stats.stage = static_cast<TraceStage>(s);
+    stats.count = values.size();
+    uint64_t total = 0;
+    for (uint64_t v : values)
+      total += v;
+    stats.totalMs = total / ticksPerMs;
+    stats.p50Ms = percentile(values, 0.50) / ticksPerMs;
+    stats.p99Ms = percentile(values, 0.99) / ticksPerMs;
+    summary.stages.push_back(stats);
+  }
+  for (size_t c = 0; c < counterCount; ++c) {
+    if (!counterSeen[c])
+      continue;
+    counters[c].counter = static_cast<TraceCounter>(c);
+    summary.counters.push_back(counters[c]);
+  }
+  return summary;
+}
+
+bool Trace::WriteChromeJSON(const std::string &path) {
+  auto snapshots = Snapshot();
+
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    std::cerr << "[Trace] Could not open " << path << std::endl;
+    return false;
+  }
+
+  // Timestamps relative to the first event, in microseconds
+  uint64_t origin = UINT64_MAX;
+  for (const auto &snapshot : snapshots)
+    for (const Event &event : snapshot.events)
+      origin = std::min(origin, event.start);
+  double ticksPerUs = TicksPerMicrosecond();
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  auto separator = [&]() {
+    if (!first)
+      file << ",\n";
+    first = false;
+  };
+
+  size_t eventCount = 0;
+  for (const auto &snapshot : snapshots) {
+    separator();
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+         << snapshot.tid << ",\"args\":{\"name\":\""
+         << EscapeJSON(snapshot.name) << "\"}}";
+
+    for (const Event &event : snapshot.events) {
+      double ts = (event.start - origin) / ticksPerUs;
+      separator();
+      if (event.isCounter) {
+        file << "{\"name\":\""
+             << GetCounterName(static_cast<TraceCounter>(event.id))
+             << "\",\"ph\":\"C\",\"ts\":" << ts << ",\"pid\":1,\"tid\":"
+             << snapshot.tid << ",\"args\":{\"value\":"
+             << static_cast<int64_t>(event.end) << "}}";
+      } else {
+        double dur = event.end >= event.start
+                         ? (event.end - event.start) / ticksPerUs
+                         : 0.0;
+        file << "{\"name\":\""
+             << GetStageName(static_cast<TraceStage>(event.id))
+             << "\",\"cat\":\"export\",\"ph\":\"X\",\"ts\":" << ts
+             << ",\"dur\":" << dur << ",\"pid\":1,\"tid\":" << snapshot.tid
+             << ",\"args\":{\"frame\":" << event.frameId << "}}";
+      }
+      eventCount++;
+    }
+  }
+  file << "\n]}\n";
+
+  std::cout << "[Trace] Wrote " << eventCount << " events to " << path
+            << std::endl;
+  return file.good();
+}
+
+const char *Trace::GetStageName(TraceStage stage) {
+  switch (stage) {
+  case TraceStage::Decode:
+    return "Decode";
+  case TraceStage::Seek:
+    return "Seek";
+  case TraceStage::TextureUpload:
+    return "Texture upload";
+  case TraceStage::Effects:
+    return "Effects";
+  case TraceStage::ReadbackWait:
+    return "Readback wait";
+  case TraceStage::ColorConvert:
+    return "Color convert";
+  case TraceStage::QueueWait:
+    return "Queue wait";
+  case TraceStage::EncoderSend:
+    return "Encoder send";
+  case TraceStage::EncoderReceive:
+    return "Encoder receive";
+  case TraceStage::MuxWrite:
+    return "Mux write";
+  default:
+    return "Unknown";
+  }
+}
+
+const char *Trace::GetCounterName(TraceCounter counter) {
+  switch (counter) {
+  case TraceCounter::YUVQueue:
+    return "YUV queue";
+  case TraceCounter::VideoPackets:
+    return "Video packets";
+  case TraceCounter::AudioPackets:
+    return "Audio packets";
+  default:
+    return "Unknown";
+  }
+}
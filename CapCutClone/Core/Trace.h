@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Pipeline stages recorded by Trace (one row each in the summary)
+ */
+enum class TraceStage : uint8_t {
+  Decode,
+  Seek,
+  TextureUpload,
+  Effects,
+  ReadbackWait,
+  ColorConvert,
+  QueueWait,
+  EncoderSend,
+  EncoderReceive,
+  MuxWrite,
+  Count
+};
+
+/**
+ * @brief Sampled values (queue depths) shown next to the stage timings
+ */
+enum class TraceCounter : uint8_t {
+  YUVQueue,
+  VideoPackets, ///< Playback demux queues
+  AudioPackets,
+  Count
+};
+
+/**
+ * @brief Low-overhead span tracing for the export pipeline
+ *
+ * Every thread writes into its own fixed-size ring buffer (no lock, no
+ * allocation after the first event), so recording a span costs two
+ * timestamp reads and one 32-byte store. Timestamps are raw TSC ticks
+ * where available and are converted to time only when reading.
+ *
+ * Recording is off until SetEnabled(true). Rings keep the most recent
+ * events; older ones are overwritten.
+ *
+ * Output:
+ * - GetSummary(): p50/p99 per stage and the latest counter values
+ * - WriteChromeJSON(): chrome://tracing / Perfetto "Trace Event" file
+ */
+class Trace {
+public:
+  struct StageStats {
+    TraceStage stage = TraceStage::Decode;
+    uint64_t count = 0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double totalMs = 0.0;
+  };
+
+  struct CounterStats {
+    TraceCounter counter = TraceCounter::YUVQueue;
+    int64_t last = 0;
+    int64_t max = 0;
+  };
+
+  struct Summary {
+    std::vector<StageStats> stages; ///< Stages with at least one span
+    std::vector<CounterStats> counters;
+  };
+
+  static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+  static bool IsEnabled() {
+    return s_Enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Label the calling thread in the Chrome trace
+   */
+  static void SetThreadName(const std::string &name);
+
+  static uint64_t Now(); ///< Ticks (TSC or steady_clock ns)
+
+  static void Record(TraceStage stage, uint64_t start, uint64_t end,
+                     int64_t frameId);
+  static void RecordCounter(TraceCounter counter, int64_t value);
+
+  static Summary GetSummary();
+  static bool WriteChromeJSON(const std::string &path);
+
+  /**
+   * @brief Forget recorded events and drop rings of exited threads
+   */
+  static void Clear();
+
+  static const char *GetStageName(TraceStage stage);
+  static const char *GetCounterName(TraceCounter counter);
+
+private:
+  static inline std::atomic<bool> s_Enabled{false};
+};
+
+/**
+ * @brief Records one span from construction to destruction
+ *
+ * Costs a single relaxed load while tracing is disabled.
+ */
+class TraceScope {
+public:
+  explicit TraceScope(TraceStage stage, int64_t frameId = -1)
+      : m_Stage(stage), m_FrameId(frameId),
+        m_Start(Trace::IsEnabled() ? Trace::Now() : 0) {}
+  ~TraceScope() {
+    if (m_Start)
+      Trace::Record(m_Stage, m_Start, Trace::Now(), m_FrameId);
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  TraceStage m_Stage;
+  int64_t m_FrameId;
+  uint64_t m_Start;
+};
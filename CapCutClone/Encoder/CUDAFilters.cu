@@ -1,7 +1,15 @@
 #include "CUDAFilters.h"
+#ifdef _WIN32
+#include <windows.h> // Before the GL headers pulled in by the interop API
+#endif
+#include <cuda_gl_interop.h>
 #include <cuda_runtime.h>
 #include <iostream>
 
+#ifndef GL_TEXTURE_2D
+#define GL_TEXTURE_2D 0x0DE1
+#endif
+
 // CUDA kernel for RGB24 to NV12 conversion
 __global__ void RGB24ToNV12Kernel(const uint8_t *__restrict__ rgb,
                                   uint8_t *__restrict__ y_plane,
@@ -41,14 +49,56 @@ __global__ void RGB24ToNV12Kernel(const uint8_t *__restrict__ rgb,
   }
 }
 
+// GL render target (RGBA8) to NV12 in pitched device memory. One thread
+// per 2x2 block; chroma is the block average (same as ColorConvert)
+__global__ void RGBAToNV12Kernel(cudaTextureObject_t rgba,
+                                 uint8_t *__restrict__ y_plane, int y_pitch,
+                                 uint8_t *__restrict__ uv_plane, int uv_pitch,
+                                 int width, int height) {
+  int cx = blockIdx.x * blockDim.x + threadIdx.x;
+  int cy = blockIdx.y * blockDim.y + threadIdx.y;
+  if (cx * 2 >= width || cy * 2 >= height)
+    return;
+
+  const float Wr = 0.2126f;
+  const float Wg = 0.7152f;
+  const float Wb = 0.0722f;
+
+  float rSum = 0.0f, gSum = 0.0f, bSum = 0.0f;
+  for (int dy = 0; dy < 2; ++dy) {
+    for (int dx = 0; dx < 2; ++dx) {
+      int x = cx * 2 + dx;
+      int y = cy * 2 + dy;
+      uchar4 p = tex2D<uchar4>(rgba, x, y);
+      float r = p.x / 255.0f;
+      float g = p.y / 255.0f;
+      float b = p.z / 255.0f;
+      float Y = Wr * r + Wg * g + Wb * b;
+      y_plane[y * y_pitch + x] = (uint8_t)(16.0f + 219.0f * Y + 0.5f);
+      rSum += r;
+      gSum += g;
+      bSum += b;
+    }
+  }
+
+  float r = rSum * 0.25f, g = gSum * 0.25f, b = bSum * 0.25f;
+  float Y = Wr * r + Wg * g + Wb * b;
+  float U = (b - Y) / (2.0f * (1.0f - Wb));
+  float V = (r - Y) / (2.0f * (1.0f - Wr));
+  uint8_t *uv = uv_plane + cy * uv_pitch + cx * 2;
+  uv[0] = (uint8_t)fminf(fmaxf(128.0f + 224.0f * U + 0.5f, 16.0f), 240.0f);
+  uv[1] = (uint8_t)fminf(fmaxf(128.0f + 224.0f * V + 0.5f, 16.0f), 240.0f);
+}
+
 CUDAConverter::CUDAConverter()
-    : m_Initialized(false), m_RGBDevice(nullptr), m_Width(0), m_Height(0) {}
+    : m_Initialized(false), m_RGBDevice(nullptr), m_GLResource(nullptr),
+      m_Width(0), m_Height(0) {}
 
 CUDAConverter::~CUDAConverter() { Cleanup(); }
 
 bool CUDAConverter::Initialize(int width, int height) {
-  // Reset any previous CUDA state
-  cudaDeviceReset();
+  // No cudaDeviceReset(): the primary context is shared with FFmpeg's
+  // CUDA device (NVENC frames) and with parallel segment exports
 
   // Initialize CUDA device
   int deviceCount = 0;
@@ -103,7 +153,8 @@ bool CUDAConverter::Initialize(int width, int height) {
 }
 
 void CUDAConverter::Cleanup() {
-  // No persistent buffers to clean up
+  // The GL resource is released by UnregisterGLTexture() on the render
+  // thread, which owns the GL context
   m_Initialized = false;
 }
 
@@ -221,3 +272,84 @@ bool CUDAConverter::ConvertRGB24ToNV12(const uint8_t *rgb_host,
 
   return true;
 }
+
+// ============================================================================
+// GL interop
+// ============================================================================
+
+bool CUDAConverter::RegisterGLTexture(unsigned int texture) {
+  UnregisterGLTexture();
+  if (!m_Initialized)
+    return false;
+
+  cudaError_t err = cudaGraphicsGLRegisterImage(
+      &m_GLResource, texture, GL_TEXTURE_2D, cudaGraphicsRegisterFlagsReadOnly);
+  if (err != cudaSuccess) {
+    std::cerr << "[CUDAConverter] GL texture registration failed: "
+              << cudaGetErrorString(err) << std::endl;
+    m_GLResource = nullptr;
+    return false;
+  }
+  std::cout << "[CUDAConverter] GL render target registered for interop"
+            << std::endl;
+  return true;
+}
+
+void CUDAConverter::UnregisterGLTexture() {
+  if (m_GLResource) {
+    cudaGraphicsUnregisterResource(m_GLResource);
+    m_GLResource = nullptr;
+  }
+}
+
+bool CUDAConverter::ConvertGLTextureToNV12(uint8_t *y_device, int y_pitch,
+                                           uint8_t *uv_device, int uv_pitch,
+                                           int width, int height) {
+  if (!m_GLResource)
+    return false;
+
+  // Mapping waits for the GL commands that render into the texture
+  cudaError_t err = cudaGraphicsMapResources(1, &m_GLResource, 0);
+  if (err != cudaSuccess) {
+    std::cerr << "[CUDAConverter] Map failed: " << cudaGetErrorString(err)
+              << std::endl;
+    return false;
+  }
+
+  cudaArray_t array = nullptr;
+  cudaTextureObject_t texture = 0;
+  err = cudaGraphicsSubResourceGetMappedArray(&array, m_GLResource, 0, 0);
+  if (err == cudaSuccess) {
+    cudaResourceDesc resource = {};
+    resource.resType = cudaResourceTypeArray;
+    resource.res.array.array = array;
+    cudaTextureDesc desc = {};
+    desc.addressMode[0] = cudaAddressModeClamp;
+    desc.addressMode[1] = cudaAddressModeClamp;
+    desc.filterMode = cudaFilterModePoint;
+    desc.readMode = cudaReadModeElementType;
+    err = cudaCreateTextureObject(&texture, &resource, &desc, nullptr);
+  }
+
+  if (err == cudaSuccess) {
+    dim3 blockSize(16, 16);
+    dim3 gridSize((width / 2 + blockSize.x - 1) / blockSize.x,
+                  (height / 2 + blockSize.y - 1) / blockSize.y);
+    RGBAToNV12Kernel<<<gridSize, blockSize>>>(
+        texture, y_device, y_pitch, uv_device, uv_pitch, width, height);
+    err = cudaGetLastError();
+    if (err == cudaSuccess)
+      err = cudaStreamSynchronize(0); // Frame is handed to NVENC next
+  }
+
+  if (texture)
+    cudaDestroyTextureObject(texture);
+  cudaGraphicsUnmapResources(1, &m_GLResource, 0);
+
+  if (err != cudaSuccess) {
+    std::cerr << "[CUDAConverter] GL texture conversion failed: "
+              << cudaGetErrorString(err) << std::endl;
+    return false;
+  }
+  return true;
+}
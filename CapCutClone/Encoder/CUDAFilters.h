@@ -19,9 +19,23 @@ public:
 
   bool IsAvailable() const { return m_Initialized; }
 
+  // GL interop: convert straight from the export render target into
+  // device memory (e.g. an encoder's CUDA frame), no host round trip.
+  // Register/Convert/Unregister need the render target's GL context
+  // current. texture: GL_RGBA8 2D texture
+  bool RegisterGLTexture(unsigned int texture);
+  void UnregisterGLTexture();
+  bool HasGLTexture() const { return m_GLResource != nullptr; }
+
+  // y_device/uv_device: device pointers with their pitches (bytes)
+  bool ConvertGLTextureToNV12(uint8_t *y_device, int y_pitch,
+                              uint8_t *uv_device, int uv_pitch, int width,
+                              int height);
+
 private:
   bool m_Initialized;
   uint8_t *m_RGBDevice; // Device memory for RGB input
+  struct cudaGraphicsResource *m_GLResource; // Registered render target
   int m_Width;
   int m_Height;
 };
@@ -0,0 +1,196 @@
+#include "EncoderProfiles.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// Config::preset 1..7 (fastest..slowest), index 0 unused
+const char *const kX26xPresets[8] = {"",         "ultrafast", "superfast",
+                                     "veryfast", "faster",    "fast",
+                                     "medium",   "slow"};
+const int kSVTAV1Presets[8] = {0, 12, 11, 10, 8, 7, 6, 4};
+
+// Encoder defaults for those presets; trimmed to the GOP below
+const int kX264Lookahead[8] = {0, 0, 0, 10, 20, 30, 40, 50};
+const int kX265Lookahead[8] = {0, 5, 10, 15, 15, 15, 20, 25};
+const int kSVTAV1Lookahead[8] = {0, 0, 16, 32, 48, 64, 96, 120};
+
+int PresetIndex(const HardwareExportManager::Config &config) {
+  return std::clamp(config.preset, 1, 7);
+}
+
+int Lookahead(const int table[8], const HardwareExportManager::Config &config) {
+  // Looking past the next keyframe costs memory and latency for nothing
+  return std::min(table[PresetIndex(config)],
+                  HardwareExportManager::GetGopSize(config));
+}
+
+} // namespace
+
+// ============================================================================
+// Profile selection
+// ============================================================================
+
+EncoderProfiles::Family EncoderProfiles::GetFamily(const AVCodec *codec) {
+  if (!codec || !codec->name)
+    return Family::Other;
+
+  std::string name = codec->name;
+  for (const char *hw : {"nvenc", "qsv", "amf", "vaapi", "videotoolbox",
+                         "vulkan", "mf"}) {
+    if (name.find(std::string("_") + hw) != std::string::npos)
+      return Family::Hardware;
+  }
+  if (name == "libx264")
+    return Family::X264;
+  if (name == "libx265")
+    return Family::X265;
+  if (name == "libsvtav1")
+    return Family::SVTAV1;
+  return Family::Other;
+}
+
+EncoderProfiles::Profile
+EncoderProfiles::Build(const AVCodec *codec,
+                       const HardwareExportManager::Config &config,
+                       int cores) {
+  if (cores <= 0)
+    cores = config.threads > 0
+                ? config.threads
+                : static_cast<int>(std::thread::hardware_concurrency());
+  cores = std::max(1, cores);
+
+  Profile profile;
+  profile.family = GetFamily(codec);
+  profile.cores = cores;
+  int preset = PresetIndex(config);
+
+  switch (profile.family) {
+  case Family::X264: {
+    // x264's own rule is 1.5 threads per core; frame threads beyond half
+    // the macroblock rows only add latency
+    int maxThreads = std::max(1, (config.height + 15) / 16 / 2);
+    profile.preset = kX26xPresets[preset];
+    profile.frameThreads = std::min(cores + cores / 2, maxThreads);
+    profile.lookaheadSlices = std::clamp(profile.frameThreads / 6, 1, 16);
+    profile.lookahead = Lookahead(kX264Lookahead, config);
+    break;
+  }
+  case Family::X265:
+    // Frame threads as x265 picks them for this many cores; the worker
+    // pool is bounded to our share so parallel segments don't oversubscribe
+    profile.preset = kX26xPresets[preset];
+    profile.frameThreads = cores >= 32   ? 6
+                           : cores >= 16 ? 5
+                           : cores >= 8  ? 3
+                           : cores >= 4  ? 2
+                                         : 1;
+    profile.lookaheadSlices =
+        config.height >= 720 ? std::min(8, std::max(1, cores / 2)) : 0;
+    profile.lookahead = Lookahead(kX265Lookahead, config);
+    break;
+  case Family::SVTAV1:
+    // SVT-AV1 sizes its own pools from a "level of parallelism" (1..6)
+    profile.preset = std::to_string(kSVTAV1Presets[preset]);
+    profile.frameThreads = cores <= 2    ? 1
+                           : cores <= 4  ? 2
+                           : cores <= 8  ? 3
+                           : cores <= 16 ? 4
+                           : cores <= 32 ? 5
+                                         : 6;
+    profile.lookahead = Lookahead(kSVTAV1Lookahead, config);
+    break;
+  default:
+    break;
+  }
+  return profile;
+}
+
+// ============================================================================
+// Applying
+// ============================================================================
+
+void EncoderProfiles::Apply(const Profile &profile,
+                            const HardwareExportManager::Config &config,
+                            AVCodecContext *codecCtx, AVDictionary **opts) {
+  bool cqp = config.rateControl == HardwareExportManager::RateControl::CQP;
+  std::string params;
+  auto addParam = [&params](const std::string &key, int value) {
+    params += (params.empty() ? "" : ":") + key + "=" + std::to_string(value);
+  };
+
+  switch (profile.family) {
+  case Family::X264:
+    codecCtx->thread_count = profile.frameThreads;
+    codecCtx->thread_type = FF_THREAD_FRAME;
+    av_dict_set(opts, "preset", profile.preset.c_str(), 0);
+    av_dict_set_int(opts, "rc-lookahead", profile.lookahead, 0);
+    if (cqp)
+      av_dict_set_int(opts, "crf", config.quality, 0);
+
+    addParam("lookahead-threads", profile.lookaheadSlices);
+    if (config.rateControl == HardwareExportManager::RateControl::CBR)
+      params += ":nal-hrd=cbr";
+    av_dict_set(opts, "x264-params", params.c_str(), 0);
+    break;
+
+  case Family::X265:
+    av_dict_set(opts, "preset", profile.preset.c_str(), 0);
+    if (cqp)
+      av_dict_set_int(opts, "crf", config.quality, 0);
+
+    addParam("pools", profile.cores);
+    addParam("frame-threads", profile.frameThreads);
+    addParam("rc-lookahead", profile.lookahead);
+    if (profile.lookaheadSlices > 0)
+      addParam("lookahead-slices", profile.lookaheadSlices);
+    av_dict_set(opts, "x265-params", params.c_str(), 0);
+    break;
+
+  case Family::SVTAV1:
+    av_dict_set(opts, "preset", profile.preset.c_str(), 0);
+    if (cqp) // CRF is 0..63 here, scale from the x264-style 0..51
+      av_dict_set_int(opts, "crf", std::min(63, config.quality * 63 / 51),
+                      0);
+
+    addParam("lp", profile.frameThreads);
+    addParam("lookahead", profile.lookahead);
+    av_dict_set(opts, "svtav1-params", params.c_str(), 0);
+    break;
+
+  default:
+    return;
+  }
+
+  std::cout << "[EncoderProfiles] " << profile.Describe() << std::endl;
+}
+
+std::string EncoderProfiles::Profile::Describe() const {
+  std::string text = GetFamilyName(family);
+  if (!preset.empty())
+    text += " preset " + preset;
+  if (frameThreads > 0)
+    text += ", " + std::to_string(frameThreads) +
+            (family == Family::SVTAV1 ? " lp" : " frame threads");
+  if (lookaheadSlices > 0)
+    text += ", " + std::to_string(lookaheadSlices) + " lookahead slices";
+  text += ", lookahead " + std::to_string(lookahead) + ", " +
+          std::to_string(cores) + " cores";
+  return text;
+}
+
+const char *EncoderProfiles::GetFamilyName(Family family) {
+  switch (family) {
+  case Family::Hardware:
+    return "Hardware";
+  case Family::X264:
+    return "x264";
+  case Family::X265:
+    return "x265";
+  case Family::SVTAV1:
+    return "SVT-AV1";
+  default:
+    return "FFmpeg";
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "HardwareExportManager.h"
+#include <string>
+
+/**
+ * @brief Tuned settings for the CPU encoders (libx264, libx265, SVT-AV1)
+ *
+ * Without NVENC the export falls back to a software encoder, whose
+ * defaults are made for a single encode owning the whole machine. This
+ * layer derives the encoder setup from the export config and the cores it
+ * may use (Config::threads, set per segment by SegmentedExportManager):
+ * - preset: Config::preset 1 (fastest) .. 7 (slowest), same scale as NVENC
+ * - threads: frame threads for the encoder proper, slices for lookahead
+ * - lookahead depth: grows with the preset
+ * - rate control: CQP maps to CRF
+ *
+ * Hardware encoders are left alone (Family::Hardware).
+ */
+class EncoderProfiles {
+public:
+  enum class Family {
+    Hardware, ///< NVENC/QSV/AMF, configured by HardwareExportManager
+    X264,
+    X265,
+    SVTAV1,
+    Other ///< Built-in FFmpeg encoders, default settings
+  };
+
+  struct Profile {
+    Family family = Family::Other;
+    std::string preset;      ///< Encoder preset name/number, empty = default
+    int frameThreads = 0;    ///< 0 = encoder default
+    int lookaheadSlices = 0; ///< Threads/slices used by the lookahead
+    int lookahead = 0;       ///< Frames, 0 = encoder default
+    int cores = 0;           ///< Cores the profile was sized for
+
+    /**
+     * @brief Short summary for logs and benchmarks, e.g. "x264 faster, 12t"
+     */
+    std::string Describe() const;
+  };
+
+  static Family GetFamily(const AVCodec *codec);
+  static bool IsSoftware(const AVCodec *codec) {
+    Family family = GetFamily(codec);
+    return family != Family::Hardware && family != Family::Other;
+  }
+
+  /**
+   * @brief Derive the settings for one export
+   * @param cores Cores available to this encoder, 0 = all
+   */
+  static Profile Build(const AVCodec *codec,
+                       const HardwareExportManager::Config &config,
+                       int cores = 0);
+
+  /**
+   * @brief Apply a profile before avcodec_open2()
+   *
+   * Sets threading fields on codecCtx and encoder private options in opts.
+   */
+  static void Apply(const Profile &profile,
+                    const HardwareExportManager::Config &config,
+                    AVCodecContext *codecCtx, AVDictionary **opts);
+
+  static const char *GetFamilyName(Family family);
+};
@@ -0,0 +1,338 @@
+#include "ExportAudioMixer.h"
+#include "../Audio/AudioEngine.h"
+#include "../Audio/LoudnessAnalyzer.h"
+#include "../Audio/LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr int kChannels = AudioEngine::kChannels;
+constexpr int kSampleRate = AudioEngine::kSampleRate;
+constexpr int kReadFrames = 1024; // Decoder reads feeding the stretcher
+
+} // namespace
+
+ExportAudioMixer::ExportAudioMixer(TimelineSnapshotPtr timeline, double fps,
+                                   int firstFrame, int endFrame,
+                                   const Settings &settings)
+    : m_Timeline(std::move(timeline)), m_Settings(settings),
+      m_StartTime(firstFrame * (1.0 / fps)), m_Position(0), m_EndPosition(0),
+      m_FormatContext(nullptr), m_CodecContext(nullptr), m_Stream(nullptr),
+      m_Frame(nullptr), m_Packet(nullptr), m_EncodedFrames(0) {
+  double endTime = std::max(firstFrame, endFrame) * (1.0 / fps);
+  m_EndPosition = std::llround((endTime - m_StartTime) * kSampleRate);
+
+  for (const Track &track : m_Timeline->tracks) {
+    auto lane = std::make_unique<Lane>();
+    lane->track = &track;
+    lane->chain.SetSettings(track.audioEffects);
+    for (const Clip &clip : track.clips) {
+      if (clip.GetEndTime() > m_StartTime)
+        lane->clips.push_back(&clip);
+    }
+    std::sort(lane->clips.begin(), lane->clips.end(),
+              [](const Clip *a, const Clip *b) {
+                return a->startTime < b->startTime;
+              });
+    m_Lanes.push_back(std::move(lane));
+  }
+}
+
+ExportAudioMixer::~ExportAudioMixer() {
+  if (m_Frame)
+    av_frame_free(&m_Frame);
+  if (m_Packet)
+    av_packet_free(&m_Packet);
+  if (m_CodecContext)
+    avcodec_free_context(&m_CodecContext);
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+
+bool ExportAudioMixer::Open(AVFormatContext *format) {
+  const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+  if (!codec) {
+    std::cerr << "[ExportAudioMixer] No AAC encoder available" << std::endl;
+    return false;
+  }
+
+  m_CodecContext = avcodec_alloc_context3(codec);
+  if (!m_CodecContext)
+    return false;
+
+  AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+  m_CodecContext->sample_fmt = AV_SAMPLE_FMT_FLTP;
+  m_CodecContext->sample_rate = kSampleRate;
+  av_channel_layout_copy(&m_CodecContext->ch_layout, &stereo);
+  m_CodecContext->bit_rate = m_Settings.bitrate;
+  m_CodecContext->time_base = AVRational{1, kSampleRate};
+  if (format->oformat->flags & AVFMT_GLOBALHEADER)
+    m_CodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+  int ret = avcodec_open2(m_CodecContext, codec, nullptr);
+  if (ret < 0) {
+    char errbuf[256];
+    av_strerror(ret, errbuf, sizeof(errbuf));
+    std::cerr << "[ExportAudioMixer] Could not open AAC encoder: " << errbuf
+              << std::endl;
+    avcodec_free_context(&m_CodecContext);
+    return false;
+  }
+
+  // Only once the encoder is open: a stream without parameters would fail
+  // the header and with it the video
+  m_Stream = avformat_new_stream(format, nullptr);
+  m_Frame = av_frame_alloc();
+  m_Packet = av_packet_alloc();
+  if (!m_Stream || !m_Frame || !m_Packet)
+    return false;
+  m_Stream->id = format->nb_streams - 1;
+  m_Stream->time_base = m_CodecContext->time_base;
+  avcodec_parameters_from_context(m_Stream->codecpar, m_CodecContext);
+
+  int frameSize =
+      m_CodecContext->frame_size > 0 ? m_CodecContext->frame_size : 1024;
+  m_Frame->format = m_CodecContext->sample_fmt;
+  m_Frame->sample_rate = kSampleRate;
+  av_channel_layout_copy(&m_Frame->ch_layout, &stereo);
+  m_Frame->nb_samples = frameSize;
+  if (av_frame_get_buffer(m_Frame, 0) < 0)
+    return false;
+  m_Mix.resize(static_cast<size_t>(frameSize) * kChannels);
+
+  m_FormatContext = format;
+  std::cout << "[ExportAudioMixer] AAC " << m_Settings.bitrate / 1000
+            << " kbps, ";
+  if (m_Settings.normalize)
+    std::cout << "normalized to " << m_Settings.targetLoudness << " LUFS ("
+              << m_Settings.truePeakCeiling << " dBTP ceiling)" << std::endl;
+  else
+    std::cout << "not normalized" << std::endl;
+  return true;
+}
+
+bool ExportAudioMixer::EncodeUntil(double seconds) {
+  if (!m_FormatContext)
+    return false;
+
+  const int frameSize = static_cast<int>(m_Mix.size()) / kChannels;
+  int64_t target = std::min<int64_t>(m_EndPosition,
+                                     std::llround(seconds * kSampleRate));
+  while (m_Position + frameSize <= target) {
+    Render(m_Mix.data(), frameSize);
+    if (!EncodeFrame(frameSize))
+      return false;
+  }
+  return true;
+}
+
+bool ExportAudioMixer::Finish() {
+  if (!m_FormatContext)
+    return false;
+
+  const int frameSize = static_cast<int>(m_Mix.size()) / kChannels;
+  while (m_Position < m_EndPosition) {
+    int frames = static_cast<int>(
+        std::min<int64_t>(frameSize, m_EndPosition - m_Position));
+    Render(m_Mix.data(), frames);
+    if (!EncodeFrame(frames))
+      return false;
+  }
+  LogEffectStats();
+  return EncodeFrame(0);
+}
+
+bool ExportAudioMixer::EncodeFrame(int frames) {
+  AVFrame *frame = nullptr;
+  if (frames > 0) {
+    // The encoder may still reference the previous buffer
+    if (av_frame_make_writable(m_Frame) < 0)
+      return false;
+    m_Frame->nb_samples = frames;
+    float *left = reinterpret_cast<float *>(m_Frame->data[0]);
+    float *right = reinterpret_cast<float *>(m_Frame->data[1]);
+    for (int i = 0; i < frames; ++i) {
+      left[i] = m_Mix[i * kChannels];
+      right[i] = m_Mix[i * kChannels + 1];
+    }
+    m_Frame->pts = m_EncodedFrames;
+    m_EncodedFrames += frames;
+    frame = m_Frame;
+  }
+
+  int ret = avcodec_send_frame(m_CodecContext, frame);
+  if (ret < 0) {
+    std::cerr << "[ExportAudioMixer] Error sending audio frame" << std::endl;
+    return false;
+  }
+  return WritePackets();
+}
+
+bool ExportAudioMixer::WritePackets() {
+  while (true) {
+    int ret = avcodec_receive_packet(m_CodecContext, m_Packet);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+      return true;
+    if (ret < 0) {
+      std::cerr << "[ExportAudioMixer] Error receiving audio packet"
+                << std::endl;
+      return false;
+    }
+
+    av_packet_rescale_ts(m_Packet, m_CodecContext->time_base,
+                         m_Stream->time_base);
+    m_Packet->stream_index = m_Stream->index;
+    if (av_interleaved_write_frame(m_FormatContext, m_Packet) < 0) {
+      std::cerr << "[ExportAudioMixer] Error writing audio packet"
+                << std::endl;
+      return false;
+    }
+  }
+}
+
+// ============================================================================
+// Mix
+// ============================================================================
+
+bool ExportAudioMixer::GetClipGain(const std::string &filepath,
+                                   const Settings &settings, float &gain) {
+  gain = 1.0f;
+  if (!settings.normalize)
+    return true;
+
+  LoudnessAnalyzer::Result result;
+  if (!LoudnessAnalyzer::Lookup(filepath, result))
+    return false;
+  gain = LoudnessMeter::GetNormalizationGain(result.loudness, result.truePeak,
+                                             settings.targetLoudness,
+                                             settings.truePeakCeiling);
+  return true;
+}
+
+int64_t ExportAudioMixer::GetPosition(double time) const {
+  return std::llround((time - m_StartTime) * kSampleRate);
+}
+
+void ExportAudioMixer::Render(float *interleaved, int frames) {
+  size_t size = static_cast<size_t>(frames) * kChannels;
+  std::fill(interleaved, interleaved + size, 0.0f);
+  if (m_Lane.size() < size)
+    m_Lane.resize(size);
+
+  // Each track through its chain, as its playback bus, then summed
+  for (auto &lane : m_Lanes) {
+    std::fill(m_Lane.begin(), m_Lane.begin() + size, 0.0f);
+    RenderLane(*lane, m_Lane.data(), frames);
+    if (lane->clip || lane->next > 0)
+      lane->chain.Process(m_Lane.data(), frames);
+    AudioEngine::MixStereo(interleaved, m_Lane.data(), frames, 1.0f, 1.0f,
+                           0.0f, 0.0f);
+  }
+  m_Position += frames;
+}
+
+void ExportAudioMixer::RenderLane(Lane &lane, float *interleaved,
+                                  int frames) {
+  int done = 0;
+  while (done < frames) {
+    int64_t position = m_Position + done;
+    if (lane.clip && position >= lane.clipEnd)
+      lane.clip = nullptr;
+    while (!lane.clip && lane.next < lane.clips.size() &&
+           GetPosition(lane.clips[lane.next]->startTime) <= position) {
+      const Clip &clip = *lane.clips[lane.next++];
+      if (GetPosition(clip.GetEndTime()) > position)
+        StartClip(lane, clip, position);
+    }
+
+    // Up to the clip's end, or through the gap up to the next clip
+    int64_t until = m_EndPosition;
+    if (lane.clip)
+      until = lane.clipEnd;
+    else if (lane.next < lane.clips.size())
+      until = GetPosition(lane.clips[lane.next]->startTime);
+    int count = static_cast<int>(
+        std::clamp<int64_t>(until - position, 1, frames - done));
+
+    if (lane.clip) {
+      size_t size = static_cast<size_t>(count) * kChannels;
+      if (m_Source.size() < size)
+        m_Source.resize(size);
+      int read = ReadSource(lane, m_Source.data(), count);
+      double clipTime = m_StartTime +
+                        static_cast<double>(position) / kSampleRate -
+                        lane.clip->startTime;
+      AudioEffectChain::ApplyFades(m_Source.data(), read, clipTime,
+                                   1.0 / kSampleRate,
+                                   lane.clip->GetDisplayDuration(),
+                                   lane.track->audioEffects.fades);
+      AudioEngine::MixStereo(interleaved + done * kChannels, m_Source.data(),
+                             read, lane.gain, lane.gain, 0.0f, 0.0f);
+    }
+    done += count;
+  }
+}
+
+void ExportAudioMixer::StartClip(Lane &lane, const Clip &clip,
+                                 int64_t position) {
+  // A file without audio stays silent
+  const std::string &filepath = clip.filepath;
+  if ((!lane.decoder.IsOpen() || lane.decoder.GetPath() != filepath) &&
+      !lane.decoder.Open(filepath))
+    return;
+
+  lane.clip = &clip;
+  lane.clipEnd = GetPosition(clip.GetEndTime());
+  double time = m_StartTime + static_cast<double>(position) / kSampleRate;
+  lane.decoder.Seek(clip.ToLocalTime(time));
+  lane.stretch.Reset();
+  lane.stretch.SetTempo(static_cast<float>(clip.speed));
+  lane.sourceEnded = false;
+
+  if (!GetClipGain(filepath, m_Settings, lane.gain) &&
+      m_Unanalyzed.insert(filepath).second) {
+    std::cerr << "[ExportAudioMixer] Loudness of " << filepath
+              << " not analyzed yet, exporting it at unity gain"
+              << std::endl;
+  }
+}
+
+void ExportAudioMixer::LogEffectStats() const {
+  for (size_t track = 0; track < m_Lanes.size(); ++track) {
+    const AudioEffectChain &chain = m_Lanes[track]->chain;
+    if (!chain.IsActive())
+      continue;
+    AudioEffectChain::Stats stats = chain.GetStats();
+    std::cout << "[ExportAudioMixer] Track " << track + 1 << " effects CPU:";
+    for (int s = 0; s < AudioEffectChain::kStageCount; ++s) {
+      if (stats.averageLoad[s] > 0.0f)
+        std::cout << " "
+                  << AudioEffectChain::GetStageName(
+                         static_cast<AudioEffectChain::Stage>(s))
+                  << " " << stats.averageLoad[s] * 100.0f << "%";
+    }
+    std::cout << " of real time" << std::endl;
+  }
+}
+
+int ExportAudioMixer::ReadSource(Lane &lane, float *interleaved,
+                                 int frames) {
+  if (lane.clip->speed == 1.0)
+    return lane.decoder.Read(interleaved, frames);
+
+  int written = lane.stretch.Pull(interleaved, frames);
+  while (written < frames && !lane.sourceEnded) {
+    float chunk[kReadFrames * kChannels];
+    int read = lane.decoder.Read(chunk, kReadFrames);
+    if (read < kReadFrames)
+      lane.sourceEnded = true;
+    lane.stretch.Push(chunk, read);
+    written += lane.stretch.Pull(interleaved + written * kChannels,
+                                 frames - written);
+  }
+  return written;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../Audio/AudioDecoder.h"
+#include "../Audio/AudioEffectChain.h"
+#include "../Audio/TimeStretch.h"
+#include "../Timeline/TimelineSnapshot.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief The audio stream of an export, loudness-normalized in one pass
+ *
+ * Mixes every track, as playback does: each clip's audio is decoded from
+ * its source time, time-stretched to the clip speed and scaled by its
+ * normalization gain; gaps are silent. Each track has its own decoder,
+ * so clips overlapping on different tracks are summed. The gain comes from
+ * LoudnessAnalyzer's cached measurement of the source file (target
+ * loudness minus the file's loudness, capped by the true-peak ceiling),
+ * so the mix lands on the target without a second decode of the output.
+ * A file not analyzed yet exports at unity gain.
+ *
+ * The clip's track fades and effect chain follow, the same
+ * AudioEffectChain code the playback bus runs: fades on the clip's audio,
+ * then normalization gain, then the track's chain. Each track's chain
+ * keeps its state across its clips. Per-effect CPU time is logged when
+ * the export finishes.
+ *
+ * Encodes AAC into its own stream of the caller's muxer. The caller
+ * drives it from the thread that writes video packets: EncodeUntil()
+ * after each video frame keeps the two streams interleaved.
+ */
+class ExportAudioMixer {
+public:
+  struct Settings {
+    bool normalize = true;
+    float targetLoudness = -14.0f; ///< LUFS
+    float truePeakCeiling = -1.0f; ///< dBTP
+    int64_t bitrate = 192000;
+  };
+
+  /**
+   * @param timeline Kept alive by the mixer; the lanes point into it
+   */
+  ExportAudioMixer(TimelineSnapshotPtr timeline, double fps, int firstFrame,
+                   int endFrame, const Settings &settings);
+  ~ExportAudioMixer();
+
+  ExportAudioMixer(const ExportAudioMixer &) = delete;
+  ExportAudioMixer &operator=(const ExportAudioMixer &) = delete;
+
+  /**
+   * @brief Add the audio stream to @p format; before avformat_write_header
+   */
+  bool Open(AVFormatContext *format);
+
+  /**
+   * @brief Encode and mux the mix up to @p seconds after the first frame
+   */
+  bool EncodeUntil(double seconds);
+
+  /**
+   * @brief Encode the rest of the frame range and flush the encoder
+   */
+  bool Finish();
+
+  /**
+   * @brief Linear gain for @p filepath under these settings
+   * @return False if the file has not been analyzed (@p gain is 1 then)
+   */
+  static bool GetClipGain(const std::string &filepath,
+                          const Settings &settings, float &gain);
+
+private:
+  // One track's clips, in start order, through its own decoder
+  struct Lane {
+    const Track *track = nullptr;
+    std::vector<const Clip *> clips; // Ending after the first frame
+    size_t next = 0;                 // Next clip to start
+    const Clip *clip = nullptr;      // Playing, null = gap
+    int64_t clipEnd = 0;             // Position where it ends
+    float gain = 1.0f;
+    AudioEffectChain chain;
+    AudioDecoder decoder;
+    TimeStretch stretch;
+    bool sourceEnded = false;
+  };
+
+  void Render(float *interleaved, int frames); // Next frames of the mix
+  void RenderLane(Lane &lane, float *interleaved, int frames);
+  void StartClip(Lane &lane, const Clip &clip, int64_t position);
+  int64_t GetPosition(double time) const; // Timeline time to mix frames
+  void LogEffectStats() const;
+  int ReadSource(Lane &lane, float *interleaved, int frames); // Stretched
+  bool EncodeFrame(int frames); // From m_Mix; 0 flushes the encoder
+  bool WritePackets();
+
+  TimelineSnapshotPtr m_Timeline;
+  Settings m_Settings;
+
+  double m_StartTime;      // Timeline time of the first frame
+  int64_t m_Position;      // Frames mixed since the first frame
+  int64_t m_EndPosition;   // End of the frame range, in audio frames
+  std::vector<std::unique_ptr<Lane>> m_Lanes; // Per track
+  std::unordered_set<std::string> m_Unanalyzed; // Warned about once
+
+  std::vector<float> m_Source; // Decoded, before gain
+  std::vector<float> m_Lane;   // One lane's mix, before its chain
+  std::vector<float> m_Mix;    // One encoder frame, interleaved
+
+  AVFormatContext *m_FormatContext; // Not owned
+  AVCodecContext *m_CodecContext;
+  AVStream *m_Stream;
+  AVFrame *m_Frame;
+  AVPacket *m_Packet;
+  int64_t m_EncodedFrames; // Next frame's pts
+};
@@ -0,0 +1,266 @@
+#include "ExportQueue.h"
+#include "SharedFrameCache.h"
+#include "../Timeline/TimelineManager.h"
+#include <algorithm>
+#include <iostream>
+
+// ============================================================================
+// Constructor / Destructor
+// ============================================================================
+
+ExportQueue::ExportQueue(GLFWwindow *mainWindow)
+    : m_MainWindow(mainWindow),
+      m_FrameCache(std::make_shared<SharedFrameCache>()) {
+  m_FrameCache->SetMaxBytes(m_Budget.frameCacheBytes);
+}
+
+ExportQueue::~ExportQueue() {
+  CancelAll();
+
+  // Managers join their threads on destruction
+  m_Jobs.clear();
+}
+
+void ExportQueue::SetBudget(const ResourceBudget &budget) {
+  m_Budget = budget;
+  m_FrameCache->SetMaxBytes(m_Budget.frameCacheBytes);
+}
+
+// ============================================================================
+// Job Management
+// ============================================================================
+
+int ExportQueue::AddJob(const std::string &name, TimelineManager *timeline,
+                        const HardwareExportManager::Config &config,
+                        const HardwareExportManager::EffectParams &effects) {
+  auto job = std::make_unique<Job>();
+  job->status.id = m_NextJobId++;
+  job->status.name = name;
+  job->timeline = timeline->GetSnapshot();
+  job->config = config;
+  job->effects = effects;
+
+  int id = job->status.id;
+  m_Jobs.push_back(std::move(job));
+
+  std::cout << "[ExportQueue] Queued job " << id << ": " << name << std::endl;
+  return id;
+}
+
+bool ExportQueue::CancelJob(int id) {
+  for (auto &job : m_Jobs) {
+    if (job->status.id != id)
+      continue;
+
+    if (job->status.state == JobState::Pending) {
+      job->status.state = JobState::Cancelled;
+      return true;
+    }
+    if (job->status.state == JobState::Running && job->manager) {
+      job->manager->CancelExport(); // Retired by Update() once threads stop
+      return true;
+    }
+    return false;
+  }
+  return false;
+}
+
+void ExportQueue::CancelAll() {
+  for (auto &job : m_Jobs) {
+    if (job->status.state == JobState::Pending)
+      job->status.state = JobState::Cancelled;
+    else if (job->status.state == JobState::Running && job->manager)
+      job->manager->CancelExport();
+  }
+}
+
+void ExportQueue::ClearFinished() {
+  m_Jobs.erase(std::remove_if(m_Jobs.begin(), m_Jobs.end(),
+                              [](const std::unique_ptr<Job> &job) {
+                                return job->status.state != JobState::Pending &&
+                                       job->status.state != JobState::Running;
+                              }),
+               m_Jobs.end());
+}
+
+// ============================================================================
+// Scheduling (main thread)
+// ============================================================================
+
+void ExportQueue::Update() {
+  bool wasBusy = m_RunningJobs > 0;
+
+  // Retire jobs whose pipeline has stopped
+  for (auto &job : m_Jobs) {
+    if (job->status.state == JobState::Running && job->manager &&
+        job->manager->IsFinished() && !job->manager->IsExporting()) {
+      RetireJob(*job);
+    }
+  }
+
+  // Start pending jobs in FIFO order while the budget allows
+  for (auto &job : m_Jobs) {
+    if (job->status.state != JobState::Pending)
+      continue;
+
+    int jobs = m_RunningJobs + 1; // With this one
+    if (jobs > m_Budget.maxConcurrentJobs ||
+        jobs * kDecoderSessionsPerJob > m_Budget.maxDecoderSessions ||
+        jobs > m_Budget.maxGpuContexts)
+      break;
+
+    bool wantsHardware = job->config.enableHardwareAccel;
+    bool hardwareFree = m_HardwareEncoders < m_Budget.maxHardwareEncoders;
+    if (wantsHardware && !hardwareFree && !m_Budget.allowSoftwareFallback)
+      continue; // Wait for an encoder slot, let CPU jobs go first
+
+    StartJob(*job, wantsHardware && hardwareFree);
+  }
+
+  // Accumulate wall time spent with work in flight
+  bool isBusy = m_RunningJobs > 0;
+  auto now = std::chrono::steady_clock::now();
+  if (wasBusy)
+    m_BusySeconds += std::chrono::duration<double>(now - m_BusySince).count();
+  if (isBusy || wasBusy)
+    m_BusySince = now;
+
+  // Nothing left to share the decoded frames with
+  if (wasBusy && !isBusy)
+    m_FrameCache->Clear();
+}
+
+bool ExportQueue::StartJob(Job &job, bool hardwareEncoder) {
+  HardwareExportManager::Config config = job.config;
+  config.enableHardwareAccel = hardwareEncoder;
+
+  job.manager = std::make_unique<HardwareExportManager>(nullptr, nullptr);
+  job.manager->SetTimelineSnapshot(job.timeline);
+  job.manager->SetMainWindow(m_MainWindow);
+  job.manager->SetEffectParams(job.effects);
+  job.manager->SetFrameCache(m_FrameCache);
+
+  if (!job.manager->Initialize(config) || !job.manager->StartExport()) {
+    job.status.state = JobState::Failed;
+    job.status.error = job.manager->GetErrorMessage();
+    std::cerr << "[ExportQueue] Job " << job.status.id
+              << " failed to start: " << job.status.error << std::endl;
+    job.manager.reset();
+    return false;
+  }
+
+  job.status.state = JobState::Running;
+  job.status.hardwareEncoder = hardwareEncoder;
+
+  m_RunningJobs++;
+  if (hardwareEncoder)
+    m_HardwareEncoders++;
+
+  std::cout << "[ExportQueue] Started job " << job.status.id << " ("
+            << (hardwareEncoder ? "hardware" : "software") << " encoder, "
+            << m_RunningJobs << " running)" << std::endl;
+  return true;
+}
+
+void ExportQueue::RetireJob(Job &job) {
+  RefreshStatus(job);
+
+  if (job.manager->IsCancelled() && job.manager->GetErrorMessage().empty())
+    job.status.state = JobState::Cancelled;
+  else if (!job.manager->GetErrorMessage().empty())
+    job.status.state = JobState::Failed;
+  else
+    job.status.state = JobState::Finished;
+  job.status.error = job.manager->GetErrorMessage();
+
+  m_RetiredFrames += job.status.encodedFrames;
+  m_RunningJobs--;
+  if (job.status.hardwareEncoder)
+    m_HardwareEncoders--;
+
+  std::cout << "[ExportQueue] Job " << job.status.id << " "
+            << GetStateName(job.status.state) << ": "
+            << job.status.encodedFrames << " frames in "
+            << job.status.elapsedSeconds << "s (" << job.status.fps << " FPS)"
+            << std::endl;
+
+  job.manager.reset(); // Joins the pipeline threads
+}
+
+void ExportQueue::RefreshStatus(Job &job) const {
+  if (!job.manager)
+    return;
+  job.status.progress = job.manager->GetProgress();
+  job.status.encodedFrames = job.manager->GetEncodedFrames();
+  job.status.elapsedSeconds = job.manager->GetElapsedSeconds();
+  job.status.fps = job.manager->GetEncodeFPS();
+}
+
+// ============================================================================
+// Status Queries
+// ============================================================================
+
+std::vector<ExportQueue::JobStatus> ExportQueue::GetJobStatuses() const {
+  std::vector<JobStatus> statuses;
+  statuses.reserve(m_Jobs.size());
+  for (const auto &job : m_Jobs) {
+    RefreshStatus(*job);
+    statuses.push_back(job->status);
+  }
+  return statuses;
+}
+
+ExportQueue::Throughput ExportQueue::GetThroughput() const {
+  Throughput t;
+  t.totalFrames = m_RetiredFrames;
+  for (const auto &job : m_Jobs) {
+    switch (job->status.state) {
+    case JobState::Pending:
+      t.pending++;
+      break;
+    case JobState::Running:
+      t.running++;
+      if (job->manager)
+        t.totalFrames += job->manager->GetEncodedFrames();
+      break;
+    default:
+      t.done++;
+      break;
+    }
+  }
+
+  t.busySeconds = m_BusySeconds;
+  if (m_RunningJobs > 0)
+    t.busySeconds += std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - m_BusySince)
+                         .count();
+  t.aggregateFPS = t.busySeconds > 0.0 ? t.totalFrames / t.busySeconds : 0.0;
+  t.cacheHits = m_FrameCache->GetHits();
+  t.cacheMisses = m_FrameCache->GetMisses();
+  return t;
+}
+
+bool ExportQueue::IsBusy() const {
+  for (const auto &job : m_Jobs) {
+    if (job->status.state == JobState::Pending ||
+        job->status.state == JobState::Running)
+      return true;
+  }
+  return false;
+}
+
+const char *ExportQueue::GetStateName(JobState state) {
+  switch (state) {
+  case JobState::Pending:
+    return "Pending";
+  case JobState::Running:
+    return "Running";
+  case JobState::Finished:
+    return "Finished";
+  case JobState::Failed:
+    return "Failed";
+  case JobState::Cancelled:
+    return "Cancelled";
+  }
+  return "Unknown";
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "HardwareExportManager.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SharedFrameCache;
+class TimelineManager;
+struct GLFWwindow;
+
+/**
+ * @brief Render queue running several exports concurrently
+ *
+ * Each job owns its own HardwareExportManager (render + encoder threads).
+ * The queue starts pending jobs while the global resource budget allows:
+ * - Decoder sessions: two per running job (its source VideoPlayer and the
+ *   DecoderPrefetcher opening the next clip)
+ * - GPU contexts: one hidden shared GL context per running job
+ * - Hardware encoders: one NVENC/QSV/AMF session per hardware job.
+ *   Consumer GPUs cap concurrent sessions, so when all slots are taken a
+ *   job can optionally fall back to the CPU encoder instead of waiting.
+ *
+ * All jobs share one SharedFrameCache, so variants of the same template
+ * decode each source frame once.
+ *
+ * Update() must be called from the main thread every frame: GLFW only
+ * allows creating the export contexts there.
+ */
+class ExportQueue {
+public:
+  struct ResourceBudget {
+    int maxConcurrentJobs = 2;
+    int maxDecoderSessions = 4;
+    int maxGpuContexts = 2;
+    int maxHardwareEncoders = 2;       ///< NVENC session limit
+    bool allowSoftwareFallback = true; ///< CPU encode when HW slots are full
+    size_t frameCacheBytes = 512ull * 1024 * 1024;
+  };
+
+  enum class JobState { Pending, Running, Finished, Failed, Cancelled };
+
+  struct JobStatus {
+    int id = -1;
+    std::string name;
+    JobState state = JobState::Pending;
+    float progress = 0.0f;
+    int64_t encodedFrames = 0;
+    double elapsedSeconds = 0.0;
+    double fps = 0.0;
+    bool hardwareEncoder = false;
+    std::string error;
+  };
+
+  struct Throughput {
+    int pending = 0;
+    int running = 0;
+    int done = 0;
+    int64_t totalFrames = 0;  ///< Encoded by all jobs so far
+    double busySeconds = 0.0; ///< Wall time with at least one job running
+    double aggregateFPS = 0.0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+  };
+
+  explicit ExportQueue(GLFWwindow *mainWindow);
+  ~ExportQueue();
+
+  void SetMainWindow(GLFWwindow *mainWindow) { m_MainWindow = mainWindow; }
+  void SetBudget(const ResourceBudget &budget);
+  const ResourceBudget &GetBudget() const { return m_Budget; }
+
+  /**
+   * @brief Queue an export
+   * @param timeline Snapshotted now; later edits do not affect the job
+   * @return Job id
+   */
+  int AddJob(const std::string &name, TimelineManager *timeline,
+             const HardwareExportManager::Config &config,
+             const HardwareExportManager::EffectParams &effects);
+
+  bool CancelJob(int id);
+  void CancelAll();
+  void ClearFinished();
+
+  /**
+   * @brief Start/retire jobs (main thread only)
+   */
+  void Update();
+
+  std::vector<JobStatus> GetJobStatuses() const;
+  Throughput GetThroughput() const;
+  bool IsBusy() const;
+
+  static const char *GetStateName(JobState state);
+
+private:
+  struct Job {
+    JobStatus status;
+    TimelineSnapshotPtr timeline;
+    HardwareExportManager::Config config;
+    HardwareExportManager::EffectParams effects;
+    std::unique_ptr<HardwareExportManager> manager;
+  };
+
+  bool StartJob(Job &job, bool hardwareEncoder);
+  void RetireJob(Job &job);
+  void RefreshStatus(Job &job) const;
+
+  GLFWwindow *m_MainWindow;
+  ResourceBudget m_Budget;
+  std::vector<std::unique_ptr<Job>> m_Jobs;
+  std::shared_ptr<SharedFrameCache> m_FrameCache;
+  int m_NextJobId = 1;
+
+  // Resources in use. Decoder sessions and GPU contexts follow from the
+  // running job count.
+  static constexpr int kDecoderSessionsPerJob = 2;
+  int m_RunningJobs = 0;
+  int m_HardwareEncoders = 0;
+
+  // Aggregate throughput
+  int64_t m_RetiredFrames = 0;
+  double m_BusySeconds = 0.0;
+  std::chrono::steady_clock::time_point m_BusySince;
+};
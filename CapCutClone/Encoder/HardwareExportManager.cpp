@@ -1,9 +1,18 @@
 #include "HardwareExportManager.h"
+#include "EncoderProfiles.h"
+#include "ExportAudioMixer.h"
+#include "RenderPlan.h"
+#include "../Core/ColorConvert.h"
+#include "../Core/Trace.h"
 #include "../Rendering/TextureRenderer.h"
+#include "../Video/DecoderPrefetcher.h"
+#include "SharedFrameCache.h"
 #include "../Timeline/EffectLayer.h"
 #include "../Timeline/TimelineManager.h"
 #include "../Video/VideoPlayer.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
 #include <glad/glad.h>
 #include <iostream>
 
@@ -19,21 +28,22 @@ HardwareExportManager::HardwareExportManager(TimelineManager *timeline,
                                              VideoPlayer *player)
     : m_TimelineManager(timeline), m_VideoPlayer(player), m_MainWindow(nullptr),
       m_OffscreenWindow(nullptr), m_IsExporting(false), m_IsFinished(false),
-      m_CancelRequested(false), m_Progress(0.0f), m_FormatCtx(nullptr),
+      m_CancelRequested(false), m_EncoderReady(false), m_Progress(0.0f),
+      m_EndTimeNs(0), m_YUVQueue(8), m_FormatCtx(nullptr),
       m_CodecCtx(nullptr), m_Codec(nullptr), m_Stream(nullptr),
       m_SwsCtx(nullptr), m_Packet(nullptr), m_FrameCount(0),
-      m_HwDeviceCtx(nullptr), m_UsingHardwareAccel(false) {}
+      m_HwDeviceCtx(nullptr), m_UsingHardwareAccel(false),
+      m_HwFramesCtx(nullptr), m_HostPixFmt(AV_PIX_FMT_NONE),
+      m_StagingFrame(nullptr) {}
 
 HardwareExportManager::~HardwareExportManager() {
   CancelExport();
 
-  // Wait for all threads to finish
-  if (m_RenderThread.joinable())
-    m_RenderThread.join();
+  // The encoder thread joins the render thread and cleans up after both
   if (m_EncoderThread.joinable())
     m_EncoderThread.join();
 
-  Cleanup();
+  Cleanup(); // Only does something if no export ever ran
 }
 
 // ============================================================================
@@ -49,9 +59,10 @@ bool HardwareExportManager::Initialize(const Config &config) {
     return false;
   }
 
-  // Align dimensions to 16 for hardware encoder
-  m_Config.width = (m_Config.width + 15) & ~15;
-  m_Config.height = (m_Config.height + 15) & ~15;
+  // Even dimensions for 4:2:0 (encoders pad to macroblocks internally, so
+  // 1080 stays 1080 and matches 1080p sources for smart render)
+  m_Config.width = (m_Config.width + 1) & ~1;
+  m_Config.height = (m_Config.height + 1) & ~1;
 
   // Set default max bitrate if not specified (VBR mode)
   if (m_Config.rateControl == RateControl::VBR && m_Config.maxBitrate == 0) {
@@ -63,7 +74,10 @@ bool HardwareExportManager::Initialize(const Config &config) {
             << std::endl;
   std::cout << "  FPS: " << m_Config.fps << std::endl;
   std::cout << "  Codec: "
-            << (m_Config.codec == Codec::H264 ? "H.264" : "H.265") << std::endl;
+            << (m_Config.codec == Codec::H264   ? "H.264"
+                : m_Config.codec == Codec::H265 ? "H.265"
+                                                : "AV1")
+            << std::endl;
   std::cout << "  Bitrate Control: ";
   switch (m_Config.rateControl) {
   case RateControl::VBR:
@@ -98,12 +112,20 @@ bool HardwareExportManager::StartExport() {
   if (m_IsExporting)
     return false;
 
-  // Wait for previous export if any
-  if (m_RenderThread.joinable())
-    m_RenderThread.join();
+  // Wait for previous export if any (its encoder thread joined the render
+  // thread)
   if (m_EncoderThread.joinable())
     m_EncoderThread.join();
 
+  // Freeze the timeline: the render thread never touches the live one, so
+  // editing can go on during the export
+  if (m_TimelineManager)
+    m_Timeline = m_TimelineManager->GetSnapshot();
+  if (!m_Timeline) {
+    m_ErrorMessage = "No timeline to export";
+    return false;
+  }
+
   // Clean up previous offscreen window
   if (m_OffscreenWindow) {
     glfwDestroyWindow(m_OffscreenWindow);
@@ -150,16 +172,13 @@ bool HardwareExportManager::StartExport() {
   m_Progress = 0.0f;
   m_ErrorMessage.clear();
   m_FrameCount = 0;
+  m_EncoderReady = false;
+  m_StartTime = std::chrono::steady_clock::now();
+  m_EndTimeNs = 0;
 
-  // Clear YUV queue
-  {
-    std::lock_guard<std::mutex> lock(m_YUVMutex);
-    while (!m_YUVQueue.empty()) {
-      if (m_YUVQueue.front().frame)
-        ReleaseFrame(m_YUVQueue.front().frame);
-      m_YUVQueue.pop();
-    }
-  }
+  // Clear YUV queue (threads are not running yet)
+  DrainYUVQueue();
+  m_YUVQueue.Reopen();
 
   // Launch threads (Phase 1 optimization: removed ProcessThread)
   m_RenderThread = std::thread(&HardwareExportManager::RenderThreadFunc, this);
@@ -170,12 +189,57 @@ bool HardwareExportManager::StartExport() {
 }
 
 void HardwareExportManager::CancelExport() {
-  if (m_IsExporting) {
-    m_CancelRequested = true;
+  // Also set when the render thread already bailed out (m_IsExporting false)
+  // so the encoder thread never waits for frames that will not come
+  m_CancelRequested = true;
 
-    // Wake up waiting encoder thread
-    m_YUVCondVar.notify_all();
-  }
+  // Wake up the render thread (queue full) and the encoder thread (empty)
+  m_YUVQueue.Close();
+}
+
+std::unique_ptr<ExportAudioMixer>
+HardwareExportManager::CreateAudioMixer(const Config &config,
+                                        TimelineSnapshotPtr timeline,
+                                        int firstFrame, int endFrame) {
+  if (!config.exportAudio || !timeline)
+    return nullptr;
+
+  ExportAudioMixer::Settings settings;
+  settings.normalize = config.normalizeLoudness;
+  settings.targetLoudness = config.targetLoudness;
+  settings.truePeakCeiling = config.truePeakCeiling;
+  settings.bitrate = config.audioBitrate;
+  return std::make_unique<ExportAudioMixer>(std::move(timeline), config.fps,
+                                            firstFrame, endFrame, settings);
+}
+
+void HardwareExportManager::GetFrameRange(int &firstFrame,
+                                          int &endFrame) const {
+  double duration = m_Timeline->totalDuration;
+  if (duration <= 0.001)
+    duration = 1.0;
+  int totalFrames = static_cast<int>(duration * m_Config.fps);
+  firstFrame = std::max(0, m_Config.startFrame);
+  endFrame = m_Config.endFrame >= 0 ? std::min(m_Config.endFrame, totalFrames)
+                                    : totalFrames;
+}
+
+double HardwareExportManager::GetElapsedSeconds() const {
+  if (m_StartTime == std::chrono::steady_clock::time_point())
+    return 0.0;
+
+  int64_t endNs = m_EndTimeNs;
+  auto end = endNs ? std::chrono::steady_clock::time_point(
+                         std::chrono::duration_cast<
+                             std::chrono::steady_clock::duration>(
+                             std::chrono::nanoseconds(endNs)))
+                   : std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - m_StartTime).count();
+}
+
+double HardwareExportManager::GetEncodeFPS() const {
+  double elapsed = GetElapsedSeconds();
+  return elapsed > 0.0 ? m_FrameCount / elapsed : 0.0;
 }
 
 // ============================================================================
@@ -184,11 +248,11 @@ void HardwareExportManager::CancelExport() {
 
 void HardwareExportManager::RenderThreadFunc() {
   std::cout << "[RenderThread] Started" << std::endl;
+  Trace::SetThreadName("Render " + m_Config.outputFile);
 
   if (!m_OffscreenWindow) {
     m_ErrorMessage = "No offscreen window available";
-    m_IsExporting = false;
-    m_IsFinished = true;
+    CancelExport(); // The encoder thread reports the end
     return;
   }
 
@@ -197,8 +261,7 @@ void HardwareExportManager::RenderThreadFunc() {
 
   if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
     m_ErrorMessage = "Failed to initialize GLAD";
-    m_IsExporting = false;
-    m_IsFinished = true;
+    CancelExport(); // The encoder thread reports the end
     return;
   }
 
@@ -206,8 +269,7 @@ void HardwareExportManager::RenderThreadFunc() {
   TextureRenderer renderer;
   if (!renderer.Initialize()) {
     m_ErrorMessage = "Failed to initialize texture renderer";
-    m_IsExporting = false;
-    m_IsFinished = true;
+    CancelExport(); // The encoder thread reports the end
     return;
   }
 
@@ -220,6 +282,12 @@ void HardwareExportManager::RenderThreadFunc() {
   renderer.SetEffectParams(m_EffectParams.vignette, m_EffectParams.grain,
                            m_EffectParams.aberration, m_EffectParams.sepia);
   renderer.SetFilterType(m_EffectParams.filterType);
+  if (!m_EffectParams.lutPath.empty() &&
+      !renderer.LoadCubeLUT(m_EffectParams.lutPath)) {
+    m_ErrorMessage = "Failed to load LUT: " + renderer.GetCubeLUTError();
+    CancelExport(); // The encoder thread reports the end
+    return;
+  }
 
   // Setup PBOs for async readback
   unsigned int pbos[2];
@@ -234,249 +302,228 @@ void HardwareExportManager::RenderThreadFunc() {
 
   bool usingPBO = (glGetError() == GL_NO_ERROR);
   GLsync fences[2] = {nullptr, nullptr};
+  int pendingPBO = -1; // PBO holding a frame that is not converted yet
+  int nextPBO = 0;
 
-  // Calculate total frames
-  double duration = m_TimelineManager->GetTotalDuration();
-  if (duration <= 0.001)
-    duration = 1.0;
-  int totalFrames = static_cast<int>(duration * m_Config.fps);
-  double frameDuration = 1.0 / m_Config.fps;
+  // Calculate frame range (a segment export renders only part of it)
+  int firstFrame = 0;
+  int endFrame = 0;
+  GetFrameRange(firstFrame, endFrame);
+  int rangeFrames = std::max(1, endFrame - firstFrame);
 
   VideoPlayer tempPlayer;
   std::string currentLoadedFile = "";
   std::vector<uint8_t> pixelBuffer;
-  size_t frameSize = m_Config.width * m_Config.height * 3;
 
-  // Main rendering loop
-  for (int i = 0; i < totalFrames && !m_CancelRequested; ++i) {
-    double currentTime = i * frameDuration;
-    bool frameRendered = false;
-
-    // Get current clip from timeline
-    auto &tracks = m_TimelineManager->GetTracks();
-    Clip *currentClip = nullptr;
-    if (!tracks.empty())
-      currentClip = tracks[0].GetClipAtTime(currentTime);
-
-    if (currentClip) {
-      // Load video if needed
-      if (!tempPlayer.IsLoaded() ||
-          currentClip->filepath != currentLoadedFile) {
-        if (tempPlayer.LoadVideo(currentClip->filepath))
-          currentLoadedFile = currentClip->filepath;
+  // The encoder thread creates the frame pool; frames acquired before that
+  // would be dropped and shift every following frame
+  while (!m_EncoderReady && !m_CancelRequested)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  // GPU frames: CUDA reads the render target and writes the encoder's
+  // surface directly; otherwise frames take the PBO readback path below
+  bool gpuFrames = false;
+#ifdef USE_CUDA
+  if (m_HwFramesCtx && m_CUDAConverter)
+    gpuFrames = m_CUDAConverter->RegisterGLTexture(
+        renderer.GetFramebufferTexture());
+#endif
+
+  // A frame that cannot be submitted would shift every later one: stop
+  // and report it (a segment pipeline fails its segment)
+  auto failFrame = [&](int frameIndex) {
+    if (!m_CancelRequested)
+      m_ErrorMessage = "Failed to submit frame " + std::to_string(frameIndex);
+    CancelExport();
+  };
+
+  // Convert the frame waiting in the pending PBO and hand it to the encoder
+  auto drainPendingPBO = [&](int frameIndex) {
+    if (pendingPBO < 0)
+      return true;
+
+    GLubyte *ptr = nullptr;
+    {
+      TraceScope trace(TraceStage::ReadbackWait, frameIndex);
+      if (fences[pendingPBO]) {
+        glClientWaitSync(fences[pendingPBO], GL_SYNC_FLUSH_COMMANDS_BIT,
+                         1000000000);
+        glDeleteSync(fences[pendingPBO]);
+        fences[pendingPBO] = nullptr;
       }
 
-      if (tempPlayer.IsLoaded()) {
-        double localTime = currentClip->ToLocalTime(currentTime);
-        double videoFPS = tempPlayer.GetFPS() > 0 ? tempPlayer.GetFPS() : 30.0;
-        double videoFrameDuration = 1.0 / videoFPS;
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pendingPBO]);
+      ptr = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    }
+    bool submitted = false;
+    if (ptr) {
+      submitted = SubmitRGBFrame(ptr, frameIndex);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    pendingPBO = -1;
+    if (!submitted)
+      failFrame(frameIndex);
+    return submitted;
+  };
+
+  // Clip, effects and decoder work change only at segment boundaries
+  RenderPlan plan(*m_Timeline, m_Config.fps, firstFrame, endFrame);
+  std::cout << "[RenderThread] " << plan.GetSegments().size()
+            << " segments for " << (endFrame - firstFrame) << " frames"
+            << std::endl;
 
-        // Seek if necessary
-        if (i == 0 || currentClip->filepath != currentLoadedFile ||
-            std::abs(localTime - tempPlayer.GetCurrentTime()) > 0.5) {
-          tempPlayer.Seek(localTime, false);
+  // Opens the next segment's file while this one renders
+  DecoderPrefetcher prefetcher;
+
+  // Main rendering loop
+  const auto &segments = plan.GetSegments();
+  for (size_t s = 0; s < segments.size() && !m_CancelRequested; ++s) {
+    const RenderPlan::Segment &segment = segments[s];
+    const Clip *clip = segment.clip;
+    bool needSeek = false;
+    if (clip) {
+      needSeek = segment.action != RenderPlan::DecoderAction::Continue;
+
+      // Also reopens if an earlier open of this file failed
+      if (segment.action == RenderPlan::DecoderAction::Open ||
+          !tempPlayer.IsLoaded() || clip->filepath != currentLoadedFile) {
+        currentLoadedFile.clear();
+        if (prefetcher.Take(clip->filepath, tempPlayer, true)) {
+          currentLoadedFile = clip->filepath;
+          needSeek = false; // Already decoded up to the segment start
+        } else if (tempPlayer.LoadVideo(clip->filepath, false)) {
+          currentLoadedFile = clip->filepath;
         }
+      }
+    }
+
+    if (const RenderPlan::Segment *next = plan.GetPrefetchTarget(s))
+      prefetcher.Request(next->clip->filepath,
+                         next->GetSourceTime(
+                             plan.GetFrameTime(next->startFrame)));
+    bool sourceReady = clip && !currentLoadedFile.empty();
+    double videoFPS =
+        sourceReady && tempPlayer.GetFPS() > 0 ? tempPlayer.GetFPS() : 30.0;
+    double videoFrameDuration = 1.0 / videoFPS;
+
+    renderer.SetBlurEffect(segment.blurAmount, segment.blurType);
+
+    for (int i = segment.startFrame;
+         i < segment.endFrame && !m_CancelRequested; ++i) {
+      bool isFirstFrame = (i == firstFrame);
+      bool frameRendered = false;
+
+      if (sourceReady) {
+        double localTime = segment.GetSourceTime(plan.GetFrameTime(i));
+
+        // Another export may have decoded this source frame already
+        int64_t sourceFrame =
+            static_cast<int64_t>(std::floor(localTime * videoFPS + 1e-6));
+        SharedFrameCache::FramePtr sharedFrame;
+        if (m_FrameCache)
+          sharedFrame = m_FrameCache->Lookup(clip->filepath, sourceFrame);
+
+        const uint8_t *data = nullptr;
+        int frameWidth = 0;
+        int frameHeight = 0;
+
+        if (sharedFrame) {
+          data = sharedFrame->rgb.data();
+          frameWidth = sharedFrame->width;
+          frameHeight = sharedFrame->height;
+        } else {
+          // Seek at the segment start, or after cache hits let the
+          // decoder fall behind
+          if (needSeek ||
+              std::abs(localTime - tempPlayer.GetCurrentTime()) > 0.5) {
+            TraceScope trace(TraceStage::Seek, i);
+            tempPlayer.Seek(localTime, false);
+            needSeek = false;
+          }
+
+          // Decode to target frame (decode ahead in larger batches)
+          int decodeAttempts = 0;
+          while (tempPlayer.GetCurrentTime() + videoFrameDuration < localTime &&
+                 decodeAttempts < 10) {
+            TraceScope trace(TraceStage::Decode, i);
+            if (!tempPlayer.DecodeNextFrame())
+              break;
+            decodeAttempts++;
+          }
 
-        // Decode to target frame (decode ahead in larger batches)
-        int decodeAttempts = 0;
-        while (tempPlayer.GetCurrentTime() + videoFrameDuration < localTime &&
-               decodeAttempts < 10) {
-          if (!tempPlayer.DecodeNextFrame())
-            break;
-          decodeAttempts++;
+          data = tempPlayer.GetFrameData();
+          frameWidth = tempPlayer.GetWidth();
+          frameHeight = tempPlayer.GetHeight();
+
+          if (data && m_FrameCache)
+            m_FrameCache->Insert(clip->filepath, sourceFrame, data,
+                                 frameWidth, frameHeight);
         }
 
-        const uint8_t *data = tempPlayer.GetFrameData();
         if (data) {
           // Create texture if needed
-          if (i == 0 || renderer.GetTextureID() == 0) {
-            renderer.CreateTexture(tempPlayer.GetWidth(),
-                                   tempPlayer.GetHeight());
+          if (isFirstFrame || renderer.GetTextureID() == 0) {
+            renderer.CreateTexture(frameWidth, frameHeight);
           }
 
           // Update texture and render to framebuffer
-          renderer.UpdateTexture(data, tempPlayer.GetWidth(),
-                                 tempPlayer.GetHeight());
-
-          // Apply blur effects if any
-          auto activeEffects = m_TimelineManager->GetActiveEffects(currentTime);
-          for (auto *effect : activeEffects) {
-            if (effect && effect->type >= EffectLayer::BLUR_GAUSSIAN &&
-                effect->type <= EffectLayer::BLUR_ZOOM) {
-              float intensity = effect->params.count("intensity")
-                                    ? effect->params.at("intensity")
-                                    : 0.5f;
-              int blurType =
-                  effect->params.count("blurType")
-                      ? static_cast<int>(effect->params.at("blurType"))
-                      : 0;
-              renderer.SetBlurEffect(intensity, blurType);
-            }
+          {
+            TraceScope trace(TraceStage::TextureUpload, i);
+            renderer.UpdateTexture(data, frameWidth, frameHeight);
           }
 
           // Render to FBO
           renderer.BindFramebuffer();
           glViewport(0, 0, m_Config.width, m_Config.height);
           glClear(GL_COLOR_BUFFER_BIT);
-          renderer.RenderTexture(0, 0, static_cast<float>(m_Config.width),
-                                 static_cast<float>(m_Config.height));
-
-          // Read pixels using PBO double buffering
-          if (usingPBO) {
-            int currentPBO = i % 2;
-            int previousPBO = (i + 1) % 2;
-
-            // Process previous frame
-            if (i > 0) {
-              if (fences[previousPBO]) {
-                glClientWaitSync(fences[previousPBO],
-                                 GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
-                glDeleteSync(fences[previousPBO]);
-                fences[previousPBO] = nullptr;
-              }
-
-              glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[previousPBO]);
-              GLubyte *ptr =
-                  (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-              if (ptr) {
-                // Phase 3: CUDA GPU conversion in async PBO path
-                AVFrame *yuvFrame = AcquireFrame();
-                if (yuvFrame) {
-                  bool converted = false;
-
-#ifdef USE_VULKAN
-                  // Try Vulkan GPU conversion first
-                  if (m_VulkanExporter && m_VulkanExporter->IsInitialized()) {
-                    if (m_VulkanExporter->ConvertRGBToNV12(
-                            ptr, yuvFrame->data[0], yuvFrame->data[1],
-                            m_Config.width, m_Config.height)) {
-                      converted = true;
-                    }
-                  }
-#endif
+          {
+            // Records GL submission only; the GPU time shows up in the
+            // readback wait
+            TraceScope trace(TraceStage::Effects, i);
+            renderer.RenderTexture(0, 0, static_cast<float>(m_Config.width),
+                                   static_cast<float>(m_Config.height));
+          }
 
-#ifdef USE_CUDA
-                  if (!converted && m_CUDAConverter &&
-                      m_CUDAConverter->IsAvailable()) {
-                    // GPU conversion from PBO mapped memory
-                    if (m_CUDAConverter->ConvertRGB24ToNV12(
-                            ptr, yuvFrame->data[0], yuvFrame->data[1],
-                            m_Config.width, m_Config.height)) {
-                      converted = true;
-                    }
-                  }
-#endif
+          bool onGPU = false;
+          if (gpuFrames) {
+            if (!drainPendingPBO(i - 1)) // Keep frame order
+              break;
+            onGPU = SubmitRenderTarget(i);
+          }
 
-                  if (!converted && m_SwsCtx) {
-                    // CPU fallback
-                    const uint8_t *srcSlice[1] = {ptr};
-                    int srcStride[1] = {m_Config.width * 3};
-
-                    int result = sws_scale(m_SwsCtx, srcSlice, srcStride, 0,
-                                           m_Config.height, yuvFrame->data,
-                                           yuvFrame->linesize);
-
-                    if (result > 0) {
-                      converted = true;
-                    }
-                  }
-
-                  if (converted) {
-                    yuvFrame->pts = i - 1;
-
-                    // Push directly to encoder queue
-                    {
-                      std::unique_lock<std::mutex> lock(m_YUVMutex);
-                      // Backpressure: wait if queue too large
-                      while (m_YUVQueue.size() > 5 && !m_CancelRequested) {
-                        lock.unlock();
-                        std::this_thread::sleep_for(
-                            std::chrono::milliseconds(5));
-                        lock.lock();
-                      }
-
-                      YUVFrame yuvPacket;
-                      yuvPacket.frame = yuvFrame;
-                      m_YUVQueue.push(std::move(yuvPacket));
-                    }
-                    m_YUVCondVar.notify_one();
-                  } else {
-                    ReleaseFrame(yuvFrame);
-                  }
-                }
-
-                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-              }
-            }
+          if (onGPU) {
+            // Frame never left the GPU
+          } else if (usingPBO) {
+            // Async readback: start the transfer of this frame, then
+            // convert the previous one while the GPU works
+            int currentPBO = nextPBO;
+            nextPBO ^= 1;
 
-            // Issue read for current frame
+            // Tight rows: widths of 2 mod 4 would otherwise be padded, and
+            // the converters assume a width * 3 stride
             glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[currentPBO]);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
             glReadPixels(0, 0, m_Config.width, m_Config.height, GL_RGB,
                          GL_UNSIGNED_BYTE, 0);
-
-            if (fences[currentPBO])
-              glDeleteSync(fences[currentPBO]);
-            fences[currentPBO] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-
+            fences[currentPBO] =
+                glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
             glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-            // Synchronous fallback
-            renderer.GetRGBPixels(pixelBuffer, m_Config.width, m_Config.height);
-
-            // Phase 3: Use CUDA for RGB→YUV if available, otherwise CPU
-            AVFrame *yuvFrame = AcquireFrame();
-            if (yuvFrame) {
-              bool converted = false;
-
-#ifdef USE_VULKAN
-              // Try Vulkan GPU conversion first
-              if (m_VulkanExporter && m_VulkanExporter->IsInitialized()) {
-                if (m_VulkanExporter->ConvertRGBToNV12(
-                        pixelBuffer.data(), yuvFrame->data[0],
-                        yuvFrame->data[1], m_Config.width, m_Config.height)) {
-                  converted = true;
-                }
-              }
-#endif
 
-#ifdef USE_CUDA
-              if (!converted && m_CUDAConverter &&
-                  m_CUDAConverter->IsAvailable()) {
-                // GPU conversion
-                if (m_CUDAConverter->ConvertRGB24ToNV12(
-                        pixelBuffer.data(), yuvFrame->data[0],
-                        yuvFrame->data[1], m_Config.width, m_Config.height)) {
-                  converted = true;
-                }
-              }
-#endif
-
-              if (!converted && m_SwsCtx) {
-                // CPU fallback
-                const uint8_t *srcSlice[1] = {pixelBuffer.data()};
-                int srcStride[1] = {m_Config.width * 3};
-
-                int result =
-                    sws_scale(m_SwsCtx, srcSlice, srcStride, 0, m_Config.height,
-                              yuvFrame->data, yuvFrame->linesize);
-
-                if (result > 0) {
-                  converted = true;
-                }
-              }
-
-              if (converted) {
-                yuvFrame->pts = i;
-
-                {
-                  std::lock_guard<std::mutex> lock(m_YUVMutex);
-                  YUVFrame yuvPacket;
-                  yuvPacket.frame = yuvFrame;
-                  m_YUVQueue.push(std::move(yuvPacket));
-                }
-                m_YUVCondVar.notify_one();
-              } else {
-                ReleaseFrame(yuvFrame);
-              }
+            bool drained = drainPendingPBO(i - 1);
+            pendingPBO = currentPBO;
+            if (!drained)
+              break;
+          } else {
+            // Synchronous fallback
+            {
+              TraceScope trace(TraceStage::ReadbackWait, i);
+              renderer.GetRGBPixels(pixelBuffer, m_Config.width,
+                                    m_Config.height);
+            }
+            if (!SubmitRGBFrame(pixelBuffer.data(), i)) {
+              failFrame(i);
+              break;
             }
           }
 
@@ -484,97 +531,234 @@ void HardwareExportManager::RenderThreadFunc() {
           frameRendered = true;
         }
       }
-    }
 
-    // Handle empty frames (black frame)
-    if (!frameRendered) {
-      // Create black YUV frame
-      AVFrame *yuvFrame = AcquireFrame();
-      if (yuvFrame) {
-        // Fill with black (Y=16, UV=128 for video range)
-        memset(yuvFrame->data[0], 16, yuvFrame->linesize[0] * m_Config.height);
-        memset(yuvFrame->data[1], 128,
-               yuvFrame->linesize[1] * (m_Config.height / 2));
-        yuvFrame->pts = i;
-
-        {
-          std::lock_guard<std::mutex> lock(m_YUVMutex);
-          YUVFrame yuvPacket;
-          yuvPacket.frame = yuvFrame;
-          m_YUVQueue.push(std::move(yuvPacket));
+      // Handle empty frames (black frame)
+      if (!frameRendered) {
+        if (!drainPendingPBO(i - 1)) // Keep frame order
+          break;
+        if (!SubmitBlackFrame(i)) {
+          failFrame(i);
+          break;
         }
-        m_YUVCondVar.notify_one();
       }
-    }
 
-    // Update progress less frequently to reduce overhead
-    if (i % 30 == 0) {
-      m_Progress = static_cast<float>(i + 1) / totalFrames;
-      std::cout << "[RenderThread] Progress: " << i << "/" << totalFrames
-                << std::endl;
+      // Progress is a relaxed atomic store; only the log line is throttled
+      m_Progress = static_cast<float>(i - firstFrame + 1) / rangeFrames;
+      if ((i - firstFrame) % 30 == 0) {
+        std::cout << "[RenderThread] Progress: " << i << "/" << endFrame
+                  << std::endl;
+      }
     }
   }
 
   // Capture last PBO frame if using async readback
-  if (usingPBO && !m_CancelRequested && totalFrames > 0) {
-    int lastPBO = (totalFrames - 1) % 2;
-    if (fences[lastPBO]) {
-      glClientWaitSync(fences[lastPBO], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
-      glDeleteSync(fences[lastPBO]);
+  if (!m_CancelRequested)
+    drainPendingPBO(endFrame - 1);
+
+  // End of stream: the encoder drains the queue and then stops
+  m_YUVQueue.Close();
+
+  // Cleanup
+  if (usingPBO) {
+    for (int i = 0; i < 2; ++i) {
+      if (fences[i])
+        glDeleteSync(fences[i]);
     }
+    glDeleteBuffers(2, pbos);
+  }
+#ifdef USE_CUDA
+  if (gpuFrames)
+    m_CUDAConverter->UnregisterGLTexture(); // Needs this GL context
+#endif
 
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[lastPBO]);
-    GLubyte *ptr = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-    if (ptr) {
-      AVFrame *yuvFrame = AcquireFrame();
-      if (yuvFrame && m_SwsCtx) {
-        const uint8_t *srcSlice[1] = {ptr};
-        int srcStride[1] = {m_Config.width * 3};
+  glfwMakeContextCurrent(nullptr);
+  std::cout << "[RenderThread] Finished" << std::endl;
+}
 
-        int result =
-            sws_scale(m_SwsCtx, srcSlice, srcStride, 0, m_Config.height,
-                      yuvFrame->data, yuvFrame->linesize);
+// ============================================================================
+// Frame Submission (render thread -> encoder thread)
+// ============================================================================
 
-        if (result > 0) {
-          yuvFrame->pts = totalFrames - 1;
+bool HardwareExportManager::SubmitRGBFrame(const uint8_t *rgb,
+                                           int frameIndex) {
+  AVFrame *yuvFrame = AcquireFrame();
+  if (!yuvFrame)
+    return false;
 
-          {
-            std::lock_guard<std::mutex> lock(m_YUVMutex);
-            YUVFrame yuvPacket;
-            yuvPacket.frame = yuvFrame;
-            m_YUVQueue.push(std::move(yuvPacket));
-          }
-          m_YUVCondVar.notify_one();
-        } else {
-          ReleaseFrame(yuvFrame);
-        }
-      }
+  TraceScope trace(TraceStage::ColorConvert, frameIndex);
+  AVFrame *host = GetHostTarget(yuvFrame);
+  bool converted = false;
 
-      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+#ifdef USE_VULKAN
+  // Try Vulkan GPU conversion first
+  if (host && m_VulkanExporter && m_VulkanExporter->IsInitialized()) {
+    if (m_VulkanExporter->ConvertRGBToNV12(rgb, host->data[0], host->data[1],
+                                           m_Config.width, m_Config.height)) {
+      converted = true;
+    }
+  }
+#endif
+
+#ifdef USE_CUDA
+  if (host && !converted && m_CUDAConverter &&
+      m_CUDAConverter->IsAvailable()) {
+    // GPU conversion
+    if (m_CUDAConverter->ConvertRGB24ToNV12(rgb, host->data[0],
+                                            host->data[1], m_Config.width,
+                                            m_Config.height)) {
+      converted = true;
     }
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
   }
+#endif
 
-  // Send stop signal to encoder thread (Phase 1: directly to encoder)
+  if (host && !converted && m_HostPixFmt == AV_PIX_FMT_NV12) {
+    // CPU fallback (same matrix as the CUDA kernel)
+    ColorConvert::RGB24ToNV12(rgb, m_Config.width * 3, host->data[0],
+                              host->linesize[0], host->data[1],
+                              host->linesize[1], m_Config.width,
+                              m_Config.height);
+    converted = true;
+  } else if (host && !converted && m_HostPixFmt == AV_PIX_FMT_YUV420P) {
+    ColorConvert::RGB24ToYUV420P(
+        rgb, m_Config.width * 3, host->data[0], host->linesize[0],
+        host->data[1], host->linesize[1], host->data[2], host->linesize[2],
+        m_Config.width, m_Config.height);
+    converted = true;
+  }
+
+  if (host && !converted && m_SwsCtx) {
+    // Other pixel formats
+    const uint8_t *srcSlice[1] = {rgb};
+    int srcStride[1] = {m_Config.width * 3};
+
+    int result = sws_scale(m_SwsCtx, srcSlice, srcStride, 0, m_Config.height,
+                           host->data, host->linesize);
+    if (result > 0) {
+      converted = true;
+    }
+  }
+
+  if (!converted || !FinishHostFrame(host, yuvFrame)) {
+    ReleaseFrame(yuvFrame);
+    return false;
+  }
+
+  yuvFrame->pts = frameIndex;
+  PushYUVFrame(yuvFrame);
+  return true;
+}
+
+bool HardwareExportManager::SubmitBlackFrame(int frameIndex) {
+  AVFrame *yuvFrame = AcquireFrame();
+  if (!yuvFrame)
+    return false;
+
+  AVFrame *host = GetHostTarget(yuvFrame);
+  if (!host) {
+    ReleaseFrame(yuvFrame);
+    return false;
+  }
+
+  // Fill with black (Y=16, UV=128 for video range)
+  memset(host->data[0], 16, host->linesize[0] * m_Config.height);
+  memset(host->data[1], 128, host->linesize[1] * (m_Config.height / 2));
+  if (host->data[2]) // Planar YUV420P
+    memset(host->data[2], 128, host->linesize[2] * (m_Config.height / 2));
+
+  if (!FinishHostFrame(host, yuvFrame)) {
+    ReleaseFrame(yuvFrame);
+    return false;
+  }
+  yuvFrame->pts = frameIndex;
+
+  PushYUVFrame(yuvFrame);
+  return true;
+}
+
+bool HardwareExportManager::SubmitRenderTarget(int frameIndex) {
+#ifdef USE_CUDA
+  if (!m_CUDAConverter || !m_CUDAConverter->HasGLTexture())
+    return false;
+
+  AVFrame *frame = AcquireFrame();
+  if (!frame)
+    return false;
+
+  bool converted;
   {
-    std::lock_guard<std::mutex> lock(m_YUVMutex);
-    YUVFrame stopFrame;
-    stopFrame.isStopSignal = true;
-    m_YUVQueue.push(std::move(stopFrame));
+    TraceScope trace(TraceStage::ColorConvert, frameIndex);
+    converted = m_CUDAConverter->ConvertGLTextureToNV12(
+        frame->data[0], frame->linesize[0], frame->data[1],
+        frame->linesize[1], m_Config.width, m_Config.height);
+  }
+  if (!converted) {
+    ReleaseFrame(frame);
+    return false;
   }
-  m_YUVCondVar.notify_one();
 
-  // Cleanup
-  if (usingPBO) {
-    for (int i = 0; i < 2; ++i) {
-      if (fences[i])
-        glDeleteSync(fences[i]);
+  frame->pts = frameIndex;
+  PushYUVFrame(frame);
+  return true;
+#else
+  (void)frameIndex;
+  return false;
+#endif
+}
+
+AVFrame *HardwareExportManager::GetHostTarget(AVFrame *frame) {
+  if (!frame->hw_frames_ctx)
+    return frame;
+
+  if (!m_StagingFrame) {
+    m_StagingFrame = av_frame_alloc();
+    if (!m_StagingFrame)
+      return nullptr;
+    m_StagingFrame->format = m_HostPixFmt;
+    m_StagingFrame->width = m_Config.width;
+    m_StagingFrame->height = m_Config.height;
+    if (av_frame_get_buffer(m_StagingFrame, 32) < 0) {
+      av_frame_free(&m_StagingFrame);
+      return nullptr;
     }
-    glDeleteBuffers(2, pbos);
   }
+  return m_StagingFrame;
+}
 
-  glfwMakeContextCurrent(nullptr);
-  std::cout << "[RenderThread] Finished" << std::endl;
+bool HardwareExportManager::FinishHostFrame(AVFrame *host, AVFrame *frame) {
+  if (!host || host == frame)
+    return host != nullptr;
+
+  // Fallback only: the frame was rendered or converted on the CPU side
+  int ret = av_hwframe_transfer_data(frame, host, 0);
+  if (ret < 0) {
+    char errbuf[256];
+    av_strerror(ret, errbuf, sizeof(errbuf));
+    std::cerr << "[HardwareExportManager] Frame upload failed: " << errbuf
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void HardwareExportManager::PushYUVFrame(AVFrame *frame) {
+  // Backpressure: sleeps until the encoder frees a slot
+  bool pushed;
+  {
+    TraceScope trace(TraceStage::QueueWait, frame->pts);
+    pushed = m_YUVQueue.Push(frame);
+  }
+  if (!pushed)
+    ReleaseFrame(frame); // Cancelled
+  Trace::RecordCounter(TraceCounter::YUVQueue,
+                       static_cast<int64_t>(m_YUVQueue.Size()));
+}
+
+void HardwareExportManager::DrainYUVQueue() {
+  AVFrame *frame = nullptr;
+  while (m_YUVQueue.TryPop(frame)) {
+    if (frame)
+      ReleaseFrame(frame);
+  }
 }
 
 // ============================================================================
@@ -583,58 +767,75 @@ void HardwareExportManager::RenderThreadFunc() {
 
 void HardwareExportManager::EncoderThreadFunc() {
   std::cout << "[EncoderThread] Started" << std::endl;
+  Trace::SetThreadName("Encoder " + m_Config.outputFile);
 
-  // Initialize FFmpeg encoder
-  if (!InitializeFFmpeg()) {
+  bool initialized = InitializeFFmpeg();
+  if (initialized) {
+    m_EncoderReady = true;
+    EncodeFrames();
+  } else {
     m_ErrorMessage = "Failed to initialize FFmpeg encoder";
-    m_IsExporting = false;
-    m_IsFinished = true;
-    return;
+    CancelExport(); // Stop the render thread
   }
 
-  // Main encoding loop
-  while (true) {
-    YUVFrame yuvFrame;
-
-    // Wait for YUV frame
-    {
-      std::unique_lock<std::mutex> lock(m_YUVMutex);
-      m_YUVCondVar.wait(
-          lock, [this] { return !m_YUVQueue.empty() || m_CancelRequested; });
+  // Until it sees the end of the queue or the cancel, the render thread may
+  // be in AcquireFrame() or a submit: everything they share goes only once
+  // it has exited, and only here
+  m_RenderThread.join();
+  DrainYUVQueue(); // Raced with the close
+  Cleanup();
 
-      if (m_CancelRequested)
-        break;
+  m_EndTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  if (initialized)
+    m_Progress = 1.0f;
+  m_IsExporting = false;
+  m_IsFinished = true;
 
-      if (m_YUVQueue.empty())
-        continue;
+  std::cout << "[EncoderThread] Finished" << std::endl;
+}
 
-      yuvFrame = std::move(m_YUVQueue.front());
-      m_YUVQueue.pop();
-    }
+void HardwareExportManager::EncodeFrames() {
+  // Main encoding loop
+  while (true) {
+    // Wait for YUV frame (false once the render thread closed the queue)
+    AVFrame *frame = nullptr;
+    if (!m_YUVQueue.Pop(frame))
+      break;
 
-    // Check for stop signal
-    if (yuvFrame.isStopSignal) {
+    if (m_CancelRequested) {
+      if (frame)
+        ReleaseFrame(frame);
       break;
     }
 
     // Encode frame
-    if (yuvFrame.frame && m_CodecCtx) {
-      yuvFrame.frame->pts = m_FrameCount++;
+    if (frame && m_CodecCtx) {
+      int64_t frameId = frame->pts; // Timeline frame set by the render thread
+      frame->pts = m_FrameCount++;
 
       // Send frame to encoder
-      int ret = avcodec_send_frame(m_CodecCtx, yuvFrame.frame);
+      int ret;
+      {
+        TraceScope trace(TraceStage::EncoderSend, frameId);
+        ret = avcodec_send_frame(m_CodecCtx, frame);
+      }
       if (ret < 0) {
         char errbuf[256];
         av_strerror(ret, errbuf, sizeof(errbuf));
         std::cerr << "[EncoderThread] Error sending frame: " << errbuf
                   << std::endl;
-        ReleaseFrame(yuvFrame.frame);
+        ReleaseFrame(frame);
         continue;
       }
 
       // Receive encoded packets
       while (ret >= 0) {
-        ret = avcodec_receive_packet(m_CodecCtx, m_Packet);
+        {
+          TraceScope trace(TraceStage::EncoderReceive, frameId);
+          ret = avcodec_receive_packet(m_CodecCtx, m_Packet);
+        }
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
           break;
         } else if (ret < 0) {
@@ -647,17 +848,30 @@ void HardwareExportManager::EncoderThreadFunc() {
                              m_Stream->time_base);
         m_Packet->stream_index = m_Stream->index;
 
+        TraceScope trace(TraceStage::MuxWrite, frameId);
         ret = av_interleaved_write_frame(m_FormatCtx, m_Packet);
         av_packet_unref(m_Packet);
       }
 
       // Return frame to pool
-      ReleaseFrame(yuvFrame.frame);
+      ReleaseFrame(frame);
+
+      // Audio up to the end of this frame, interleaved with the video
+      if (m_Audio && !m_Audio->EncodeUntil(static_cast<double>(m_FrameCount) /
+                                           m_Config.fps)) {
+        std::cerr << "[EncoderThread] Audio encoding failed, dropping audio"
+                  << std::endl;
+        m_Audio.reset();
+      }
     }
 
     // Progress updated by render thread only
   }
 
+  // Frames left behind by a cancel; the render thread's pushes fail from now
+  m_YUVQueue.Close();
+  DrainYUVQueue();
+
   // Flush encoder
   if (m_CodecCtx) {
     avcodec_send_frame(m_CodecCtx, nullptr);
@@ -676,16 +890,10 @@ void HardwareExportManager::EncoderThreadFunc() {
       av_packet_unref(m_Packet);
     }
 
+    if (m_Audio && !m_CancelRequested)
+      m_Audio->Finish();
     av_write_trailer(m_FormatCtx);
   }
-
-  Cleanup();
-
-  m_Progress = 1.0f;
-  m_IsExporting = false;
-  m_IsFinished = true;
-
-  std::cout << "[EncoderThread] Finished - Export complete!" << std::endl;
 }
 
 // ============================================================================
@@ -738,8 +946,10 @@ bool HardwareExportManager::InitializeFFmpeg() {
 
   // Initialize hardware acceleration if requested
   if (m_Config.enableHardwareAccel) {
-    InitializeHardwareAccel();
+    if (InitializeHardwareAccel())
+      InitializeHardwareFrames();
   }
+  m_HostPixFmt = m_HwFramesCtx ? AV_PIX_FMT_NV12 : m_CodecCtx->pix_fmt;
 
   // Open codec
   AVDictionary *opts = nullptr;
@@ -773,9 +983,15 @@ bool HardwareExportManager::InitializeFFmpeg() {
     av_dict_set(&opts, "async_depth", "2", 0);
 
     std::cout << "[HardwareExportManager] NVENC settings applied" << std::endl;
-  } else if (codecName.find("x264") != std::string::npos) {
-    av_dict_set(&opts, "preset", "ultrafast", 0);
-    av_dict_set(&opts, "tune", "zerolatency", 0);
+  }
+
+  // CPU encoders: threads, lookahead and preset for the cores we may use
+  m_EncoderDescription = codecName + (m_HwFramesCtx ? " (GPU frames)" : "");
+  if (EncoderProfiles::IsSoftware(m_Codec)) {
+    EncoderProfiles::Profile profile =
+        EncoderProfiles::Build(m_Codec, m_Config);
+    EncoderProfiles::Apply(profile, m_Config, m_CodecCtx, &opts);
+    m_EncoderDescription += " (" + profile.Describe() + ")";
   }
 
   int ret = avcodec_open2(m_CodecCtx, m_Codec, &opts);
@@ -796,6 +1012,18 @@ bool HardwareExportManager::InitializeFFmpeg() {
   // Copy codec parameters to stream
   avcodec_parameters_from_context(m_Stream->codecpar, m_CodecCtx);
 
+  // Audio stream next to the video; the export goes on without it if the
+  // encoder is unavailable
+  int firstFrame = 0;
+  int endFrame = 0;
+  GetFrameRange(firstFrame, endFrame);
+  m_Audio = CreateAudioMixer(m_Config, m_Timeline, firstFrame, endFrame);
+  if (m_Audio && !m_Audio->Open(m_FormatCtx)) {
+    std::cerr << "[HardwareExportManager] Exporting without audio"
+              << std::endl;
+    m_Audio.reset();
+  }
+
   // Open output file
   if (!(m_FormatCtx->oformat->flags & AVFMT_NOFILE)) {
     if (avio_open(&m_FormatCtx->pb, m_Config.outputFile.c_str(),
@@ -819,7 +1047,7 @@ bool HardwareExportManager::InitializeFFmpeg() {
   // Create SwsContext for RGB->YUV conversion
   m_SwsCtx =
       sws_getContext(m_Config.width, m_Config.height, AV_PIX_FMT_RGB24,
-                     m_Config.width, m_Config.height, m_CodecCtx->pix_fmt,
+                     m_Config.width, m_Config.height, m_HostPixFmt,
                      SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
 
   if (!m_SwsCtx) {
@@ -829,17 +1057,15 @@ bool HardwareExportManager::InitializeFFmpeg() {
   }
 
   // Initialize frame pool
-  m_FramePool = std::make_unique<BufferPool<AVFrame>>(
-      5, // Initial pool size
-      [this]() {
-        AVFrame *frame = av_frame_alloc();
-        frame->format = m_CodecCtx->pix_fmt;
-        frame->width = m_Config.width;
-        frame->height = m_Config.height;
-        av_frame_get_buffer(frame, 32);
-        return frame;
-      },
-      [](AVFrame *frame) { av_frame_free(&frame); });
+  // Frames in flight are bounded by the YUV queue plus the one being
+  // filled and the one being encoded
+  PoolTraits<AVFrame>::Params frameParams;
+  frameParams.format = m_HostPixFmt;
+  frameParams.width = m_Config.width;
+  frameParams.height = m_Config.height;
+  frameParams.hwFramesCtx = m_HwFramesCtx; // CUDA surfaces if set
+  m_FramePool = std::make_unique<FramePool<AVFrame>>(
+      5, m_YUVQueue.GetCapacity() + 4, frameParams);
 
   std::cout << "[HardwareExportManager] FFmpeg encoder initialized successfully"
             << std::endl;
@@ -847,9 +1073,15 @@ bool HardwareExportManager::InitializeFFmpeg() {
 }
 
 bool HardwareExportManager::InitializeHardwareAccel() {
-  // Try to initialize CUDA hardware context
+  // Try to initialize CUDA hardware context. With CUDA built in, share the
+  // primary context so our kernels can write the encoder's surfaces
+#ifdef USE_CUDA
+  int flags = AV_CUDA_USE_PRIMARY_CONTEXT;
+#else
+  int flags = 0;
+#endif
   int ret = av_hwdevice_ctx_create(&m_HwDeviceCtx, AV_HWDEVICE_TYPE_CUDA,
-                                   nullptr, nullptr, 0);
+                                   nullptr, nullptr, flags);
   if (ret < 0) {
     std::cerr
         << "[HardwareExportManager] Failed to create CUDA device context, "
@@ -868,6 +1100,48 @@ bool HardwareExportManager::InitializeHardwareAccel() {
   return true;
 }
 
+bool HardwareExportManager::InitializeHardwareFrames() {
+#ifdef USE_CUDA
+  // Only NVENC takes CUDA frames, and only the CUDA converter can fill them
+  // without a host copy
+  if (!m_CUDAConverter || !m_CUDAConverter->IsAvailable() ||
+      std::string(m_Codec->name).find("nvenc") == std::string::npos)
+    return false;
+
+  AVBufferRef *framesRef = av_hwframe_ctx_alloc(m_HwDeviceCtx);
+  if (!framesRef)
+    return false;
+
+  auto *frames = reinterpret_cast<AVHWFramesContext *>(framesRef->data);
+  frames->format = AV_PIX_FMT_CUDA;
+  frames->sw_format = AV_PIX_FMT_NV12;
+  frames->width = m_Config.width;
+  frames->height = m_Config.height;
+  frames->initial_pool_size = 0; // CUDA pools grow on demand
+
+  int ret = av_hwframe_ctx_init(framesRef);
+  if (ret < 0) {
+    char errbuf[256];
+    av_strerror(ret, errbuf, sizeof(errbuf));
+    std::cerr << "[HardwareExportManager] CUDA frame pool failed (" << errbuf
+              << "), using host frames" << std::endl;
+    av_buffer_unref(&framesRef);
+    return false;
+  }
+
+  m_HwFramesCtx = framesRef;
+  m_CodecCtx->pix_fmt = AV_PIX_FMT_CUDA;
+  m_CodecCtx->hw_frames_ctx = av_buffer_ref(m_HwFramesCtx);
+
+  std::cout << "[HardwareExportManager] Encoder input stays on the GPU "
+               "(CUDA frames)"
+            << std::endl;
+  return true;
+#else
+  return false;
+#endif
+}
+
 const AVCodec *HardwareExportManager::FindBestCodec() {
   std::vector<std::string> candidates;
 
@@ -880,6 +1154,14 @@ const AVCodec *HardwareExportManager::FindBestCodec() {
     }
     candidates.push_back("libx264");
     candidates.push_back("h264");
+  } else if (m_Config.codec == Codec::AV1) {
+    if (m_Config.enableHardwareAccel) {
+      candidates.push_back("av1_nvenc");
+      candidates.push_back("av1_qsv");
+      candidates.push_back("av1_amf");
+    }
+    candidates.push_back("libsvtav1");
+    candidates.push_back("libaom-av1");
   } else { // H265
     if (m_Config.enableHardwareAccel) {
       candidates.push_back("hevc_nvenc");
@@ -946,9 +1228,18 @@ bool HardwareExportManager::ConfigureEncoder() {
     break;
   }
 
-  m_CodecCtx->gop_size = m_Config.fps * 2; // 2 second GOP
+  m_CodecCtx->gop_size = GetGopSize(m_Config);
   m_CodecCtx->max_b_frames = 2;
 
+  // Segments must not reference frames of a neighbouring segment
+  if (m_Config.closedGOP) {
+    m_CodecCtx->flags |= AV_CODEC_FLAG_CLOSED_GOP;
+  }
+
+  if (m_Config.threads > 0) {
+    m_CodecCtx->thread_count = m_Config.threads;
+  }
+
   if (m_Config.codec == Codec::H264) {
     m_CodecCtx->profile = AV_PROFILE_H264_HIGH;
   }
@@ -968,28 +1259,26 @@ AVFrame *HardwareExportManager::AcquireFrame() {
   if (!m_FramePool)
     return nullptr;
 
-  // Get shared_ptr and store it to keep frame alive
-  auto framePtr = m_FramePool->Acquire();
-  if (!framePtr)
+  // Blocks if all frames are in flight
+  AVFrame *frame = m_FramePool->Acquire();
+  if (!frame)
     return nullptr;
 
-  // Store in map for later release
-  AVFrame *rawPtr = framePtr.get();
-  {
-    std::lock_guard<std::mutex> lock(m_PoolMutex);
-    m_ActiveFrames[rawPtr] = framePtr;
+  // An encoder that keeps input frames referenced still owns the pixels;
+  // only then does this allocate
+  if (!PoolTraits<AVFrame>::MakeWritable(frame, m_FramePool->GetParams())) {
+    m_FramePool->Release(frame);
+    return nullptr;
   }
-
-  return rawPtr;
+  return frame;
 }
 
 void HardwareExportManager::ReleaseFrame(AVFrame *frame) {
   if (!frame)
     return;
 
-  std::lock_guard<std::mutex> lock(m_PoolMutex);
-  m_ActiveFrames.erase(frame);
-  // shared_ptr will be destroyed, returning frame to pool
+  if (m_FramePool)
+    m_FramePool->Release(frame);
 }
 
 // ============================================================================
@@ -1019,6 +1308,8 @@ void HardwareExportManager::Cleanup() {
     m_CodecCtx = nullptr;
   }
 
+  m_Audio.reset();
+
   if (m_FormatCtx) {
     if (!(m_FormatCtx->oformat->flags & AVFMT_NOFILE) && m_FormatCtx->pb) {
       avio_closep(&m_FormatCtx->pb);
@@ -1027,15 +1318,27 @@ void HardwareExportManager::Cleanup() {
     m_FormatCtx = nullptr;
   }
 
+  // GPU frames, innermost first. The render thread has exited (see
+  // EncoderThreadFunc) and unregistered the render target from CUDA in its
+  // own GL context, so nothing maps these any more.
+  if (m_StagingFrame)
+    av_frame_free(&m_StagingFrame);
+  m_FramePool.reset(); // Pooled CUDA frames reference the frames context
+  if (m_HwFramesCtx)
+    av_buffer_unref(&m_HwFramesCtx);
+  m_HostPixFmt = AV_PIX_FMT_NONE;
+#ifdef USE_CUDA
+  m_CUDAConverter.reset();
+#endif
+
   if (m_HwDeviceCtx) {
     av_buffer_unref(&m_HwDeviceCtx);
     m_HwDeviceCtx = nullptr;
   }
 
+  // Last: the context the interop image was registered in
   if (m_OffscreenWindow) {
     glfwDestroyWindow(m_OffscreenWindow);
     m_OffscreenWindow = nullptr;
   }
-
-  m_FramePool.reset();
 }
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "../Core/BoundedQueue.h"
+#include "../Core/FramePool.h"
+#include "../Timeline/TimelineSnapshot.h"
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -26,69 +29,18 @@ extern "C" {
 #include <libavutil/hwcontext.h>
 #include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
+#ifdef USE_CUDA
+#include <libavutil/hwcontext_cuda.h>
+#endif
 }
 
 // Forward declarations
+class ExportAudioMixer;
 class TimelineManager;
 class VideoPlayer;
+class SharedFrameCache;
 struct GLFWwindow;
 
-/**
- * @brief Buffer Pool for efficient memory reuse
- *
- * Template class that manages a pool of reusable objects to avoid
- * frequent allocations/deallocations. Uses smart pointers for automatic
- * lifetime management.
- */
-template <typename T> class BufferPool {
-public:
-  using Deleter = std::function<void(T *)>;
-
-  BufferPool(size_t initialSize, std::function<T *()> allocator,
-             Deleter deleter)
-      : m_Allocator(allocator), m_Deleter(deleter) {
-    for (size_t i = 0; i < initialSize; ++i) {
-      m_Pool.push(allocator());
-    }
-  }
-
-  ~BufferPool() {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    while (!m_Pool.empty()) {
-      m_Deleter(m_Pool.front());
-      m_Pool.pop();
-    }
-  }
-
-  std::shared_ptr<T> Acquire() {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    T *obj = nullptr;
-
-    if (!m_Pool.empty()) {
-      obj = m_Pool.front();
-      m_Pool.pop();
-    } else {
-      obj = m_Allocator();
-    }
-
-    // Custom deleter returns object to pool
-    return std::shared_ptr<T>(obj, [this](T *p) { Release(p); });
-  }
-
-private:
-  void Release(T *obj) {
-    if (!obj)
-      return;
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    m_Pool.push(obj);
-  }
-
-  std::queue<T *> m_Pool;
-  std::mutex m_Mutex;
-  std::function<T *()> m_Allocator;
-  Deleter m_Deleter;
-};
-
 /**
  * @brief Hardware-Accelerated Video Export Manager
  *
@@ -114,7 +66,8 @@ public:
    */
   enum class Codec {
     H264, ///< H.264/AVC - Better compatibility
-    H265  ///< H.265/HEVC - Better compression, higher quality
+    H265, ///< H.265/HEVC - Better compression, higher quality
+    AV1   ///< AV1 - Best compression (NVENC on RTX 40+, else SVT-AV1)
   };
 
   /**
@@ -143,6 +96,20 @@ public:
     int quality = 23;                ///< CQP quality (18-28, lower=better)
     int preset = 1;                  ///< NVENC preset (1=fastest, 7=slowest)
     bool enableHardwareAccel = true; ///< Use NVENC if available
+
+    // Segment export (see SegmentedExportManager)
+    int startFrame = 0;     ///< First timeline frame to render
+    int endFrame = -1;      ///< End frame (exclusive), -1 = timeline end
+    int gopSize = 0;        ///< Keyframe interval, 0 = 2 seconds
+    bool closedGOP = false; ///< No references across GOP boundaries
+    int threads = 0;        ///< Encoder threads, 0 = auto
+
+    // Audio (see ExportAudioMixer)
+    bool exportAudio = true;       ///< AAC mix of every track
+    bool normalizeLoudness = true; ///< Per-clip gain to targetLoudness
+    float targetLoudness = -14.0f; ///< LUFS
+    float truePeakCeiling = -1.0f; ///< dBTP
+    int64_t audioBitrate = 192000;
   };
 
   /**
@@ -156,12 +123,31 @@ public:
     float grain = 0.0f;
     float aberration = 0.0f;
     bool sepia = false;
-    int filterType = 0; // 0 = None, 1-15 = Various filters
+    int filterType = 0;  // 0 = None, 1-15 = Various filters
+    std::string lutPath; // Imported .cube LUT, empty = none
   };
 
+  /**
+   * @param timeline Live timeline, snapshotted by each StartExport(); may be
+   * null when SetTimelineSnapshot() provides the timeline instead
+   */
   HardwareExportManager(TimelineManager *timeline, VideoPlayer *player);
   ~HardwareExportManager();
 
+  static int GetGopSize(const Config &config) {
+    return config.gopSize > 0 ? config.gopSize : config.fps * 2;
+  }
+
+  /**
+   * @brief Audio stream for @p config, or null if it exports no audio
+   *
+   * Covers frames [firstFrame, endFrame) of @p timeline. The caller opens
+   * it on its muxer before writing the header.
+   */
+  static std::unique_ptr<ExportAudioMixer>
+  CreateAudioMixer(const Config &config, TimelineSnapshotPtr timeline,
+                   int firstFrame, int endFrame);
+
   // Initialization
   bool Initialize(const Config &config);
 
@@ -178,14 +164,64 @@ public:
   bool IsExporting() const { return m_IsExporting; }
   bool IsFinished() const { return m_IsFinished; }
   const std::string &GetErrorMessage() const { return m_ErrorMessage; }
+  bool IsCancelled() const { return m_CancelRequested; }
+
+  // Throughput
+  int64_t GetEncodedFrames() const { return m_FrameCount; }
+  double GetElapsedSeconds() const;
+  double GetEncodeFPS() const;
+  const Config &GetConfig() const { return m_Config; }
+
+  /**
+   * @brief Encoder in use and, for CPU encoders, its tuning
+   *
+   * Empty until the encoder thread has opened the codec.
+   */
+  std::string GetEncoderDescription() const {
+    return m_EncoderReady ? m_EncoderDescription : std::string();
+  }
+
+  /**
+   * @brief Render -> encoder queue occupancy and stall times
+   *
+   * High pushStallSeconds: the encoder is the bottleneck. High
+   * popStallSeconds: the encoder waits on rendering.
+   */
+  BoundedQueue<AVFrame *>::Stats GetQueueStats() const {
+    return m_YUVQueue.GetStats();
+  }
+
+  /**
+   * @brief True if frames reach the encoder as GPU surfaces (no host copy
+   * unless the GL interop is unavailable)
+   */
+  bool IsUsingHardwareFrames() const {
+    return m_EncoderReady && m_HwFramesCtx != nullptr;
+  }
 
   // Effect configuration
   void SetEffectParams(const EffectParams &params) { m_EffectParams = params; }
 
+  /**
+   * @brief Export this snapshot instead of one taken at StartExport()
+   *
+   * Segments and queued jobs use it so that all of them render the
+   * timeline as it was when the user pressed Export.
+   */
+  void SetTimelineSnapshot(TimelineSnapshotPtr snapshot) {
+    m_Timeline = std::move(snapshot);
+  }
+
+  // Decoded source frames shared with other concurrent exports (optional)
+  void SetFrameCache(std::shared_ptr<SharedFrameCache> cache) {
+    m_FrameCache = std::move(cache);
+  }
+
 private:
   // Configuration
   Config m_Config;
   TimelineManager *m_TimelineManager;
+  TimelineSnapshotPtr m_Timeline; // What the render thread reads
   VideoPlayer *m_VideoPlayer;
   GLFWwindow *m_MainWindow;
   GLFWwindow *m_OffscreenWindow;
@@ -196,12 +232,17 @@ private:
   std::atomic<bool> m_IsExporting;
   std::atomic<bool> m_IsFinished;
   std::atomic<bool> m_CancelRequested;
+  std::atomic<bool> m_EncoderReady; // Encoder opened, frame pool available
   std::atomic<float> m_Progress;
   std::string m_ErrorMessage;
+  std::chrono::steady_clock::time_point m_StartTime;
+  std::atomic<int64_t> m_EndTimeNs; // steady_clock ns, 0 while running
+
+  std::shared_ptr<SharedFrameCache> m_FrameCache;
 
   // Multi-threaded pipeline (Phase 2: added decode workers)
-  std::thread m_RenderThread;  // Main rendering thread
-  std::thread m_EncoderThread; // Encoding + muxing thread
+  std::thread m_RenderThread;  // Main rendering thread (joined by encoder)
+  std::thread m_EncoderThread; // Encoding + muxing thread, then Cleanup()
 
   // Phase 2: Decode worker pool
   std::vector<std::thread> m_DecodeWorkers;
@@ -231,18 +272,11 @@ private:
   int m_NextFrameToConsume = 0;
 
   // ========== Thread B -> C: YUV Frame Queue ==========
-  struct YUVFrame {
-    AVFrame *frame;
-    bool isStopSignal = false;
-  };
-  std::queue<YUVFrame> m_YUVQueue;
-  std::mutex m_YUVMutex;
-  std::condition_variable m_YUVCondVar;
+  // Closed by the render thread after the last frame (or on cancel)
+  BoundedQueue<AVFrame *> m_YUVQueue;
 
   // ========== Frame Buffer Pool ==========
-  std::unique_ptr<BufferPool<AVFrame>> m_FramePool;
-  std::unordered_map<AVFrame *, std::shared_ptr<AVFrame>> m_ActiveFrames;
-  std::mutex m_PoolMutex;
+  std::unique_ptr<FramePool<AVFrame>> m_FramePool;
 
 #ifdef USE_CUDA
   // Phase 3: CUDA converter for RGB→NV12
@@ -259,32 +293,54 @@ private:
   AVCodecContext *m_CodecCtx;
   const AVCodec *m_Codec;
   AVStream *m_Stream;
+  std::string m_EncoderDescription; // Written before m_EncoderReady
   SwsContext *m_SwsCtx;
   AVPacket *m_Packet;
-  int64_t m_FrameCount;
+  std::atomic<int64_t> m_FrameCount;
+  std::unique_ptr<ExportAudioMixer> m_Audio; // Null without an audio stream
 
   // Hardware acceleration
   AVBufferRef *m_HwDeviceCtx;
   bool m_UsingHardwareAccel;
 
+  // GPU-resident encoder input (NVENC + CUDA): pooled frames are CUDA
+  // surfaces from this context. Written before m_EncoderReady.
+  AVBufferRef *m_HwFramesCtx;
+  AVPixelFormat m_HostPixFmt; // Layout of CPU-converted frames
+  AVFrame *m_StagingFrame;    // Host frame for uploads (render thread)
+
   // Thread functions
   void
   RenderThreadFunc(); // Render frames to RGB (Phase 2: consumes decoded frames)
   void EncoderThreadFunc(); // Encode YUV frames to video file
+  void EncodeFrames();      // Encoder loop, flush and trailer
 
   // Phase 2: Decode worker
   void DecodeWorkerFunc(); // Decode frames in parallel
 
   // Initialization helpers
+  void GetFrameRange(int &firstFrame, int &endFrame) const;
   bool InitializeFFmpeg();
   bool InitializeHardwareAccel();
+  bool InitializeHardwareFrames(); // After InitializeHardwareAccel
   const AVCodec *FindBestCodec();
   bool ConfigureEncoder();
 
   // Frame processing
   AVFrame *AcquireFrame();
   void ReleaseFrame(AVFrame *frame);
-
-  // Cleanup
+  bool SubmitRGBFrame(const uint8_t *rgb, int frameIndex); // Convert + queue
+  bool SubmitBlackFrame(int frameIndex);
+  // GL render target -> CUDA frame, no host copy (needs m_HwFramesCtx and
+  // a registered texture; always false without CUDA)
+  bool SubmitRenderTarget(int frameIndex);
+  // Host memory to fill for a pooled frame: the frame itself, or the
+  // staging frame that FinishHostFrame() uploads into a GPU frame
+  AVFrame *GetHostTarget(AVFrame *frame);
+  bool FinishHostFrame(AVFrame *host, AVFrame *frame);
+  void PushYUVFrame(AVFrame *frame); // Blocks while the queue is full
+  void DrainYUVQueue();              // Return queued frames to the pool
+
+  // Cleanup: only once neither pipeline thread runs
   void Cleanup();
 };
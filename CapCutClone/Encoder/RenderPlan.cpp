@@ -0,0 +1,120 @@
+#include "RenderPlan.h"
+#include <algorithm>
+#include <cmath>
+
+RenderPlan::RenderPlan(const TimelineSnapshot &timeline, double fps,
+                       int firstFrame, int endFrame)
+    : m_FrameDuration(1.0 / fps), m_FirstFrame(firstFrame),
+      m_EndFrame(std::max(firstFrame, endFrame)) {
+  // Frames where anything but the source time can change
+  std::vector<int> cuts = {m_FirstFrame, m_EndFrame};
+  auto addCut = [&](double time) {
+    int frame = FirstFrameAtOrAfter(time);
+    if (frame > m_FirstFrame && frame < m_EndFrame)
+      cuts.push_back(frame);
+  };
+  if (!timeline.tracks.empty()) {
+    for (const Clip &clip : timeline.tracks[0].clips) {
+      addCut(clip.startTime);
+      addCut(clip.GetEndTime());
+    }
+  }
+  for (const EffectLayer &layer : timeline.effectLayers) {
+    addCut(layer.startTime);
+    addCut(layer.GetEndTime());
+  }
+  std::sort(cuts.begin(), cuts.end());
+  cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+  for (size_t c = 0; c + 1 < cuts.size(); ++c) {
+    double time = GetFrameTime(cuts[c]);
+    const Clip *clip = timeline.GetClipAtTime(0, time);
+    std::vector<const EffectLayer *> effects =
+        timeline.GetActiveEffects(time);
+
+    // A cut from a clip on another track or a layer edge that changes
+    // nothing here
+    if (!m_Segments.empty() && m_Segments.back().clip == clip &&
+        m_Segments.back().effects == effects) {
+      m_Segments.back().endFrame = cuts[c + 1];
+      continue;
+    }
+
+    Segment segment;
+    segment.startFrame = cuts[c];
+    segment.endFrame = cuts[c + 1];
+    segment.clip = clip;
+    if (clip) {
+      segment.speed = clip->speed;
+      segment.sourceOffset = clip->inPoint - clip->startTime * clip->speed;
+    }
+    segment.effects = std::move(effects);
+
+    // Same rule as the per-frame loop had: the last blur layer wins
+    for (const EffectLayer *effect : segment.effects) {
+      if (effect->type >= EffectLayer::BLUR_GAUSSIAN &&
+          effect->type <= EffectLayer::BLUR_ZOOM) {
+        auto intensity = effect->params.find("intensity");
+        auto blurType = effect->params.find("blurType");
+        segment.blurAmount =
+            intensity != effect->params.end() ? intensity->second : 0.5f;
+        segment.blurType = blurType != effect->params.end()
+                               ? static_cast<int>(blurType->second)
+                               : 0;
+      }
+    }
+    m_Segments.push_back(std::move(segment));
+  }
+
+  // Decoder actions; the decoder keeps its file across black segments
+  const std::string *openFile = nullptr;
+  for (size_t s = 0; s < m_Segments.size(); ++s) {
+    Segment &segment = m_Segments[s];
+    if (!segment.clip)
+      continue;
+
+    const std::string &file = segment.clip->filepath;
+    if (!openFile || *openFile != file) {
+      segment.action = DecoderAction::Open;
+    } else {
+      // Continuous only if the previous frame came from the same source
+      // and the source time runs on without a jump
+      const Segment *previous = s > 0 ? &m_Segments[s - 1] : nullptr;
+      bool continuous =
+          previous && previous->clip && segment.speed == previous->speed &&
+          std::abs(segment.sourceOffset - previous->sourceOffset) <
+              0.5 * m_FrameDuration;
+      segment.action =
+          continuous ? DecoderAction::Continue : DecoderAction::Seek;
+    }
+    openFile = &file;
+  }
+
+  int nextOpen = -1;
+  for (size_t s = m_Segments.size(); s-- > 0;) {
+    m_Segments[s].nextOpen = nextOpen;
+    if (m_Segments[s].action == DecoderAction::Open)
+      nextOpen = static_cast<int>(s);
+  }
+}
+
+const RenderPlan::Segment *
+RenderPlan::GetPrefetchTarget(size_t segment) const {
+  if (segment >= m_Segments.size() || m_Segments[segment].nextOpen < 0)
+    return nullptr;
+  return &m_Segments[m_Segments[segment].nextOpen];
+}
+
+int RenderPlan::FirstFrameAtOrAfter(double time) const {
+  // Estimate, then settle on the exact frame with the loop's own
+  // arithmetic so rounding cannot move a cut by one frame
+  double estimate = std::ceil(time / m_FrameDuration);
+  int frame = static_cast<int>(
+      std::clamp(estimate, static_cast<double>(m_FirstFrame),
+                 static_cast<double>(m_EndFrame)));
+  while (frame > m_FirstFrame && GetFrameTime(frame - 1) >= time)
+    --frame;
+  while (frame < m_EndFrame && GetFrameTime(frame) < time)
+    ++frame;
+  return frame;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../Timeline/TimelineSnapshot.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Export timeline compiled into a run-length frame schedule
+ *
+ * Splits the frame range at every frame where the main-track clip or the
+ * set of active effect layers changes. Inside a segment nothing but the
+ * source time moves, so the render loop looks up the clip, the effects
+ * and the decoder action once per segment instead of once per frame.
+ *
+ * Frame times use the same expression as the render loop
+ * (frame * (1.0 / fps)), so a frame lands in the same clip it would have
+ * with a per-frame GetClipAtTime() query.
+ *
+ * Pointers refer into the snapshot, which must outlive the plan.
+ */
+class RenderPlan {
+public:
+  /// What the decoder has to do before the first frame of a segment
+  enum class DecoderAction {
+    None,     ///< No clip: black frames, decoder untouched
+    Continue, ///< Same file, source time continues: keep decoding forward
+    Seek,     ///< File already open, source time jumps
+    Open      ///< Different file: load it, then seek
+  };
+
+  struct Segment {
+    int startFrame = 0;
+    int endFrame = 0;           ///< Exclusive
+    const Clip *clip = nullptr; ///< Main-track clip, null = black
+    double sourceOffset = 0.0;  ///< See GetSourceTime()
+    double speed = 1.0;         ///< Source seconds per timeline second
+    std::vector<const EffectLayer *> effects; ///< Active, in apply order
+    float blurAmount = 0.0f;    ///< Resolved from the last blur layer
+    int blurType = 0;
+    DecoderAction action = DecoderAction::None;
+    int nextOpen = -1; ///< Next segment with DecoderAction::Open, -1 if none
+
+    double GetSourceTime(double time) const {
+      return time * speed + sourceOffset;
+    }
+  };
+
+  RenderPlan(const TimelineSnapshot &timeline, double fps, int firstFrame,
+             int endFrame);
+
+  const std::vector<Segment> &GetSegments() const { return m_Segments; }
+  double GetFrameTime(int frame) const { return frame * m_FrameDuration; }
+
+  /**
+   * @brief Segment whose decoder can be opened ahead of time
+   *
+   * The first segment after @p segment that switches to another file, or
+   * nullptr. Lets a prefetcher open and pre-roll the next source while the
+   * current segment renders.
+   */
+  const Segment *GetPrefetchTarget(size_t segment) const;
+
+private:
+  int FirstFrameAtOrAfter(double time) const;
+
+  std::vector<Segment> m_Segments;
+  double m_FrameDuration;
+  int m_FirstFrame;
+  int m_EndFrame;
+};
@@ -0,0 +1,586 @@
+#include "SegmentedExportManager.h"
+#include "ExportAudioMixer.h"
+#include "../Timeline/TimelineManager.h"
+#include "SmartRenderPlanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+extern "C" {
+#include <libavcodec/bsf.h>
+}
+
+// ============================================================================
+// Constructor / Destructor
+// ============================================================================
+
+SegmentedExportManager::SegmentedExportManager(TimelineManager *timeline)
+    : m_TimelineManager(timeline), m_MainWindow(nullptr), m_SegmentCount(0),
+      m_SmartRender(false), m_ThreadsPerSegment(0), m_NextPipeline(0),
+      m_IsExporting(false), m_IsFinished(false), m_CancelRequested(false),
+      m_StitchProgress(0.0f) {}
+
+SegmentedExportManager::~SegmentedExportManager() {
+  CancelExport();
+  if (m_StitchThread.joinable())
+    m_StitchThread.join();
+
+  std::lock_guard<std::mutex> lock(m_PipelineMutex);
+  m_Pipelines.clear(); // Joins segment threads
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+
+bool SegmentedExportManager::Initialize(
+    const HardwareExportManager::Config &config, int segmentCount) {
+  if (config.width <= 0 || config.height <= 0 || config.fps <= 0) {
+    m_ErrorMessage = "Invalid export dimensions or FPS";
+    return false;
+  }
+
+  m_Config = config;
+  // Same rounding as HardwareExportManager::Initialize, so copied ranges
+  // are compared against the size the encoded ranges will have
+  m_Config.width = (m_Config.width + 1) & ~1;
+  m_Config.height = (m_Config.height + 1) & ~1;
+
+  m_SegmentCount = segmentCount > 0 ? segmentCount : GetAutoSegmentCount();
+  return true;
+}
+
+int SegmentedExportManager::GetAutoSegmentCount() {
+  // Leave each segment a few cores for its encoder threads
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(2, std::min(8, cores / 4));
+}
+
+std::vector<SegmentedExportManager::Segment>
+SegmentedExportManager::PlanSegments(int totalFrames, int gopSize,
+                                     int segmentCount) {
+  std::vector<Segment> segments;
+  if (totalFrames <= 0)
+    return segments;
+
+  gopSize = std::max(1, gopSize);
+  segmentCount = std::max(1, segmentCount);
+
+  // Whole GOPs per segment so every boundary falls on a keyframe
+  int gops = (totalFrames + gopSize - 1) / gopSize;
+  int gopsPerSegment = std::max(1, (gops + segmentCount - 1) / segmentCount);
+  int framesPerSegment = gopsPerSegment * gopSize;
+
+  for (int start = 0; start < totalFrames; start += framesPerSegment) {
+    Segment segment;
+    segment.startFrame = start;
+    segment.endFrame = std::min(totalFrames, start + framesPerSegment);
+    segments.push_back(segment);
+  }
+  return segments;
+}
+
+// ============================================================================
+// Export Control
+// ============================================================================
+
+bool SegmentedExportManager::StartExport() {
+  if (m_IsExporting)
+    return false;
+
+  if (m_StitchThread.joinable())
+    m_StitchThread.join();
+
+  std::lock_guard<std::mutex> lock(m_PipelineMutex);
+  m_Pipelines.clear();
+
+  m_IsFinished = false;
+  m_CancelRequested = false;
+  m_StitchProgress = 0.0f;
+  m_ErrorMessage.clear();
+
+  // All segments render the timeline as it was when export started
+  m_Timeline = m_TimelineManager->GetSnapshot();
+
+  // Same frame count as HardwareExportManager::RenderThreadFunc
+  double duration = m_Timeline->totalDuration;
+  if (duration <= 0.001)
+    duration = 1.0;
+  int totalFrames = static_cast<int>(duration * m_Config.fps);
+  int gopSize = HardwareExportManager::GetGopSize(m_Config);
+
+  m_Segments.clear();
+  if (m_SmartRender) {
+    SmartRenderPlanner planner(m_Timeline);
+    auto plan = planner.Plan(m_Config, m_EffectParams, totalFrames);
+
+    int encodeFrames = 0;
+    for (const auto &range : plan)
+      if (!range.copy)
+        encodeFrames += range.endFrame - range.startFrame;
+
+    // Long encode ranges are still split for parallelism
+    int targetFrames =
+        std::max(gopSize, (encodeFrames + m_SegmentCount - 1) /
+                              std::max(1, m_SegmentCount));
+
+    for (const auto &range : plan) {
+      if (range.copy) {
+        Segment segment;
+        segment.startFrame = range.startFrame;
+        segment.endFrame = range.endFrame;
+        segment.copy = true;
+        segment.sourceFile = range.sourceFile;
+        segment.sourceStart = range.sourceStart;
+        segment.sourceEnd = range.sourceEnd;
+        m_Segments.push_back(segment);
+        continue;
+      }
+
+      int length = range.endFrame - range.startFrame;
+      int pieces = (length + targetFrames - 1) / targetFrames;
+      for (Segment segment : PlanSegments(length, gopSize, pieces)) {
+        segment.startFrame += range.startFrame;
+        segment.endFrame += range.startFrame;
+        m_Segments.push_back(segment);
+      }
+    }
+  } else {
+    m_Segments = PlanSegments(totalFrames, gopSize, m_SegmentCount);
+  }
+
+  int encodeSegments = 0;
+  for (size_t s = 0; s < m_Segments.size(); ++s) {
+    if (m_Segments[s].copy)
+      continue;
+    m_Segments[s].file =
+        m_Config.outputFile + ".seg" + std::to_string(s) + ".mp4";
+    encodeSegments++;
+  }
+
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  int concurrent = std::max(1, std::min(m_SegmentCount, encodeSegments));
+  m_ThreadsPerSegment = std::max(1, cores / concurrent);
+
+  std::cout << "[SegmentedExport] " << totalFrames << " frames in "
+            << m_Segments.size() << " segments (" << encodeSegments
+            << " encoded), " << m_ThreadsPerSegment
+            << " encoder threads each" << std::endl;
+
+  // Start the first batch; Update() starts the rest as slots free up
+  m_Pipelines.resize(m_Segments.size());
+  m_NextPipeline = 0;
+  int started = 0;
+  while (started < m_SegmentCount && m_NextPipeline < m_Segments.size()) {
+    size_t index = m_NextPipeline++;
+    if (m_Segments[index].copy)
+      continue;
+    if (!StartPipeline(index)) {
+      for (auto &pipeline : m_Pipelines)
+        if (pipeline)
+          pipeline->CancelExport();
+      m_Pipelines.clear(); // Joins the segments already started
+      RemoveSegmentFiles();
+      m_IsFinished = true;
+      return false;
+    }
+    started++;
+  }
+
+  m_IsExporting = true;
+  m_StitchThread = std::thread(&SegmentedExportManager::StitchThreadFunc, this);
+  return true;
+}
+
+bool SegmentedExportManager::StartPipeline(size_t index) {
+  const Segment &segment = m_Segments[index];
+
+  HardwareExportManager::Config config = m_Config;
+  config.outputFile = segment.file;
+  config.startFrame = segment.startFrame;
+  config.endFrame = segment.endFrame;
+  config.closedGOP = true;
+  config.enableHardwareAccel = false;
+  config.threads = m_ThreadsPerSegment;
+  config.exportAudio = false; // Mixed once by the stitch thread
+
+  auto pipeline = std::make_unique<HardwareExportManager>(nullptr, nullptr);
+  pipeline->SetTimelineSnapshot(m_Timeline);
+  pipeline->SetMainWindow(m_MainWindow);
+  pipeline->SetEffectParams(m_EffectParams);
+
+  if (!pipeline->Initialize(config) || !pipeline->StartExport()) {
+    m_ErrorMessage = "Segment " + std::to_string(index) +
+                     " failed to start: " + pipeline->GetErrorMessage();
+    std::cerr << "[SegmentedExport] " << m_ErrorMessage << std::endl;
+    return false;
+  }
+
+  m_Pipelines[index] = std::move(pipeline);
+  return true;
+}
+
+void SegmentedExportManager::Update() {
+  if (!m_IsExporting || m_CancelRequested)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_PipelineMutex);
+  int running = 0;
+  for (const auto &pipeline : m_Pipelines)
+    if (pipeline && (pipeline->IsExporting() || !pipeline->IsFinished()))
+      running++;
+
+  while (running < m_SegmentCount && m_NextPipeline < m_Segments.size()) {
+    size_t index = m_NextPipeline++;
+    if (m_Segments[index].copy)
+      continue;
+    if (!StartPipeline(index)) {
+      m_CancelRequested = true; // Stitch thread cleans up
+      for (auto &pipeline : m_Pipelines)
+        if (pipeline)
+          pipeline->CancelExport();
+      return;
+    }
+    running++;
+  }
+}
+
+void SegmentedExportManager::CancelExport() {
+  m_CancelRequested = true;
+  std::lock_guard<std::mutex> lock(m_PipelineMutex);
+  for (auto &pipeline : m_Pipelines)
+    if (pipeline)
+      pipeline->CancelExport();
+}
+
+float SegmentedExportManager::GetProgress() const {
+  std::lock_guard<std::mutex> lock(m_PipelineMutex);
+  if (m_Pipelines.empty())
+    return m_IsFinished ? 1.0f : 0.0f;
+
+  // Rendering dominates; stitching is a fast remux. Weight by frames.
+  double done = 0.0;
+  double total = 0.0;
+  for (size_t s = 0; s < m_Segments.size(); ++s) {
+    if (m_Segments[s].copy)
+      continue;
+    double frames = m_Segments[s].endFrame - m_Segments[s].startFrame;
+    total += frames;
+    if (m_Pipelines[s])
+      done += frames * m_Pipelines[s]->GetProgress();
+  }
+  float render = total > 0.0 ? static_cast<float>(done / total) : 1.0f;
+  return render * 0.95f + m_StitchProgress * 0.05f;
+}
+
+int SegmentedExportManager::GetCopiedFrames() const {
+  int frames = 0;
+  for (const auto &segment : m_Segments)
+    if (segment.copy)
+      frames += segment.endFrame - segment.startFrame;
+  return frames;
+}
+
+int SegmentedExportManager::GetTotalFrames() const {
+  return m_Segments.empty() ? 0 : m_Segments.back().endFrame;
+}
+
+// ============================================================================
+// Stitch Thread
+// ============================================================================
+
+void SegmentedExportManager::StitchThreadFunc() {
+  // Wait for all encode segments
+  bool failed = false;
+  while (!m_CancelRequested) {
+    bool allDone = true;
+    {
+      std::lock_guard<std::mutex> lock(m_PipelineMutex);
+      if (m_NextPipeline < m_Segments.size())
+        allDone = false; // Not all started yet
+
+      for (const auto &pipeline : m_Pipelines) {
+        if (!pipeline)
+          continue;
+        if (pipeline->IsExporting() || !pipeline->IsFinished()) {
+          allDone = false;
+        } else if (!pipeline->GetErrorMessage().empty()) {
+          m_ErrorMessage = pipeline->GetErrorMessage();
+          failed = true;
+        }
+      }
+      if (failed) {
+        for (auto &pipeline : m_Pipelines)
+          if (pipeline)
+            pipeline->CancelExport();
+      }
+    }
+    if (failed || allDone)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  if (!failed && !m_CancelRequested) {
+    std::string error;
+    auto audio = HardwareExportManager::CreateAudioMixer(
+        m_Config, m_Timeline, 0,
+        m_Segments.empty() ? 0 : m_Segments.back().endFrame);
+    if (!ConcatSegments(m_Segments, m_Config.fps, m_Config.outputFile, error,
+                        m_SmartRender, &m_StitchProgress, &m_CancelRequested,
+                        audio.get())) {
+      m_ErrorMessage = error;
+    }
+  }
+
+  // Segment pipelines may still be shutting down after a cancel
+  while (true) {
+    bool stopped = true;
+    {
+      std::lock_guard<std::mutex> lock(m_PipelineMutex);
+      for (const auto &pipeline : m_Pipelines)
+        if (pipeline && pipeline->IsExporting())
+          stopped = false;
+    }
+    if (stopped)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  RemoveSegmentFiles();
+
+  m_StitchProgress = 1.0f;
+  m_IsExporting = false;
+  m_IsFinished = true;
+
+  std::cout << "[SegmentedExport] Finished"
+            << (m_ErrorMessage.empty() ? "" : " with error: ")
+            << m_ErrorMessage << std::endl;
+}
+
+void SegmentedExportManager::RemoveSegmentFiles() {
+  for (const auto &segment : m_Segments) {
+    if (!segment.copy && !segment.file.empty())
+      std::remove(segment.file.c_str());
+  }
+}
+
+// ============================================================================
+// Concat Remux
+// ============================================================================
+
+bool SegmentedExportManager::ConcatSegments(
+    const std::vector<Segment> &segments, int fps,
+    const std::string &outputFile, std::string &error, bool inBandHeaders,
+    std::atomic<float> *progress, const std::atomic<bool> *cancel,
+    ExportAudioMixer *audio) {
+  AVFormatContext *outCtx = nullptr;
+  avformat_alloc_output_context2(&outCtx, nullptr, nullptr,
+                                 outputFile.c_str());
+  if (!outCtx)
+    avformat_alloc_output_context2(&outCtx, nullptr, "mp4", outputFile.c_str());
+  if (!outCtx) {
+    error = "Failed to create output context";
+    return false;
+  }
+
+  AVStream *outStream = nullptr;
+  AVPacket *packet = av_packet_alloc();
+  int64_t lastDts = AV_NOPTS_VALUE;
+  bool ok = true;
+
+  for (size_t s = 0; s < segments.size() && ok; ++s) {
+    if (cancel && *cancel) {
+      error = "Cancelled";
+      ok = false;
+      break;
+    }
+
+    const Segment &segment = segments[s];
+    const std::string &inputFile =
+        segment.copy ? segment.sourceFile : segment.file;
+    AVFormatContext *inCtx = nullptr;
+    if (avformat_open_input(&inCtx, inputFile.c_str(), nullptr, nullptr) <
+            0 ||
+        avformat_find_stream_info(inCtx, nullptr) < 0) {
+      error = "Could not open segment: " + inputFile;
+      if (inCtx)
+        avformat_close_input(&inCtx);
+      ok = false;
+      break;
+    }
+
+    int videoIndex =
+        av_find_best_stream(inCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex < 0) {
+      error = "No video stream in segment: " + inputFile;
+      avformat_close_input(&inCtx);
+      ok = false;
+      break;
+    }
+    AVStream *inStream = inCtx->streams[videoIndex];
+
+    if (!outStream) {
+      // Stream parameters (incl. SPS/PPS) come from the first segment
+      outStream = avformat_new_stream(outCtx, nullptr);
+      avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+      outStream->codecpar->codec_tag = 0;
+      outStream->time_base = inStream->time_base;
+
+      if (!(outCtx->oformat->flags & AVFMT_NOFILE) &&
+          avio_open(&outCtx->pb, outputFile.c_str(), AVIO_FLAG_WRITE) < 0) {
+        error = "Could not open output file: " + outputFile;
+        avformat_close_input(&inCtx);
+        ok = false;
+        break;
+      }
+      if (audio && !audio->Open(outCtx)) {
+        std::cerr << "[SegmentedExport] Stitching without audio" << std::endl;
+        audio = nullptr;
+      }
+      if (avformat_write_header(outCtx, nullptr) < 0) {
+        error = "Error writing file header";
+        avformat_close_input(&inCtx);
+        ok = false;
+        break;
+      }
+    } else if (!inBandHeaders) {
+      const AVCodecParameters *first = outStream->codecpar;
+      const AVCodecParameters *current = inStream->codecpar;
+      if (first->extradata_size != current->extradata_size ||
+          (first->extradata_size > 0 &&
+           memcmp(first->extradata, current->extradata,
+                  first->extradata_size) != 0)) {
+        std::cerr << "[SegmentedExport] Warning: segment " << s
+                  << " has different codec headers" << std::endl;
+      }
+    }
+
+    // Segment timestamps start at 0; place them at their timeline frame
+    // (after write_header, which may have changed the output time base)
+    int64_t offset = av_rescale_q(segment.startFrame, AVRational{1, fps},
+                                  outStream->time_base);
+
+    // Copied range: from its IDR up to (not including) the next GOP
+    int64_t rangeStart = 0;
+    int64_t rangeEnd = INT64_MAX;
+    if (segment.copy) {
+      double timeBase = av_q2d(inStream->time_base);
+      rangeStart = std::llround(segment.sourceStart / timeBase);
+      rangeEnd = std::llround(segment.sourceEnd / timeBase);
+      av_seek_frame(inCtx, videoIndex, rangeStart, AVSEEK_FLAG_BACKWARD);
+    }
+
+    // Copied and encoded parts have different SPS/PPS: repeat them in-band
+    AVBSFContext *bsf = nullptr;
+    if (inBandHeaders) {
+      const AVBitStreamFilter *filter = av_bsf_get_by_name("dump_extra");
+      if (filter && av_bsf_alloc(filter, &bsf) >= 0) {
+        avcodec_parameters_copy(bsf->par_in, inStream->codecpar);
+        bsf->time_base_in = inStream->time_base;
+        if (av_bsf_init(bsf) < 0)
+          av_bsf_free(&bsf);
+      }
+    }
+
+    auto writePacket = [&](AVPacket *pkt) {
+      if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts -= rangeStart;
+      if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts -= rangeStart;
+      av_packet_rescale_ts(pkt, inStream->time_base, outStream->time_base);
+      if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts += offset;
+      if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts += offset;
+
+      // Reordering delay is identical across encoded segments, so DTS stays
+      // monotonic. A regression means the segments do not line up (offset
+      // or range wrong): fail rather than shift timestamps and desync audio
+      if (lastDts != AV_NOPTS_VALUE && pkt->dts != AV_NOPTS_VALUE &&
+          pkt->dts <= lastDts) {
+        error = "Non-monotonic DTS in segment " + std::to_string(s) + " (" +
+                std::to_string(pkt->dts) + " after " +
+                std::to_string(lastDts) + ")";
+        return false;
+      }
+      if (pkt->dts != AV_NOPTS_VALUE)
+        lastDts = pkt->dts;
+
+      pkt->stream_index = outStream->index;
+      pkt->pos = -1;
+      int64_t dts = pkt->dts;
+      if (av_interleaved_write_frame(outCtx, pkt) < 0) {
+        error = "Error writing packet";
+        return false;
+      }
+
+      // Audio up to the video just written
+      if (audio && dts != AV_NOPTS_VALUE &&
+          !audio->EncodeUntil(dts * av_q2d(outStream->time_base))) {
+        std::cerr << "[SegmentedExport] Audio encoding failed, dropping audio"
+                  << std::endl;
+        audio = nullptr;
+      }
+      return true;
+    };
+
+    while (ok && av_read_frame(inCtx, packet) >= 0) {
+      if (packet->stream_index != videoIndex) {
+        av_packet_unref(packet);
+        continue;
+      }
+
+      if (segment.copy && packet->pts != AV_NOPTS_VALUE) {
+        if (packet->pts < rangeStart) { // Seek landed on an earlier GOP
+          av_packet_unref(packet);
+          continue;
+        }
+        if (packet->pts >= rangeEnd) // Next GOP starts here
+          break;
+      }
+
+      if (!bsf) {
+        ok = writePacket(packet);
+        continue;
+      }
+
+      if (av_bsf_send_packet(bsf, packet) < 0) {
+        av_packet_unref(packet);
+        continue;
+      }
+      while (ok && av_bsf_receive_packet(bsf, packet) >= 0)
+        ok = writePacket(packet);
+    }
+
+    if (bsf) {
+      // Drain the filter
+      av_bsf_send_packet(bsf, nullptr);
+      while (ok && av_bsf_receive_packet(bsf, packet) >= 0)
+        ok = writePacket(packet);
+      av_bsf_free(&bsf);
+    }
+    av_packet_unref(packet);
+    avformat_close_input(&inCtx);
+
+    if (progress)
+      *progress = static_cast<float>(s + 1) / segments.size();
+  }
+
+  if (ok && outStream) {
+    if (audio)
+      audio->Finish();
+    av_write_trailer(outCtx);
+  }
+
+  av_packet_free(&packet);
+  if (!(outCtx->oformat->flags & AVFMT_NOFILE) && outCtx->pb)
+    avio_closep(&outCtx->pb);
+  avformat_free_context(outCtx);
+
+  if (ok)
+    std::cout << "[SegmentedExport] Stitched " << segments.size()
+              << " segments into " << outputFile << std::endl;
+  return ok;
+}
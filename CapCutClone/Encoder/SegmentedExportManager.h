@@ -0,0 +1,128 @@
+#pragma once
+
+#include "../Timeline/TimelineSnapshot.h"
+#include "HardwareExportManager.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ExportAudioMixer;
+class TimelineManager;
+struct GLFWwindow;
+
+/**
+ * @brief Segment-parallel export
+ *
+ * Splits the timeline at GOP boundaries into K frame ranges. Every range
+ * runs its own HardwareExportManager pipeline (render + encode) into a
+ * temporary file with closed GOPs. When all segments are done a stitch
+ * thread remuxes them into the final container without re-encoding,
+ * shifting each segment's timestamps by its first timeline frame.
+ *
+ * With smart render enabled, untouched clip ranges found by
+ * SmartRenderPlanner become copy segments: their source packets are
+ * remuxed directly and only the ranges around cuts and effects are
+ * encoded. Parameter sets are then repeated in-band at every keyframe,
+ * since copied and encoded parts carry different SPS/PPS.
+ *
+ * Segments always use the CPU encoder: hardware encoders cap concurrent
+ * sessions, and all segments must produce identical stream parameters to
+ * be concatenated.
+ *
+ * Segments are rendered without audio. The stitch thread mixes and
+ * encodes the audio of the whole range once, while it remuxes the video,
+ * so there are no encoder-priming gaps at segment joins.
+ */
+class SegmentedExportManager {
+public:
+  struct Segment {
+    int startFrame = 0;
+    int endFrame = 0; ///< Exclusive
+    std::string file;
+
+    // Copy segment: packets come straight from the source file
+    bool copy = false;
+    std::string sourceFile;
+    double sourceStart = 0.0; ///< Seconds, IDR frame
+    double sourceEnd = 0.0;   ///< Seconds, exclusive
+  };
+
+  explicit SegmentedExportManager(TimelineManager *timeline);
+  ~SegmentedExportManager();
+
+  void SetMainWindow(GLFWwindow *mainWindow) { m_MainWindow = mainWindow; }
+  void SetEffectParams(const HardwareExportManager::EffectParams &params) {
+    m_EffectParams = params;
+  }
+  void SetSmartRender(bool enabled) { m_SmartRender = enabled; }
+
+  /**
+   * @param segmentCount Number of parallel segments, 0 = from CPU count
+   */
+  bool Initialize(const HardwareExportManager::Config &config,
+                  int segmentCount = 0);
+
+  // Export control (StartExport and Update must run on the main thread)
+  bool StartExport();
+  void Update(); // Starts queued segment pipelines as others finish
+  void CancelExport();
+
+  // Status queries
+  float GetProgress() const;
+  bool IsExporting() const { return m_IsExporting; }
+  bool IsFinished() const { return m_IsFinished; }
+  const std::string &GetErrorMessage() const { return m_ErrorMessage; }
+  const std::vector<Segment> &GetSegments() const { return m_Segments; }
+  int GetCopiedFrames() const;
+  int GetTotalFrames() const;
+
+  /**
+   * @brief Split [0, totalFrames) into up to segmentCount GOP-aligned ranges
+   */
+  static std::vector<Segment> PlanSegments(int totalFrames, int gopSize,
+                                           int segmentCount);
+  static int GetAutoSegmentCount();
+
+  /**
+   * @brief Remux segment files into one container (no re-encode)
+   * @param inBandHeaders Repeat SPS/PPS at keyframes (dump_extra)
+   * @param progress Optional, receives 0..1 per finished segment
+   * @param audio Optional audio stream, interleaved with the video
+   */
+  static bool ConcatSegments(const std::vector<Segment> &segments, int fps,
+                             const std::string &outputFile,
+                             std::string &error, bool inBandHeaders = false,
+                             std::atomic<float> *progress = nullptr,
+                             const std::atomic<bool> *cancel = nullptr,
+                             ExportAudioMixer *audio = nullptr);
+
+private:
+  bool StartPipeline(size_t index);
+  void StitchThreadFunc();
+  void RemoveSegmentFiles();
+
+  TimelineManager *m_TimelineManager;
+  TimelineSnapshotPtr m_Timeline; // Shared by every segment pipeline
+  GLFWwindow *m_MainWindow;
+  HardwareExportManager::Config m_Config;
+  HardwareExportManager::EffectParams m_EffectParams;
+  int m_SegmentCount;
+  bool m_SmartRender;
+  int m_ThreadsPerSegment;
+
+  std::vector<Segment> m_Segments;
+  // One entry per segment; null for copy segments and not-yet-started ones
+  std::vector<std::unique_ptr<HardwareExportManager>> m_Pipelines;
+  size_t m_NextPipeline; // Next encode segment to start
+  mutable std::mutex m_PipelineMutex;
+  std::thread m_StitchThread;
+
+  std::atomic<bool> m_IsExporting;
+  std::atomic<bool> m_IsFinished;
+  std::atomic<bool> m_CancelRequested;
+  std::atomic<float> m_StitchProgress;
+  std::string m_ErrorMessage;
+};
@@ -0,0 +1,72 @@
+#include "SharedFrameCache.h"
+#include <cstring>
+
+SharedFrameCache::SharedFrameCache(size_t maxBytes)
+    : m_MaxBytes(maxBytes), m_Bytes(0), m_Hits(0), m_Misses(0) {}
+
+SharedFrameCache::FramePtr SharedFrameCache::Lookup(const std::string &filepath,
+                                                    int64_t frameIndex) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Entries.find(Key{filepath, frameIndex});
+  if (it == m_Entries.end()) {
+    m_Misses++;
+    return nullptr;
+  }
+
+  // Touch: move to front of LRU list
+  m_LRU.splice(m_LRU.begin(), m_LRU, it->second.lruIt);
+  m_Hits++;
+  return it->second.frame;
+}
+
+void SharedFrameCache::Insert(const std::string &filepath, int64_t frameIndex,
+                              const uint8_t *rgb, int width, int height) {
+  if (!rgb || width <= 0 || height <= 0)
+    return;
+
+  size_t size = static_cast<size_t>(width) * height * 3;
+  if (size > m_MaxBytes)
+    return;
+
+  // Copy outside the lock - this is the expensive part
+  auto frame = std::make_shared<Frame>();
+  frame->rgb.resize(size);
+  memcpy(frame->rgb.data(), rgb, size);
+  frame->width = width;
+  frame->height = height;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Key key{filepath, frameIndex};
+  if (m_Entries.count(key))
+    return; // Another job published it first
+
+  m_LRU.push_front(key);
+  m_Entries.emplace(std::move(key), Entry{std::move(frame), m_LRU.begin()});
+  m_Bytes += size;
+
+  EvictLocked();
+}
+
+void SharedFrameCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Entries.clear();
+  m_LRU.clear();
+  m_Bytes = 0;
+}
+
+void SharedFrameCache::SetMaxBytes(size_t maxBytes) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MaxBytes = maxBytes;
+  EvictLocked();
+}
+
+void SharedFrameCache::EvictLocked() {
+  while (m_Bytes > m_MaxBytes && !m_LRU.empty()) {
+    auto it = m_Entries.find(m_LRU.back());
+    if (it != m_Entries.end()) {
+      m_Bytes -= it->second.frame->rgb.size();
+      m_Entries.erase(it);
+    }
+    m_LRU.pop_back();
+  }
+}
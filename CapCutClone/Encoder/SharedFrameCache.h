@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Decoded source frame cache shared between concurrent exports
+ *
+ * Batch renders of the same template read the same media at the same
+ * source times. The first job that decodes a frame publishes its RGB24
+ * pixels here; the other jobs pick them up instead of decoding again.
+ * Frames are immutable once inserted and handed out as shared_ptr, so a
+ * reader keeps its frame alive even if it is evicted meanwhile.
+ *
+ * Eviction is LRU bounded by total pixel bytes. All methods are thread-safe.
+ */
+class SharedFrameCache {
+public:
+  struct Frame {
+    std::vector<uint8_t> rgb; ///< RGB24, tightly packed
+    int width = 0;
+    int height = 0;
+  };
+  using FramePtr = std::shared_ptr<const Frame>;
+
+  explicit SharedFrameCache(size_t maxBytes = 512ull * 1024 * 1024);
+
+  /**
+   * @brief Find a decoded frame
+   * @param filepath Source media path
+   * @param frameIndex Source frame index (localTime * sourceFPS)
+   * @return Frame or nullptr on miss
+   */
+  FramePtr Lookup(const std::string &filepath, int64_t frameIndex);
+
+  /**
+   * @brief Publish a decoded frame (copies the pixels)
+   */
+  void Insert(const std::string &filepath, int64_t frameIndex,
+              const uint8_t *rgb, int width, int height);
+
+  /**
+   * @brief Drop all frames (hit/miss counters are kept)
+   */
+  void Clear();
+
+  void SetMaxBytes(size_t maxBytes);
+  size_t GetMaxBytes() const { return m_MaxBytes; }
+  size_t GetBytes() const { return m_Bytes; }
+  uint64_t GetHits() const { return m_Hits; }
+  uint64_t GetMisses() const { return m_Misses; }
+
+private:
+  struct Key {
+    std::string filepath;
+    int64_t frameIndex;
+    bool operator==(const Key &other) const {
+      return frameIndex == other.frameIndex && filepath == other.filepath;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      return std::hash<std::string>()(key.filepath) ^
+             (std::hash<int64_t>()(key.frameIndex) * 0x9E3779B97F4A7C15ull);
+    }
+  };
+  struct Entry {
+    FramePtr frame;
+    std::list<Key>::iterator lruIt;
+  };
+
+  void EvictLocked();
+
+  std::unordered_map<Key, Entry, KeyHash> m_Entries;
+  std::list<Key> m_LRU; // Front = most recently used
+  mutable std::mutex m_Mutex;
+
+  std::atomic<size_t> m_MaxBytes; // Also read by Insert() before the lock
+  std::atomic<size_t> m_Bytes;
+  std::atomic<uint64_t> m_Hits;
+  std::atomic<uint64_t> m_Misses;
+};
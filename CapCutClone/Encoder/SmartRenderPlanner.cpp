@@ -0,0 +1,301 @@
+#include "SmartRenderPlanner.h"
+#include "../Timeline/Clip.h"
+#include "../Timeline/EffectLayer.h"
+#include "../Timeline/Track.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+SmartRenderPlanner::SmartRenderPlanner(TimelineSnapshotPtr timeline)
+    : m_Timeline(std::move(timeline)) {}
+
+bool SmartRenderPlanner::IsNeutral(
+    const HardwareExportManager::EffectParams &effects) {
+  return effects.brightness == 0.0f && effects.contrast == 1.0f &&
+         effects.saturation == 1.0f && effects.vignette == 0.0f &&
+         effects.grain == 0.0f && effects.aberration == 0.0f &&
+         !effects.sepia && effects.filterType == 0 && effects.lutPath.empty();
+}
+
+// ============================================================================
+// Planning
+// ============================================================================
+
+std::vector<SmartRenderPlanner::Range>
+SmartRenderPlanner::Plan(const HardwareExportManager::Config &config,
+                         const HardwareExportManager::EffectParams &effects,
+                         int totalFrames) {
+  std::vector<Range> copyRanges;
+  auto &tracks = m_Timeline->tracks;
+
+  AVCodecID outputCodec = AV_CODEC_ID_HEVC;
+  if (config.codec == HardwareExportManager::Codec::H264)
+    outputCodec = AV_CODEC_ID_H264;
+  else if (config.codec == HardwareExportManager::Codec::AV1)
+    outputCodec = AV_CODEC_ID_AV1;
+  double fps = static_cast<double>(config.fps);
+
+  if (IsNeutral(effects) && !tracks.empty()) {
+    for (const Clip &clip : tracks[0].clips) {
+      if (!IsClipUntouched(clip))
+        continue;
+
+      const SourceInfo &source = Probe(clip.filepath);
+      if (!source.valid || source.codecId != outputCodec ||
+          source.width != config.width || source.height != config.height ||
+          std::abs(source.fps - fps) > 0.01 ||
+          source.pixelFormat != AV_PIX_FMT_YUV420P)
+        continue;
+
+      // First IDR inside the clip, and the last GOP boundary before its end
+      const double eps = 0.25 / fps;
+      double copyStart = -1.0;
+      double copyEnd = -1.0;
+      for (double t : source.idrTimes) {
+        if (copyStart < 0.0 && t >= clip.inPoint - eps)
+          copyStart = t;
+        if (t <= clip.outPoint + eps)
+          copyEnd = t;
+      }
+      // The stream end closes the last GOP
+      if (source.endTime <= clip.outPoint + eps)
+        copyEnd = source.endTime;
+      if (copyStart < 0.0 || copyEnd <= copyStart)
+        continue;
+
+      // Map onto the output frame grid; both ends must land on a frame
+      double startPos = (clip.startTime + copyStart - clip.inPoint) * fps;
+      double endPos = (clip.startTime + copyEnd - clip.inPoint) * fps;
+      int startFrame = static_cast<int>(std::lround(startPos));
+      int endFrame = static_cast<int>(std::lround(endPos));
+      if (std::abs(startPos - startFrame) > 0.01 ||
+          std::abs(endPos - endFrame) > 0.01)
+        continue;
+      endFrame = std::min(endFrame, totalFrames);
+
+      // Not worth a cut for less than a second
+      if (endFrame - startFrame < config.fps)
+        continue;
+
+      Range range;
+      range.startFrame = startFrame;
+      range.endFrame = endFrame;
+      range.copy = true;
+      range.sourceFile = clip.filepath;
+      range.sourceStart = copyStart;
+      range.sourceEnd = copyEnd;
+      copyRanges.push_back(range);
+    }
+  }
+
+  std::sort(copyRanges.begin(), copyRanges.end(),
+            [](const Range &a, const Range &b) {
+              return a.startFrame < b.startFrame;
+            });
+
+  // Fill the gaps between copied ranges with encode ranges
+  std::vector<Range> plan;
+  int cursor = 0;
+  for (const Range &copy : copyRanges) {
+    if (copy.startFrame < cursor)
+      continue; // Overlapping clips on track 0
+    if (copy.startFrame > cursor) {
+      Range encode;
+      encode.startFrame = cursor;
+      encode.endFrame = copy.startFrame;
+      plan.push_back(encode);
+    }
+    plan.push_back(copy);
+    cursor = copy.endFrame;
+  }
+  if (cursor < totalFrames) {
+    Range encode;
+    encode.startFrame = cursor;
+    encode.endFrame = totalFrames;
+    plan.push_back(encode);
+  }
+
+  int copied = 0;
+  for (const Range &range : plan)
+    if (range.copy)
+      copied += range.endFrame - range.startFrame;
+  std::cout << "[SmartRender] " << copied << "/" << totalFrames
+            << " frames stream-copied in " << copyRanges.size() << " ranges"
+            << std::endl;
+
+  return plan;
+}
+
+bool SmartRenderPlanner::IsClipUntouched(const Clip &clip) const {
+  // Retimed frames have to be re-encoded
+  if (clip.speed != 1.0)
+    return false;
+
+  double start = clip.startTime;
+  double end = clip.GetEndTime();
+
+  for (const auto &layer : m_Timeline->effectLayers) {
+    if (layer.startTime < end && layer.GetEndTime() > start)
+      return false;
+  }
+
+  // Anything stacked on another track would be composited over it
+  auto &tracks = m_Timeline->tracks;
+  for (size_t t = 1; t < tracks.size(); ++t) {
+    for (const Clip &other : tracks[t].clips) {
+      if (other.startTime < end && other.GetEndTime() > start)
+        return false;
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// Source Probing
+// ============================================================================
+
+const SmartRenderPlanner::SourceInfo &
+SmartRenderPlanner::Probe(const std::string &filepath) {
+  auto it = m_Sources.find(filepath);
+  if (it != m_Sources.end())
+    return it->second;
+
+  SourceInfo &info = m_Sources[filepath];
+
+  AVFormatContext *formatCtx = nullptr;
+  if (avformat_open_input(&formatCtx, filepath.c_str(), nullptr, nullptr) <
+      0)
+    return info;
+  if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+    avformat_close_input(&formatCtx);
+    return info;
+  }
+
+  int videoIndex =
+      av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+  if (videoIndex < 0) {
+    avformat_close_input(&formatCtx);
+    return info;
+  }
+
+  AVStream *stream = formatCtx->streams[videoIndex];
+  AVCodecParameters *par = stream->codecpar;
+  info.codecId = par->codec_id;
+  info.width = par->width;
+  info.height = par->height;
+  info.pixelFormat = static_cast<AVPixelFormat>(par->format);
+  info.fps = av_q2d(stream->avg_frame_rate);
+  if (info.fps <= 0.0)
+    info.fps = av_q2d(stream->r_frame_rate);
+
+  // avcC/hvcC extradata: NAL units are length-prefixed, otherwise Annex B
+  int nalLengthSize = 0;
+  if (par->codec_id == AV_CODEC_ID_H264 && par->extradata_size > 4 &&
+      par->extradata[0] == 1)
+    nalLengthSize = (par->extradata[4] & 3) + 1;
+  else if (par->codec_id == AV_CODEC_ID_HEVC && par->extradata_size > 21 &&
+           par->extradata[0] == 1)
+    nalLengthSize = (par->extradata[21] & 3) + 1;
+
+  // Read packets only (no decoding) to find every IDR
+  for (unsigned int i = 0; i < formatCtx->nb_streams; ++i) {
+    if (static_cast<int>(i) != videoIndex)
+      formatCtx->streams[i]->discard = AVDISCARD_ALL;
+  }
+
+  double timeBase = av_q2d(stream->time_base);
+  AVPacket *packet = av_packet_alloc();
+  while (av_read_frame(formatCtx, packet) >= 0) {
+    if (packet->stream_index == videoIndex && packet->pts != AV_NOPTS_VALUE) {
+      double t = packet->pts * timeBase;
+      if ((packet->flags & AV_PKT_FLAG_KEY) &&
+          IsIDRPacket(packet->data, packet->size, info.codecId, nalLengthSize))
+        info.idrTimes.push_back(t);
+      info.endTime = std::max(info.endTime, t + packet->duration * timeBase);
+    }
+    av_packet_unref(packet);
+  }
+  av_packet_free(&packet);
+  avformat_close_input(&formatCtx);
+
+  std::sort(info.idrTimes.begin(), info.idrTimes.end());
+  info.valid = !info.idrTimes.empty();
+
+  std::cout << "[SmartRender] Probed " << filepath << ": "
+            << info.idrTimes.size() << " IDR frames" << std::endl;
+  return info;
+}
+
+bool SmartRenderPlanner::IsIDRPacket(const uint8_t *data, int size,
+                                     AVCodecID codecId, int nalLengthSize) {
+  auto isIDR = [codecId](uint8_t header) {
+    if (codecId == AV_CODEC_ID_H264)
+      return (header & 0x1F) == 5;
+    int type = (header >> 1) & 0x3F;
+    return type == 19 || type == 20; // IDR_W_RADL, IDR_N_LP
+  };
+
+  if (!data || size <= 0)
+    return false;
+
+  if (codecId == AV_CODEC_ID_AV1) {
+    // Low-overhead OBUs: a keyframe packet is only a safe cut point when it
+    // carries its own sequence header
+    int pos = 0;
+    while (pos < size) {
+      uint8_t header = data[pos];
+      int type = (header >> 3) & 0x0F;
+      bool hasExtension = (header & 0x04) != 0;
+      bool hasSize = (header & 0x02) != 0;
+      if (header & 0x80) // Forbidden bit: not low-overhead format
+        return false;
+      if (type == 1) // OBU_SEQUENCE_HEADER
+        return true;
+      pos += hasExtension ? 2 : 1;
+      if (!hasSize) // Runs to the end of the packet
+        return false;
+
+      // leb128 payload size
+      uint64_t obuSize = 0;
+      int i = 0;
+      for (; i < 8 && pos < size; ++i) {
+        uint8_t byte = data[pos++];
+        obuSize |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80))
+          break;
+      }
+      if (i == 8 || obuSize > static_cast<uint64_t>(size - pos))
+        return false;
+      pos += static_cast<int>(obuSize);
+    }
+    return false;
+  }
+
+  if (nalLengthSize > 0) {
+    // Length-prefixed NAL units
+    int pos = 0;
+    while (pos + nalLengthSize < size) {
+      uint32_t nalSize = 0;
+      for (int i = 0; i < nalLengthSize; ++i)
+        nalSize = (nalSize << 8) | data[pos + i];
+      pos += nalLengthSize;
+      if (nalSize == 0 || nalSize > static_cast<uint32_t>(size - pos))
+        break;
+      if (isIDR(data[pos]))
+        return true;
+      pos += nalSize;
+    }
+    return false;
+  }
+
+  // Annex B start codes
+  for (int i = 0; i + 3 < size; ++i) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+      if (isIDR(data[i + 3]))
+        return true;
+      i += 2;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../Timeline/TimelineSnapshot.h"
+#include "HardwareExportManager.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct Clip;
+
+/**
+ * @brief Finds timeline ranges that can be stream-copied on export
+ *
+ * A clip range is copied packet-for-packet (no decode/render/encode) when
+ * nothing would change its pixels:
+ * - No global color/filter adjustment and no effect layer over the clip
+ * - No clip on another track overlapping it
+ * - Source codec, resolution, frame rate and pixel format match the output
+ *
+ * Only whole source GOPs starting at an IDR frame are copied. The partial
+ * GOPs at the clip's cut points (and everything not eligible) are left to
+ * the normal render + encode path.
+ */
+class SmartRenderPlanner {
+public:
+  struct Range {
+    int startFrame = 0; ///< Timeline frame
+    int endFrame = 0;   ///< Exclusive
+    bool copy = false;
+    std::string sourceFile; ///< Copy only
+    double sourceStart = 0.0; ///< IDR time in the source (seconds)
+    double sourceEnd = 0.0;   ///< Next IDR time or end of stream
+  };
+
+  struct SourceInfo {
+    bool valid = false;
+    AVCodecID codecId = AV_CODEC_ID_NONE;
+    int width = 0;
+    int height = 0;
+    double fps = 0.0;
+    AVPixelFormat pixelFormat = AV_PIX_FMT_NONE;
+    std::vector<double> idrTimes; ///< Sorted, seconds (pts * time_base)
+    double endTime = 0.0;         ///< End of the last packet
+  };
+
+  explicit SmartRenderPlanner(TimelineSnapshotPtr timeline);
+
+  /**
+   * @brief Split [0, totalFrames) into copy and encode ranges
+   */
+  std::vector<Range> Plan(const HardwareExportManager::Config &config,
+                          const HardwareExportManager::EffectParams &effects,
+                          int totalFrames);
+
+  static bool IsNeutral(const HardwareExportManager::EffectParams &effects);
+
+  /**
+   * @brief True if the packet starts a closed GOP (H.264 IDR, HEVC IDR,
+   * AV1 keyframe with a sequence header)
+   *
+   * Non-IDR keyframes (open GOP, HEVC CRA) can have leading pictures that
+   * reference the previous GOP, so they are not safe cut points. For AV1
+   * the caller also requires AV_PKT_FLAG_KEY; @p nalLengthSize is unused.
+   */
+  static bool IsIDRPacket(const uint8_t *data, int size, AVCodecID codecId,
+                          int nalLengthSize);
+
+private:
+  const SourceInfo &Probe(const std::string &filepath);
+  bool IsClipUntouched(const Clip &clip) const;
+
+  TimelineSnapshotPtr m_Timeline;
+  std::map<std::string, SourceInfo> m_Sources;
+};
@@ -0,0 +1,386 @@
+#include "ColorLUT.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLORLUT_SSE2 1
+#endif
+
+namespace {
+
+constexpr int kMaxCubeSize = 256;
+
+std::atomic<bool> g_SIMDEnabled{true};
+
+#ifdef COLORLUT_SSE2
+// One channel of four lattice points
+struct Float4 {
+  __m128 v;
+  Float4(__m128 value) : v(value) {}
+  Float4(float value) : v(_mm_set1_ps(value)) {}
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+#endif
+
+// ============================================================================
+// Color math, written once for float and Float4 lanes
+// ============================================================================
+
+template <typename V> struct Color {
+  V r, g, b;
+};
+
+template <typename V> inline V Luma(const Color<V> &c) {
+  return c.r * 0.299f + c.g * 0.587f + c.b * 0.114f;
+}
+
+template <typename V> inline V Mix(V a, V b, float t) {
+  return a + (b - a) * t;
+}
+
+template <typename V> void Scale(Color<V> &c, float r, float g, float b) {
+  c.r = c.r * r;
+  c.g = c.g * g;
+  c.b = c.b * b;
+}
+
+template <typename V> void Scale(Color<V> &c, float s) { Scale(c, s, s, s); }
+
+template <typename V> void Offset(Color<V> &c, float r, float g, float b) {
+  c.r = c.r + r;
+  c.g = c.g + g;
+  c.b = c.b + b;
+}
+
+template <typename V> void Offset(Color<V> &c, float o) { Offset(c, o, o, o); }
+
+// (c - 0.5) * amount + pivot
+template <typename V> void Contrast(Color<V> &c, float amount, float pivot) {
+  Offset(c, -0.5f);
+  Scale(c, amount);
+  Offset(c, pivot);
+}
+
+// mix(gray, c, amount): saturation
+template <typename V> void MixGray(Color<V> &c, V gray, float amount) {
+  c.r = Mix<V>(gray, c.r, amount);
+  c.g = Mix<V>(gray, c.g, amount);
+  c.b = Mix<V>(gray, c.b, amount);
+}
+
+// mix(c, constant, t): tint
+template <typename V>
+void MixColor(Color<V> &c, float r, float g, float b, float t) {
+  c.r = Mix<V>(c.r, r, t);
+  c.g = Mix<V>(c.g, g, t);
+  c.b = Mix<V>(c.b, b, t);
+}
+
+template <typename V> void ApplyFilter(int filterType, Color<V> &c) {
+  switch (filterType) {
+  case 1: { // Light Green: tint green, slightly faded
+    V average = (c.r + c.g + c.b) * 0.33f;
+    c.r = Mix<V>(c.r, average * 0.8f, 0.3f);
+    c.g = Mix<V>(c.g, average, 0.3f);
+    c.b = Mix<V>(c.b, average * 0.8f, 0.3f);
+    Scale(c, 0.9f, 1.1f, 0.9f);
+    break;
+  }
+  case 2: // 80s Holiday: warm, pinkish highlight
+    Scale(c, 1.1f, 0.9f, 0.9f);
+    MixColor(c, 1.0f, 0.8f, 0.8f, 0.1f);
+    break;
+  case 3: // Milky Tone: low contrast, bright, whiter
+    Contrast(c, 0.8f, 0.5f);
+    Offset(c, 0.1f);
+    MixColor(c, 1.0f, 1.0f, 1.0f, 0.1f);
+    break;
+  case 4: // Cinematic Dusk: saturated, cool shadows, warm highlights
+    MixGray(c, Luma(c), 1.2f);
+    Scale(c, 0.9f, 0.95f, 1.1f);
+    Offset(c, 0.1f, 0.05f, 0.0f);
+    break;
+  case 5: // Ice City: cool blue, high contrast
+    Contrast(c, 1.2f, 0.5f);
+    Scale(c, 0.8f, 0.9f, 1.1f);
+    break;
+  case 6: // Flash CCD: high exposure
+    Contrast(c, 1.3f, 0.6f);
+    break;
+  case 7: // LA Classic: warm, vintage
+    Scale(c, 1.1f, 1.0f, 0.8f);
+    Offset(c, -0.05f);
+    break;
+  case 8: // Warlock: dark, green/purple tint
+    Contrast(c, 1.3f, 0.4f);
+    Scale(c, 0.9f, 1.1f, 0.8f);
+    break;
+  case 9: // Brighten Up
+    Offset(c, 0.15f);
+    Scale(c, 1.1f);
+    break;
+  case 10: { // Hollywood Past: high contrast black and white
+    V gray = (Luma(c) - 0.5f) * 1.5f + 0.5f;
+    c = Color<V>{gray, gray, gray};
+    break;
+  }
+  case 11: // Fade: low saturation, raised blacks
+    MixGray(c, Luma(c), 0.6f);
+    Scale(c, 0.8f);
+    Offset(c, 0.1f);
+    break;
+  case 12: // Maldives: aqua boost
+    Scale(c, 0.9f, 1.2f, 1.2f);
+    Contrast(c, 1.1f, 0.5f);
+    break;
+  case 13: // Clear: neutral clean
+    Contrast(c, 1.05f, 0.5f);
+    Scale(c, 1.05f);
+    break;
+  case 14: // Azure Morning: soft blue tint
+    MixColor(c, 0.8f, 0.9f, 1.0f, 0.15f);
+    Scale(c, 1.1f);
+    break;
+  case 15: // Hasselblad: natural, deep
+    Contrast(c, 1.1f, 0.5f);
+    Scale(c, 1.05f, 1.02f, 1.0f);
+    break;
+  default:
+    break;
+  }
+}
+
+template <typename V>
+void ApplyAdjustments(const ColorLUT::Grade &grade, Color<V> &c) {
+  Offset(c, grade.brightness);
+  Contrast(c, grade.contrast, 0.5f);
+  MixGray(c, Luma(c), grade.saturation);
+
+  if (grade.sepia) {
+    V r = c.r * 0.393f + c.g * 0.769f + c.b * 0.189f;
+    V g = c.r * 0.349f + c.g * 0.686f + c.b * 0.168f;
+    V b = c.r * 0.272f + c.g * 0.534f + c.b * 0.131f;
+    c = Color<V>{r, g, b};
+  }
+}
+
+/**
+ * @brief Run @p op over planar rows, four points at a time where SIMD is
+ * available and enabled, the remainder one at a time
+ */
+template <typename Op>
+void ProcessRow(float *r, float *g, float *b, int count, bool simd, Op op) {
+  int x = 0;
+#ifdef COLORLUT_SSE2
+  if (simd) {
+    for (; x + 4 <= count; x += 4) {
+      Color<Float4> c{_mm_loadu_ps(r + x), _mm_loadu_ps(g + x),
+                      _mm_loadu_ps(b + x)};
+      op(c);
+      _mm_storeu_ps(r + x, c.r.v);
+      _mm_storeu_ps(g + x, c.g.v);
+      _mm_storeu_ps(b + x, c.b.v);
+    }
+  }
+#else
+  (void)simd;
+#endif
+  for (; x < count; ++x) {
+    Color<float> c{r[x], g[x], b[x]};
+    op(c);
+    r[x] = c.r;
+    g[x] = c.g;
+    b[x] = c.b;
+  }
+}
+
+// ============================================================================
+// Imported LUT
+// ============================================================================
+
+// Trilinear lookup; input outside the cube's domain clamps to its edge
+void SampleCube(const ColorLUT::Cube &cube, float &r, float &g, float &b) {
+  const int size = cube.size;
+  const float last = static_cast<float>(size - 1);
+  float in[3] = {r, g, b};
+  int index[3];
+  float frac[3];
+  for (int c = 0; c < 3; ++c) {
+    float x = (in[c] - cube.domainMin[c]) /
+              (cube.domainMax[c] - cube.domainMin[c]) * last;
+    x = std::min(std::max(x, 0.0f), last);
+    index[c] = std::min(static_cast<int>(x), size - 2);
+    frac[c] = x - static_cast<float>(index[c]);
+  }
+
+  const float *base =
+      cube.table.data() +
+      ((static_cast<size_t>(index[2]) * size + index[1]) * size + index[0]) *
+          3;
+  const size_t dg = static_cast<size_t>(size) * 3;
+  const size_t db = dg * size;
+
+  float out[3];
+  for (int c = 0; c < 3; ++c) {
+    const float *p = base + c;
+    float c00 = p[0] + (p[3] - p[0]) * frac[0];
+    float c10 = p[dg] + (p[dg + 3] - p[dg]) * frac[0];
+    float c01 = p[db] + (p[db + 3] - p[db]) * frac[0];
+    float c11 = p[db + dg] + (p[db + dg + 3] - p[db + dg]) * frac[0];
+    float c0 = c00 + (c10 - c00) * frac[1];
+    float c1 = c01 + (c11 - c01) * frac[1];
+    out[c] = c0 + (c1 - c0) * frac[2];
+  }
+  r = out[0];
+  g = out[1];
+  b = out[2];
+}
+
+bool ReadTriple(std::istringstream &in, float values[3]) {
+  return static_cast<bool>(in >> values[0] >> values[1] >> values[2]);
+}
+
+} // namespace
+
+bool ColorLUT::LoadCube(const std::string &path, Cube &cube,
+                        std::string &error) {
+  std::ifstream file(path);
+  if (!file) {
+    error = "Cannot open " + path;
+    return false;
+  }
+
+  Cube result;
+  result.path = path;
+  size_t expected = 0;
+  std::string line;
+  int lineNumber = 0;
+
+  auto fail = [&](const std::string &message) {
+    error = path + ":";
+    if (lineNumber > 0)
+      error += std::to_string(lineNumber) + ":";
+    error += " " + message;
+    return false;
+  };
+
+  while (std::getline(file, line)) {
+    ++lineNumber;
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#')
+      continue;
+    std::istringstream in(line.substr(start));
+
+    if (std::isalpha(static_cast<unsigned char>(line[start]))) {
+      std::string key;
+      in >> key;
+      if (key == "TITLE") {
+        size_t open = line.find('"');
+        size_t close = line.rfind('"');
+        if (open != std::string::npos && close > open)
+          result.title = line.substr(open + 1, close - open - 1);
+      } else if (key == "LUT_3D_SIZE") {
+        if (!(in >> result.size) || result.size < 2 ||
+            result.size > kMaxCubeSize)
+          return fail("Invalid LUT_3D_SIZE");
+        expected = static_cast<size_t>(result.size) * result.size *
+                   result.size * 3;
+        result.table.reserve(expected);
+      } else if (key == "LUT_1D_SIZE") {
+        return fail("1D LUTs are not supported");
+      } else if (key == "DOMAIN_MIN") {
+        if (!ReadTriple(in, result.domainMin))
+          return fail("Invalid DOMAIN_MIN");
+      } else if (key == "DOMAIN_MAX") {
+        if (!ReadTriple(in, result.domainMax))
+          return fail("Invalid DOMAIN_MAX");
+      } else if (key == "LUT_3D_INPUT_RANGE") { // Resolve
+        float low = 0.0f, high = 1.0f;
+        if (!(in >> low >> high))
+          return fail("Invalid LUT_3D_INPUT_RANGE");
+        std::fill(result.domainMin, result.domainMin + 3, low);
+        std::fill(result.domainMax, result.domainMax + 3, high);
+      }
+      // Other keywords do not affect the table
+      continue;
+    }
+
+    if (result.size == 0)
+      return fail("Table data before LUT_3D_SIZE");
+    float rgb[3];
+    if (!ReadTriple(in, rgb))
+      return fail("Expected three values");
+    if (result.table.size() == expected)
+      return fail("More entries than LUT_3D_SIZE");
+    result.table.insert(result.table.end(), rgb, rgb + 3);
+  }
+  lineNumber = 0; // Whole-file errors from here on
+
+  if (result.size == 0)
+    return fail("No LUT_3D_SIZE");
+  if (result.table.size() != expected)
+    return fail("Expected " + std::to_string(expected / 3) +
+                " entries, found " + std::to_string(result.table.size() / 3));
+  for (int c = 0; c < 3; ++c) {
+    if (!(result.domainMax[c] > result.domainMin[c]))
+      return fail("Empty domain");
+  }
+
+  cube = std::move(result);
+  return true;
+}
+
+void ColorLUT::Bake(const Grade &grade, const Cube *cube, float *table) {
+  bool simd = g_SIMDEnabled.load(std::memory_order_relaxed);
+  if (cube && cube->IsEmpty())
+    cube = nullptr;
+
+  auto filter = [&](auto &c) { ApplyFilter(grade.filterType, c); };
+  auto adjust = [&](auto &c) { ApplyAdjustments(grade, c); };
+
+  // One red row at a time, planar while processing
+  const float step = 1.0f / static_cast<float>(kSize - 1);
+  float r[kSize], g[kSize], b[kSize];
+  for (int bi = 0; bi < kSize; ++bi) {
+    for (int gi = 0; gi < kSize; ++gi) {
+      for (int ri = 0; ri < kSize; ++ri) {
+        r[ri] = static_cast<float>(ri) * step;
+        g[ri] = static_cast<float>(gi) * step;
+        b[ri] = static_cast<float>(bi) * step;
+      }
+
+      if (grade.filterType != 0)
+        ProcessRow(r, g, b, kSize, simd, filter);
+      if (cube) {
+        for (int ri = 0; ri < kSize; ++ri)
+          SampleCube(*cube, r[ri], g[ri], b[ri]);
+      }
+      ProcessRow(r, g, b, kSize, simd, adjust);
+
+      float *out = table + (static_cast<size_t>(bi) * kSize + gi) * kSize * 3;
+      for (int ri = 0; ri < kSize; ++ri) {
+        out[ri * 3] = r[ri];
+        out[ri * 3 + 1] = g[ri];
+        out[ri * 3 + 2] = b[ri];
+      }
+    }
+  }
+}
+
+void ColorLUT::SetSIMDEnabled(bool enabled) { g_SIMDEnabled = enabled; }
+
+bool ColorLUT::IsSIMDAvailable() {
+#ifdef COLORLUT_SSE2
+  return true;
+#else
+  return false;
+#endif
+}
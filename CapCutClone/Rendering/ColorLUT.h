@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Per-pixel color pipeline baked into a 3D lookup table
+ *
+ * TextureRenderer's color stages depend only on the input color, so they
+ * are evaluated once per lattice point whenever a parameter changes and
+ * the fragment shader replaces them with a single trilinear 3D texture
+ * fetch. The baked pipeline, in order:
+ *
+ * 1. Filter preset (filterType 1-15)
+ * 2. Imported .cube LUT, if any
+ * 3. Brightness, contrast, saturation
+ * 4. Sepia
+ *
+ * Spatial effects (blur, aberration, vignette, grain) stay in the shader.
+ *
+ * The baker runs four lattice points per SSE register (x86) and matches
+ * the scalar path; a full bake takes well under a millisecond.
+ */
+class ColorLUT {
+public:
+  static constexpr int kSize = 33; ///< Lattice points per axis
+
+  /**
+   * @brief The parameters the table is baked from
+   */
+  struct Grade {
+    int filterType = 0; ///< 0 = None, 1-15 = presets
+    float brightness = 0.0f;
+    float contrast = 1.0f;
+    float saturation = 1.0f;
+    bool sepia = false;
+
+    bool operator==(const Grade &other) const {
+      return filterType == other.filterType &&
+             brightness == other.brightness && contrast == other.contrast &&
+             saturation == other.saturation && sepia == other.sepia;
+    }
+    bool operator!=(const Grade &other) const { return !(*this == other); }
+
+    bool IsNeutral() const { return *this == Grade(); }
+  };
+
+  /**
+   * @brief A 3D LUT read from a .cube file (Adobe / Resolve format)
+   */
+  struct Cube {
+    std::string path;
+    std::string title;
+    int size = 0;             ///< Lattice points per axis
+    std::vector<float> table; ///< RGB, red fastest
+    float domainMin[3] = {0.0f, 0.0f, 0.0f};
+    float domainMax[3] = {1.0f, 1.0f, 1.0f};
+
+    bool IsEmpty() const { return size == 0; }
+  };
+
+  /**
+   * @brief Parse a .cube file; 1D LUTs are not supported
+   * @return false with @p error set if the file is missing or malformed
+   */
+  static bool LoadCube(const std::string &path, Cube &cube,
+                       std::string &error);
+
+  /**
+   * @brief Evaluate @p grade (and @p cube, may be null) at every lattice
+   * point
+   * @param table kSize^3 RGB floats, red fastest then green then blue;
+   * values may fall outside 0..1
+   */
+  static void Bake(const Grade &grade, const Cube *cube, float *table);
+
+  /**
+   * @brief Disable the SIMD path (benchmarks and comparisons)
+   */
+  static void SetSIMDEnabled(bool enabled);
+  static bool IsSIMDAvailable();
+};
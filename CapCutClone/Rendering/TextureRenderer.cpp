@@ -3,6 +3,7 @@
 #include <vector>
 #include <GLFW/glfw3.h> // Required for glfwGetTime
 #include <cmath>
+#include <utility>
 
 // Vertex shader source
 const char* vertexShaderSource = R"(
@@ -30,16 +31,16 @@ in vec2 TexCoord;
 
 uniform sampler2D texture1;
 uniform float alpha; 
-uniform float brightness;
-uniform float contrast;
-uniform float saturation;
+
+// Filter, color correction and sepia, baked by ColorLUT
+uniform sampler3D colorLUT;
+uniform int lutEnabled;    // 0 = identity, skip the fetch
+uniform vec2 lutTransform; // Color -> texel-center coordinate: scale, offset
 
 // Effects
 uniform float vignette;    // 0.0 to 1.0
 uniform float grain;       // 0.0 to 1.0
 uniform float aberration;  // 0.0 to 0.05
-uniform int sepia;         // 0 or 1
-uniform int filterType;    // 0=None, 1=LightGreen, 2=80s, 3=Milky, etc.
 uniform float time;        // For animated grain
 
 // Advanced Blur Effects
@@ -51,22 +52,6 @@ float rand(vec2 co){
     return fract(sin(dot(co.xy ,vec2(12.9898,78.233))) * 43758.5453);
 }
 
-// Color conversion helpers
-vec3 rgb2hsv(vec3 c) {
-    vec4 K = vec4(0.0, -1.0 / 3.0, 2.0 / 3.0, -1.0);
-    vec4 p = mix(vec4(c.bg, K.wz), vec4(c.gb, K.xy), step(c.b, c.g));
-    vec4 q = mix(vec4(p.xyw, c.r), vec4(c.r, p.yzx), step(p.x, c.r));
-    float d = q.x - min(q.w, q.y);
-    float e = 1.0e-10;
-    return vec3(abs(q.z + (q.w - q.y) / (6.0 * d + e)), d / (q.x + e), q.x);
-}
-
-vec3 hsv2rgb(vec3 c) {
-    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
-    vec3 p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
-    return c.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), c.y);
-}
-
 // Blur Helper Functions
 vec3 applyGaussianBlur(vec2 uv, float amount) {
     vec3 color = vec3(0.0);
@@ -156,102 +141,9 @@ void main() {
     }
     // Note: if aberration is 0, texColor already has the correct (possibly blurred) value
     
-    // --- FILTERS ---
-    if (filterType == 1) { // Light Green
-        // Tint green, slightly faded
-        texColor = mix(texColor, vec3(0.8, 1.0, 0.8) * dot(texColor, vec3(0.33)), 0.3);
-        texColor *= vec3(0.9, 1.1, 0.9); 
-    }
-    else if (filterType == 2) { // 80s Holiday
-        // Warm, slightly saturated, pinkish highlight
-        texColor = texColor * vec3(1.1, 0.9, 0.9);
-        texColor = mix(texColor, vec3(1.0, 0.8, 0.8), 0.1);
-    }
-    else if (filterType == 3) { // Milky Tone
-        // Low contrast, bright, whiter
-        texColor = (texColor - 0.5) * 0.8 + 0.5; // low contrast
-        texColor += 0.1; // brightness
-        texColor = mix(texColor, vec3(1.0), 0.1); // milky
-    }
-    else if (filterType == 4) { // Cinematic Dusk
-        // Teal/Orange look basic
-        vec3 gray = vec3(dot(texColor, vec3(0.299, 0.587, 0.114)));
-        texColor = mix(gray, texColor, 1.2); // boost sat
-        texColor *= vec3(0.9, 0.95, 1.1); // cool shadows
-        texColor += vec3(0.1, 0.05, 0.0); // warm highlights simulation (simple)
-    }
-    else if (filterType == 5) { // Ice City
-        // Cool blue, high contrast
-        texColor = (texColor - 0.5) * 1.2 + 0.5;
-        texColor *= vec3(0.8, 0.9, 1.1);
-    }
-    else if (filterType == 6) { // Flash CCD
-        // High exposure, bloom-like
-        texColor = (texColor - 0.5) * 1.3 + 0.6;
-    }
-    else if (filterType == 7) { // LA Classic
-        // Warm, sunny, vintage
-        texColor *= vec3(1.1, 1.0, 0.8);
-        texColor -= 0.05;
-    }
-    else if (filterType == 8) { // Warlock
-        // Dark, green/purple tint
-        texColor = (texColor - 0.5) * 1.3 + 0.4;
-        texColor *= vec3(0.9, 1.1, 0.8);
-    }
-    else if (filterType == 9) { // Brighten Up
-        texColor += 0.15;
-        texColor *= 1.1;
-    }
-    else if (filterType == 10) { // Hollywood Past
-        // B&W high contrast
-        float g = dot(texColor, vec3(0.299, 0.587, 0.114));
-        texColor = vec3((g - 0.5) * 1.5 + 0.5);
-    }
-    else if (filterType == 11) { // Fade
-        // Low saturation, raised blacks
-        float g = dot(texColor, vec3(0.299, 0.587, 0.114));
-        texColor = mix(vec3(g), texColor, 0.6);
-        texColor = texColor * 0.8 + 0.1; // lift blacks
-    }
-    else if (filterType == 12) { // Maldives
-        // Aqua boost
-        texColor *= vec3(0.9, 1.2, 1.2);
-        texColor = (texColor - 0.5) * 1.1 + 0.5;
-    }
-    else if (filterType == 13) { // Clear
-        // Neutral clean
-        texColor = (texColor - 0.5) * 1.05 + 0.5;
-        texColor *= 1.05;
-    }
-    else if (filterType == 14) { // Azure Morning
-        // Soft blue tint
-        texColor = mix(texColor, vec3(0.8, 0.9, 1.0), 0.15);
-        texColor *= 1.1;
-    }
-    else if (filterType == 15) { // Hasselblad
-        // Natural, deep properties
-        texColor = (texColor - 0.5) * 1.1 + 0.5;
-        texColor *= vec3(1.05, 1.02, 1.0);
-    }
-    
-    // Brightness
-    texColor += brightness;
-    
-    // Contrast
-    texColor = (texColor - 0.5) * contrast + 0.5;
-    
-    // Saturation
-    float gray = dot(texColor, vec3(0.299, 0.587, 0.114));
-    texColor = mix(vec3(gray), texColor, saturation);
-    
-    // Sepia
-    if (sepia > 0) {
-        vec3 sepiaColor;
-        sepiaColor.r = dot(texColor, vec3(0.393, 0.769, 0.189));
-        sepiaColor.g = dot(texColor, vec3(0.349, 0.686, 0.168));
-        sepiaColor.b = dot(texColor, vec3(0.272, 0.534, 0.131));
-        texColor = sepiaColor;
+    // Filter, brightness, contrast, saturation, sepia: one trilinear fetch
+    if (lutEnabled > 0) {
+        texColor = texture(colorLUT, texColor * lutTransform.x + lutTransform.y).rgb;
     }
     
     // Vignette
@@ -271,6 +163,46 @@ void main() {
 }
 )";
 
+// Filter atlas: one instance per filter, placed by its index
+const char* atlasVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;  // Unit quad
+layout (location = 1) in int aFilter; // Per instance
+
+out vec2 TexCoord;
+flat out int Filter;
+
+uniform int columns;
+uniform vec4 sourceCrop; // Offset, scale (center square of the source)
+
+void main() {
+    vec2 tile = vec2(aFilter % columns, aFilter / columns);
+    gl_Position = vec4((tile + aPos) / float(columns) * 2.0 - 1.0, 0.0, 1.0);
+    TexCoord = sourceCrop.xy + aPos * sourceCrop.zw;
+    Filter = aFilter;
+}
+)";
+
+const char* atlasFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in int Filter;
+
+uniform sampler2D texture1;
+uniform sampler3D filterLUTs; // One lattice per filter, grid over red and blue
+uniform vec2 lutTransform;    // Color -> texel-center coordinate in a lattice
+uniform int lutGrid;          // Lattices per row of the grid
+
+void main() {
+    vec3 coord = texture(texture1, TexCoord).rgb * lutTransform.x + lutTransform.y;
+    vec2 cell = vec2(Filter % lutGrid, Filter / lutGrid);
+    coord.xz = (coord.xz + cell) / float(lutGrid);
+    FragColor = vec4(texture(filterLUTs, coord).rgb, 1.0);
+}
+)";
+
 TextureRenderer::TextureRenderer()
     : m_TextureID(0)
     , m_ShaderProgram(0)
@@ -292,8 +224,28 @@ TextureRenderer::TextureRenderer()
     , m_PreviewTexture(0)
     , m_PreviewWidth(0)
     , m_PreviewHeight(0)
+    , m_PreviewHash(0)
+    , m_PreviewValid(false)
+    , m_PreviewRenders(0)
+    , m_TextureVersion(0)
+    , m_CubeVersion(0)
     , m_FlipY(false)
     , m_FilterType(0)
+    , m_LUTTexture(0)
+    , m_LUTHasCube(false)
+    , m_LUTValid(false)
+    , m_AtlasProgram(0)
+    , m_AtlasVAO(0)
+    , m_AtlasQuadVBO(0)
+    , m_AtlasInstanceVBO(0)
+    , m_AtlasLUT(0)
+    , m_AtlasFBO(0)
+    , m_AtlasFence(nullptr)
+    , m_AtlasTileSize(0)
+    , m_AtlasSourceHash(0)
+    , m_AtlasValid(false)
+    , m_AtlasRenderTime(0.0)
+    , m_AtlasDeferred(false)
     , m_BlurAmount(0.0f)
     , m_BlurType(0)
     , m_GlitchIntensity(0.0f)
@@ -308,6 +260,8 @@ TextureRenderer::TextureRenderer()
     m_EdgeGlowColor[0] = 1.0f;
     m_EdgeGlowColor[1] = 1.0f;
     m_EdgeGlowColor[2] = 1.0f;
+    m_AtlasTexture[0] = 0;
+    m_AtlasTexture[1] = 0;
 }
 
 void TextureRenderer::SetFlipY(bool flip) {
@@ -318,6 +272,82 @@ void TextureRenderer::SetFilterType(int type) {
     m_FilterType = type;
 }
 
+bool TextureRenderer::LoadCubeLUT(const std::string& path) {
+    ColorLUT::Cube cube;
+    if (!ColorLUT::LoadCube(path, cube, m_CubeError)) {
+        std::cerr << "[TextureRenderer] " << m_CubeError << std::endl;
+        return false;
+    }
+    std::cout << "[TextureRenderer] Loaded LUT " << path << " (" << cube.size << "^3)" << std::endl;
+    m_Cube = std::move(cube);
+    m_CubeError.clear();
+    m_LUTValid = false;
+    m_CubeVersion++;
+    return true;
+}
+
+void TextureRenderer::ClearCubeLUT() {
+    m_Cube = ColorLUT::Cube();
+    m_CubeError.clear();
+    m_LUTValid = false;
+    m_CubeVersion++;
+}
+
+ColorLUT::Grade TextureRenderer::GetGrade() const {
+    ColorLUT::Grade grade;
+    grade.filterType = m_FilterType;
+    grade.brightness = m_Brightness;
+    grade.contrast = m_Contrast;
+    grade.saturation = m_Saturation;
+    grade.sepia = m_Sepia;
+    return grade;
+}
+
+void TextureRenderer::CreateColorLUT() {
+    const int size = ColorLUT::kSize;
+    glGenTextures(1, &m_LUTTexture);
+    glBindTexture(GL_TEXTURE_3D, m_LUTTexture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    // Half float: filters push values outside 0..1 before vignette and grain
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, size, size, size, 0, GL_RGB, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    m_LUTTable.resize(static_cast<size_t>(size) * size * size * 3);
+    m_LUTValid = false;
+}
+
+void TextureRenderer::ApplyColorLUT(const ColorLUT::Grade& grade, bool withCube) {
+    const int size = ColorLUT::kSize;
+    bool useCube = withCube && !m_Cube.IsEmpty();
+    bool enabled = useCube || !grade.IsNeutral();
+
+    // Only a parameter change costs a bake and upload, never a plain frame
+    if (enabled && (!m_LUTValid || grade != m_LUTGrade || useCube != m_LUTHasCube)) {
+        ColorLUT::Bake(grade, useCube ? &m_Cube : nullptr, m_LUTTable.data());
+        glBindTexture(GL_TEXTURE_3D, m_LUTTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, size, size, size, GL_RGB, GL_FLOAT, m_LUTTable.data());
+        glBindTexture(GL_TEXTURE_3D, 0);
+        m_LUTGrade = grade;
+        m_LUTHasCube = useCube;
+        m_LUTValid = true;
+    }
+
+    GLint loc;
+    if ((loc = glGetUniformLocation(m_ShaderProgram, "lutEnabled")) >= 0) glUniform1i(loc, enabled ? 1 : 0);
+    if ((loc = glGetUniformLocation(m_ShaderProgram, "colorLUT")) >= 0) glUniform1i(loc, 1);
+    // Map 0..1 onto the first and last texel centers
+    if ((loc = glGetUniformLocation(m_ShaderProgram, "lutTransform")) >= 0)
+        glUniform2f(loc, (size - 1.0f) / size, 0.5f / size);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, m_LUTTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
 // ... (Initialize/Cleanup remains similar, but need to clean FBOs too)
 
 void TextureRenderer::CopySettingsFrom(const TextureRenderer* other) {
@@ -330,6 +360,9 @@ void TextureRenderer::CopySettingsFrom(const TextureRenderer* other) {
     m_Aberration = other->m_Aberration;
     m_Sepia = other->m_Sepia;
     m_FilterType = other->m_FilterType;
+    m_Cube = other->m_Cube;
+    m_LUTValid = false;
+    m_CubeVersion++;
     
     // Copy blur settings
     m_BlurAmount = other->m_BlurAmount;
@@ -346,10 +379,10 @@ bool TextureRenderer::CreateFramebuffer(int width, int height) {
     glGenFramebuffers(1, &m_FBO);
     glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
 
-    // Create texture to render to
+    // Create texture to render to (RGBA8: CUDA interop cannot map RGB8)
     glGenTextures(1, &m_FBOTexture);
     glBindTexture(GL_TEXTURE_2D, m_FBOTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_FBOTexture, 0);
@@ -407,6 +440,7 @@ bool TextureRenderer::Initialize() {
     }
 
     SetupQuad();
+    CreateColorLUT();
     m_Initialized = true;
     return true;
 }
@@ -417,16 +451,22 @@ void TextureRenderer::Cleanup() {
     if (m_VBO) { glDeleteBuffers(1, &m_VBO); m_VBO = 0; }
     if (m_EBO) { glDeleteBuffers(1, &m_EBO); m_EBO = 0; }
     if (m_ShaderProgram) { glDeleteProgram(m_ShaderProgram); m_ShaderProgram = 0; }
+    if (m_LUTTexture) { glDeleteTextures(1, &m_LUTTexture); m_LUTTexture = 0; }
+    m_LUTValid = false;
     
     // Cleanup preview FBO
     if (m_PreviewFBO) { glDeleteFramebuffers(1, &m_PreviewFBO); m_PreviewFBO = 0; }
     if (m_PreviewTexture) { glDeleteTextures(1, &m_PreviewTexture); m_PreviewTexture = 0; }
-    
+    m_PreviewValid = false;
+
+    DestroyFilterAtlas();
+
     m_Initialized = false;
 }
 
 void TextureRenderer::CreateTexture(int width, int height) {
     DeleteTexture();
+    m_TextureVersion++;
     glGenTextures(1, &m_TextureID);
     glBindTexture(GL_TEXTURE_2D, m_TextureID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -439,6 +479,7 @@ void TextureRenderer::CreateTexture(int width, int height) {
 
 void TextureRenderer::UpdateTexture(const uint8_t* data, int width, int height) {
     if (!m_TextureID || !data) return;
+    m_TextureVersion++;
     glBindTexture(GL_TEXTURE_2D, m_TextureID);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -462,14 +503,10 @@ void TextureRenderer::RenderTexture(float x, float y, float width, float height)
     // Uniforms
     GLint loc;
     if ((loc = glGetUniformLocation(m_ShaderProgram, "alpha")) >= 0) glUniform1f(loc, 1.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "brightness")) >= 0) glUniform1f(loc, m_Brightness);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "contrast")) >= 0) glUniform1f(loc, m_Contrast);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "saturation")) >= 0) glUniform1f(loc, m_Saturation);
+    ApplyColorLUT(GetGrade(), true);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "vignette")) >= 0) glUniform1f(loc, m_Vignette);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "grain")) >= 0) glUniform1f(loc, m_Grain);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "aberration")) >= 0) glUniform1f(loc, m_Aberration);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "sepia")) >= 0) glUniform1i(loc, m_Sepia ? 1 : 0);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "filterType")) >= 0) glUniform1i(loc, m_FilterType);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "time")) >= 0) glUniform1f(loc, (float)glfwGetTime());
     
     // Blur uniforms
@@ -515,93 +552,252 @@ void TextureRenderer::RenderTexture(float x, float y, float width, float height)
     glBindVertexArray(0);
 }
 
-GLuint TextureRenderer::GenerateFilterThumbnail(GLuint inputTex, int filterType, int width, int height) {
-    if (!m_Initialized || !inputTex) return 0;
-    
-    // Save current state
-    GLint oldViewport[4];
-    glGetIntegerv(GL_VIEWPORT, oldViewport);
-    GLint oldFBO;
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
-    
-    GLuint fbo, tex; // Temporary FBO
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
-    
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "[TextureRenderer] Failed to create FBO for filter thumbnail!" << std::endl;
+bool TextureRenderer::CreateFilterAtlas(int tileSize) {
+    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+    if (CompileShader(vs, atlasVertexShaderSource) && CompileShader(fs, atlasFragmentShaderSource)) {
+        m_AtlasProgram = glCreateProgram();
+        glAttachShader(m_AtlasProgram, vs);
+        glAttachShader(m_AtlasProgram, fs);
+        glLinkProgram(m_AtlasProgram);
+
+        GLint success;
+        glGetProgramiv(m_AtlasProgram, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(m_AtlasProgram, 512, nullptr, infoLog);
+            std::cerr << "[TextureRenderer] Filter atlas shader link error: " << infoLog << std::endl;
+            glDeleteProgram(m_AtlasProgram);
+            m_AtlasProgram = 0;
+        }
+    }
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    if (!m_AtlasProgram) return false;
+
+    // Unit quad (shared indices), one instance per filter
+    float quad[] = { 0.0f, 0.0f,  1.0f, 0.0f,  1.0f, 1.0f,  0.0f, 1.0f };
+    int filters[kFilterCount];
+    for (int i = 0; i < kFilterCount; i++) filters[i] = i;
+
+    glGenVertexArrays(1, &m_AtlasVAO);
+    glGenBuffers(1, &m_AtlasQuadVBO);
+    glGenBuffers(1, &m_AtlasInstanceVBO);
+
+    glBindVertexArray(m_AtlasVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_AtlasQuadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, m_AtlasInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(filters), filters, GL_STATIC_DRAW);
+    glVertexAttribIPointer(1, 1, GL_INT, sizeof(int), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBindVertexArray(0);
+
+    // Preset lattices in a grid over red and blue (a 16-deep stack along
+    // one axis would exceed the 256 texel minimum GL guarantees)
+    const int size = ColorLUT::kSize;
+    const int grid = kFilterAtlasColumns;
+    std::vector<float> table(static_cast<size_t>(size) * size * size * 3);
+    glGenTextures(1, &m_AtlasLUT);
+    glBindTexture(GL_TEXTURE_3D, m_AtlasLUT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, size * grid, size, size * grid, 0, GL_RGB, GL_FLOAT, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int i = 0; i < kFilterCount; i++) {
+        ColorLUT::Grade grade;
+        grade.filterType = i;
+        ColorLUT::Bake(grade, nullptr, table.data());
+        glTexSubImage3D(GL_TEXTURE_3D, 0, (i % grid) * size, 0, (i / grid) * size, size, size, size, GL_RGB, GL_FLOAT, table.data());
+    }
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // Double-buffered target: the UI shows one while the other renders
+    int atlasSize = tileSize * kFilterAtlasColumns;
+    glGenTextures(2, m_AtlasTexture);
+    for (GLuint tex : m_AtlasTexture) {
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, atlasSize, atlasSize, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glGenFramebuffers(1, &m_AtlasFBO);
+
+    std::cout << "[TextureRenderer] Created " << atlasSize << "x" << atlasSize << " filter atlas" << std::endl;
+    return true;
+}
+
+void TextureRenderer::DestroyFilterAtlas() {
+    if (m_AtlasFence) { glDeleteSync(m_AtlasFence); m_AtlasFence = nullptr; }
+    if (m_AtlasProgram) { glDeleteProgram(m_AtlasProgram); m_AtlasProgram = 0; }
+    if (m_AtlasVAO) { glDeleteVertexArrays(1, &m_AtlasVAO); m_AtlasVAO = 0; }
+    if (m_AtlasQuadVBO) { glDeleteBuffers(1, &m_AtlasQuadVBO); m_AtlasQuadVBO = 0; }
+    if (m_AtlasInstanceVBO) { glDeleteBuffers(1, &m_AtlasInstanceVBO); m_AtlasInstanceVBO = 0; }
+    if (m_AtlasLUT) { glDeleteTextures(1, &m_AtlasLUT); m_AtlasLUT = 0; }
+    if (m_AtlasFBO) { glDeleteFramebuffers(1, &m_AtlasFBO); m_AtlasFBO = 0; }
+    for (GLuint& tex : m_AtlasTexture) {
+        if (tex) { glDeleteTextures(1, &tex); tex = 0; }
+    }
+    m_AtlasTileSize = 0;
+    m_AtlasSourceHash = 0;
+    m_AtlasValid = false;
+    m_AtlasDeferred = false;
+}
+
+GLuint TextureRenderer::GetFilterAtlas(GLuint fallbackTex, int tileSize) {
+    if (!m_Initialized || tileSize <= 0) return 0;
+
+    if (m_AtlasTileSize != tileSize) {
+        DestroyFilterAtlas();
+        if (!CreateFilterAtlas(tileSize)) {
+            std::cerr << "[TextureRenderer] Failed to create the filter atlas" << std::endl;
+            DestroyFilterAtlas();
+        }
+        m_AtlasTileSize = tileSize; // Don't retry every frame after a failure
+    }
+    if (!m_AtlasProgram) return 0;
+
+    // A finished render becomes the shown atlas; never wait for one
+    if (m_AtlasFence) {
+        GLenum status = glClientWaitSync(m_AtlasFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glDeleteSync(m_AtlasFence);
+            m_AtlasFence = nullptr;
+            std::swap(m_AtlasTexture[0], m_AtlasTexture[1]);
+            m_AtlasValid = true;
+        }
+    }
+
+    GLuint source = m_TextureID ? m_TextureID : fallbackTex;
+    StateHash hash;
+    hash.Add(source);
+    hash.Add(m_TextureID ? m_TextureVersion : 0);
+
+    // One render in flight, and during playback at most one per interval:
+    // frames decoded meanwhile collapse into the next
+    double now = glfwGetTime();
+    m_AtlasDeferred = source && hash.value != m_AtlasSourceHash;
+    if (m_AtlasDeferred && !m_AtlasFence &&
+        (!m_AtlasValid || now - m_AtlasRenderTime >= kFilterAtlasInterval)) {
+        m_AtlasSourceHash = hash.value;
+        m_AtlasRenderTime = now;
+        m_AtlasDeferred = false;
+
+        GLint oldViewport[4];
+        glGetIntegerv(GL_VIEWPORT, oldViewport);
+        GLint oldFBO;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+
+        int atlasSize = tileSize * kFilterAtlasColumns;
+        glBindFramebuffer(GL_FRAMEBUFFER, m_AtlasFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_AtlasTexture[1], 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+            glViewport(0, 0, atlasSize, atlasSize);
+            glUseProgram(m_AtlasProgram);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, source);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_3D, m_AtlasLUT);
+            glActiveTexture(GL_TEXTURE0);
+
+            // Center square of the source: wide frames are cropped, not squashed
+            GLint w = 0, h = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+            float crop[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+            if (w > h && h > 0) {
+                crop[2] = (float)h / w;
+                crop[0] = (1.0f - crop[2]) * 0.5f;
+            } else if (h > w && w > 0) {
+                crop[3] = (float)w / h;
+                crop[1] = (1.0f - crop[3]) * 0.5f;
+            }
+
+            const int size = ColorLUT::kSize;
+            GLint loc;
+            if ((loc = glGetUniformLocation(m_AtlasProgram, "columns")) >= 0) glUniform1i(loc, kFilterAtlasColumns);
+            if ((loc = glGetUniformLocation(m_AtlasProgram, "sourceCrop")) >= 0) glUniform4f(loc, crop[0], crop[1], crop[2], crop[3]);
+            if ((loc = glGetUniformLocation(m_AtlasProgram, "texture1")) >= 0) glUniform1i(loc, 0);
+            if ((loc = glGetUniformLocation(m_AtlasProgram, "filterLUTs")) >= 0) glUniform1i(loc, 1);
+            if ((loc = glGetUniformLocation(m_AtlasProgram, "lutTransform")) >= 0)
+                glUniform2f(loc, (size - 1.0f) / size, 0.5f / size);
+            if ((loc = glGetUniformLocation(m_AtlasProgram, "lutGrid")) >= 0) glUniform1i(loc, kFilterAtlasColumns);
+
+            // Every tile in one draw; each covers its whole area, so no clear
+            glBindVertexArray(m_AtlasVAO);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, kFilterCount);
+            glBindVertexArray(0);
+
+            m_AtlasFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        } else {
+            std::cerr << "[TextureRenderer] Filter atlas framebuffer is not complete" << std::endl;
+        }
+
         glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
         glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
-        glDeleteFramebuffers(1, &fbo);
-        glDeleteTextures(1, &tex);
-        return 0;
     }
-    
-    // Set viewport and clear
-    glViewport(0, 0, width, height);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    
-    glUseProgram(m_ShaderProgram);
-    
-    // Set Uniforms - Only enable the specific filter loop
-    GLint loc;
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "alpha")) >= 0) glUniform1f(loc, 1.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "brightness")) >= 0) glUniform1f(loc, 0.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "contrast")) >= 0) glUniform1f(loc, 1.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "saturation")) >= 0) glUniform1f(loc, 1.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "vignette")) >= 0) glUniform1f(loc, 0.0f); // Default values
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "grain")) >= 0) glUniform1f(loc, 0.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "aberration")) >= 0) glUniform1f(loc, 0.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "sepia")) >= 0) glUniform1i(loc, 0);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "filterType")) >= 0) glUniform1i(loc, filterType);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "time")) >= 0) glUniform1f(loc, 0.0f);
-    
-    // Standard projection (Non-flipped for FBO internal storage usually)
-    float projection[16] = {
-        2.0f / width, 0.0f, 0.0f, 0.0f,
-        0.0f, 2.0f / height, 0.0f, 0.0f, // Positive Y because texture coords will match
-        0.0f, 0.0f, -1.0f, 0.0f,
-        -1.0f, -1.0f, 0.0f, 1.0f
-    };
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "projection")) >= 0) glUniformMatrix4fv(loc, 1, GL_FALSE, projection);
 
-    // Full screen quad
-    float vertices[] = {
-        0.0f, 0.0f,          0.0f, 0.0f, // Use standard UVs
-        (float)width, 0.0f,  1.0f, 0.0f,
-        (float)width, (float)height, 1.0f, 1.0f,
-        0.0f, (float)height, 0.0f, 1.0f
-    };
-    
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, inputTex);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "texture1")) >= 0) glUniform1i(loc, 0);
-    
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    
-    // Restore state
-    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
-    glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
-    glDeleteFramebuffers(1, &fbo);
-   
-    return tex;
+    return m_AtlasValid ? m_AtlasTexture[0] : 0;
 }
 
-GLuint TextureRenderer::GetFilteredTextureID(int width, int height) {
+void TextureRenderer::GetFilterAtlasUV(int filterType, float uv0[2], float uv1[2]) {
+    const float tile = 1.0f / kFilterAtlasColumns;
+    uv0[0] = (filterType % kFilterAtlasColumns) * tile;
+    uv0[1] = (filterType / kFilterAtlasColumns) * tile;
+    uv1[0] = uv0[0] + tile;
+    uv1[1] = uv0[1] + tile;
+}
+
+uint64_t TextureRenderer::GetRenderStateHash(int width, int height, uint64_t sceneHash) const {
+    StateHash hash;
+    hash.Add(sceneHash);
+    hash.Add(m_TextureID);
+    hash.Add(m_TextureVersion);
+    hash.Add(width);
+    hash.Add(height);
+
+    // Color pipeline (see ColorLUT)
+    hash.Add(m_FilterType);
+    hash.Add(m_Brightness);
+    hash.Add(m_Contrast);
+    hash.Add(m_Saturation);
+    hash.Add(m_Sepia);
+    hash.Add(m_CubeVersion);
+
+    // Effects
+    hash.Add(m_Vignette);
+    hash.Add(m_Grain);
+    hash.Add(m_Aberration);
+    hash.Add(m_BlurAmount);
+    hash.Add(m_BlurType);
+    hash.Add(m_GlitchIntensity);
+    hash.Add(m_RippleFreq);
+    hash.Add(m_RippleAmp);
+    hash.Add(m_Distortion);
+    hash.Add(m_EdgeGlowIntensity);
+    hash.Add(m_EdgeGlowColor);
+    hash.Add(m_FadeAmount);
+    hash.Add(m_ZoomAmount);
+    hash.Add(m_LightLeakIntensity);
+
+    // Grain is animated: a new pattern every frame while it is on
+    if (m_Grain > 0.0f) hash.Add(glfwGetTime());
+    return hash.value;
+}
+
+GLuint TextureRenderer::GetFilteredTextureID(int width, int height, uint64_t sceneHash) {
     if (!m_Initialized || !m_TextureID) return m_TextureID; // Fallback to original
     
     // Recreate if size changed or FBO doesn't exist
@@ -634,7 +830,13 @@ GLuint TextureRenderer::GetFilteredTextureID(int width, int height) {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         m_PreviewWidth = width;
         m_PreviewHeight = height;
+        m_PreviewValid = false;
     }
+
+    // Nothing changed since the last render: reuse it (paused preview
+    // costs no GPU work)
+    uint64_t stateHash = GetRenderStateHash(width, height, sceneHash);
+    if (m_PreviewValid && stateHash == m_PreviewHash) return m_PreviewTexture;
     
     // Save current OpenGL state
     GLint oldViewport[4];
@@ -654,14 +856,10 @@ GLuint TextureRenderer::GetFilteredTextureID(int width, int height) {
     // Set all uniforms with current filter settings
     GLint loc;
     if ((loc = glGetUniformLocation(m_ShaderProgram, "alpha")) >= 0) glUniform1f(loc, 1.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "brightness")) >= 0) glUniform1f(loc, m_Brightness);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "contrast")) >= 0) glUniform1f(loc, m_Contrast);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "saturation")) >= 0) glUniform1f(loc, m_Saturation);
+    ApplyColorLUT(GetGrade(), true);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "vignette")) >= 0) glUniform1f(loc, m_Vignette);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "grain")) >= 0) glUniform1f(loc, m_Grain);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "aberration")) >= 0) glUniform1f(loc, m_Aberration);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "sepia")) >= 0) glUniform1i(loc, m_Sepia ? 1 : 0);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "filterType")) >= 0) glUniform1i(loc, m_FilterType);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "time")) >= 0) glUniform1f(loc, (float)glfwGetTime());
     
     // Blur uniforms (CRITICAL for preview!)
@@ -701,6 +899,9 @@ GLuint TextureRenderer::GetFilteredTextureID(int width, int height) {
     glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
     glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
     
+    m_PreviewHash = stateHash;
+    m_PreviewValid = true;
+    m_PreviewRenders++;
     return m_PreviewTexture;
 }
 
@@ -718,14 +919,10 @@ void TextureRenderer::RenderOverlay(unsigned int textureID, float x, float y, fl
     // Disable effects for overlay/stickers usually, or keep them? 
     // Usually overlays are not affected by video filters, but for simplicity they share shader.
     // Let's reset effects for overlays to avoid double-application or weirdness
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "brightness")) >= 0) glUniform1f(loc, 0.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "contrast")) >= 0) glUniform1f(loc, 1.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "saturation")) >= 0) glUniform1f(loc, 1.0f);
+    if ((loc = glGetUniformLocation(m_ShaderProgram, "lutEnabled")) >= 0) glUniform1i(loc, 0); // No filter for overlays
     if ((loc = glGetUniformLocation(m_ShaderProgram, "vignette")) >= 0) glUniform1f(loc, 0.0f);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "grain")) >= 0) glUniform1f(loc, 0.0f);
     if ((loc = glGetUniformLocation(m_ShaderProgram, "aberration")) >= 0) glUniform1f(loc, 0.0f);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "sepia")) >= 0) glUniform1i(loc, 0);
-    if ((loc = glGetUniformLocation(m_ShaderProgram, "filterType")) >= 0) glUniform1i(loc, 0); // No filter for overlays
 
     float projection[16] = {
         2.0f / 1280.0f, 0.0f, 0.0f, 0.0f,
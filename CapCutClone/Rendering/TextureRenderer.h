@@ -2,12 +2,32 @@
 
 #include <glad/glad.h>
 
+#include "ColorLUT.h"
 #include <cstdint>
+#include <string>
 #include <vector>
 
 
 class TextureRenderer {
 public:
+  /**
+   * @brief 64-bit FNV-1a over the bytes of each value added
+   */
+  struct StateHash {
+    uint64_t value = 14695981039346656037ull;
+
+    void Add(const void *data, size_t size) {
+      const uint8_t *bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0; i < size; ++i)
+        value = (value ^ bytes[i]) * 1099511628211ull;
+    }
+    template <typename T> void Add(const T &v) { Add(&v, sizeof(v)); }
+    void Add(const std::string &s) {
+      Add(s.data(), s.size());
+      Add(s.size());
+    }
+  };
+
   TextureRenderer();
   ~TextureRenderer();
 
@@ -69,6 +89,7 @@ public:
   void BindFramebuffer();
   void UnbindFramebuffer();
   void GetRGBPixels(std::vector<uint8_t> &buffer, int width, int height);
+  GLuint GetFramebufferTexture() const { return m_FBOTexture; }
 
   // Copy visual settings from another renderer
   void CopySettingsFrom(const TextureRenderer *other);
@@ -78,14 +99,35 @@ public:
   void SetFilterType(int type); // 0 = None, 1...N = Filters
   int GetFilterType() const { return m_FilterType; }
 
-  // Generate a thumbnail with a specific filter applied (for UI)
-  // Returns the new texture ID. Caller owns the texture.
-  GLuint GenerateFilterThumbnail(GLuint inputTex, int filterType, int width,
-                                 int height);
+  // Imported .cube LUT, applied after the filter preset (see ColorLUT)
+  bool LoadCubeLUT(const std::string &path); // Keeps the old one on failure
+  void ClearCubeLUT();
+  const std::string &GetCubeLUTPath() const { return m_Cube.path; }
+  const std::string &GetCubeLUTTitle() const { return m_Cube.title; }
+  const std::string &GetCubeLUTError() const { return m_CubeError; }
+
+  // Filter preview atlas (for UI): every preset applied to the current
+  // video frame, or to @p fallbackTex while no video is loaded, as
+  // kFilterAtlasColumns x kFilterAtlasColumns square tiles of @p tileSize
+  // in one instanced draw. A new frame starts a re-render in the
+  // background, at most one per kFilterAtlasInterval; until its fence
+  // signals the previous atlas is returned (0 before the first one
+  // finishes). Pending while a render is in flight or held back.
+  static constexpr int kFilterCount = 16; // Including 0 = None
+  static constexpr int kFilterAtlasColumns = 4;
+  static constexpr double kFilterAtlasInterval = 0.25; // Seconds
+  GLuint GetFilterAtlas(GLuint fallbackTex, int tileSize);
+  bool IsFilterAtlasPending() const {
+    return m_AtlasFence != nullptr || m_AtlasDeferred;
+  }
+  static void GetFilterAtlasUV(int filterType, float uv0[2], float uv1[2]);
 
   // Render current texture with filter to FBO and return FBO texture ID (for
-  // ImGui preview)
-  GLuint GetFilteredTextureID(int width, int height);
+  // ImGui preview). Re-renders only when the source frame, a parameter,
+  // the size or @p sceneHash (caller state such as timeline layers)
+  // changed since the last call; animated grain renders every call.
+  GLuint GetFilteredTextureID(int width, int height, uint64_t sceneHash = 0);
+  uint64_t GetPreviewRenderCount() const { return m_PreviewRenders; }
 
   // YUV Export Support (Phase 1 optimization)
   struct YUVFramebuffer {
@@ -119,10 +161,39 @@ private:
   GLuint m_PreviewTexture;
   int m_PreviewWidth;
   int m_PreviewHeight;
+  uint64_t m_PreviewHash; // Render state of m_PreviewTexture
+  bool m_PreviewValid;
+  uint64_t m_PreviewRenders;
+  uint64_t m_TextureVersion; // Bumped by every upload
+  uint64_t m_CubeVersion;    // Bumped by every LUT load or clear
 
   bool m_FlipY;
   int m_FilterType;
 
+  // Color LUT: filter, color correction and sepia, rebaked when they change
+  GLuint m_LUTTexture;
+  ColorLUT::Grade m_LUTGrade; // What m_LUTTexture holds
+  bool m_LUTHasCube;
+  bool m_LUTValid;
+  ColorLUT::Cube m_Cube;
+  std::string m_CubeError;
+  std::vector<float> m_LUTTable; // Bake output
+
+  // Filter preview atlas
+  GLuint m_AtlasProgram;
+  GLuint m_AtlasVAO;
+  GLuint m_AtlasQuadVBO;
+  GLuint m_AtlasInstanceVBO; // Filter index per instance
+  GLuint m_AtlasLUT;         // Every preset's lattice, grid over red/blue
+  GLuint m_AtlasFBO;
+  GLuint m_AtlasTexture[2];  // Shown, rendering
+  GLsync m_AtlasFence;       // Set while m_AtlasTexture[1] renders
+  int m_AtlasTileSize;
+  uint64_t m_AtlasSourceHash; // Source of the newest render
+  bool m_AtlasValid;          // m_AtlasTexture[0] holds a finished atlas
+  double m_AtlasRenderTime;   // glfwGetTime() of the newest render
+  bool m_AtlasDeferred;       // Source changed, render held back
+
   // PBO for async readback (Double buffering)
   GLuint m_PBO[2];
   int m_PBOIndex;
@@ -165,4 +236,11 @@ private:
   bool CreateShaderProgram();
   void SetupQuad();
   bool CreateYUVShaders(); // Compile RGB→YUV shaders
+  ColorLUT::Grade GetGrade() const;
+  uint64_t GetRenderStateHash(int width, int height, uint64_t sceneHash) const;
+  void CreateColorLUT();
+  // Bake if needed, bind to texture unit 1 and set the LUT uniforms
+  void ApplyColorLUT(const ColorLUT::Grade &grade, bool withCube);
+  bool CreateFilterAtlas(int tileSize);
+  void DestroyFilterAtlas();
 };
@@ -9,10 +9,11 @@ struct Clip {
     double outPoint;       // End point within the source file (seconds)
     int trackIndex;        // Index of the track this clip belongs to (0-based)
     int id;                // Unique ID for selection/identification
+    double speed = 1.0;    // Source seconds played per timeline second (0.25 - 4)
 
     // Helper to get the actual duration of the clip on the timeline
     double GetDisplayDuration() const {
-        return outPoint - inPoint;
+        return (outPoint - inPoint) / speed;
     }
     
     // Helper to get the end time on the timeline
@@ -27,6 +28,6 @@ struct Clip {
 
     // Convert timeline time to local clip video time
     double ToLocalTime(double timelineTime) const {
-        return inPoint + (timelineTime - startTime);
+        return inPoint + (timelineTime - startTime) * speed;
     }
 };
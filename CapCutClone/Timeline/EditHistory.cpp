@@ -0,0 +1,109 @@
+#include "EditHistory.h"
+#include <cstring>
+
+void EditHistory::Push(Step step) {
+    for (const auto& redo : m_Redo) {
+        m_Bytes -= redo.bytes;
+    }
+    m_Redo.clear();
+
+    if (step.mergeable && TryMerge(step)) {
+        return;
+    }
+
+    step.bytes = EstimateBytes(step);
+    m_Bytes += step.bytes;
+    m_Undo.push_back(std::move(step));
+    m_GestureOpen = true;
+    Trim();
+}
+
+bool EditHistory::TryMerge(Step& step) {
+    if (!m_GestureOpen || m_Undo.empty() || !m_Undo.back().mergeable) {
+        return false;
+    }
+
+    // Same kind of edit (a trim right after a move on the same clip stays
+    // its own step) on the same single clip, effect or track
+    Step& last = m_Undo.back();
+    if (std::strcmp(step.name, last.name) != 0) {
+        return false;
+    }
+    bool merged = false;
+    if (step.clips.size() == 1 && last.clips.size() == 1 &&
+        step.effects.empty() && last.effects.empty() &&
+        step.trackAudio.empty() && last.trackAudio.empty() &&
+        step.clips[0].id == last.clips[0].id &&
+        step.clips[0].trackIndex == last.clips[0].trackIndex) {
+        last.clips[0].after = std::move(step.clips[0].after);
+        merged = true;
+    } else if (step.effects.size() == 1 && last.effects.size() == 1 &&
+               step.clips.empty() && last.clips.empty() &&
+               step.trackAudio.empty() && last.trackAudio.empty() &&
+               step.effects[0].id == last.effects[0].id) {
+        last.effects[0].after = std::move(step.effects[0].after);
+        merged = true;
+    } else if (step.trackAudio.size() == 1 && last.trackAudio.size() == 1 &&
+               step.clips.empty() && last.clips.empty() &&
+               step.effects.empty() && last.effects.empty() &&
+               step.trackAudio[0].trackIndex == last.trackAudio[0].trackIndex) {
+        last.trackAudio[0].after = step.trackAudio[0].after;
+        merged = true;
+    }
+    if (!merged) {
+        return false;
+    }
+
+    // The new after image may be larger (a longer path, more params)
+    m_Bytes -= last.bytes;
+    last.bytes = EstimateBytes(last);
+    m_Bytes += last.bytes;
+    Trim();
+    return true;
+}
+
+void EditHistory::Undone() {
+    if (m_Undo.empty()) return;
+    m_Redo.push_back(std::move(m_Undo.back()));
+    m_Undo.pop_back();
+    m_GestureOpen = false;
+}
+
+void EditHistory::Redone() {
+    if (m_Redo.empty()) return;
+    m_Undo.push_back(std::move(m_Redo.back()));
+    m_Redo.pop_back();
+    m_GestureOpen = false;
+}
+
+void EditHistory::Clear() {
+    m_Undo.clear();
+    m_Redo.clear();
+    m_Bytes = 0;
+    m_GestureOpen = false;
+}
+
+void EditHistory::Trim() {
+    while (!m_Undo.empty() &&
+           (m_Undo.size() > kMaxSteps || m_Bytes > kMaxBytes)) {
+        m_Bytes -= m_Undo.front().bytes;
+        m_Undo.pop_front();
+    }
+}
+
+size_t EditHistory::EstimateBytes(const Step& step) {
+    size_t bytes = sizeof(Step);
+    for (const auto& image : step.clips) {
+        bytes += sizeof(ClipImage);
+        if (image.before) bytes += image.before->filepath.capacity();
+        if (image.after) bytes += image.after->filepath.capacity();
+    }
+    for (const auto& image : step.effects) {
+        // std::map node plus the key string, roughly
+        size_t params = (image.before ? image.before->params.size() : 0) +
+                        (image.after ? image.after->params.size() : 0);
+        bytes += sizeof(EffectImage) + params * 64;
+    }
+    bytes += step.trackAudio.size() * sizeof(TrackAudioImage);
+    return bytes;
+}
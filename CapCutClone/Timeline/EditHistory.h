@@ -0,0 +1,91 @@
+#pragma once
+#include "Clip.h"
+#include "EffectLayer.h"
+#include "../Audio/AudioEffectSettings.h"
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Undo/redo log of timeline edits
+ *
+ * A step stores only what the edit touched: the before and after image
+ * of each changed clip or effect (empty = did not exist) or of a track's
+ * audio effect settings. Undo puts the
+ * before images back, redo the after images, so both cost the size of
+ * the edit, not the size of the project.
+ *
+ * Continuous edits (dragging a clip, an effect handle or a slider) arrive
+ * as one call per frame. While a gesture is open, mergeable steps of the
+ * same kind (same name) on the same clip or effect fold into the previous
+ * step, which keeps the first before image and takes the latest after
+ * image. EndGesture() closes it.
+ *
+ * The log is bounded by step count and by an estimate of the bytes held;
+ * the oldest steps are dropped first.
+ */
+class EditHistory {
+public:
+    struct ClipImage {
+        int trackIndex;
+        int id;
+        std::optional<Clip> before;
+        std::optional<Clip> after;
+    };
+
+    struct EffectImage {
+        int id;
+        size_t index; // Position in the effect list (effects apply in order)
+        std::optional<EffectLayer> before;
+        std::optional<EffectLayer> after;
+    };
+
+    struct TrackAudioImage {
+        int trackIndex;
+        AudioEffectSettings before;
+        AudioEffectSettings after;
+    };
+
+    struct Step {
+        const char* name = "";
+        bool mergeable = false; // Continuous edit of a single clip/effect/track
+        int addedTrack = -1;    // Track appended by this step, -1 if none
+        std::vector<ClipImage> clips;
+        std::vector<EffectImage> effects;
+        std::vector<TrackAudioImage> trackAudio;
+        size_t bytes = 0;       // Filled in by Push()
+    };
+
+    // Record an applied edit; clears the redo list
+    void Push(Step step);
+
+    bool CanUndo() const { return !m_Undo.empty(); }
+    bool CanRedo() const { return !m_Redo.empty(); }
+    const char* GetUndoName() const { return m_Undo.empty() ? "" : m_Undo.back().name; }
+    const char* GetRedoName() const { return m_Redo.empty() ? "" : m_Redo.back().name; }
+
+    // The step to undo/redo next; call Undone()/Redone() once it is applied
+    const Step* PeekUndo() const { return m_Undo.empty() ? nullptr : &m_Undo.back(); }
+    const Step* PeekRedo() const { return m_Redo.empty() ? nullptr : &m_Redo.back(); }
+    void Undone();
+    void Redone();
+
+    void EndGesture() { m_GestureOpen = false; }
+    void Clear();
+
+    size_t GetMemoryUsage() const { return m_Bytes; }
+
+    static constexpr size_t kMaxSteps = 1000;
+    static constexpr size_t kMaxBytes = 16u << 20; // 16 MB
+
+private:
+    std::deque<Step> m_Undo;
+    std::vector<Step> m_Redo;
+    size_t m_Bytes = 0;
+    bool m_GestureOpen = false;
+
+    static size_t EstimateBytes(const Step& step);
+    bool TryMerge(Step& step);
+    void Trim();
+};
@@ -0,0 +1,888 @@
+#include "ProjectFile.h"
+#include "TimelineManager.h"
+#include "../Audio/LoudnessAnalyzer.h"
+#include "../Core/MappedFile.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+using namespace ProjectFormat;
+
+static_assert(sizeof(FileHeader) == 32 && sizeof(SectionEntry) == 24, "layout");
+static_assert(sizeof(MediaRecord) == 16 && sizeof(TrackRecord) == 16, "layout");
+static_assert(sizeof(ClipRecord) == 32 && sizeof(EffectRecord) == 32, "layout");
+static_assert(sizeof(ParamRecord) == 16 && sizeof(StickerRecord) == 48, "layout");
+static_assert(sizeof(KeyframeRecord) == 32 && sizeof(LoudnessRecord) == 16, "layout");
+static_assert(sizeof(TrackAudioRecord) == 88, "layout");
+
+namespace {
+
+// ============================================================================
+// Journal layout
+// ============================================================================
+
+struct JournalHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t snapshotId;
+};
+
+struct RecordHeader {
+    uint32_t size;     // Payload bytes
+    uint16_t type;     // RecordType
+    uint16_t reserved;
+    uint32_t sequence; // 0, 1, 2... since the snapshot
+    uint32_t checksum; // FNV-1a of the payload
+};
+
+enum RecordType : uint16_t {
+    TrackAdd = 1,     // int32 trackIndex
+    ClipUpsert = 2,   // JournalClip + path bytes
+    ClipRemove = 3,   // int32 trackIndex, int32 id
+    EffectUpsert = 4, // JournalEffect + paramCount x (JournalParam + name)
+    EffectRemove = 5, // int32 id
+    TrackRemove = 6,  // int32 trackIndex (undo of TrackAdd)
+    TrackAudio = 7    // int32 trackIndex, TrackAudioRecord
+};
+
+struct JournalClip {
+    double startTime;
+    double duration;
+    double inPoint;
+    double outPoint;
+    int32_t id;
+    int32_t trackIndex;
+    uint32_t pathLength;
+    float speed; // 0 (older journals) = 1x
+};
+
+struct JournalEffect {
+    double startTime;
+    double duration;
+    int32_t id;
+    int32_t type;
+    uint32_t paramCount;
+    uint32_t index; // Position in the effect list (effects apply in order)
+};
+
+struct JournalParam {
+    float value;
+    uint32_t nameLength;
+};
+
+uint32_t Checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void Put(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void PutString(std::vector<uint8_t>& out, const std::string& text) {
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+// Bounds-checked sequential reads over a journal payload
+struct Reader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+    template <typename T>
+    bool Get(T& value) {
+        if (size - pos < sizeof(T)) return false;
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool GetString(std::string& text, uint32_t length) {
+        if (size - pos < length) return false;
+        text.assign(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return true;
+    }
+};
+
+TrackAudioRecord ToRecord(const AudioEffectSettings& settings) {
+    TrackAudioRecord record{};
+    record.enabled = (settings.gate.enabled ? 1u : 0u) | (settings.eq.enabled ? 2u : 0u) |
+                     (settings.compressor.enabled ? 4u : 0u) |
+                     (settings.limiter.enabled ? 8u : 0u);
+    record.fadeCurve = static_cast<uint32_t>(settings.fades.curve);
+    record.fadeIn = settings.fades.in;
+    record.fadeOut = settings.fades.out;
+    record.gateThreshold = settings.gate.threshold;
+    record.gateAttack = settings.gate.attack;
+    record.gateRelease = settings.gate.release;
+    record.eqLowGain = settings.eq.lowGain;
+    record.eqLowFreq = settings.eq.lowFreq;
+    record.eqMidGain = settings.eq.midGain;
+    record.eqMidFreq = settings.eq.midFreq;
+    record.eqMidQ = settings.eq.midQ;
+    record.eqHighGain = settings.eq.highGain;
+    record.eqHighFreq = settings.eq.highFreq;
+    record.compressorThreshold = settings.compressor.threshold;
+    record.compressorRatio = settings.compressor.ratio;
+    record.compressorKnee = settings.compressor.knee;
+    record.compressorAttack = settings.compressor.attack;
+    record.compressorRelease = settings.compressor.release;
+    record.compressorMakeup = settings.compressor.makeup;
+    record.limiterCeiling = settings.limiter.ceiling;
+    record.limiterRelease = settings.limiter.release;
+    return record;
+}
+
+AudioEffectSettings FromRecord(const TrackAudioRecord& record) {
+    AudioEffectSettings settings;
+    settings.gate.enabled = (record.enabled & 1u) != 0;
+    settings.eq.enabled = (record.enabled & 2u) != 0;
+    settings.compressor.enabled = (record.enabled & 4u) != 0;
+    settings.limiter.enabled = (record.enabled & 8u) != 0;
+    if (record.fadeCurve <= static_cast<uint32_t>(FadeCurve::Exponential)) {
+        settings.fades.curve = static_cast<FadeCurve>(record.fadeCurve);
+    }
+    settings.fades.in = record.fadeIn;
+    settings.fades.out = record.fadeOut;
+    settings.gate.threshold = record.gateThreshold;
+    settings.gate.attack = record.gateAttack;
+    settings.gate.release = record.gateRelease;
+    settings.eq.lowGain = record.eqLowGain;
+    settings.eq.lowFreq = record.eqLowFreq;
+    settings.eq.midGain = record.eqMidGain;
+    settings.eq.midFreq = record.eqMidFreq;
+    settings.eq.midQ = record.eqMidQ;
+    settings.eq.highGain = record.eqHighGain;
+    settings.eq.highFreq = record.eqHighFreq;
+    settings.compressor.threshold = record.compressorThreshold;
+    settings.compressor.ratio = record.compressorRatio;
+    settings.compressor.knee = record.compressorKnee;
+    settings.compressor.attack = record.compressorAttack;
+    settings.compressor.release = record.compressorRelease;
+    settings.compressor.makeup = record.compressorMakeup;
+    settings.limiter.ceiling = record.limiterCeiling;
+    settings.limiter.release = record.limiterRelease;
+    return settings;
+}
+
+uint64_t NewSnapshotId() {
+    std::random_device device;
+    uint64_t id = (static_cast<uint64_t>(device()) << 32) ^ device();
+    return id ^ static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+// ============================================================================
+// Snapshot reading
+// ============================================================================
+
+/**
+ * @brief Typed view of one mapped section (empty if absent or invalid)
+ */
+template <typename T>
+struct SectionView {
+    const uint8_t* base = nullptr;
+    uint32_t stride = 0;
+    uint64_t count = 0;
+
+    const T& operator[](uint64_t i) const {
+        return *reinterpret_cast<const T*>(base + i * stride);
+    }
+};
+
+class Snapshot {
+public:
+    bool Open(const MappedFile& file) {
+        m_Data = file.GetData();
+        m_Size = file.GetSize();
+        if (m_Size < sizeof(FileHeader)) return false;
+
+        m_Header = reinterpret_cast<const FileHeader*>(m_Data);
+        if (m_Header->magic != kMagic) {
+            std::cerr << "[ProjectFile] Not a project file" << std::endl;
+            return false;
+        }
+        if (m_Header->version > kVersion) {
+            std::cerr << "[ProjectFile] Project version " << m_Header->version
+                      << " is newer than this build (" << kVersion << ")" << std::endl;
+            return false;
+        }
+        uint64_t directoryEnd = sizeof(FileHeader) +
+            static_cast<uint64_t>(m_Header->sectionCount) * sizeof(SectionEntry);
+        if (m_Header->fileSize != m_Size || directoryEnd > m_Size) {
+            std::cerr << "[ProjectFile] Truncated project file" << std::endl;
+            return false;
+        }
+        m_Sections = reinterpret_cast<const SectionEntry*>(m_Data + sizeof(FileHeader));
+        return true;
+    }
+
+    uint64_t GetSnapshotId() const { return m_Header->snapshotId; }
+
+    template <typename T>
+    bool Get(SectionType type, SectionView<T>& view) const {
+        view = SectionView<T>();
+        for (uint32_t i = 0; i < m_Header->sectionCount; ++i) {
+            const SectionEntry& entry = m_Sections[i];
+            if (entry.type != static_cast<uint32_t>(type)) continue;
+
+            bool valid = entry.recordSize >= sizeof(T) &&
+                         entry.offset % alignof(T) == 0 &&
+                         entry.recordSize % alignof(T) == 0 &&
+                         entry.offset <= m_Size &&
+                         entry.count <= (m_Size - entry.offset) / entry.recordSize;
+            if (!valid) {
+                std::cerr << "[ProjectFile] Corrupt section " << entry.type << std::endl;
+                return false;
+            }
+            view.base = m_Data + entry.offset;
+            view.stride = entry.recordSize;
+            view.count = entry.count;
+            return true;
+        }
+        return true; // Absent = empty
+    }
+
+    bool GetString(const SectionView<char>& strings, StringRef ref, std::string& text) const {
+        if (ref.offset > strings.count || ref.length > strings.count - ref.offset) return false;
+        text.assign(reinterpret_cast<const char*>(strings.base) + ref.offset, ref.length);
+        return true;
+    }
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    const FileHeader* m_Header = nullptr;
+    const SectionEntry* m_Sections = nullptr;
+};
+
+// ============================================================================
+// Journal replay (applied to the loaded state before it reaches the timeline)
+// ============================================================================
+
+/**
+ * @brief Applies journal records to the loaded tracks and effects
+ *
+ * Clips are found through a per-track ID index and updated in place;
+ * touched tracks are sorted once in Finish() instead of after every record.
+ */
+class Replay {
+public:
+    Replay(std::vector<Track>& tracks, std::vector<EffectLayer>& effects)
+        : m_Tracks(tracks), m_Effects(effects) {}
+
+    bool Apply(uint16_t type, Reader& in) {
+        switch (type) {
+        case TrackAdd: {
+            int32_t trackIndex;
+            if (!in.Get(trackIndex)) return false;
+            GetTrack(trackIndex);
+            return true;
+        }
+        case TrackRemove: {
+            int32_t trackIndex;
+            if (!in.Get(trackIndex)) return false;
+            if (trackIndex == static_cast<int>(m_Tracks.size()) - 1 &&
+                m_Tracks.back().clips.empty()) {
+                m_Tracks.pop_back();
+                if (m_Index.size() > m_Tracks.size()) m_Index.resize(m_Tracks.size());
+            }
+            return true;
+        }
+        case ClipUpsert: {
+            JournalClip record;
+            Clip clip;
+            if (!in.Get(record) || !in.GetString(clip.filepath, record.pathLength)) return false;
+            clip.startTime = record.startTime;
+            clip.duration = record.duration;
+            clip.inPoint = record.inPoint;
+            clip.outPoint = record.outPoint;
+            clip.trackIndex = record.trackIndex;
+            clip.id = record.id;
+            if (record.speed > 0.0f) clip.speed = record.speed;
+            UpsertClip(clip);
+            return true;
+        }
+        case ClipRemove: {
+            int32_t trackIndex, id;
+            if (!in.Get(trackIndex) || !in.Get(id)) return false;
+            RemoveClip(trackIndex, id);
+            return true;
+        }
+        case EffectUpsert: {
+            JournalEffect record;
+            if (!in.Get(record)) return false;
+            EffectLayer effect(record.id, static_cast<EffectLayer::EffectType>(record.type),
+                               record.startTime, record.duration);
+            effect.params.clear();
+            for (uint32_t i = 0; i < record.paramCount; ++i) {
+                JournalParam param;
+                std::string name;
+                if (!in.Get(param) || !in.GetString(name, param.nameLength)) return false;
+                effect.params[name] = param.value;
+            }
+            auto it = std::find_if(m_Effects.begin(), m_Effects.end(),
+                [&](const EffectLayer& e) { return e.id == effect.id; });
+            if (it != m_Effects.end()) {
+                *it = effect;
+            } else {
+                size_t index = std::min<size_t>(record.index, m_Effects.size());
+                m_Effects.insert(m_Effects.begin() + index, effect);
+            }
+            return true;
+        }
+        case TrackAudio: {
+            int32_t trackIndex;
+            TrackAudioRecord record;
+            if (!in.Get(trackIndex) || !in.Get(record)) return false;
+            if (Track* track = GetTrack(trackIndex)) track->audioEffects = FromRecord(record);
+            return true;
+        }
+        case EffectRemove: {
+            int32_t id;
+            if (!in.Get(id)) return false;
+            m_Effects.erase(std::remove_if(m_Effects.begin(), m_Effects.end(),
+                [id](const EffectLayer& e) { return e.id == id; }), m_Effects.end());
+            return true;
+        }
+        default:
+            return true; // Newer record type, nothing to apply
+        }
+    }
+
+    void Finish() {
+        for (size_t t = 0; t < m_Index.size(); ++t) {
+            if (m_Index[t].empty()) continue;
+            auto& clips = m_Tracks[t].clips;
+            std::sort(clips.begin(), clips.end(), [](const Clip& a, const Clip& b) {
+                return a.startTime < b.startTime;
+            });
+        }
+    }
+
+private:
+    std::vector<Track>& m_Tracks;
+    std::vector<EffectLayer>& m_Effects;
+    std::vector<std::unordered_map<int, size_t>> m_Index; // Built on first touch
+
+    Track* GetTrack(int trackIndex) {
+        if (trackIndex < 0 || trackIndex >= TimelineManager::MAX_TRACKS) return nullptr;
+        while (static_cast<int>(m_Tracks.size()) <= trackIndex) {
+            m_Tracks.emplace_back(static_cast<int>(m_Tracks.size()));
+        }
+        return &m_Tracks[trackIndex];
+    }
+
+    std::unordered_map<int, size_t>& GetIndex(int trackIndex) {
+        if (m_Index.size() < m_Tracks.size()) m_Index.resize(m_Tracks.size());
+        auto& index = m_Index[trackIndex];
+        if (index.empty()) {
+            const auto& clips = m_Tracks[trackIndex].clips;
+            for (size_t i = 0; i < clips.size(); ++i) index[clips[i].id] = i;
+        }
+        return index;
+    }
+
+    void UpsertClip(const Clip& clip) {
+        Track* track = GetTrack(clip.trackIndex);
+        if (!track) return;
+        auto& index = GetIndex(clip.trackIndex);
+        auto it = index.find(clip.id);
+        if (it != index.end()) {
+            track->clips[it->second] = clip;
+        } else {
+            index[clip.id] = track->clips.size();
+            track->clips.push_back(clip);
+        }
+    }
+
+    void RemoveClip(int trackIndex, int id) {
+        if (trackIndex < 0 || trackIndex >= static_cast<int>(m_Tracks.size())) return;
+        auto& clips = m_Tracks[trackIndex].clips;
+        auto& index = GetIndex(trackIndex);
+        auto it = index.find(id);
+        if (it == index.end()) return;
+
+        // Order is restored in Finish(), so fill the hole with the last clip
+        size_t slot = it->second;
+        index.erase(it);
+        if (slot + 1 != clips.size()) {
+            clips[slot] = std::move(clips.back());
+            index[clips[slot].id] = slot;
+        }
+        clips.pop_back();
+    }
+};
+
+} // namespace
+
+// ============================================================================
+// Save
+// ============================================================================
+
+ProjectFile::~ProjectFile() {
+    Close();
+}
+
+void ProjectFile::Close() {
+    if (m_Journal) {
+        fclose(m_Journal);
+        m_Journal = nullptr;
+    }
+    m_JournalSize = 0;
+    m_Sequence = 0;
+}
+
+bool ProjectFile::Save(const std::string& path, const TimelineManager& timeline,
+                       const std::vector<Sticker>& stickers) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // 1. Flatten the timeline into record arrays
+    std::string strings;
+    std::unordered_map<std::string, StringRef> interned;
+    auto intern = [&](const std::string& text) {
+        auto it = interned.find(text);
+        if (it != interned.end()) return it->second;
+        StringRef ref{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(text.size())};
+        strings += text;
+        interned.emplace(text, ref);
+        return ref;
+    };
+
+    std::vector<MediaRecord> media;
+    std::vector<LoudnessRecord> loudness; // Parallel to media
+    std::unordered_map<std::string, uint32_t> mediaIndex;
+    std::vector<TrackRecord> tracks;
+    std::vector<ClipRecord> clips;
+    std::vector<float> clipSpeeds; // Parallel to clips
+    std::vector<TrackAudioRecord> trackAudio; // Parallel to tracks
+    for (const auto& track : timeline.GetTracks()) {
+        TrackRecord trackRecord{};
+        trackRecord.trackIndex = track.trackIndex;
+        trackRecord.firstClip = static_cast<uint32_t>(clips.size());
+        trackRecord.clipCount = static_cast<uint32_t>(track.clips.size());
+        tracks.push_back(trackRecord);
+        trackAudio.push_back(ToRecord(track.audioEffects));
+
+        for (const auto& clip : track.clips) {
+            auto it = mediaIndex.find(clip.filepath);
+            if (it == mediaIndex.end()) {
+                it = mediaIndex.emplace(clip.filepath, static_cast<uint32_t>(media.size())).first;
+                media.push_back({intern(clip.filepath), clip.duration});
+                LoudnessAnalyzer::Result result;
+                bool analyzed = LoudnessAnalyzer::Lookup(clip.filepath, result);
+                loudness.push_back({analyzed ? result.loudness : 0.0f,
+                                    analyzed ? result.truePeak : 0.0f,
+                                    analyzed ? 1u : 0u, 0});
+            }
+            clips.push_back({clip.startTime, clip.inPoint, clip.outPoint, clip.id, it->second});
+            clipSpeeds.push_back(static_cast<float>(clip.speed));
+        }
+    }
+
+    std::vector<EffectRecord> effects;
+    std::vector<ParamRecord> params;
+    for (const auto& effect : timeline.GetEffectLayers()) {
+        effects.push_back({effect.startTime, effect.duration, effect.id,
+                           static_cast<int32_t>(effect.type),
+                           static_cast<uint32_t>(params.size()),
+                           static_cast<uint32_t>(effect.params.size())});
+        for (const auto& param : effect.params) {
+            params.push_back({intern(param.first), param.second, 0});
+        }
+    }
+
+    std::vector<StickerRecord> stickerRecords;
+    for (const auto& sticker : stickers) {
+        stickerRecords.push_back({sticker.startTime, sticker.duration,
+                                  sticker.position.x, sticker.position.y,
+                                  sticker.scale, sticker.rotation, sticker.opacity,
+                                  sticker.id, intern(sticker.filepath)});
+    }
+
+    // 2. Lay out header, directory and 8-byte aligned sections
+    struct Pending {
+        SectionType type;
+        uint32_t recordSize;
+        const void* data;
+        uint64_t count;
+    };
+    const Pending pending[] = {
+        {SectionType::Strings, 1, strings.data(), strings.size()},
+        {SectionType::Media, sizeof(MediaRecord), media.data(), media.size()},
+        {SectionType::Tracks, sizeof(TrackRecord), tracks.data(), tracks.size()},
+        {SectionType::Clips, sizeof(ClipRecord), clips.data(), clips.size()},
+        {SectionType::Effects, sizeof(EffectRecord), effects.data(), effects.size()},
+        {SectionType::EffectParams, sizeof(ParamRecord), params.data(), params.size()},
+        {SectionType::Stickers, sizeof(StickerRecord), stickerRecords.data(), stickerRecords.size()},
+        {SectionType::ClipSpeeds, sizeof(float), clipSpeeds.data(), clipSpeeds.size()},
+        {SectionType::MediaLoudness, sizeof(LoudnessRecord), loudness.data(), loudness.size()},
+        {SectionType::TrackAudio, sizeof(TrackAudioRecord), trackAudio.data(), trackAudio.size()},
+    };
+    const uint32_t sectionCount = sizeof(pending) / sizeof(pending[0]);
+
+    std::vector<uint8_t> bytes(sizeof(FileHeader) + sectionCount * sizeof(SectionEntry));
+    std::vector<SectionEntry> directory;
+    for (const auto& section : pending) {
+        bytes.resize((bytes.size() + 7) & ~size_t(7));
+        directory.push_back({static_cast<uint32_t>(section.type), section.recordSize,
+                             bytes.size(), section.count});
+        const uint8_t* data = static_cast<const uint8_t*>(section.data);
+        bytes.insert(bytes.end(), data, data + section.count * section.recordSize);
+    }
+
+    uint64_t snapshotId = NewSnapshotId();
+    FileHeader header{kMagic, kVersion, sectionCount, 0, snapshotId, bytes.size()};
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), directory.data(),
+                directory.size() * sizeof(SectionEntry));
+
+    // 3. Write next to the target and swap in, so a failed save never
+    //    leaves a half-written project behind
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "[ProjectFile] Cannot write " << tempPath << std::endl;
+        return false;
+    }
+    bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    written = (fclose(file) == 0) && written;
+
+    std::error_code error;
+    if (written) {
+        std::filesystem::rename(tempPath, path, error);
+    }
+    if (!written || error) {
+        std::cerr << "[ProjectFile] Failed to save " << path << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    // 4. The snapshot now holds everything; start an empty journal for it
+    Close();
+    m_Path = path;
+    m_SnapshotId = snapshotId;
+    StartJournal(0);
+
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    std::cout << "[ProjectFile] Saved " << path << " (" << clips.size() << " clips, "
+              << effects.size() << " effects, " << bytes.size() << " bytes, "
+              << elapsed << " ms)" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Load
+// ============================================================================
+
+bool ProjectFile::Load(const std::string& path, TimelineManager& timeline,
+                       std::vector<Sticker>& stickers) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    MappedFile file;
+    Snapshot snapshot;
+    if (!file.Open(path) || !snapshot.Open(file)) {
+        std::cerr << "[ProjectFile] Failed to load " << path << std::endl;
+        return false;
+    }
+
+    SectionView<char> strings;
+    SectionView<MediaRecord> media;
+    SectionView<TrackRecord> trackRecords;
+    SectionView<ClipRecord> clipRecords;
+    SectionView<EffectRecord> effectRecords;
+    SectionView<ParamRecord> paramRecords;
+    SectionView<StickerRecord> stickerRecords;
+    SectionView<float> clipSpeeds;
+    SectionView<LoudnessRecord> loudness;
+    SectionView<TrackAudioRecord> trackAudio;
+    bool ok = snapshot.Get(SectionType::Strings, strings) &&
+              snapshot.Get(SectionType::Media, media) &&
+              snapshot.Get(SectionType::Tracks, trackRecords) &&
+              snapshot.Get(SectionType::Clips, clipRecords) &&
+              snapshot.Get(SectionType::Effects, effectRecords) &&
+              snapshot.Get(SectionType::EffectParams, paramRecords) &&
+              snapshot.Get(SectionType::Stickers, stickerRecords) &&
+              snapshot.Get(SectionType::ClipSpeeds, clipSpeeds) &&
+              snapshot.Get(SectionType::MediaLoudness, loudness) &&
+              snapshot.Get(SectionType::TrackAudio, trackAudio);
+
+    // 1. Build the timeline straight from the mapped records
+    std::vector<std::string> mediaPaths(ok ? media.count : 0);
+    for (uint64_t i = 0; ok && i < media.count; ++i) {
+        ok = snapshot.GetString(strings, media[i].path, mediaPaths[i]);
+        if (ok && i < loudness.count && loudness[i].analyzed) {
+            LoudnessAnalyzer::Store(mediaPaths[i], {loudness[i].loudness, loudness[i].truePeak});
+        }
+    }
+
+    std::vector<Track> tracks;
+    tracks.reserve(trackRecords.count);
+    for (uint64_t t = 0; ok && t < trackRecords.count; ++t) {
+        const TrackRecord& trackRecord = trackRecords[t];
+        if (trackRecord.firstClip > clipRecords.count ||
+            trackRecord.clipCount > clipRecords.count - trackRecord.firstClip) {
+            ok = false;
+            break;
+        }
+
+        Track track(trackRecord.trackIndex);
+        if (t < trackAudio.count) track.audioEffects = FromRecord(trackAudio[t]);
+        track.clips.reserve(trackRecord.clipCount);
+        for (uint32_t c = 0; c < trackRecord.clipCount; ++c) {
+            const ClipRecord& record = clipRecords[trackRecord.firstClip + c];
+            if (record.media >= media.count) {
+                ok = false;
+                break;
+            }
+            Clip clip;
+            clip.filepath = mediaPaths[record.media];
+            clip.startTime = record.startTime;
+            clip.duration = media[record.media].duration;
+            clip.inPoint = record.inPoint;
+            clip.outPoint = record.outPoint;
+            clip.trackIndex = trackRecord.trackIndex;
+            clip.id = record.id;
+            uint64_t clipIndex = trackRecord.firstClip + c;
+            if (clipIndex < clipSpeeds.count && clipSpeeds[clipIndex] > 0.0f)
+                clip.speed = clipSpeeds[clipIndex];
+            track.clips.push_back(clip); // Saved in order, no re-sort
+        }
+        tracks.push_back(std::move(track));
+    }
+
+    std::vector<EffectLayer> effects;
+    effects.reserve(effectRecords.count);
+    for (uint64_t e = 0; ok && e < effectRecords.count; ++e) {
+        const EffectRecord& record = effectRecords[e];
+        if (record.firstParam > paramRecords.count ||
+            record.paramCount > paramRecords.count - record.firstParam) {
+            ok = false;
+            break;
+        }
+        EffectLayer effect(record.id, static_cast<EffectLayer::EffectType>(record.type),
+                           record.startTime, record.duration);
+        effect.params.clear();
+        for (uint32_t p = 0; ok && p < record.paramCount; ++p) {
+            const ParamRecord& param = paramRecords[record.firstParam + p];
+            std::string name;
+            ok = snapshot.GetString(strings, param.name, name);
+            effect.params[name] = param.value;
+        }
+        effects.push_back(std::move(effect));
+    }
+
+    std::vector<Sticker> loadedStickers;
+    for (uint64_t s = 0; ok && s < stickerRecords.count; ++s) {
+        const StickerRecord& record = stickerRecords[s];
+        Sticker sticker;
+        sticker.id = record.id;
+        sticker.startTime = record.startTime;
+        sticker.duration = record.duration;
+        sticker.position = StickerVec2(record.x, record.y);
+        sticker.scale = record.scale;
+        sticker.rotation = record.rotation;
+        sticker.opacity = record.opacity;
+        ok = snapshot.GetString(strings, record.path, sticker.filepath);
+        loadedStickers.push_back(sticker);
+    }
+
+    if (!ok) {
+        std::cerr << "[ProjectFile] Corrupt project file: " << path << std::endl;
+        return false;
+    }
+
+    // 2. Replay edits made since the snapshot; stop at the first torn record
+    uint64_t snapshotId = snapshot.GetSnapshotId();
+    uint64_t journalEnd = 0;
+    uint32_t replayed = 0;
+    MappedFile journal;
+    std::error_code error;
+    std::string journalPath = GetJournalPath(path);
+    if (std::filesystem::exists(journalPath, error) &&
+        std::filesystem::file_size(journalPath, error) > 0 && journal.Open(journalPath)) {
+        const uint8_t* data = journal.GetData();
+        size_t size = journal.GetSize();
+
+        JournalHeader journalHeader;
+        if (size >= sizeof(journalHeader)) {
+            std::memcpy(&journalHeader, data, sizeof(journalHeader));
+        }
+        if (size >= sizeof(journalHeader) && journalHeader.magic == kJournalMagic &&
+            journalHeader.snapshotId == snapshotId) {
+            Replay replay(tracks, effects);
+            size_t pos = sizeof(journalHeader);
+            journalEnd = pos;
+            while (size - pos >= sizeof(RecordHeader)) {
+                RecordHeader record;
+                std::memcpy(&record, data + pos, sizeof(record));
+                const uint8_t* payload = data + pos + sizeof(record);
+                if (record.size > size - pos - sizeof(record) || record.sequence != replayed ||
+                    record.checksum != Checksum(payload, record.size)) {
+                    break;
+                }
+                Reader in{payload, record.size};
+                if (!replay.Apply(record.type, in)) break;
+
+                pos += sizeof(record) + record.size;
+                journalEnd = pos;
+                replayed++;
+            }
+            replay.Finish();
+
+            if (journalEnd < size) {
+                std::cout << "[ProjectFile] Dropped " << (size - journalEnd)
+                          << " bytes of incomplete autosave data" << std::endl;
+            }
+        } else {
+            std::cout << "[ProjectFile] Ignoring autosave journal from another snapshot"
+                      << std::endl;
+        }
+    }
+    journal.Close();
+    file.Close();
+
+    timeline.RestoreState(std::move(tracks), std::move(effects));
+    stickers = std::move(loadedStickers);
+
+    // 3. Keep appending to the same journal (minus any torn tail)
+    Close();
+    m_Path = path;
+    m_SnapshotId = snapshotId;
+    m_Sequence = replayed;
+    StartJournal(journalEnd);
+
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    std::cout << "[ProjectFile] Loaded " << path << " (" << clipRecords.count
+              << " clips, " << replayed << " autosaved edits, " << elapsed << " ms)"
+              << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Journal
+// ============================================================================
+
+bool ProjectFile::StartJournal(uint64_t keepBytes) {
+    std::string journalPath = GetJournalPath(m_Path);
+
+    if (keepBytes > 0) {
+        std::error_code error;
+        std::filesystem::resize_file(journalPath, keepBytes, error);
+        m_Journal = error ? nullptr : fopen(journalPath.c_str(), "ab");
+        m_JournalSize = keepBytes;
+    } else {
+        m_Journal = fopen(journalPath.c_str(), "wb");
+        JournalHeader header{kJournalMagic, kVersion, m_SnapshotId};
+        if (m_Journal && fwrite(&header, sizeof(header), 1, m_Journal) != 1) {
+            fclose(m_Journal);
+            m_Journal = nullptr;
+        }
+        if (m_Journal) fflush(m_Journal);
+        m_JournalSize = sizeof(header);
+        m_Sequence = 0;
+    }
+
+    if (!m_Journal) {
+        std::cerr << "[ProjectFile] Cannot open autosave journal " << journalPath
+                  << ", edits are not autosaved" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ProjectFile::RecordChange(const TimelineManager& timeline, const TimelineChange& change) {
+    if (!m_Journal) return;
+
+    m_Record.clear();
+    switch (change.kind) {
+    case TimelineChange::TrackAdded:
+        Put<int32_t>(m_Record, change.trackIndex);
+        AppendRecord(TrackAdd);
+        break;
+
+    case TimelineChange::TrackRemoved:
+        Put<int32_t>(m_Record, change.trackIndex);
+        AppendRecord(TrackRemove);
+        break;
+
+    case TimelineChange::ClipChanged: {
+        const Clip* clip = timeline.FindClip(change.trackIndex, change.id);
+        if (!clip) return;
+        JournalClip record{clip->startTime, clip->duration, clip->inPoint, clip->outPoint,
+                           clip->id, clip->trackIndex,
+                           static_cast<uint32_t>(clip->filepath.size()),
+                           static_cast<float>(clip->speed)};
+        Put(m_Record, record);
+        PutString(m_Record, clip->filepath);
+        AppendRecord(ClipUpsert);
+        break;
+    }
+
+    case TimelineChange::ClipRemoved:
+        Put<int32_t>(m_Record, change.trackIndex);
+        Put<int32_t>(m_Record, change.id);
+        AppendRecord(ClipRemove);
+        break;
+
+    case TimelineChange::EffectChanged: {
+        const EffectLayer* effect = timeline.FindEffectLayer(change.id);
+        if (!effect) return;
+        JournalEffect record{effect->startTime, effect->duration, effect->id,
+                             static_cast<int32_t>(effect->type),
+                             static_cast<uint32_t>(effect->params.size()),
+                             static_cast<uint32_t>(effect - timeline.GetEffectLayers().data())};
+        Put(m_Record, record);
+        for (const auto& param : effect->params) {
+            Put(m_Record, JournalParam{param.second, static_cast<uint32_t>(param.first.size())});
+            PutString(m_Record, param.first);
+        }
+        AppendRecord(EffectUpsert);
+        break;
+    }
+
+    case TimelineChange::EffectRemoved:
+        Put<int32_t>(m_Record, change.id);
+        AppendRecord(EffectRemove);
+        break;
+
+    case TimelineChange::TrackAudioChanged: {
+        const auto& tracks = timeline.GetTracks();
+        if (change.trackIndex < 0 || change.trackIndex >= static_cast<int>(tracks.size())) return;
+        Put<int32_t>(m_Record, change.trackIndex);
+        Put(m_Record, ToRecord(tracks[change.trackIndex].audioEffects));
+        AppendRecord(TrackAudio);
+        break;
+    }
+    }
+}
+
+void ProjectFile::AppendRecord(uint16_t type) {
+    RecordHeader header{static_cast<uint32_t>(m_Record.size()), type, 0, m_Sequence,
+                        Checksum(m_Record.data(), m_Record.size())};
+
+    // Flushed to the OS so an app crash loses nothing; no fsync, that would
+    // cost milliseconds per edit
+    bool ok = fwrite(&header, sizeof(header), 1, m_Journal) == 1 &&
+              fwrite(m_Record.data(), 1, m_Record.size(), m_Journal) == m_Record.size() &&
+              fflush(m_Journal) == 0;
+    if (!ok) {
+        std::cerr << "[ProjectFile] Autosave write failed, autosave disabled" << std::endl;
+        fclose(m_Journal);
+        m_Journal = nullptr;
+        return;
+    }
+    m_JournalSize += sizeof(header) + m_Record.size();
+    m_Sequence++;
+}
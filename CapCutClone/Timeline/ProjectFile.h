@@ -0,0 +1,193 @@
+#pragma once
+#include "Sticker.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class TimelineManager;
+struct TimelineChange;
+
+/**
+ * @brief On-disk layout of .ccpj projects (little-endian, version 1)
+ *
+ * FileHeader, then sectionCount SectionEntry rows, then the sections.
+ * Every section is a flat array of fixed-size records starting on an
+ * 8-byte boundary, so a mapped file is read in place: record i of a
+ * section is at offset + i * recordSize. Readers step by the stored
+ * recordSize (newer versions may append fields) and skip section types
+ * they do not know. Text lives in the Strings section and is referenced
+ * by StringRef.
+ */
+namespace ProjectFormat {
+
+constexpr uint32_t kMagic = 0x4A504343;        // "CCPJ"
+constexpr uint32_t kJournalMagic = 0x4C504343; // "CCPL"
+constexpr uint32_t kVersion = 1;
+
+enum class SectionType : uint32_t {
+    Strings = 1,      // Raw UTF-8 bytes, recordSize 1
+    Media = 2,        // MediaRecord, one per distinct source file
+    Tracks = 3,       // TrackRecord
+    Clips = 4,        // ClipRecord, grouped by track
+    Effects = 5,      // EffectRecord
+    EffectParams = 6, // ParamRecord, grouped by effect
+    Stickers = 7,     // StickerRecord
+    Keyframes = 8,    // KeyframeRecord, reserved until keyframes exist
+    ClipSpeeds = 9,   // float per ClipRecord, same order; absent = 1x
+    MediaLoudness = 10, // LoudnessRecord per MediaRecord, same order
+    TrackAudio = 11     // TrackAudioRecord per TrackRecord, same order; absent = none
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t reserved;
+    uint64_t snapshotId; // Pairs the snapshot with its journal
+    uint64_t fileSize;
+};
+
+struct SectionEntry {
+    uint32_t type;
+    uint32_t recordSize;
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct MediaRecord {
+    StringRef path;
+    double duration; // Source duration in seconds
+};
+
+// Cached LoudnessAnalyzer result, so a file is not re-analyzed on load
+struct LoudnessRecord {
+    float loudness;    // Integrated, LUFS
+    float truePeak;    // dBTP
+    uint32_t analyzed; // 0 = analysis had not finished when saved
+    uint32_t reserved;
+};
+
+struct TrackRecord {
+    int32_t trackIndex;
+    uint32_t firstClip;
+    uint32_t clipCount;
+    uint32_t reserved;
+};
+
+// AudioEffectSettings of a track; dB, ms and seconds as there
+struct TrackAudioRecord {
+    uint32_t enabled; // Bit 0 gate, 1 EQ, 2 compressor, 3 limiter
+    uint32_t fadeCurve;
+    float fadeIn, fadeOut;
+    float gateThreshold, gateAttack, gateRelease;
+    float eqLowGain, eqLowFreq, eqMidGain, eqMidFreq, eqMidQ, eqHighGain, eqHighFreq;
+    float compressorThreshold, compressorRatio, compressorKnee;
+    float compressorAttack, compressorRelease, compressorMakeup;
+    float limiterCeiling, limiterRelease;
+};
+
+struct ClipRecord {
+    double startTime;
+    double inPoint;
+    double outPoint;
+    int32_t id;
+    uint32_t media;
+};
+
+struct EffectRecord {
+    double startTime;
+    double duration;
+    int32_t id;
+    int32_t type;
+    uint32_t firstParam;
+    uint32_t paramCount;
+};
+
+struct ParamRecord {
+    StringRef name;
+    float value;
+    uint32_t reserved;
+};
+
+struct StickerRecord {
+    double startTime;
+    double duration;
+    float x, y;
+    float scale;
+    float rotation;
+    float opacity;
+    int32_t id;
+    StringRef path;
+};
+
+struct KeyframeRecord {
+    int32_t ownerId;    // Clip or effect ID
+    uint32_t ownerKind; // 0 = clip, 1 = effect
+    StringRef param;
+    double time;        // Seconds from the owner's start
+    float value;
+    uint32_t interpolation;
+};
+
+} // namespace ProjectFormat
+
+/**
+ * @brief Binary project save/load with an append-only autosave journal
+ *
+ * Save() writes a full snapshot (memory-mappable, see ProjectFormat) and
+ * starts a fresh journal next to it (<project>.log). From then on every
+ * timeline edit passed to RecordChange() appends one small delta record
+ * (the clip or effect as it is now, or its removal) and flushes it, so an
+ * edit costs a ~100 byte write no matter how large the project is.
+ *
+ * Load() maps the snapshot, builds the timeline straight from the record
+ * arrays and replays the journal on top. A torn record at the end of the
+ * journal (crash mid-write) is dropped. Saving again folds the journal
+ * into a new snapshot; NeedsCompaction() says when that is worth doing.
+ *
+ * Stickers are stored in the snapshot only.
+ */
+class ProjectFile {
+public:
+    ProjectFile() = default;
+    ~ProjectFile();
+
+    ProjectFile(const ProjectFile&) = delete;
+    ProjectFile& operator=(const ProjectFile&) = delete;
+
+    bool Save(const std::string& path, const TimelineManager& timeline,
+              const std::vector<Sticker>& stickers);
+    bool Load(const std::string& path, TimelineManager& timeline,
+              std::vector<Sticker>& stickers);
+
+    // Append one edit to the journal (no-op until Save/Load succeeded)
+    void RecordChange(const TimelineManager& timeline, const TimelineChange& change);
+
+    void Close();
+
+    bool IsOpen() const { return m_Journal != nullptr; }
+    const std::string& GetPath() const { return m_Path; }
+    uint64_t GetJournalSize() const { return m_JournalSize; }
+    bool NeedsCompaction() const { return m_JournalSize > kCompactionThreshold; }
+
+    static std::string GetJournalPath(const std::string& path) { return path + ".log"; }
+
+private:
+    static constexpr uint64_t kCompactionThreshold = 8ull << 20; // 8 MB
+
+    std::string m_Path;
+    FILE* m_Journal = nullptr;
+    uint64_t m_SnapshotId = 0;
+    uint64_t m_JournalSize = 0;
+    uint32_t m_Sequence = 0;
+    std::vector<uint8_t> m_Record; // Reused payload buffer
+
+    bool StartJournal(uint64_t keepBytes);
+    void AppendRecord(uint16_t type);
+};
@@ -1,10 +1,30 @@
 #pragma once
 #include "Track.h"
 #include "EffectLayer.h"
+#include "EditHistory.h"
+#include "TimelineSnapshot.h"
+#include <functional>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 
 class VideoPlayer; // Forward declaration
+class DecoderPrefetcher;
+
+/**
+ * @brief One applied edit, reported to the change listener (autosave)
+ */
+struct TimelineChange {
+    enum Kind {
+        TrackAdded, TrackRemoved, ClipChanged, ClipRemoved, EffectChanged, EffectRemoved,
+        TrackAudioChanged
+    };
+
+    Kind kind;
+    int trackIndex; // Track of the clip (or the added/removed track), -1 for effects
+    int id;         // Clip or effect ID, -1 for track changes
+};
 
 class TimelineManager {
 public:
@@ -14,12 +34,23 @@ public:
     // Setup
     void SetVideoPlayer(VideoPlayer* videoPlayer);
 
+    // Called after every edit below, with what changed
+    using ChangeListener = std::function<void(const TimelineChange&)>;
+    void SetChangeListener(ChangeListener listener) { m_ChangeListener = std::move(listener); }
+
+    // Replace the whole timeline (project load). Does not notify.
+    void RestoreState(std::vector<Track> tracks, std::vector<EffectLayer> effectLayers);
+
     // Core Actions
     void AddTrack();
     void AddClipToTrack(const std::string& filepath, int trackIndex, double startTime);
     void RemoveClip(int trackIndex, int clipId);
     void SplitClip(int trackIndex, int clipId, double splitTime);
     void MoveClip(int trackIndex, int clipId, double newStartTime);
+    // Retime a clip (0.25x - 4x); its start stays, its length follows
+    void SetClipSpeed(int trackIndex, int clipId, double speed);
+    // Audio effect chain of a track, also applied to its audio engine bus
+    void SetTrackAudioEffects(int trackIndex, const AudioEffectSettings& settings);
     
     // Effect Layer Management
     int AddEffectLayer(EffectLayer::EffectType type, double startTime, double duration);
@@ -28,23 +59,47 @@ public:
     void ResizeEffectLayer(int effectId, double newDuration);
     void UpdateEffectParam(int effectId, const std::string& paramName, float value);
     
+    // Undo/redo of the edits above (see EditHistory)
+    bool Undo();
+    bool Redo();
+    bool CanUndo() const { return m_History.CanUndo(); }
+    bool CanRedo() const { return m_History.CanRedo(); }
+    const char* GetUndoName() const { return m_History.GetUndoName(); }
+    const char* GetRedoName() const { return m_History.GetRedoName(); }
+    // Ends a drag: the next move/resize starts a new undo step
+    void EndEditGesture() { m_History.EndGesture(); }
+    
     // Get effects active at specific time
     std::vector<EffectLayer*> GetActiveEffects(double time);
     
     // Get all effect layers for UI rendering
     std::vector<EffectLayer>& GetEffectLayers() { return m_EffectLayers; }
+    const std::vector<EffectLayer>& GetEffectLayers() const { return m_EffectLayers; }
+    const EffectLayer* FindEffectLayer(int effectId) const;
     
     // Playback integration
     void Update(float deltaTime); // Called every frame
     void SetCurrentTime(double time);
     double GetCurrentTime() const { return m_CurrentTime; }
+    // Clip audio plays (and clips ahead are scheduled) only while set
+    void SetPlaying(bool playing);
     double GetTotalDuration() const;
 
     // Data Access for UI
     std::vector<Track>& GetTracks() { return m_Tracks; }
+    const std::vector<Track>& GetTracks() const { return m_Tracks; }
+    const Clip* FindClip(int trackIndex, int clipId) const;
+
+    // Immutable copy for export threads. Cached until the next edit, so
+    // exports started without edits in between share one copy.
+    TimelineSnapshotPtr GetSnapshot();
     
     // Constants
     static const int MAX_TRACKS = 10;
+    static constexpr double PREFETCH_LEAD = 1.0; // Seconds before a cut
+    static constexpr double AUDIO_DRIFT = 0.25;  // Playhead vs clip audio before a re-seek
+    static constexpr double SCRUB_STEP = 0.1;    // Playhead move that plays a scrub grain
+    static constexpr double AUDIO_TAIL = 0.1;    // Clip audio kept past its end to drain
 
 private:
     std::vector<Track> m_Tracks;
@@ -56,10 +111,44 @@ private:
     int m_NextEffectId; // NEW: For generating unique effect IDs
 
     Clip* m_ActiveClip; // The clip currently supplying video to the player
+
+    // Audio of one clip on any track, on its own audio-only decoder and
+    // voice: clips at the playhead, and while playing those starting
+    // within PREFETCH_LEAD, held back until their start on the engine clock.
+    // Players are opened and closed on the m_Prefetcher worker.
+    struct ClipAudio {
+        Clip clip;                           // As opened; an edit reopens it
+        std::unique_ptr<VideoPlayer> player; // Null: opening, or no audio
+        bool opening = true;                 // Not yet taken from m_Prefetcher
+        bool positioned = false;
+    };
+    std::vector<ClipAudio> m_ClipAudio;
+    bool m_Playing = false;
+    double m_AudioTime = 0.0;   // Playhead the clip audio was positioned at
+    uint64_t m_AudioClock = 0;  // Engine clock at m_AudioTime while playing
+    ChangeListener m_ChangeListener;
+    EditHistory m_History;
+    std::unique_ptr<DecoderPrefetcher> m_Prefetcher; // Opens the next clip before the cut
+    uint64_t m_Version = 0;         // Bumped by every edit
+    TimelineSnapshotPtr m_Snapshot; // Copy of version m_Snapshot->version
     
     int GenerateClipId() { return m_NextClipId++; }
     int GenerateEffectId() { return m_NextEffectId++; } // NEW
     
     // Internal helper to sync video player state with timeline
     void SyncVideoPlayer();
+    void PrefetchNextClip();
+    void SyncClipAudio();
+
+    void NotifyChange(TimelineChange::Kind kind, int trackIndex, int id) {
+        m_Version++;
+        if (m_ChangeListener) m_ChangeListener({kind, trackIndex, id});
+    }
+
+    // Undo/redo helpers: put a clip/effect into the given state (empty = removed)
+    std::optional<Clip> CopyClip(int trackIndex, int clipId) const;
+    void SetClip(int trackIndex, int clipId, const std::optional<Clip>& image);
+    void SetEffectLayer(int effectId, size_t index, const std::optional<EffectLayer>& image);
+    void SetTrackAudio(int trackIndex, const AudioEffectSettings& settings);
+    void RecordEffectEdit(const char* name, size_t index, EffectLayer before);
 };
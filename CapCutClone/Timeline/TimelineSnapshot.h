@@ -0,0 +1,39 @@
+#pragma once
+#include "Track.h"
+#include "EffectLayer.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Read-only copy of the timeline for export threads
+ *
+ * Taken on the UI thread with TimelineManager::GetSnapshot() and never
+ * modified afterwards, so any number of threads can read it while the
+ * user keeps editing the live timeline. Shared by pointer: every export
+ * started between two edits gets the same copy.
+ */
+struct TimelineSnapshot {
+    std::vector<Track> tracks;
+    std::vector<EffectLayer> effectLayers;
+    double totalDuration = 0.0;
+    uint64_t version = 0; // TimelineManager edit count when taken
+
+    const Clip* GetClipAtTime(int trackIndex, double time) const {
+        if (trackIndex < 0 || trackIndex >= static_cast<int>(tracks.size())) return nullptr;
+        return tracks[trackIndex].GetClipAtTime(time);
+    }
+
+    // Same order as TimelineManager::GetActiveEffects
+    std::vector<const EffectLayer*> GetActiveEffects(double time) const {
+        std::vector<const EffectLayer*> activeEffects;
+        for (const auto& effect : effectLayers) {
+            if (effect.IsActiveAtTime(time)) {
+                activeEffects.push_back(&effect);
+            }
+        }
+        return activeEffects;
+    }
+};
+
+using TimelineSnapshotPtr = std::shared_ptr<const TimelineSnapshot>;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Clip.h"
+#include "../Audio/AudioEffectSettings.h"
 #include <vector>
 #include <algorithm>
 
@@ -7,6 +8,7 @@ class Track {
 public:
     std::vector<Clip> clips;
     int trackIndex;
+    AudioEffectSettings audioEffects; // Chain on the track's audio bus
 
     Track(int index) : trackIndex(index) {}
 
@@ -49,4 +51,13 @@ public:
         }
         return nullptr;
     }
+
+    const Clip* GetClipAtTime(double time) const {
+        for (const auto& clip : clips) {
+            if (clip.ContainsTime(time)) {
+                return &clip;
+            }
+        }
+        return nullptr;
+    }
 };
@@ -1,9 +1,16 @@
 #define NOMINMAX
 #include "UIManager.h"
 #include "../Application.h"
+#include "../Audio/AudioEffectChain.h"
+#include "../Audio/AudioEngine.h"
+#include "../Audio/LoudnessAnalyzer.h"
+#include "../Core/Trace.h"
+#include "../Encoder/ExportQueue.h"
 #include "../Encoder/HardwareExportManager.h"
+#include "../Encoder/SegmentedExportManager.h"
 #include "../Rendering/TextureRenderer.h"
 #include "../Timeline/Clip.h"
+#include "../Timeline/ProjectFile.h"
 #include "../Timeline/TimelineManager.h"
 #include "../Timeline/Track.h"
 #include "../Video/VideoPlayer.h"
@@ -81,14 +88,19 @@ static bool IconButton(const char *id, const char *icon,
 UIManager::UIManager()
     : m_VideoPlayer(nullptr), m_TextureRenderer(nullptr),
       m_TimelineThumbnails(nullptr), m_TimelineManager(nullptr),
-      m_ExportManager(nullptr), m_FilterGenerationAttempted(false),
-      m_IsPlaying(false), m_CurrentTime(0.0f), m_TotalDuration(330.0f),
-      m_TimelineZoom(1.0f), m_SeekPosition(0.0f), m_LastFrameTime(0.0f),
-      m_PlaybackStartTime(0.0), m_AspectRatioMode(0), m_SelectedClipId(-1),
-      m_SelectedTrackIndex(-1), m_SelectedStickerId(-1),
+      m_ExportManager(nullptr), m_IsPlaying(false), m_CurrentTime(0.0f),
+      m_TotalDuration(330.0f), m_TimelineZoom(1.0f), m_SeekPosition(0.0f),
+      m_LastFrameTime(0.0f), m_PlaybackStartTime(0.0), m_AspectRatioMode(0),
+      m_SelectedClipId(-1), m_SelectedTrackIndex(-1), m_SelectedStickerId(-1),
       m_DefaultStickerTexture(0) {
   m_TimelineThumbnails = new TimelineThumbnails();
   m_TimelineManager = new TimelineManager();
+
+  // Every timeline edit goes to the autosave journal once a project is open
+  m_ProjectFile = new ProjectFile();
+  m_TimelineManager->SetChangeListener([this](const TimelineChange &change) {
+    m_ProjectFile->RecordChange(*m_TimelineManager, change);
+  });
 }
 
 UIManager::~UIManager() {
@@ -96,6 +108,12 @@ UIManager::~UIManager() {
     delete m_TimelineThumbnails;
   if (m_TimelineManager)
     delete m_TimelineManager;
+  if (m_ProjectFile)
+    delete m_ProjectFile;
+  if (m_ExportQueue)
+    delete m_ExportQueue;
+  if (m_SegmentedExport)
+    delete m_SegmentedExport;
   if (m_ExportManager)
     delete m_ExportManager;
   if (m_DefaultStickerTexture)
@@ -115,6 +133,47 @@ void UIManager::SetVideoPlayer(VideoPlayer *player) {
       m_ExportManager->SetMainWindow(mainWindow);
     }
   }
+  if (!m_ExportQueue) {
+    m_ExportQueue = new ExportQueue(glfwGetCurrentContext());
+  }
+}
+
+double UIManager::GetIdleTimeout() const {
+  // Exports report progress through atomics and queued jobs start from
+  // Update(), so background work is polled rather than signalled
+  constexpr double kBackgroundPoll = 0.1;
+  constexpr double kTimelineFrame = 1.0 / 30.0; // Playback without video
+
+  double timeout = -1.0;
+  auto limit = [&timeout](double seconds) {
+    seconds = std::max(seconds, 0.0);
+    timeout = timeout < 0.0 ? seconds : std::min(timeout, seconds);
+  };
+
+  if (m_IsPlaying) {
+    if (m_VideoPlayer && m_VideoPlayer->IsLoaded()) {
+      // Update() decodes the next frame once playback reaches this PTS
+      limit(m_PlaybackStartTime + m_VideoPlayer->GetCurrentTime() -
+            glfwGetTime());
+    } else {
+      limit(kTimelineFrame);
+    }
+  }
+
+  if (m_ShowExportProgress || (m_ExportQueue && m_ExportQueue->IsBusy()) ||
+      LoudnessAnalyzer::GetPendingCount() > 0)
+    limit(kBackgroundPoll);
+
+  // Swap in the filter atlas once its render finishes or is due; its fence
+  // cannot wake the loop, so it is polled
+  if (m_FilterAtlasPending)
+    limit(kBackgroundPoll);
+
+  // Compaction retry after a failure
+  if (m_ProjectFile && m_ProjectFile->NeedsCompaction())
+    limit(m_NextCompactionTime - glfwGetTime());
+
+  return timeout;
 }
 
 void UIManager::Update(float deltaTime) {
@@ -125,8 +184,25 @@ void UIManager::Update(float deltaTime) {
         std::max(10.0f, (float)m_TimelineManager->GetTotalDuration() + 5.0f);
   }
 
-  if (m_ExportManager && m_ShowExportProgress) {
-    m_ExportProgress = m_ExportManager->GetProgress();
+  // Fold a long autosave journal back into the snapshot
+  if (m_ProjectFile && m_ProjectFile->NeedsCompaction() &&
+      glfwGetTime() >= m_NextCompactionTime) {
+    if (!SaveProject())
+      m_NextCompactionTime = glfwGetTime() + 30.0;
+  }
+
+  if (m_ShowExportProgress) {
+    if (m_ExportIsSegmented && m_SegmentedExport) {
+      m_SegmentedExport->Update(); // Starts queued segments
+      m_ExportProgress = m_SegmentedExport->GetProgress();
+    } else if (m_ExportManager) {
+      m_ExportProgress = m_ExportManager->GetProgress();
+    }
+  }
+
+  // Start/retire queued exports (needs the main thread for GL contexts)
+  if (m_ExportQueue) {
+    m_ExportQueue->Update();
   }
 
   if (m_IsPlaying && m_VideoPlayer && m_VideoPlayer->IsLoaded()) {
@@ -144,8 +220,12 @@ void UIManager::Update(float deltaTime) {
         m_CurrentTime = (float)m_VideoPlayer->GetCurrentTime();
         m_SeekPosition = m_CurrentTime / m_TotalDuration;
       } else {
-        if (m_CurrentTime >= m_TotalDuration)
+        if (m_CurrentTime >= m_TotalDuration) {
           m_IsPlaying = false;
+          m_VideoPlayer->SetPlaying(false);
+          if (m_TimelineManager)
+            m_TimelineManager->SetPlaying(false);
+        }
       }
     } else {
       m_CurrentTime =
@@ -156,14 +236,23 @@ void UIManager::Update(float deltaTime) {
     if (m_CurrentTime >= m_TotalDuration) {
       m_CurrentTime = m_TotalDuration;
       m_IsPlaying = false;
+      if (m_TimelineManager)
+        m_TimelineManager->SetPlaying(false);
     }
   }
 }
 
 void UIManager::Render() {
+  m_FilterAtlasPending = false; // Set again if the filter panel is visible
+
+  // A released mouse ends any drag, so the next drag is its own undo step
+  if (m_TimelineManager && ImGui::IsMouseReleased(0))
+    m_TimelineManager->EndEditGesture();
+
   RenderMenuBar();
   RenderExportDialog();
   RenderExportProgress();
+  RenderRenderQueue();
 
   ImGuiViewport *viewport = ImGui::GetMainViewport();
   ImVec2 workPos = viewport->WorkPos;
@@ -322,35 +411,16 @@ void UIManager::RenderMediaPanel(float x, float y, float w, float h) {
     ImGui::Separator();
 
     if (activeTab == 6) { // FILTERS TAB
-      // Generate Thumbnails if needed or if they're invalid
-      bool thumbnailsValid = !m_FilterThumbnails.empty();
-      if (thumbnailsValid) {
-        // Verify first thumbnail is still valid
-        GLboolean isTexture = glIsTexture(m_FilterThumbnails[0]);
-        thumbnailsValid = (isTexture == GL_TRUE);
-
-        // Also check if demo image is still valid
-        if (thumbnailsValid && m_DemoImageTexture != 0) {
-          GLboolean isDemoValid = glIsTexture(m_DemoImageTexture);
-          if (isDemoValid != GL_TRUE) {
-            std::cout << "[UIManager] Demo image texture became invalid, "
-                         "regenerating..."
-                      << std::endl;
-            thumbnailsValid = false;
-          }
-        }
-      }
-
-      if (!thumbnailsValid) {
-        // Clear old thumbnails and regenerate
-        std::cout << "[UIManager] Regenerating filter thumbnails (valid="
-                  << thumbnailsValid << ", count=" << m_FilterThumbnails.size()
-                  << ")" << std::endl;
-        m_FilterThumbnails.clear();
-        m_FilterGenerationAttempted = false;
-        m_DemoImageTexture = 0; // Reset to force reload
-        LoadDemoImage();
-        GenerateFilterThumbnails();
+      // All presets applied to the current frame (the demo image until a
+      // video is loaded), rendered into one atlas in the background
+      const int kTileSize = 200;
+      GLuint atlas = 0;
+      if (m_TextureRenderer) {
+        if (!m_TextureRenderer->GetTextureID())
+          LoadDemoImage();
+        atlas = m_TextureRenderer->GetFilterAtlas(m_DemoImageTexture,
+                                                  kTileSize);
+        m_FilterAtlasPending = m_TextureRenderer->IsFilterAtlasPending();
       }
 
       float itemSz = 90;
@@ -360,26 +430,31 @@ void UIManager::RenderMediaPanel(float x, float y, float w, float h) {
 
       if (ImGui::BeginTable("FilterGrid", cols)) {
         // Filter definitions
-        const char *filterNames[] = {
+        const char *filterNames[TextureRenderer::kFilterCount] = {
             "Normal",         "Light Green", "80s Holiday",    "Milky Tone",
             "Cinematic Dusk", "Ice City",    "Flash CCD",      "LA Classic",
             "Warlock",        "Brighten Up", "Hollywood Past", "Fade",
             "Maldives",       "Clear",       "Azure Morning",  "Hasselblad"};
-        int filterCount = 16;
-        // Reuse size of filter thumbnails if matches
-        if (m_FilterThumbnails.size() < (size_t)filterCount)
-          filterCount = (int)m_FilterThumbnails.size();
 
-        for (int i = 0; i < filterCount; i++) {
+        for (int i = 0; i < TextureRenderer::kFilterCount; i++) {
           ImGui::TableNextColumn();
           ImGui::PushID(i);
 
           // Filter Card
           ImVec2 pMin = ImGui::GetCursorScreenPos();
-          // Image Button
-          if (ImGui::ImageButton("##filterBtn",
-                                 (ImTextureID)(intptr_t)m_FilterThumbnails[i],
-                                 ImVec2(itemSz, itemSz))) {
+          bool clicked;
+          if (atlas) {
+            float uv0[2], uv1[2];
+            TextureRenderer::GetFilterAtlasUV(i, uv0, uv1);
+            clicked = ImGui::ImageButton(
+                "##filterBtn", (ImTextureID)(intptr_t)atlas,
+                ImVec2(itemSz, itemSz), ImVec2(uv0[0], uv0[1]),
+                ImVec2(uv1[0], uv1[1]));
+          } else {
+            // First atlas still rendering
+            clicked = ImGui::Button("##filterBtn", ImVec2(itemSz, itemSz));
+          }
+          if (clicked) {
             // Apply Filter
             if (m_TextureRenderer) {
               m_TextureRenderer->SetFilterType(i); // 0 = Normal
@@ -400,6 +475,30 @@ void UIManager::RenderMediaPanel(float x, float y, float w, float h) {
         }
         ImGui::EndTable();
       }
+
+      // Imported LUT, applied on top of the selected filter
+      ImGui::Separator();
+      ImGui::TextDisabled("Import LUT (.cube)");
+      ImGui::SetNextItemWidth(-70);
+      ImGui::InputText("##LUTPath", m_LUTPath, sizeof(m_LUTPath));
+      ImGui::SameLine();
+      if (ImGui::Button("Import", ImVec2(60, 0)) && m_TextureRenderer)
+        m_TextureRenderer->LoadCubeLUT(m_LUTPath);
+
+      if (m_TextureRenderer) {
+        if (!m_TextureRenderer->GetCubeLUTError().empty()) {
+          ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s",
+                             m_TextureRenderer->GetCubeLUTError().c_str());
+        }
+        const std::string &lutPath = m_TextureRenderer->GetCubeLUTPath();
+        if (!lutPath.empty()) {
+          const std::string &title = m_TextureRenderer->GetCubeLUTTitle();
+          ImGui::TextWrapped("Active: %s",
+                             title.empty() ? lutPath.c_str() : title.c_str());
+          if (ImGui::Button("Remove LUT"))
+            m_TextureRenderer->ClearCubeLUT();
+        }
+      }
     } else { // EFFECTS TAB
       ImGui::Text("Video Effects");
       ImGui::Separator();
@@ -551,6 +650,10 @@ void UIManager::RenderPreviewPanel(float x, float y, float w, float h) {
 
   // Draw Video
   if (m_VideoPlayer && m_VideoPlayer->IsLoaded() && m_TextureRenderer) {
+    // Timeline state that reaches the preview besides the renderer's own
+    // parameters; the filtered texture is rebuilt only when it changes
+    TextureRenderer::StateHash scene;
+
     // CRITICAL: Apply timeline effects at current playback time
     if (m_TimelineManager) {
       // Clear all effects first
@@ -564,6 +667,13 @@ void UIManager::RenderPreviewPanel(float x, float y, float w, float h) {
         if (!effect)
           continue;
 
+        scene.Add(effect->id);
+        scene.Add(effect->type);
+        for (const auto &param : effect->params) {
+          scene.Add(param.first);
+          scene.Add(param.second);
+        }
+
         // Apply based on effect type
         if (effect->type >= EffectLayer::BLUR_GAUSSIAN &&
             effect->type <= EffectLayer::BLUR_ZOOM) {
@@ -580,10 +690,23 @@ void UIManager::RenderPreviewPanel(float x, float y, float w, float h) {
       }
     }
 
+    for (const Sticker &sticker : m_Stickers) {
+      if (m_CurrentTime < sticker.startTime ||
+          m_CurrentTime >= sticker.startTime + sticker.duration)
+        continue;
+      scene.Add(sticker.id);
+      scene.Add(sticker.textureID);
+      scene.Add(sticker.position.x);
+      scene.Add(sticker.position.y);
+      scene.Add(sticker.scale);
+      scene.Add(sticker.rotation);
+      scene.Add(sticker.opacity);
+    }
+
     ImGui::SetCursorPos(ImVec2(offsetX, offsetY));
     // Use filtered texture ID so filters are applied in preview
-    GLuint previewTexture =
-        m_TextureRenderer->GetFilteredTextureID((int)previewW, (int)previewH);
+    GLuint previewTexture = m_TextureRenderer->GetFilteredTextureID(
+        (int)previewW, (int)previewH, scene.value);
     ImGui::Image((ImTextureID)(intptr_t)previewTexture,
                  ImVec2(previewW, previewH));
   } else {
@@ -625,6 +748,139 @@ void UIManager::RenderPreviewPanel(float x, float y, float w, float h) {
   ImGui::PopStyleColor();
 }
 
+void UIManager::RenderTrackAudioTab() {
+  const Clip *clip =
+      m_TimelineManager ? m_TimelineManager->FindClip(m_SelectedTrackIndex,
+                                                      m_SelectedClipId)
+                        : nullptr;
+  if (!clip) {
+    ImGui::TextDisabled("Select a clip");
+    return;
+  }
+
+  // Effects belong to the clip's track; edits go through the timeline so
+  // they are undoable, autosaved and reach the track's audio bus
+  const auto &tracks = m_TimelineManager->GetTracks();
+  AudioEffectSettings settings = tracks[m_SelectedTrackIndex].audioEffects;
+  const AudioEffectChain *chain =
+      AudioEngine::GetBusChain(m_SelectedTrackIndex);
+  AudioEffectChain::Stats stats =
+      chain ? chain->GetStats() : AudioEffectChain::Stats{};
+  bool changed = false;
+
+  auto slider = [&](const char *label, const char *id, float *value,
+                    float min, float max, const char *format,
+                    ImGuiSliderFlags flags = 0) {
+    ImGui::Text("%s", label);
+    ImGui::SameLine(100);
+    changed |= ImGui::SliderFloat(id, value, min, max, format, flags);
+  };
+  auto section = [&](const char *label, bool &enabled,
+                     AudioEffectChain::Stage stage) {
+    ImGui::Separator();
+    changed |= ImGui::Checkbox(label, &enabled);
+    if (enabled) {
+      ImGui::SameLine();
+      ImGui::TextDisabled("%.2f%% CPU", stats.load[stage] * 100.0f);
+    }
+    return enabled;
+  };
+
+  ImGui::Spacing();
+  ImGui::TextDisabled("Track %d", m_SelectedTrackIndex + 1);
+
+  ImGui::Separator();
+  ImGui::TextDisabled("Fades");
+  slider("Fade In", "##FadeIn", &settings.fades.in, 0.0f, 5.0f, "%.2fs");
+  slider("Fade Out", "##FadeOut", &settings.fades.out, 0.0f, 5.0f, "%.2fs");
+  const char *curves[] = {"Linear", "Equal Power", "Exponential"};
+  int curve = static_cast<int>(settings.fades.curve);
+  ImGui::Text("Curve");
+  ImGui::SameLine(100);
+  if (ImGui::Combo("##FadeCurve", &curve, curves, IM_ARRAYSIZE(curves))) {
+    settings.fades.curve = static_cast<FadeCurve>(curve);
+    changed = true;
+  }
+
+  if (section("Noise Gate", settings.gate.enabled, AudioEffectChain::Gate)) {
+    slider("Threshold", "##GateThr", &settings.gate.threshold, -80.0f, 0.0f,
+           "%.0f dB");
+    slider("Attack", "##GateAtk", &settings.gate.attack, 0.1f, 50.0f,
+           "%.1f ms", ImGuiSliderFlags_Logarithmic);
+    slider("Release", "##GateRel", &settings.gate.release, 10.0f, 1000.0f,
+           "%.0f ms", ImGuiSliderFlags_Logarithmic);
+  }
+
+  if (section("EQ", settings.eq.enabled, AudioEffectChain::EQ)) {
+    slider("Low", "##EqLowG", &settings.eq.lowGain, -18.0f, 18.0f,
+           "%+.1f dB");
+    slider("Low Freq", "##EqLowF", &settings.eq.lowFreq, 20.0f, 500.0f,
+           "%.0f Hz", ImGuiSliderFlags_Logarithmic);
+    slider("Mid", "##EqMidG", &settings.eq.midGain, -18.0f, 18.0f,
+           "%+.1f dB");
+    slider("Mid Freq", "##EqMidF", &settings.eq.midFreq, 200.0f, 8000.0f,
+           "%.0f Hz", ImGuiSliderFlags_Logarithmic);
+    slider("Mid Q", "##EqMidQ", &settings.eq.midQ, 0.2f, 8.0f, "%.2f",
+           ImGuiSliderFlags_Logarithmic);
+    slider("High", "##EqHighG", &settings.eq.highGain, -18.0f, 18.0f,
+           "%+.1f dB");
+    slider("High Freq", "##EqHighF", &settings.eq.highFreq, 2000.0f,
+           20000.0f, "%.0f Hz", ImGuiSliderFlags_Logarithmic);
+  }
+
+  if (section("Compressor", settings.compressor.enabled,
+              AudioEffectChain::Compressor)) {
+    slider("Threshold", "##CompThr", &settings.compressor.threshold, -60.0f,
+           0.0f, "%.0f dB");
+    slider("Ratio", "##CompRatio", &settings.compressor.ratio, 1.0f, 20.0f,
+           "%.1f:1", ImGuiSliderFlags_Logarithmic);
+    slider("Knee", "##CompKnee", &settings.compressor.knee, 0.0f, 24.0f,
+           "%.0f dB");
+    slider("Attack", "##CompAtk", &settings.compressor.attack, 0.1f, 200.0f,
+           "%.1f ms", ImGuiSliderFlags_Logarithmic);
+    slider("Release", "##CompRel", &settings.compressor.release, 10.0f,
+           2000.0f, "%.0f ms", ImGuiSliderFlags_Logarithmic);
+    slider("Makeup", "##CompMakeup", &settings.compressor.makeup, 0.0f,
+           24.0f, "%.1f dB");
+  }
+
+  if (section("Limiter", settings.limiter.enabled,
+              AudioEffectChain::Limiter)) {
+    slider("Ceiling", "##LimCeil", &settings.limiter.ceiling, -12.0f, 0.0f,
+           "%.1f dB");
+    slider("Release", "##LimRel", &settings.limiter.release, 1.0f, 500.0f,
+           "%.0f ms", ImGuiSliderFlags_Logarithmic);
+  }
+
+  if (changed)
+    m_TimelineManager->SetTrackAudioEffects(m_SelectedTrackIndex, settings);
+
+  // Every track's chain, so the cost of many tracks is visible at once
+  ImGui::Separator();
+  ImGui::TextDisabled("Effect CPU (share of real time)");
+  for (size_t t = 0; t < tracks.size(); ++t) {
+    const AudioEffectChain *busChain =
+        AudioEngine::GetBusChain(static_cast<int>(t));
+    if (!busChain || !tracks[t].audioEffects.HasChainEffects())
+      continue;
+    AudioEffectChain::Stats busStats = busChain->GetStats();
+    float total = 0.0f;
+    for (int s = 0; s < AudioEffectChain::kStageCount; ++s)
+      total += busStats.load[s];
+    ImGui::Text("Track %d: %.2f%%", static_cast<int>(t) + 1, total * 100.0f);
+    for (int s = 0; s < AudioEffectChain::kStageCount; ++s) {
+      if (busStats.load[s] <= 0.0f)
+        continue;
+      ImGui::SameLine();
+      ImGui::TextDisabled(
+          "%s %.2f%%",
+          AudioEffectChain::GetStageName(
+              static_cast<AudioEffectChain::Stage>(s)),
+          busStats.load[s] * 100.0f);
+    }
+  }
+}
+
 void UIManager::RenderPropertiesPanel(float x, float y, float w, float h) {
   ImGui::SetNextWindowPos(ImVec2(x, y));
   ImGui::SetNextWindowSize(ImVec2(w, h));
@@ -666,7 +922,30 @@ void UIManager::RenderPropertiesPanel(float x, float y, float w, float h) {
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Speed")) {
-      ImGui::Text("Curvet");
+      const Clip *clip =
+          m_TimelineManager
+              ? m_TimelineManager->FindClip(m_SelectedTrackIndex,
+                                            m_SelectedClipId)
+              : nullptr;
+      if (clip) {
+        ImGui::Spacing();
+        ImGui::TextDisabled("Standard");
+        ImGui::Text("Speed");
+        ImGui::SameLine(80);
+        float speed = static_cast<float>(clip->speed);
+        if (ImGui::SliderFloat("##Speed", &speed, 0.25f, 4.0f, "%.2fx",
+                               ImGuiSliderFlags_Logarithmic)) {
+          m_TimelineManager->SetClipSpeed(m_SelectedTrackIndex,
+                                          m_SelectedClipId, speed);
+        }
+        ImGui::TextDisabled("Duration %.1fs", clip->GetDisplayDuration());
+      } else {
+        ImGui::TextDisabled("Select a clip");
+      }
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Audio")) {
+      RenderTrackAudioTab();
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Animation")) {
@@ -1079,14 +1358,37 @@ void UIManager::RenderMenuBar() {
   }
   if (ImGui::BeginPopup("MenuPopup")) {
     if (ImGui::MenuItem("Open Project")) {
-      if (g_Application)
-        g_Application->OpenVideoFile();
+      LoadProject();
     }
     if (ImGui::MenuItem("Save Project")) {
+      SaveProject();
+    }
+    ImGui::Separator();
+    bool canUndo = m_TimelineManager && m_TimelineManager->CanUndo();
+    bool canRedo = m_TimelineManager && m_TimelineManager->CanRedo();
+    std::string undoLabel =
+        std::string("Undo ") + (canUndo ? m_TimelineManager->GetUndoName() : "");
+    std::string redoLabel =
+        std::string("Redo ") + (canRedo ? m_TimelineManager->GetRedoName() : "");
+    if (ImGui::MenuItem(undoLabel.c_str(), "Ctrl+Z", false, canUndo)) {
+      OnUndoPressed();
+    }
+    if (ImGui::MenuItem(redoLabel.c_str(), "Ctrl+Y", false, canRedo)) {
+      OnRedoPressed();
+    }
+    ImGui::Separator();
+    ImGui::SetNextItemWidth(220);
+    ImGui::InputText("##ProjectPath", m_ProjectPath, sizeof(m_ProjectPath));
+    if (ImGui::MenuItem("Import Media")) {
+      if (g_Application)
+        g_Application->OpenVideoFile();
     }
     if (ImGui::MenuItem("Export")) {
       m_ShowExportDialog = true;
     }
+    if (ImGui::MenuItem("Render Queue", nullptr, m_ShowRenderQueue)) {
+      m_ShowRenderQueue = !m_ShowRenderQueue;
+    }
     ImGui::Separator();
     if (ImGui::MenuItem("Exit")) {
       GLFWwindow *window = glfwGetCurrentContext();
@@ -1123,7 +1425,15 @@ void UIManager::RenderMenuBar() {
   // Export Button
   ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.00f, 0.78f, 0.84f, 1.00f));
   ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 0, 0, 1));
-  if (ImGui::Button("Export", ImVec2(80, 24))) {
+  if (m_ShowExportProgress && m_ExportInBackground) {
+    // Export keeps running from its snapshot; click to bring the dialog back
+    char label[32];
+    snprintf(label, sizeof(label), "%d%%##ExportBtn",
+             (int)(m_ExportProgress * 100.0f));
+    if (ImGui::Button(label, ImVec2(80, 24))) {
+      m_ExportInBackground = false;
+    }
+  } else if (ImGui::Button("Export", ImVec2(80, 24))) {
     m_ShowExportDialog = true;
   }
   ImGui::PopStyleColor(2);
@@ -1341,6 +1651,22 @@ void UIManager::RenderExportDialog() {
         ImGui::Combo("##Fps", &m_ExportFpsIndex, fpsList,
                      IM_ARRAYSIZE(fpsList));
 
+        // Segment-parallel export (CPU encoder, stitched without re-encode)
+        ImGui::Checkbox("Parallel segments", &m_UseSegmentedExport);
+        if (m_UseSegmentedExport) {
+          ImGui::SameLine();
+          ImGui::SetNextItemWidth(120);
+          ImGui::SliderInt("##Segments", &m_ExportSegmentCount, 0, 16,
+                           m_ExportSegmentCount == 0 ? "Auto" : "%d");
+        }
+
+        // Copy unedited clip ranges from the source, encode the rest
+        ImGui::Checkbox("Smart render (copy untouched clips)",
+                        &m_UseSmartRender);
+
+        // Stage timings while exporting, Chrome trace next to the video
+        ImGui::Checkbox("Record pipeline trace", &m_TraceExport);
+
         ImGui::Spacing();
         ImGui::TextDisabled("Color space: Rec. 709 SDR");
 
@@ -1349,9 +1675,24 @@ void UIManager::RenderExportDialog() {
 
       ImGui::Spacing();
 
-      // Audio Section (Placeholder)
-      static bool exportAudio = true;
-      ImGui::Checkbox("Audio", &exportAudio);
+      // Audio: every track mixed, each clip normalized from its analysis
+      ImGui::Checkbox("Audio", &m_ExportAudio);
+      if (m_ExportAudio) {
+        ImGui::Indent();
+        ImGui::Checkbox("Normalize loudness", &m_NormalizeLoudness);
+        if (m_NormalizeLoudness) {
+          ImGui::SameLine();
+          ImGui::SetNextItemWidth(120);
+          ImGui::SliderFloat("##TargetLoudness", &m_TargetLoudness, -24.0f,
+                             -9.0f, "%.0f LUFS");
+          int pending = LoudnessAnalyzer::GetPendingCount();
+          if (pending > 0)
+            ImGui::TextDisabled("Analyzing %d file(s); unanalyzed clips "
+                                "export at unity gain",
+                                pending);
+        }
+        ImGui::Unindent();
+      }
 
       // GIF Section (Placeholder)
       static bool exportGif = false;
@@ -1376,69 +1717,108 @@ void UIManager::RenderExportDialog() {
     ImGui::SetCursorPosY(ImGui::GetWindowHeight() - footerHeight - 10);
 
     float btnWidth = 120.0f;
-    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - btnWidth * 2 - 30);
+    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - btnWidth * 3 - 40);
 
     if (ImGui::Button("Cancel", ImVec2(btnWidth, 30))) {
       m_ShowExportDialog = false;
     }
 
+    ImGui::SameLine();
+    bool queueClicked = ImGui::Button("Add to Queue", ImVec2(btnWidth, 30));
+
     ImGui::SameLine();
     ImGui::PushStyleColor(ImGuiCol_Button,
                           ImVec4(0, 0.8f, 0.85f, 1.0f)); // CapCut Teal
     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 1, 1, 1));
-    if (ImGui::Button("Export", ImVec2(btnWidth, 30))) {
-      if (m_ExportManager) {
+    bool exportClicked = ImGui::Button("Export", ImVec2(btnWidth, 30));
+
+    if (exportClicked || queueClicked) {
+      // Apply Effects logic
+      HardwareExportManager::EffectParams params;
+      if (m_TextureRenderer) {
+        params.brightness = m_TextureRenderer->GetBrightness();
+        params.contrast = m_TextureRenderer->GetContrast();
+        params.saturation = m_TextureRenderer->GetSaturation();
+        params.vignette = m_TextureRenderer->GetVignette();
+        params.grain = m_TextureRenderer->GetGrain();
+        params.aberration = m_TextureRenderer->GetAberration();
+        params.sepia = m_TextureRenderer->GetSepia();
+        params.filterType =
+            m_TextureRenderer->GetFilterType(); // Include active filter!
+        params.lutPath = m_TextureRenderer->GetCubeLUTPath();
+      }
+
+      // Construct Filename
+      // std::string fullPath = std::string(m_ExportPath) +
+      // std::string(m_ExportName) + ".mp4";
+      // For safety, just use m_ExportFilename buffer or copy to it
+      strcpy_s(m_ExportFilename, m_ExportName);
+      if (strstr(m_ExportFilename, ".mp4") == nullptr)
+        strcat_s(m_ExportFilename, ".mp4");
+
+      int w = GetWidthFromIndex(m_ExportResIndex);
+      int h = GetHeightFromIndex(m_ExportResIndex);
+      int f = GetFpsFromIndex(m_ExportFpsIndex);
+
+      // Initialize export configuration
+      HardwareExportManager::Config config;
+      config.outputFile = m_ExportFilename;
+      config.width = w;
+      config.height = h;
+      config.fps = f;
+      config.codec = HardwareExportManager::Codec::H264;
+      config.rateControl = HardwareExportManager::RateControl::VBR;
+      config.bitrate = 8000000; // 8 Mbps
+      config.preset = 1;        // p1 = fastest
+      config.exportAudio = m_ExportAudio;
+      config.normalizeLoudness = m_NormalizeLoudness;
+      config.targetLoudness = m_TargetLoudness;
+
+      if (exportClicked) {
+        Trace::SetEnabled(m_TraceExport);
+        Trace::Clear();
+        m_TraceSummary = Trace::Summary();
+      }
+
+      if (queueClicked && m_ExportQueue) {
+        // Queued jobs run alongside each other, see RenderRenderQueue()
+        m_ExportQueue->AddJob(m_ExportName, m_TimelineManager, config, params);
+        m_ShowRenderQueue = true;
+      } else if (exportClicked && (m_UseSegmentedExport || m_UseSmartRender)) {
+        if (!m_SegmentedExport)
+          m_SegmentedExport = new SegmentedExportManager(m_TimelineManager);
+        m_SegmentedExport->SetMainWindow(glfwGetCurrentContext());
+        m_SegmentedExport->SetEffectParams(params);
+        m_SegmentedExport->SetSmartRender(m_UseSmartRender);
+
+        m_LastExportPath = m_ExportFilename; // Save for success dialog
+
+        int segmentCount = m_UseSegmentedExport ? m_ExportSegmentCount : 1;
+        if (m_SegmentedExport->Initialize(config, segmentCount)) {
+          m_SegmentedExport->StartExport();
+        }
+        m_ExportIsSegmented = true;
+        m_ShowExportProgress = true;
+        m_ExportInBackground = false;
+      } else if (exportClicked && m_ExportManager) {
         // Ensure Main Window is set (Critical for context sharing)
         if (!m_ExportManager->GetMainWindow()) {
           m_ExportManager->SetMainWindow(glfwGetCurrentContext());
         }
-
-        // Apply Effects logic
         if (m_TextureRenderer) {
-          HardwareExportManager::EffectParams params;
-          params.brightness = m_TextureRenderer->GetBrightness();
-          params.contrast = m_TextureRenderer->GetContrast();
-          params.saturation = m_TextureRenderer->GetSaturation();
-          params.vignette = m_TextureRenderer->GetVignette();
-          params.grain = m_TextureRenderer->GetGrain();
-          params.aberration = m_TextureRenderer->GetAberration();
-          params.sepia = m_TextureRenderer->GetSepia();
-          params.filterType =
-              m_TextureRenderer->GetFilterType(); // Include active filter!
           m_ExportManager->SetEffectParams(params);
         }
 
-        // Construct Filename
-        // std::string fullPath = std::string(m_ExportPath) +
-        // std::string(m_ExportName) + ".mp4";
-        // For safety, just use m_ExportFilename buffer or copy to it
-        strcpy_s(m_ExportFilename, m_ExportName);
-        if (strstr(m_ExportFilename, ".mp4") == nullptr)
-          strcat_s(m_ExportFilename, ".mp4");
-
-        int w = GetWidthFromIndex(m_ExportResIndex);
-        int h = GetHeightFromIndex(m_ExportResIndex);
-        int f = GetFpsFromIndex(m_ExportFpsIndex);
-
         m_LastExportPath = m_ExportFilename; // Save for success dialog
 
-        // Initialize export configuration
-        HardwareExportManager::Config config;
-        config.outputFile = m_ExportFilename;
-        config.width = w;
-        config.height = h;
-        config.fps = f;
-        config.codec = HardwareExportManager::Codec::H264;
-        config.rateControl = HardwareExportManager::RateControl::VBR;
-        config.bitrate = 8000000; // 8 Mbps
-        config.preset = 1;        // p1 = fastest
-
         if (m_ExportManager->Initialize(config)) {
           m_ExportManager->StartExport();
         }
+        m_ExportIsSegmented = false;
+        m_ShowExportProgress = true;
+        m_ExportInBackground = false;
       }
       m_ShowExportDialog = false;
-      m_ShowExportProgress = true;
     }
     ImGui::PopStyleColor(2);
 
@@ -1446,7 +1826,26 @@ void UIManager::RenderExportDialog() {
   }
 }
 void UIManager::RenderExportProgress() {
-  if (m_ShowExportProgress && m_ExportManager) {
+  bool segmented = m_ExportIsSegmented && m_SegmentedExport;
+  if (m_ShowExportProgress && (m_ExportManager || segmented)) {
+    // Checked every frame so a backgrounded export still reports completion
+    bool exporting = segmented ? m_SegmentedExport->IsExporting()
+                               : m_ExportManager->IsExporting();
+    if (!exporting) {
+      if (Trace::IsEnabled()) {
+        Trace::SetEnabled(false);
+        Trace::WriteChromeJSON(m_LastExportPath + ".trace.json");
+      }
+
+      // Export finished - show success dialog
+      m_ShowExportProgress = false;
+      m_ExportInBackground = false;
+      m_ShowExportSuccess = true;
+    }
+  }
+
+  if (m_ShowExportProgress && !m_ExportInBackground &&
+      (m_ExportManager || segmented)) {
     ImGui::OpenPopup("Exporting...");
     ImVec2 center = ImGui::GetMainViewport()->GetCenter();
     ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
@@ -1454,23 +1853,85 @@ void UIManager::RenderExportProgress() {
     if (ImGui::BeginPopupModal("Exporting...", NULL,
                                ImGuiWindowFlags_AlwaysAutoResize |
                                    ImGuiWindowFlags_NoMove)) {
-      ImGui::Text("Exporting video, please wait...");
+      ImGui::Text("Exporting video...");
       ImGui::ProgressBar(m_ExportProgress, ImVec2(350, 0));
 
       ImGui::Spacing();
       ImGui::Text("Progress: %.1f%%", m_ExportProgress * 100.0f);
+      if (segmented) {
+        ImGui::TextDisabled("%d segments in parallel",
+                            (int)m_SegmentedExport->GetSegments().size());
+        if (m_SegmentedExport->GetCopiedFrames() > 0) {
+          ImGui::TextDisabled("%d/%d frames stream-copied",
+                              m_SegmentedExport->GetCopiedFrames(),
+                              m_SegmentedExport->GetTotalFrames());
+        }
+      } else {
+        std::string encoder = m_ExportManager->GetEncoderDescription();
+        if (!encoder.empty())
+          ImGui::TextDisabled("Encoder: %s", encoder.c_str());
+
+        // Render -> encoder handoff: who waits on whom
+        auto stats = m_ExportManager->GetQueueStats();
+        ImGui::TextDisabled("Encoder queue %d/%d (peak %d)", (int)stats.size,
+                            (int)stats.capacity, (int)stats.highWater);
+        ImGui::TextDisabled("Render stalled %.2fs, encoder starved %.2fs",
+                            stats.pushStallSeconds, stats.popStallSeconds);
+      }
 
-      ImGui::Spacing();
-      if (ImGui::Button("Cancel Export", ImVec2(350, 30))) {
-        if (m_ExportManager) {
-          m_ExportManager->CancelExport();
+      if (Trace::IsEnabled()) {
+        // Walking the trace rings is not free; refresh twice a second
+        if (ImGui::GetTime() - m_TraceSummaryTime > 0.5) {
+          m_TraceSummary = Trace::GetSummary();
+          m_TraceSummaryTime = ImGui::GetTime();
+        }
+
+        ImGui::Spacing();
+        if (ImGui::BeginTable("TraceStages", 4,
+                              ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_BordersInnerH)) {
+          ImGui::TableSetupColumn("Stage");
+          ImGui::TableSetupColumn("p50 ms", ImGuiTableColumnFlags_WidthFixed,
+                                  60.0f);
+          ImGui::TableSetupColumn("p99 ms", ImGuiTableColumnFlags_WidthFixed,
+                                  60.0f);
+          ImGui::TableSetupColumn("Total s", ImGuiTableColumnFlags_WidthFixed,
+                                  60.0f);
+          ImGui::TableHeadersRow();
+
+          for (const auto &stage : m_TraceSummary.stages) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(Trace::GetStageName(stage.stage));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stage.p50Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stage.p99Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stage.totalMs / 1000.0);
+          }
+          ImGui::EndTable();
+        }
+        for (const auto &counter : m_TraceSummary.counters) {
+          ImGui::TextDisabled("%s depth: %lld (max %lld)",
+                              Trace::GetCounterName(counter.counter),
+                              (long long)counter.last, (long long)counter.max);
         }
       }
 
-      if (!m_ExportManager->IsExporting()) {
-        // Export finished - show success dialog
-        m_ShowExportProgress = false;
-        m_ShowExportSuccess = true;
+      ImGui::Spacing();
+      // The export renders a snapshot, so editing the timeline is safe
+      if (ImGui::Button("Keep Editing", ImVec2(171, 30))) {
+        m_ExportInBackground = true;
+        ImGui::CloseCurrentPopup();
+      }
+      ImGui::SameLine(0, 8);
+      if (ImGui::Button("Cancel Export", ImVec2(171, 30))) {
+        if (segmented) {
+          m_SegmentedExport->CancelExport();
+        } else if (m_ExportManager) {
+          m_ExportManager->CancelExport();
+        }
       }
       ImGui::EndPopup();
     }
@@ -1528,6 +1989,75 @@ void UIManager::RenderExportProgress() {
   }
 }
 
+void UIManager::RenderRenderQueue() {
+  if (!m_ShowRenderQueue || !m_ExportQueue)
+    return;
+
+  ImGui::SetNextWindowSize(ImVec2(560, 320), ImGuiCond_FirstUseEver);
+  if (ImGui::Begin("Render Queue", &m_ShowRenderQueue)) {
+    ExportQueue::Throughput total = m_ExportQueue->GetThroughput();
+    ImGui::Text("Running: %d  Pending: %d  Done: %d", total.running,
+                total.pending, total.done);
+    ImGui::Text("Aggregate: %.1f FPS (%lld frames in %.1fs)",
+                total.aggregateFPS, (long long)total.totalFrames,
+                total.busySeconds);
+    uint64_t lookups = total.cacheHits + total.cacheMisses;
+    ImGui::Text("Shared frame cache: %.0f%% hits",
+                lookups ? 100.0 * total.cacheHits / lookups : 0.0);
+    ImGui::Separator();
+
+    int cancelId = -1;
+    if (ImGui::BeginTable("RenderQueueJobs", 5,
+                          ImGuiTableFlags_RowBg |
+                              ImGuiTableFlags_BordersInnerH)) {
+      ImGui::TableSetupColumn("Job");
+      ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+      ImGui::TableSetupColumn("Progress", ImGuiTableColumnFlags_WidthFixed,
+                              140.0f);
+      ImGui::TableSetupColumn("FPS", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+      ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 30.0f);
+      ImGui::TableHeadersRow();
+
+      for (const auto &job : m_ExportQueue->GetJobStatuses()) {
+        ImGui::PushID(job.id);
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::Text("%s", job.name.c_str());
+        if (!job.error.empty() && ImGui::IsItemHovered())
+          ImGui::SetTooltip("%s", job.error.c_str());
+        ImGui::TableSetColumnIndex(1);
+        ImGui::Text("%s%s", ExportQueue::GetStateName(job.state),
+                    job.state == ExportQueue::JobState::Running &&
+                            !job.hardwareEncoder
+                        ? " (CPU)"
+                        : "");
+        ImGui::TableSetColumnIndex(2);
+        ImGui::ProgressBar(job.progress, ImVec2(-1, 0));
+        ImGui::TableSetColumnIndex(3);
+        ImGui::Text("%.1f", job.fps);
+        ImGui::TableSetColumnIndex(4);
+        if ((job.state == ExportQueue::JobState::Pending ||
+             job.state == ExportQueue::JobState::Running) &&
+            ImGui::SmallButton(ICON_FA_XMARK)) {
+          cancelId = job.id;
+        }
+        ImGui::PopID();
+      }
+      ImGui::EndTable();
+    }
+    if (cancelId >= 0)
+      m_ExportQueue->CancelJob(cancelId);
+
+    ImGui::Spacing();
+    if (ImGui::Button("Cancel All"))
+      m_ExportQueue->CancelAll();
+    ImGui::SameLine();
+    if (ImGui::Button("Clear Finished"))
+      m_ExportQueue->ClearFinished();
+  }
+  ImGui::End();
+}
+
 void UIManager::CreateDefaultStickerTexture() {} // Placeholder
 void UIManager::AddSticker() {}                  // Placeholder
 const char *UIManager::FormatTime(float seconds) {
@@ -1542,8 +2072,22 @@ void UIManager::OnSpacePressed() {
   m_IsPlaying = !m_IsPlaying;
   if (m_IsPlaying && m_VideoPlayer)
     m_PlaybackStartTime = glfwGetTime() - m_CurrentTime;
+  if (m_VideoPlayer)
+    m_VideoPlayer->SetPlaying(m_IsPlaying);
+  if (m_TimelineManager)
+    m_TimelineManager->SetPlaying(m_IsPlaying);
+}
+void UIManager::OnUndoPressed() {
+  if (m_TimelineManager)
+    m_TimelineManager->Undo();
+}
+void UIManager::OnRedoPressed() {
+  if (m_TimelineManager)
+    m_TimelineManager->Redo();
 }
 void UIManager::OnVideoLoaded(const std::string &filepath) {
+  // Measured while the user edits; export normalization reads the result
+  LoudnessAnalyzer::Request(filepath);
   if (m_TimelineManager) {
     m_TimelineManager->AddClipToTrack(filepath, 0, 0.0);
     m_TotalDuration =
@@ -1553,6 +2097,36 @@ void UIManager::OnVideoLoaded(const std::string &filepath) {
 }
 void UIManager::OnOpenVideoClicked() {}
 
+bool UIManager::SaveProject() {
+  if (!m_TimelineManager || !m_ProjectFile)
+    return false;
+  return m_ProjectFile->Save(m_ProjectPath, *m_TimelineManager, m_Stickers);
+}
+
+void UIManager::LoadProject() {
+  if (!m_TimelineManager || !m_ProjectFile)
+    return;
+  if (!m_ProjectFile->Load(m_ProjectPath, *m_TimelineManager, m_Stickers))
+    return;
+
+  for (auto &sticker : m_Stickers)
+    sticker.textureID = m_DefaultStickerTexture;
+  // Files saved with their loudness are cached already; no-op for those
+  for (const auto &track : m_TimelineManager->GetTracks()) {
+    for (const auto &clip : track.clips)
+      LoudnessAnalyzer::Request(clip.filepath);
+  }
+  m_SelectedClipId = -1;
+  m_SelectedTrackIndex = -1;
+  m_SelectedEffectId = -1;
+  m_SelectedStickerId = -1;
+  m_CurrentTime = 0.0f;
+  m_IsPlaying = false;
+  if (m_VideoPlayer)
+    m_VideoPlayer->SetPlaying(false);
+  m_TimelineManager->SetPlaying(false);
+}
+
 // Helper Methods Implementation
 
 void UIManager::LoadDemoImage() {
@@ -1743,27 +2317,4 @@ void UIManager::LoadDemoImage() {
                  fallbackData.data());
     glBindTexture(GL_TEXTURE_2D, 0);
   }
-}
-
-void UIManager::GenerateFilterThumbnails() {
-  if (!m_TextureRenderer || !m_DemoImageTexture)
-    return;
-
-  // We want square thumbnails for the UI (e.g. 200x200)
-  int thumbW = 200;
-  int thumbH = 200;
-
-  // Generate 16 thumbnails (0..15)
-  for (int i = 0; i < 16; i++) {
-    GLuint tex = m_TextureRenderer->GenerateFilterThumbnail(m_DemoImageTexture,
-                                                            i, thumbW, thumbH);
-    if (tex) {
-      m_FilterThumbnails.push_back(tex);
-    } else {
-      // Fallback (should not happen if GL works)
-      m_FilterThumbnails.push_back(m_DemoImageTexture);
-    }
-  }
-  std::cout << "[UIManager] Generated " << m_FilterThumbnails.size()
-            << " filter thumbnails." << std::endl;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../Core/Trace.h"
 #include "../Timeline/Sticker.h"
 #include <imgui.h>
 #include <string>
@@ -11,6 +12,7 @@ class VideoPlayer;
 class TextureRenderer;
 class TimelineThumbnails;
 class TimelineManager;
+class ProjectFile;
 
 class UIManager {
 public:
@@ -20,8 +22,20 @@ public:
   void Update(float deltaTime);
   void Render();
 
+  /**
+   * @brief How long the main loop may block waiting for input before the
+   * UI has something new to show
+   *
+   * The next frame's due time during playback, a short poll while exports
+   * or loudness analysis run, otherwise no limit.
+   * @return Seconds, or a negative value to wait for input only
+   */
+  double GetIdleTimeout() const;
+
   // Keyboard shortcuts callback
   void OnSpacePressed();
+  void OnUndoPressed();
+  void OnRedoPressed();
 
   // Video integration
   void SetVideoPlayer(VideoPlayer *player);
@@ -71,11 +85,29 @@ private:
 
   // Effect Selection
   int m_SelectedEffectId = -1; // -1 = none selected
+  char m_LUTPath[512] = "";    // .cube file for the Filters tab import
+
+  // Project State (binary snapshot + autosave journal)
+  ProjectFile *m_ProjectFile = nullptr;
+  char m_ProjectPath[512] = "project.ccpj";
+  double m_NextCompactionTime = 0.0; // Backoff after a failed compaction
+  bool SaveProject();
+  void LoadProject();
 
   // Export State
   class HardwareExportManager *m_ExportManager = nullptr;
+  class ExportQueue *m_ExportQueue = nullptr; // Batch render queue
+  class SegmentedExportManager *m_SegmentedExport = nullptr;
+  bool m_UseSegmentedExport = false; // Split into GOP-aligned segments
+  bool m_UseSmartRender = false;     // Stream-copy untouched clip ranges
+  bool m_TraceExport = false;        // Per-stage timing + trace JSON
+  Trace::Summary m_TraceSummary;     // Refreshed twice a second
+  double m_TraceSummaryTime = 0.0;
+  bool m_ExportIsSegmented = false;  // Which exporter the progress tracks
   bool m_ShowExportDialog = false;
+  bool m_ShowRenderQueue = false;
   bool m_ShowExportProgress = false;
+  bool m_ExportInBackground = false; // Progress modal hidden while editing
   bool m_ShowExportSuccess = false;
   float m_ExportProgress = 0.0f;
   std::string m_LastExportPath = "";
@@ -88,6 +120,10 @@ private:
   int m_ExportCodecIndex = 0;   // 0=H.264, 1=HEVC
   int m_ExportFormatIndex = 0;  // 0=mp4, 1=mov
   int m_ExportFpsIndex = 2;     // 0=24, 1=25, 2=30, 3=50, 4=60
+  int m_ExportSegmentCount = 0; // 0 = auto (from CPU cores)
+  bool m_ExportAudio = true;
+  bool m_NormalizeLoudness = true; // Per-clip gain from the import analysis
+  float m_TargetLoudness = -14.0f; // LUFS
 
   // Internal use for export call
   char m_ExportFilename[256] =
@@ -101,21 +137,21 @@ private:
   void RenderMediaPanel(float x, float y, float w, float h);
   void RenderPreviewPanel(float x, float y, float w, float h);
   void RenderPropertiesPanel(float x, float y, float w, float h);
+  void RenderTrackAudioTab(); // Selected clip's track effects and CPU
   void RenderTimelinePanel(float x, float y, float w, float h);
   void RenderTimelineTracks(); // Renamed from RenderTimelinePanel()
 
   void RenderExportDialog();
   void RenderExportProgress();
+  void RenderRenderQueue();
 
   // Helper methods
   const char *FormatTime(float seconds);
 
   // Filters Panel
-  unsigned int m_DemoImageTexture = 0;
-  std::vector<unsigned int> m_FilterThumbnails;
-  bool m_FilterGenerationAttempted = false;
-  void LoadDemoImage(); // Load cat.jpg
-  void GenerateFilterThumbnails();
+  unsigned int m_DemoImageTexture = 0; // Atlas source until a video loads
+  bool m_FilterAtlasPending = false;   // Set each frame the panel waits on it
+  void LoadDemoImage();                // Load cat.jpg
 
   // Effects Panel State
   int m_SelectedBlur = -1; // -1 = none, 0-3 = blur types
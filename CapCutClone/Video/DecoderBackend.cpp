@@ -0,0 +1,142 @@
+#include "DecoderBackend.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+std::atomic<DecoderBackend::Mode> DecoderBackend::s_Mode{
+    DecoderBackend::Mode::Auto};
+std::atomic<int> DecoderBackend::s_OpenDecoders{0};
+
+namespace {
+
+// Shared devices; null entry = creation failed, do not retry
+std::mutex g_DeviceMutex;
+std::map<AVHWDeviceType, AVBufferRef *> g_Devices;
+
+constexpr int kMaxCpuThreads = 16;
+
+// Pixel format the codec outputs for this device type, NONE if unsupported
+AVPixelFormat GetHardwareFormat(const AVCodec *codec, AVHWDeviceType type) {
+  for (int i = 0;; ++i) {
+    const AVCodecHWConfig *config = avcodec_get_hw_config(codec, i);
+    if (!config)
+      return AV_PIX_FMT_NONE;
+    if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) &&
+        config->device_type == type)
+      return config->pix_fmt;
+  }
+}
+
+} // namespace
+
+std::string DecoderBackend::Selection::Describe() const {
+  if (deviceType != AV_HWDEVICE_TYPE_NONE)
+    return av_hwdevice_get_type_name(deviceType);
+  return "cpu, " + std::to_string(threads) +
+         (threads == 1 ? " thread" : " threads");
+}
+
+std::vector<AVHWDeviceType> DecoderBackend::GetCandidates() {
+#if defined(_WIN32)
+  return {AV_HWDEVICE_TYPE_D3D11VA, AV_HWDEVICE_TYPE_DXVA2};
+#elif defined(__APPLE__)
+  return {AV_HWDEVICE_TYPE_VIDEOTOOLBOX};
+#else
+  return {AV_HWDEVICE_TYPE_VAAPI, AV_HWDEVICE_TYPE_VULKAN};
+#endif
+}
+
+int DecoderBackend::GetCpuThreads() {
+  if (s_Mode == Mode::SoftwareOnly)
+    return 1;
+
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  if (cores <= 0)
+    cores = 4;
+  int decoders = std::max(1, s_OpenDecoders.load() + 1);
+  return std::clamp(cores / decoders, 1, kMaxCpuThreads);
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+DecoderBackend::Selection DecoderBackend::Configure(AVCodecContext *codecCtx,
+                                                    const AVCodec *codec,
+                                                    AVBufferRef **device) {
+  Selection selection;
+
+  if (s_Mode == Mode::Auto) {
+    for (AVHWDeviceType type : GetCandidates()) {
+      if (GetHardwareFormat(codec, type) == AV_PIX_FMT_NONE)
+        continue;
+      AVBufferRef *shared = GetDevice(type);
+      if (!shared)
+        continue;
+
+      *device = av_buffer_ref(shared);
+      codecCtx->hw_device_ctx = av_buffer_ref(shared);
+      codecCtx->get_format = GetFormat;
+      // Surfaces come from the device; extra threads only add latency
+      codecCtx->thread_count = 1;
+      selection.deviceType = type;
+      return selection;
+    }
+  }
+
+  selection.threads = GetCpuThreads();
+  codecCtx->thread_count = selection.threads;
+  codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  return selection;
+}
+
+AVBufferRef *DecoderBackend::GetDevice(AVHWDeviceType type) {
+  std::lock_guard<std::mutex> lock(g_DeviceMutex);
+  auto it = g_Devices.find(type);
+  if (it != g_Devices.end())
+    return it->second;
+
+  AVBufferRef *device = nullptr;
+  if (av_hwdevice_ctx_create(&device, type, nullptr, nullptr, 0) < 0) {
+    device = nullptr;
+    std::cout << "[DecoderBackend] " << av_hwdevice_get_type_name(type)
+              << " not available" << std::endl;
+  } else {
+    std::cout << "[DecoderBackend] Using " << av_hwdevice_get_type_name(type)
+              << " for hardware decode" << std::endl;
+  }
+  g_Devices[type] = device; // Kept for the life of the process
+  return device;
+}
+
+enum AVPixelFormat
+DecoderBackend::GetFormat(AVCodecContext *codecCtx,
+                          const enum AVPixelFormat *formats) {
+  AVPixelFormat hardware = AV_PIX_FMT_NONE;
+  if (codecCtx->hw_device_ctx) {
+    auto *deviceCtx =
+        reinterpret_cast<AVHWDeviceContext *>(codecCtx->hw_device_ctx->data);
+    hardware = GetHardwareFormat(codecCtx->codec, deviceCtx->type);
+  }
+
+  AVPixelFormat software = AV_PIX_FMT_NONE;
+  for (const AVPixelFormat *p = formats; *p != AV_PIX_FMT_NONE; ++p) {
+    if (*p == hardware)
+      return *p;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(*p);
+    if (software == AV_PIX_FMT_NONE && desc &&
+        !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+      software = *p;
+  }
+
+  // This stream is not decodable on the device (profile, size): CPU
+  std::cerr << "[DecoderBackend] Hardware format not offered, decoding on CPU"
+            << std::endl;
+  return software;
+}
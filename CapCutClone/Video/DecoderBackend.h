@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+}
+
+/**
+ * @brief Picks hardware or CPU decode for every VideoPlayer
+ *
+ * Hardware: the platform's device types are tried in order (Windows
+ * D3D11VA then DXVA2, Linux VAAPI then Vulkan, macOS VideoToolbox). A
+ * type is used only if the codec has a hardware config for it. Devices
+ * are created once per process and shared by all decoders; a type whose
+ * device cannot be created is not probed again.
+ *
+ * CPU: frame + slice threading, with the cores split between the
+ * decoders open at the same time (playback, prefetch and every export
+ * pipeline each hold one).
+ *
+ * Mode::SoftwareOnly skips hardware and uses one thread, so decoded
+ * frames and timings do not depend on the machine (tests, benchmarks).
+ */
+class DecoderBackend {
+public:
+  enum class Mode { Auto, SoftwareOnly };
+
+  struct Selection {
+    AVHWDeviceType deviceType = AV_HWDEVICE_TYPE_NONE; ///< NONE = CPU
+    int threads = 1;
+
+    /**
+     * @brief Short summary for logs, e.g. "vaapi" or "cpu, 4 threads"
+     */
+    std::string Describe() const;
+  };
+
+  static void SetMode(Mode mode) { s_Mode = mode; }
+  static Mode GetMode() { return s_Mode; }
+
+  /**
+   * @brief Set up the codec context before avcodec_open2()
+   * @param device Receives a reference to the hardware device, or stays
+   * null for CPU decode; the caller unrefs it
+   */
+  static Selection Configure(AVCodecContext *codecCtx, const AVCodec *codec,
+                             AVBufferRef **device);
+
+  /**
+   * @brief Device types tried on this platform, in order
+   */
+  static std::vector<AVHWDeviceType> GetCandidates();
+
+  /**
+   * @brief CPU decode threads for one more decoder next to the open ones
+   */
+  static int GetCpuThreads();
+
+  // Open decoder count, maintained by VideoPlayer
+  static void AddDecoder() { s_OpenDecoders++; }
+  static void RemoveDecoder() { s_OpenDecoders--; }
+  static int GetOpenDecoders() { return s_OpenDecoders; }
+
+  static bool IsHardwareFrame(const AVFrame *frame) {
+    return frame->hw_frames_ctx != nullptr;
+  }
+
+private:
+  static AVBufferRef *GetDevice(AVHWDeviceType type);
+  static enum AVPixelFormat GetFormat(AVCodecContext *codecCtx,
+                                      const enum AVPixelFormat *formats);
+
+  static std::atomic<Mode> s_Mode;
+  static std::atomic<int> s_OpenDecoders;
+};
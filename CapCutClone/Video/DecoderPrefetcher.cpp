@@ -0,0 +1,201 @@
+#include "DecoderPrefetcher.h"
+#include "VideoPlayer.h"
+#include <algorithm>
+#include <iostream>
+
+DecoderPrefetcher::DecoderPrefetcher()
+    : m_Player(std::make_unique<VideoPlayer>()) {
+  m_Worker = std::thread(&DecoderPrefetcher::WorkerFunc, this);
+}
+
+DecoderPrefetcher::~DecoderPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Shutdown = true;
+  }
+  m_WakeWorker.notify_one();
+  if (m_Worker.joinable())
+    m_Worker.join();
+}
+
+void DecoderPrefetcher::Request(const std::string &filepath,
+                                double sourceTime) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_State != State::Idle && m_File == filepath &&
+        m_SourceTime == sourceTime)
+      return;
+
+    // Supersedes whatever was pending; a load in progress finishes and is
+    // then discarded by the worker
+    m_File = filepath;
+    m_SourceTime = sourceTime;
+    m_State = State::Pending;
+  }
+  m_WakeWorker.notify_one();
+}
+
+bool DecoderPrefetcher::Take(const std::string &filepath, VideoPlayer &player,
+                             bool wait) {
+  std::unique_ptr<VideoPlayer> ready;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (wait) {
+      m_Done.wait(lock, [&] {
+        return m_File != filepath ||
+               (m_State != State::Pending && m_State != State::Loading);
+      });
+    }
+    if (m_State != State::Ready || m_File != filepath)
+      return false;
+
+    ready = std::move(m_Player);
+    m_State = State::Idle;
+    m_File.clear();
+  }
+
+  // Outside the lock: may reconfigure the audio device
+  player.SwapDecoder(*ready);
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Retired.push_back(std::move(ready));
+  }
+  m_WakeWorker.notify_one();
+  return true;
+}
+
+void DecoderPrefetcher::OpenAudio(int clipId, const std::string &filepath) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    AudioOpen open;
+    open.clipId = clipId;
+    open.ticket = m_NextTicket++;
+    open.file = filepath;
+    m_AudioOpens.push_back(std::move(open));
+  }
+  m_WakeWorker.notify_one();
+}
+
+bool DecoderPrefetcher::TakeAudio(int clipId,
+                                  std::unique_ptr<VideoPlayer> &player) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = std::find_if(
+      m_AudioOpens.begin(), m_AudioOpens.end(),
+      [&](const AudioOpen &open) { return open.clipId == clipId; });
+  if (it == m_AudioOpens.end() || !it->done)
+    return false;
+
+  player = std::move(it->player);
+  m_AudioOpens.erase(it);
+  return true;
+}
+
+void DecoderPrefetcher::CancelAudio(int clipId) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = std::find_if(
+        m_AudioOpens.begin(), m_AudioOpens.end(),
+        [&](const AudioOpen &open) { return open.clipId == clipId; });
+    if (it == m_AudioOpens.end())
+      return;
+    // An open in progress finds its ticket gone and retires the player
+    if (it->player)
+      m_Retired.push_back(std::move(it->player));
+    m_AudioOpens.erase(it);
+  }
+  m_WakeWorker.notify_one();
+}
+
+void DecoderPrefetcher::Retire(std::unique_ptr<VideoPlayer> player) {
+  if (!player)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Retired.push_back(std::move(player));
+  }
+  m_WakeWorker.notify_one();
+}
+
+void DecoderPrefetcher::OpenNextAudio(std::unique_lock<std::mutex> &lock) {
+  auto it = std::find_if(m_AudioOpens.begin(), m_AudioOpens.end(),
+                         [](const AudioOpen &open) { return !open.done; });
+  uint64_t ticket = it->ticket;
+  std::string file = it->file;
+  lock.unlock();
+
+  // Audio only: the video stream is discarded at the demuxer
+  auto player = std::make_unique<VideoPlayer>();
+  bool loaded = player->LoadVideo(file, true, false) && player->HasAudio();
+
+  lock.lock();
+  it = std::find_if(
+      m_AudioOpens.begin(), m_AudioOpens.end(),
+      [&](const AudioOpen &open) { return open.ticket == ticket; });
+  if (it != m_AudioOpens.end()) {
+    it->done = true;
+    if (loaded)
+      it->player = std::move(player);
+  }
+  if (player)
+    m_Retired.push_back(std::move(player)); // Cancelled meanwhile, or silent
+}
+
+void DecoderPrefetcher::WorkerFunc() {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (true) {
+    m_WakeWorker.wait(lock, [this] {
+      return m_Shutdown || !m_Retired.empty() ||
+             std::any_of(m_AudioOpens.begin(), m_AudioOpens.end(),
+                         [](const AudioOpen &open) { return !open.done; }) ||
+             (m_State == State::Pending && m_Player);
+    });
+    if (m_Shutdown)
+      break;
+
+    if (!m_Retired.empty()) {
+      // Closing a decoder frees the hardware device; keep it off the
+      // caller's thread. The first retired player becomes the next spare.
+      auto retired = std::move(m_Retired);
+      lock.unlock();
+      for (auto &player : retired)
+        player->Close();
+      lock.lock();
+      if (!m_Player) {
+        m_Player = std::move(retired.back());
+        retired.pop_back();
+      }
+      continue;
+    }
+
+    // Clip audio first: it is needed at the playhead, the prefetch only
+    // at the next cut
+    if (std::any_of(m_AudioOpens.begin(), m_AudioOpens.end(),
+                    [](const AudioOpen &open) { return !open.done; })) {
+      OpenNextAudio(lock);
+      continue;
+    }
+
+    std::string file = m_File;
+    double sourceTime = m_SourceTime;
+    std::unique_ptr<VideoPlayer> player = std::move(m_Player);
+    m_State = State::Loading;
+    lock.unlock();
+
+    bool loaded = player->LoadVideo(file, false);
+    if (loaded && sourceTime > 0.0)
+      player->Seek(sourceTime, false);
+    else if (loaded)
+      player->DecodeNextFrame();
+
+    lock.lock();
+    m_Player = std::move(player);
+    if (m_State == State::Loading) {
+      m_State = loaded ? State::Ready : State::Failed;
+      if (!loaded)
+        std::cerr << "[DecoderPrefetcher] Cannot open " << file << std::endl;
+    }
+    // Otherwise a newer request came in meanwhile and is Pending
+    m_Done.notify_all();
+  }
+}
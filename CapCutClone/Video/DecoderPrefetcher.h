@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class VideoPlayer;
+
+/**
+ * @brief Opens the next clip's decoder on a background thread
+ *
+ * LoadVideo() opens the container, probes the streams, creates the
+ * hardware device and opens the codecs. Doing that at a cut stalls
+ * playback and export for the whole open. Request() names the file and
+ * source time of the upcoming clip; a worker thread opens a spare
+ * VideoPlayer and decodes up to that time. At the cut, Take() swaps the
+ * ready decoder into the caller's player in O(1).
+ *
+ * One request is in flight at a time and a new request replaces an older
+ * one. The decoder swapped out by Take() is closed on the worker too.
+ *
+ * The same worker opens the audio-only players of timeline clips
+ * (OpenAudio()/TakeAudio()) and closes the ones handed to Retire(), so
+ * clip audio starting at a cut does not open a file on the UI thread.
+ */
+class DecoderPrefetcher {
+public:
+  DecoderPrefetcher();
+  ~DecoderPrefetcher();
+
+  DecoderPrefetcher(const DecoderPrefetcher &) = delete;
+  DecoderPrefetcher &operator=(const DecoderPrefetcher &) = delete;
+
+  /**
+   * @brief Open @p filepath and pre-roll it to @p sourceTime
+   *
+   * No-op if the same file and time is already pending or done, so it is
+   * safe to call every frame.
+   */
+  void Request(const std::string &filepath, double sourceTime);
+
+  /**
+   * @brief Swap the prefetched decoder for @p filepath into @p player
+   * @param wait Block while a matching request is still opening
+   * @return False if nothing usable was prefetched for this file
+   */
+  bool Take(const std::string &filepath, VideoPlayer &player, bool wait);
+
+  /**
+   * @brief Queue an audio-only open of @p filepath for timeline clip
+   * @p clipId; collect it with TakeAudio()
+   */
+  void OpenAudio(int clipId, const std::string &filepath);
+
+  /**
+   * @brief Collect the player opened for @p clipId
+   * @param player Set to the player, or null if the file has no audio
+   * @return False while the open is still queued or running
+   */
+  bool TakeAudio(int clipId, std::unique_ptr<VideoPlayer> &player);
+
+  /**
+   * @brief Drop the open for @p clipId; a finished player is retired
+   */
+  void CancelAudio(int clipId);
+
+  /**
+   * @brief Close @p player on the worker
+   */
+  void Retire(std::unique_ptr<VideoPlayer> player);
+
+private:
+  enum class State { Idle, Pending, Loading, Ready, Failed };
+
+  struct AudioOpen {
+    int clipId = -1;
+    uint64_t ticket = 0; // Tells a reopen of the same clip apart
+    std::string file;
+    bool done = false;
+    std::unique_ptr<VideoPlayer> player; // Null if done without audio
+  };
+
+  void WorkerFunc();
+  void OpenNextAudio(std::unique_lock<std::mutex> &lock);
+
+  std::thread m_Worker;
+  std::mutex m_Mutex;
+  std::condition_variable m_WakeWorker;
+  std::condition_variable m_Done;
+  bool m_Shutdown = false;
+
+  State m_State = State::Idle;
+  std::string m_File;
+  double m_SourceTime = 0.0;
+  std::unique_ptr<VideoPlayer> m_Player; ///< Spare, or the prefetched one
+  std::vector<std::unique_ptr<VideoPlayer>> m_Retired; ///< Closed by worker
+
+  std::vector<AudioOpen> m_AudioOpens; ///< Queued, opening or done
+  uint64_t m_NextTicket = 0;
+};
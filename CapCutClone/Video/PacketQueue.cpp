@@ -0,0 +1,127 @@
+#include "PacketQueue.h"
+
+PacketQueue::PacketQueue(size_t capacity, TraceCounter counter)
+    : m_Packets(capacity), m_Free(capacity * 2), m_Counter(counter) {}
+
+PacketQueue::~PacketQueue() {
+  Entry entry;
+  while (m_Packets.TryPop(entry))
+    av_packet_free(&entry.packet);
+  AVPacket *shell = nullptr;
+  while (m_Free.TryPop(shell))
+    av_packet_free(&shell);
+}
+
+AVPacket *PacketQueue::AcquireShell() {
+  AVPacket *shell = nullptr;
+  if (m_Free.TryPop(shell))
+    return shell;
+  return av_packet_alloc();
+}
+
+void PacketQueue::Recycle(AVPacket *shell) {
+  av_packet_unref(shell);
+  if (!m_Free.TryPush(shell))
+    av_packet_free(&shell);
+}
+
+bool PacketQueue::Push(AVPacket *packet, int serial) {
+  auto cancelled = [&] { return m_Aborted || serial < m_MinSerial; };
+  if (cancelled())
+    return false;
+
+  AVPacket *shell = AcquireShell();
+  if (!shell)
+    return false;
+  av_packet_move_ref(shell, packet);
+  Entry entry{shell, serial};
+  if (!m_Packets.Push(entry, cancelled)) {
+    av_packet_move_ref(packet, shell); // Left with the caller
+    Recycle(shell);
+    return false;
+  }
+  Trace::RecordCounter(m_Counter, static_cast<int64_t>(m_Packets.Size()));
+  return true;
+}
+
+bool PacketQueue::PushDropOldest(AVPacket *packet, int serial) {
+  if (m_Aborted || serial < m_MinSerial)
+    return false;
+
+  AVPacket *shell = AcquireShell();
+  if (!shell)
+    return false;
+  av_packet_move_ref(shell, packet);
+  Entry entry{shell, serial};
+  while (!m_Packets.TryPush(entry)) {
+    Entry oldest;
+    if (m_Packets.TryPop(oldest))
+      Recycle(oldest.packet);
+  }
+  Trace::RecordCounter(m_Counter, static_cast<int64_t>(m_Packets.Size()));
+  return true;
+}
+
+PacketQueue::Result PacketQueue::Pop(AVPacket *packet, int &serial,
+                                     bool wait) {
+  // Packets stay queued while aborted: SwapDecoder() hands them over
+  if (m_Aborted)
+    return Result::Aborted;
+
+  Entry entry;
+  bool popped =
+      wait ? m_Packets.Pop(entry, [this] { return m_Aborted || m_EndOfStream; })
+           : m_Packets.TryPop(entry);
+  if (!popped) {
+    if (m_Aborted)
+      return Result::Aborted;
+    return m_EndOfStream ? Result::EndOfStream : Result::Empty;
+  }
+
+  av_packet_move_ref(packet, entry.packet);
+  serial = entry.serial;
+  Recycle(entry.packet);
+  return Result::Packet;
+}
+
+void PacketQueue::WaitWhileEnded() {
+  std::unique_lock<std::mutex> lock(m_StateMutex);
+  m_StateChanged.wait(lock, [this] { return m_Aborted || !m_EndOfStream; });
+}
+
+void PacketQueue::SetState(bool endOfStream) {
+  {
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    m_EndOfStream = endOfStream;
+  }
+  m_StateChanged.notify_all();
+  m_Packets.Wake();
+}
+
+void PacketQueue::SetEndOfStream() { SetState(true); }
+
+void PacketQueue::Flush() {
+  Entry entry;
+  while (m_Packets.TryPop(entry))
+    Recycle(entry.packet);
+  SetState(false);
+}
+
+void PacketQueue::ExpireBefore(int serial) {
+  int expired = m_MinSerial;
+  while (expired < serial &&
+         !m_MinSerial.compare_exchange_weak(expired, serial)) {
+  }
+  SetState(false);
+}
+
+void PacketQueue::Abort() {
+  {
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    m_Aborted = true;
+  }
+  m_StateChanged.notify_all();
+  m_Packets.Wake();
+}
+
+void PacketQueue::Start() { m_Aborted = false; }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../Core/BoundedQueue.h"
+#include "../Core/Trace.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief Bounded FIFO of demuxed packets for one stream
+ *
+ * The demux thread pushes and one decoder pops, through a BoundedQueue
+ * like the other pipeline stages, so its occupancy and stalls are
+ * measured the same way (GetStats(), and the depth as a Trace counter).
+ * Every packet carries the serial of the seek it was read after, so a
+ * consumer can drop packets that were already in flight when a seek was
+ * requested. Packet shells are recycled through a free list: after
+ * warm-up nothing is allocated.
+ */
+class PacketQueue {
+public:
+  enum class Result { Packet, Empty, EndOfStream, Aborted };
+
+  /**
+   * @param capacity Rounded up to a power of two (see BoundedQueue)
+   * @param counter Trace counter the depth is recorded under
+   */
+  PacketQueue(size_t capacity, TraceCounter counter);
+  ~PacketQueue();
+
+  PacketQueue(const PacketQueue &) = delete;
+  PacketQueue &operator=(const PacketQueue &) = delete;
+
+  /**
+   * @brief Move @p packet's payload into the queue, waiting while full
+   * @return False if aborted or @p serial expired (the payload is left in
+   * @p packet)
+   */
+  bool Push(AVPacket *packet, int serial);
+
+  /**
+   * @brief Like Push(), but drops the oldest packet instead of waiting
+   */
+  bool PushDropOldest(AVPacket *packet, int serial);
+
+  /**
+   * @brief Move the oldest packet into @p packet (caller unrefs it)
+   * @param wait Block until a packet, the end of stream or Abort()
+   */
+  Result Pop(AVPacket *packet, int &serial, bool wait);
+
+  /**
+   * @brief Block while the stream is at its end (until Flush or Abort)
+   */
+  void WaitWhileEnded();
+
+  void SetEndOfStream();
+  void Flush(); ///< Drop everything and clear the end of stream
+
+  /**
+   * @brief A seek to @p serial was requested: pushes of older packets fail
+   * instead of waiting for room, and the old end of stream is cleared
+   *
+   * Queued packets stay; the consumer skips stale ones by serial, so
+   * packets already read after the seek are never lost.
+   */
+  void ExpireBefore(int serial);
+
+  void Abort(); ///< Wake all waiters; Push/Pop fail until Start()
+  void Start();
+
+  size_t GetSize() const { return m_Packets.Size(); }
+  auto GetStats() const { return m_Packets.GetStats(); }
+
+private:
+  struct Entry {
+    AVPacket *packet = nullptr;
+    int serial = 0;
+  };
+
+  AVPacket *AcquireShell(); // Recycled or new, null on allocation failure
+  void Recycle(AVPacket *shell);
+  void SetState(bool endOfStream); // Under m_StateMutex, wakes everyone
+
+  BoundedQueue<Entry> m_Packets;
+  BoundedQueue<AVPacket *> m_Free;
+  TraceCounter m_Counter;
+
+  // Stream state; changes are rare, waits on them go through m_StateMutex
+  std::atomic<bool> m_EndOfStream{false};
+  std::atomic<bool> m_Aborted{false};
+  std::atomic<int> m_MinSerial{0}; // Pushes of older packets fail
+  std::mutex m_StateMutex;
+  std::condition_variable m_StateChanged; // Ended, flushed, expired, aborted
+};
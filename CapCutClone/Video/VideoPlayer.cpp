@@ -1,5 +1,39 @@
 #include "VideoPlayer.h"
+#include "../Audio/AudioEffectChain.h"
+#include "../Audio/AudioEngine.h"
+#include "../Audio/TimeStretch.h"
+#include "DecoderBackend.h"
+#include "PacketQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <utility>
+
+namespace {
+
+// Demuxed packets buffered ahead of each decoder. Audio holds more (its
+// packets are ~20 ms) so it can run on while video stalls.
+constexpr size_t kVideoQueuePackets = 64;
+constexpr size_t kAudioQueuePackets = 512;
+
+// Clock rate DecodeNextFrame() advances at for audio-only files
+constexpr double kAudioOnlyFPS = 30.0;
+
+// Scrub grains: as long as the gap between scrub steps, within limits; a
+// step after a pause in the drag plays the longest grain at normal speed
+constexpr double kScrubGrainMin = 0.05;
+constexpr double kScrubGrainMax = 0.2;
+constexpr double kScrubIdle = 0.3;
+constexpr int kScrubFadeFrames = 256; // Grain end fade-out (~5 ms)
+
+double WallSeconds() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
 
 VideoPlayer::VideoPlayer()
     : m_FormatContext(nullptr), m_CodecContext(nullptr),
@@ -8,12 +42,29 @@ VideoPlayer::VideoPlayer()
       m_AudioFrame(nullptr), m_Packet(nullptr), m_Buffer(nullptr),
       m_VideoStreamIndex(-1), m_AudioStreamIndex(-1), m_Width(0), m_Height(0),
       m_Duration(0.0), m_CurrentTime(0.0), m_FPS(0.0), m_IsLoaded(false),
-      m_HardwareDeviceContext(nullptr) {}
-
-VideoPlayer::~VideoPlayer() { Cleanup(); }
+      m_HardwareDeviceContext(nullptr), m_AudioOutput(true), m_AudioVoice(-1),
+      m_AudioBus(0),
+      m_VideoPackets(std::make_unique<PacketQueue>(
+          kVideoQueuePackets, TraceCounter::VideoPackets)),
+      m_AudioPackets(std::make_unique<PacketQueue>(
+          kAudioQueuePackets, TraceCounter::AudioPackets)),
+      m_DemuxPacket(nullptr), m_DemuxHasPacket(false), m_DemuxEnded(false),
+      m_SeekPending(false), m_SeekTarget(0.0), m_AudioSerial(0),
+      m_StopThreads(false), m_Serial(0), m_AudioSkipUntil(0.0),
+      m_Playing(false), m_Stretch(std::make_unique<TimeStretch>()),
+      m_Scrubbing(false), m_ScrubFrames(0), m_ScrubTempo(1.0f),
+      m_LastScrubTarget(0.0), m_LastScrubWall(-1.0), m_GrainLeft(-1),
+      m_GrainLength(0) {}
+
+VideoPlayer::~VideoPlayer() {
+  Cleanup();
+  AudioEngine::ReleaseVoice(m_AudioVoice);
+}
 
-bool VideoPlayer::LoadVideo(const std::string &filepath) {
+bool VideoPlayer::LoadVideo(const std::string &filepath, bool audioOutput,
+                            bool decodeVideo) {
   Cleanup();
+  m_AudioOutput = audioOutput;
 
   // Completely suppress FFmpeg warnings (set to QUIET)
   av_log_set_level(AV_LOG_QUIET);
@@ -38,7 +89,7 @@ bool VideoPlayer::LoadVideo(const std::string &filepath) {
   for (unsigned int i = 0; i < m_FormatContext->nb_streams; i++) {
     if (m_FormatContext->streams[i]->codecpar->codec_type ==
             AVMEDIA_TYPE_VIDEO &&
-        m_VideoStreamIndex == -1) {
+        m_VideoStreamIndex == -1 && decodeVideo) {
       m_VideoStreamIndex = i;
     } else if (m_FormatContext->streams[i]->codecpar->codec_type ==
                    AVMEDIA_TYPE_AUDIO &&
@@ -47,87 +98,22 @@ bool VideoPlayer::LoadVideo(const std::string &filepath) {
     }
   }
 
-  if (m_VideoStreamIndex == -1) {
-    std::cerr << "Could not find video stream" << std::endl;
+  // Audio-only files (music tracks) have no pictures but keep a clock
+  if (m_VideoStreamIndex == -1 && m_AudioStreamIndex == -1) {
+    std::cerr << "Could not find video or audio stream" << std::endl;
     Cleanup();
     return false;
   }
 
-  // Get codec parameters
-  AVCodecParameters *codecParams =
-      m_FormatContext->streams[m_VideoStreamIndex]->codecpar;
-
-  // Enable Hardware Acceleration (Modern Method)
-  const AVCodec *codec = avcodec_find_decoder(codecParams->codec_id);
-  if (!codec) {
-    Cleanup();
-    return false;
-  }
-
-  m_CodecContext = avcodec_alloc_context3(codec);
-  if (!m_CodecContext) {
-    Cleanup();
-    return false;
-  }
-
-  if (avcodec_parameters_to_context(m_CodecContext, codecParams) < 0) {
-    Cleanup();
-    return false;
-  }
-
-  // MAXIMUM error concealment to fix broken frames
-  m_CodecContext->error_concealment =
-      FF_EC_GUESS_MVS | FF_EC_DEBLOCK | FF_EC_FAVOR_INTER;
-  m_CodecContext->err_recognition = 0; // Be permissive - accept all frames
-  m_CodecContext->workaround_bugs =
-      FF_BUG_AUTODETECT | FF_BUG_XVID_ILACE | FF_BUG_UMP4 | FF_BUG_NO_PADDING |
-      FF_BUG_AMV | FF_BUG_QPEL_CHROMA | FF_BUG_STD_QPEL |
-      FF_BUG_DIRECT_BLOCKSIZE | FF_BUG_EDGE | FF_BUG_HPEL_CHROMA |
-      FF_BUG_DC_CLIP | FF_BUG_MS | FF_BUG_TRUNCATED | FF_BUG_IEDGE;
-  m_CodecContext->idct_algo = FF_IDCT_AUTO;
-  m_CodecContext->debug = 0; // Disable debug output
-
-  // Don't skip any frames - show everything
-  m_CodecContext->skip_frame = AVDISCARD_NONE;
-  m_CodecContext->skip_idct = AVDISCARD_NONE;
-  m_CodecContext->skip_loop_filter = AVDISCARD_NONE;
-
-  // Try to create Hardware Device Context (D3D11VA)
-  int ret = av_hwdevice_ctx_create(
-      &m_HardwareDeviceContext, AV_HWDEVICE_TYPE_D3D11VA, nullptr, nullptr, 0);
-  if (ret < 0) {
-    std::cout << "D3D11VA not available, trying DXVA2..." << std::endl;
-    ret = av_hwdevice_ctx_create(&m_HardwareDeviceContext,
-                                 AV_HWDEVICE_TYPE_DXVA2, nullptr, nullptr, 0);
-  }
-
-  if (ret == 0) {
-    std::cout << "[VideoPlayer] SUCCESS: Hardware Acceleration (D3D11VA/DXVA2) "
-                 "Enabled!"
-              << std::endl;
-    m_CodecContext->hw_device_ctx = av_buffer_ref(m_HardwareDeviceContext);
-
-    // This callback is required to negotiate the pixel format
-    m_CodecContext->get_format =
-        [](AVCodecContext * ctx,
-           const enum AVPixelFormat *pix_fmts) -> enum AVPixelFormat {
-      const enum AVPixelFormat *p;
-      for (p = pix_fmts; *p != -1; p++) {
-        if (*p == AV_PIX_FMT_D3D11 || *p == AV_PIX_FMT_DXVA2_VLD) {
-          return *p;
-        }
-      }
-      std::cerr << "Failed to get HW surface format." << std::endl;
-      return AV_PIX_FMT_NONE;
-    };
-  } else {
-    std::cerr
-        << "[VideoPlayer] WARNING: Hardware Acceleration FAILED. using CPU."
-        << std::endl;
+  // Streams nobody decodes (the video of an audio-only open, subtitles,
+  // data) are skipped by the demuxer instead of read and dropped
+  for (unsigned int i = 0; i < m_FormatContext->nb_streams; i++) {
+    if (static_cast<int>(i) != m_VideoStreamIndex &&
+        static_cast<int>(i) != m_AudioStreamIndex)
+      m_FormatContext->streams[i]->discard = AVDISCARD_ALL;
   }
 
-  if (avcodec_open2(m_CodecContext, codec, nullptr) < 0) {
-    std::cerr << "Could not open codec" << std::endl;
+  if (m_VideoStreamIndex != -1 && !OpenVideoDecoder()) {
     Cleanup();
     return false;
   }
@@ -148,21 +134,23 @@ bool VideoPlayer::LoadVideo(const std::string &filepath) {
                     << m_AudioCodecContext->ch_layout.nb_channels << " channels"
                     << std::endl;
 
-          // Initialize Audio Context
-          m_AudioContext.Init(m_AudioCodecContext->sample_rate,
-                              m_AudioCodecContext->ch_layout.nb_channels);
+          OpenAudioOutput();
+        } else {
+          avcodec_free_context(&m_AudioCodecContext);
         }
       }
     }
   }
 
-  std::cout << "Using decoder: " << codec->name << std::endl;
+  if (m_VideoStreamIndex == -1 && !m_AudioCodecContext) {
+    std::cerr << "Could not open audio codec" << std::endl;
+    Cleanup();
+    return false;
+  }
 
-  // Get video properties
-  m_Width = m_CodecContext->width;
-  m_Height = m_CodecContext->height;
-
-  AVStream *videoStream = m_FormatContext->streams[m_VideoStreamIndex];
+  // Stream the clock and duration come from
+  AVStream *mainStream = m_FormatContext->streams[
+      m_VideoStreamIndex != -1 ? m_VideoStreamIndex : m_AudioStreamIndex];
 
   // Use container duration for accuracy (stream duration can be wrong for some
   // videos)
@@ -170,13 +158,22 @@ bool VideoPlayer::LoadVideo(const std::string &filepath) {
     m_Duration = m_FormatContext->duration / (double)AV_TIME_BASE;
   } else {
     // Fallback to stream duration if container doesn't have it
-    m_Duration = videoStream->duration * av_q2d(videoStream->time_base);
+    m_Duration = mainStream->duration * av_q2d(mainStream->time_base);
   }
 
-  // Get average frame rate (more reliable than r_frame_rate for VFR videos)
-  m_FPS = av_q2d(videoStream->avg_frame_rate);
-  if (m_FPS <= 0) {
-    m_FPS = av_q2d(videoStream->r_frame_rate); // Fallback
+  if (m_VideoStreamIndex != -1) {
+    // Get video properties
+    m_Width = m_CodecContext->width;
+    m_Height = m_CodecContext->height;
+
+    // Get average frame rate (more reliable than r_frame_rate for VFR
+    // videos)
+    m_FPS = av_q2d(mainStream->avg_frame_rate);
+    if (m_FPS <= 0) {
+      m_FPS = av_q2d(mainStream->r_frame_rate); // Fallback
+    }
+  } else {
+    m_FPS = kAudioOnlyFPS;
   }
 
   // Allocate frames
@@ -184,36 +181,49 @@ bool VideoPlayer::LoadVideo(const std::string &filepath) {
   m_FrameRGB = av_frame_alloc();
   m_AudioFrame = av_frame_alloc();
   m_Packet = av_packet_alloc();
+  m_DemuxPacket = av_packet_alloc();
 
-  if (!m_Frame || !m_FrameRGB || !m_Packet || !m_AudioFrame) {
+  if (!m_Frame || !m_FrameRGB || !m_Packet || !m_AudioFrame ||
+      !m_DemuxPacket) {
     std::cerr << "Could not allocate frames" << std::endl;
     Cleanup();
     return false;
   }
 
-  // Allocate buffer for RGB frame
-  int numBytes =
-      av_image_get_buffer_size(AV_PIX_FMT_RGB24, m_Width, m_Height, 1);
-  m_Buffer = (uint8_t *)av_malloc(numBytes * sizeof(uint8_t));
-  av_image_fill_arrays(m_FrameRGB->data, m_FrameRGB->linesize, m_Buffer,
-                       AV_PIX_FMT_RGB24, m_Width, m_Height, 1);
-
-  // Initialize SWS context (Initial attempt, might fail for HW formats like
-  // D3D11) This is fine, as DecodeNextFrame will fix it dynamically using
-  // sws_getCachedContext
-  m_SwsContext = sws_getContext(m_Width, m_Height, m_CodecContext->pix_fmt,
-                                m_Width, m_Height, AV_PIX_FMT_RGB24,
-                                SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-
-  // Warn but do NOT fail here. DecodeNextFrame handles the real SWS creation.
-  if (!m_SwsContext) {
-    std::cout << "[VideoPlayer] Note: Initial sws_getContext failed (likely HW "
-                 "format). Will retry in DecodeNextFrame."
-              << std::endl;
+  if (m_VideoStreamIndex != -1) {
+    // Allocate buffer for RGB frame
+    int numBytes =
+        av_image_get_buffer_size(AV_PIX_FMT_RGB24, m_Width, m_Height, 1);
+    m_Buffer = (uint8_t *)av_malloc(numBytes * sizeof(uint8_t));
+    av_image_fill_arrays(m_FrameRGB->data, m_FrameRGB->linesize, m_Buffer,
+                         AV_PIX_FMT_RGB24, m_Width, m_Height, 1);
+
+    // Initialize SWS context (Initial attempt, might fail for HW formats like
+    // D3D11) This is fine, as DecodeNextFrame will fix it dynamically using
+    // sws_getCachedContext
+    m_SwsContext = sws_getContext(m_Width, m_Height, m_CodecContext->pix_fmt,
+                                  m_Width, m_Height, AV_PIX_FMT_RGB24,
+                                  SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
+    // Warn but do NOT fail here. DecodeNextFrame handles the real SWS
+    // creation.
+    if (!m_SwsContext) {
+      std::cout << "[VideoPlayer] Note: Initial sws_getContext failed (likely "
+                   "HW format). Will retry in DecodeNextFrame."
+                << std::endl;
+    }
   }
 
   m_IsLoaded = true;
   m_CurrentTime = 0.0;
+  m_AudioSerial = m_Serial;
+  m_AudioSkipUntil = 0.0;
+  m_Scrubbing = false;
+  m_GrainLeft = -1;
+  ResetAudioClip();
+  if (m_VideoStreamIndex != -1)
+    DecoderBackend::AddDecoder();
+  StartThreads();
 
   std::cout << "Video loaded successfully!" << std::endl;
   std::cout << "Resolution: " << m_Width << "x" << m_Height << std::endl;
@@ -223,109 +233,525 @@ bool VideoPlayer::LoadVideo(const std::string &filepath) {
   return true;
 }
 
-bool VideoPlayer::DecodeNextFrame() {
-  if (!m_IsLoaded)
+bool VideoPlayer::OpenVideoDecoder() {
+  // Get codec parameters
+  AVCodecParameters *codecParams =
+      m_FormatContext->streams[m_VideoStreamIndex]->codecpar;
+
+  // Enable Hardware Acceleration (Modern Method)
+  const AVCodec *codec = avcodec_find_decoder(codecParams->codec_id);
+  if (!codec) {
     return false;
+  }
 
-  std::lock_guard<std::mutex> lock(m_PacketMutex);
+  m_CodecContext = avcodec_alloc_context3(codec);
+  if (!m_CodecContext) {
+    return false;
+  }
 
-  while (av_read_frame(m_FormatContext, m_Packet) >= 0) {
-    // Video Stream
-    if (m_Packet->stream_index == m_VideoStreamIndex) {
-      int ret = avcodec_send_packet(m_CodecContext, m_Packet);
-      if (ret < 0) {
-        av_packet_unref(m_Packet);
-        continue;
+  if (avcodec_parameters_to_context(m_CodecContext, codecParams) < 0) {
+    return false;
+  }
+
+  // MAXIMUM error concealment to fix broken frames
+  m_CodecContext->error_concealment =
+      FF_EC_GUESS_MVS | FF_EC_DEBLOCK | FF_EC_FAVOR_INTER;
+  m_CodecContext->err_recognition = 0; // Be permissive - accept all frames
+  m_CodecContext->workaround_bugs =
+      FF_BUG_AUTODETECT | FF_BUG_XVID_ILACE | FF_BUG_UMP4 | FF_BUG_NO_PADDING |
+      FF_BUG_AMV | FF_BUG_QPEL_CHROMA | FF_BUG_STD_QPEL |
+      FF_BUG_DIRECT_BLOCKSIZE | FF_BUG_EDGE | FF_BUG_HPEL_CHROMA |
+      FF_BUG_DC_CLIP | FF_BUG_MS | FF_BUG_TRUNCATED | FF_BUG_IEDGE;
+  m_CodecContext->idct_algo = FF_IDCT_AUTO;
+  m_CodecContext->debug = 0; // Disable debug output
+
+  // Don't skip any frames - show everything
+  m_CodecContext->skip_frame = AVDISCARD_NONE;
+  m_CodecContext->skip_idct = AVDISCARD_NONE;
+  m_CodecContext->skip_loop_filter = AVDISCARD_NONE;
+
+  // Hardware device or CPU threading, see DecoderBackend
+  DecoderBackend::Selection backend = DecoderBackend::Configure(
+      m_CodecContext, codec, &m_HardwareDeviceContext);
+
+  if (avcodec_open2(m_CodecContext, codec, nullptr) < 0) {
+    std::cerr << "Could not open codec" << std::endl;
+    return false;
+  }
+
+  std::cout << "Using decoder: " << codec->name << " ("
+            << backend.Describe() << ")" << std::endl;
+  return true;
+}
+
+void VideoPlayer::OpenAudioOutput() {
+  if (!m_AudioOutput) {
+    AudioEngine::ReleaseVoice(m_AudioVoice);
+    m_AudioVoice = -1;
+    return;
+  }
+
+  // The voice is kept across files; only the first one with audio gets it
+  if (m_AudioVoice < 0 && m_AudioCodecContext && AudioEngine::Start()) {
+    m_AudioVoice = AudioEngine::AcquireVoice();
+    AudioEngine::SetPaused(m_AudioVoice, !m_Playing);
+    AudioEngine::SetVoiceBus(m_AudioVoice, m_AudioBus);
+  }
+}
+
+void VideoPlayer::SetAudioClip(int bus, double inPoint, double outPoint,
+                               double speed,
+                               const AudioEffectSettings::Fades &fades) {
+  m_AudioBus = bus;
+  AudioEngine::SetVoiceBus(m_AudioVoice, bus);
+
+  std::lock_guard<std::mutex> lock(m_AudioClipMutex);
+  m_AudioClip.inPoint = inPoint;
+  m_AudioClip.outPoint = outPoint;
+  m_AudioClip.speed = speed;
+  m_AudioClip.fades = fades;
+}
+
+void VideoPlayer::ResetAudioClip() {
+  std::lock_guard<std::mutex> lock(m_AudioClipMutex);
+  m_AudioClip = AudioClip();
+}
+
+double VideoPlayer::GetAudioClipEnd() {
+  std::lock_guard<std::mutex> lock(m_AudioClipMutex);
+  return m_AudioClip.outPoint > m_AudioClip.inPoint ? m_AudioClip.outPoint
+                                                    : -1.0;
+}
+
+void VideoPlayer::SetPlaying(bool playing) {
+  m_Playing = playing;
+  // The audio thread parks after a scrub grain; restart it at the picture
+  if (playing && m_Scrubbing.exchange(false) && m_IsLoaded)
+    Seek(m_CurrentTime);
+  AudioEngine::SetPaused(m_AudioVoice, !playing);
+}
+
+void VideoPlayer::StartAt(uint64_t clockFrame) {
+  AudioEngine::StartAt(m_AudioVoice, clockFrame);
+}
+
+void VideoPlayer::SwapDecoder(VideoPlayer &other) {
+  if (this == &other)
+    return;
+
+  // The threads belong to the player; queued packets move with the decoder
+  StopThreads();
+  other.StopThreads();
+
+  {
+    std::scoped_lock lock(m_PacketMutex, other.m_PacketMutex);
+    std::swap(m_FormatContext, other.m_FormatContext);
+    std::swap(m_CodecContext, other.m_CodecContext);
+    std::swap(m_AudioCodecContext, other.m_AudioCodecContext);
+    std::swap(m_SwsContext, other.m_SwsContext);
+    std::swap(m_SwrContext, other.m_SwrContext);
+    std::swap(m_HardwareDeviceContext, other.m_HardwareDeviceContext);
+    std::swap(m_Frame, other.m_Frame);
+    std::swap(m_FrameRGB, other.m_FrameRGB);
+    std::swap(m_AudioFrame, other.m_AudioFrame);
+    std::swap(m_Packet, other.m_Packet);
+    std::swap(m_Buffer, other.m_Buffer);
+    std::swap(m_VideoStreamIndex, other.m_VideoStreamIndex);
+    std::swap(m_AudioStreamIndex, other.m_AudioStreamIndex);
+    std::swap(m_Width, other.m_Width);
+    std::swap(m_Height, other.m_Height);
+    std::swap(m_Duration, other.m_Duration);
+    std::swap(m_CurrentTime, other.m_CurrentTime);
+    std::swap(m_FPS, other.m_FPS);
+    std::swap(m_IsLoaded, other.m_IsLoaded);
+
+    std::swap(m_VideoPackets, other.m_VideoPackets);
+    std::swap(m_AudioPackets, other.m_AudioPackets);
+    std::swap(m_DemuxPacket, other.m_DemuxPacket);
+    std::swap(m_DemuxHasPacket, other.m_DemuxHasPacket);
+    std::swap(m_DemuxEnded, other.m_DemuxEnded);
+    std::swap(m_SeekPending, other.m_SeekPending);
+    std::swap(m_SeekTarget, other.m_SeekTarget);
+    std::swap(m_AudioSerial, other.m_AudioSerial);
+    m_Serial = other.m_Serial.exchange(m_Serial);
+    m_AudioSkipUntil = other.m_AudioSkipUntil.exchange(m_AudioSkipUntil);
+  }
+
+  // A parked scrub grain and the clip window belong to the previous file
+  m_GrainLeft = -1;
+  other.m_GrainLeft = -1;
+  ResetAudioClip();
+  other.ResetAudioClip();
+
+  // The voice still holds the outgoing clip's tail, which ends at its out
+  // point; the new clip's audio queues right behind it, so the cut is
+  // seamless
+  OpenAudioOutput();
+  other.OpenAudioOutput();
+
+  StartThreads();
+  other.StartThreads();
+}
+
+// ============================================================================
+// Demux and audio threads
+// ============================================================================
+
+void VideoPlayer::StartThreads() {
+  if (!m_IsLoaded)
+    return;
+
+  m_StopThreads = false;
+  m_DemuxThread = std::thread(&VideoPlayer::DemuxThreadFunc, this);
+  if (m_AudioCodecContext && m_AudioVoice >= 0)
+    m_AudioThread = std::thread(&VideoPlayer::AudioThreadFunc, this);
+}
+
+void VideoPlayer::StopThreads() {
+  {
+    std::lock_guard<std::mutex> lock(m_DemuxMutex);
+    m_StopThreads = true;
+  }
+  m_DemuxWake.notify_all();
+  m_VideoPackets->Abort();
+  m_AudioPackets->Abort();
+  AudioEngine::WakeWaiters(); // Audio thread waiting for queue space
+
+  if (m_DemuxThread.joinable())
+    m_DemuxThread.join();
+  if (m_AudioThread.joinable())
+    m_AudioThread.join();
+
+  // Queued packets are kept: SwapDecoder() hands them to the other player
+  m_VideoPackets->Start();
+  m_AudioPackets->Start();
+}
+
+void VideoPlayer::DemuxThreadFunc() {
+  while (true) {
+    int serial = 0;
+    {
+      std::unique_lock<std::mutex> lock(m_DemuxMutex);
+      m_DemuxWake.wait(lock, [this] {
+        return m_StopThreads || m_SeekPending || !m_DemuxEnded;
+      });
+      if (m_StopThreads)
+        return;
+
+      if (m_SeekPending) {
+        m_SeekPending = false;
+        SeekDemuxer(m_SeekTarget);
+        m_VideoPackets->Flush();
+        m_AudioPackets->Flush();
+        av_packet_unref(m_DemuxPacket);
+        m_DemuxHasPacket = false;
+        m_DemuxEnded = false;
       }
+      serial = m_Serial;
+    }
 
-      ret = avcodec_receive_frame(m_CodecContext, m_Frame);
-      if (ret == 0) {
-        // Determine final frame (SW or HW)
-        AVFrame *finalFrame = m_Frame;
-        AVFrame *swFrame = nullptr;
-
-        if (m_Frame->format == AV_PIX_FMT_D3D11 ||
-            m_Frame->format == AV_PIX_FMT_DXVA2_VLD) {
-          swFrame = av_frame_alloc();
-          if (av_hwframe_transfer_data(swFrame, m_Frame, 0) < 0) {
-            std::cerr << "Error transferring HW frame to CPU" << std::endl;
-            av_frame_free(&swFrame);
-            av_packet_unref(m_Packet);
-            return false;
-          }
-          finalFrame = swFrame;
+    if (!m_DemuxHasPacket) {
+      if (av_read_frame(m_FormatContext, m_DemuxPacket) < 0) {
+        // End of file: decoders drain their queues, then report it. Not if
+        // a seek came in meanwhile, as it already flushed the queues.
+        std::lock_guard<std::mutex> lock(m_DemuxMutex);
+        if (!m_SeekPending) {
+          m_DemuxEnded = true;
+          m_VideoPackets->SetEndOfStream();
+          m_AudioPackets->SetEndOfStream();
         }
+        continue;
+      }
+      m_DemuxHasPacket = true;
+    }
 
-        // Re-init SWS if needed
-        m_SwsContext = sws_getCachedContext(
-            m_SwsContext, m_Width, m_Height, (AVPixelFormat)finalFrame->format,
-            m_Width, m_Height, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, nullptr,
-            nullptr, nullptr);
+    bool queued = true;
+    if (m_DemuxPacket->stream_index == m_VideoStreamIndex) {
+      queued = m_VideoPackets->Push(m_DemuxPacket, serial);
+    } else if (m_DemuxPacket->stream_index == m_AudioStreamIndex &&
+               m_AudioCodecContext) {
+      // Audio never holds up video; only audio-only files wait for room
+      if (m_VideoStreamIndex != -1)
+        queued = m_AudioPackets->PushDropOldest(m_DemuxPacket, serial);
+      else
+        queued = m_AudioPackets->Push(m_DemuxPacket, serial);
+    } else {
+      av_packet_unref(m_DemuxPacket);
+    }
 
-        if (m_SwsContext) {
-          sws_scale(m_SwsContext, finalFrame->data, finalFrame->linesize, 0,
-                    m_Height, m_FrameRGB->data, m_FrameRGB->linesize);
-        }
+    // Not queued = stopping; the packet is pushed first after a restart
+    if (queued)
+      m_DemuxHasPacket = false;
+  }
+}
 
-        if (swFrame)
-          av_frame_free(&swFrame);
+void VideoPlayer::SeekDemuxer(double timestamp) {
+  int streamIndex =
+      m_VideoStreamIndex != -1 ? m_VideoStreamIndex : m_AudioStreamIndex;
+  AVStream *stream = m_FormatContext->streams[streamIndex];
+  int64_t seekTarget = (int64_t)(timestamp / av_q2d(stream->time_base));
 
-        m_CurrentTime =
-            m_Frame->pts *
-            av_q2d(m_FormatContext->streams[m_VideoStreamIndex]->time_base);
-        av_packet_unref(m_Packet);
+  // Seek to nearest keyframe before target
+  if (av_seek_frame(m_FormatContext, streamIndex, seekTarget,
+                    AVSEEK_FLAG_BACKWARD) < 0) {
+    std::cerr << "Error seeking to timestamp" << std::endl;
+  }
+}
 
-        return true;
+void VideoPlayer::AudioThreadFunc() {
+  AVPacket *packet = av_packet_alloc();
+  if (!packet)
+    return;
+
+  while (!m_StopThreads) {
+    int serial = 0;
+    PacketQueue::Result result = m_AudioPackets->Pop(packet, serial, true);
+    if (result == PacketQueue::Result::Aborted)
+      break;
+    if (result == PacketQueue::Result::EndOfStream) {
+      m_AudioPackets->WaitWhileEnded();
+      continue;
+    }
+    if (result != PacketQueue::Result::Packet)
+      continue;
+
+    // Read before a seek that has since been requested
+    if (serial != m_Serial) {
+      av_packet_unref(packet);
+      continue;
+    }
+
+    // Past the clip's out point: not even decoded
+    double clipEnd = GetAudioClipEnd();
+    if (clipEnd >= 0.0 && serial == m_AudioSerial &&
+        packet->pts != AV_NOPTS_VALUE &&
+        packet->pts * av_q2d(m_FormatContext->streams[m_AudioStreamIndex]
+                                 ->time_base) >= clipEnd) {
+      av_packet_unref(packet);
+      continue;
+    }
+
+    // First packet after a seek: drop the decoder state and queued audio
+    if (serial != m_AudioSerial) {
+      avcodec_flush_buffers(m_AudioCodecContext);
+      if (m_SwrContext) {
+        swr_close(m_SwrContext);
+        swr_init(m_SwrContext);
+      }
+      AudioEngine::Flush(m_AudioVoice);
+      m_AudioSerial = serial;
+
+      int grain = m_ScrubFrames;
+      m_GrainLeft = grain > 0 ? grain : -1;
+      m_GrainLength = grain;
+      if (grain > 0) {
+        m_Stretch->Reset();
+        m_Stretch->SetTempo(m_ScrubTempo);
       }
     }
-    // Audio Stream
-    else if (m_Packet->stream_index == m_AudioStreamIndex &&
-             m_AudioCodecContext) {
-      int ret = avcodec_send_packet(m_AudioCodecContext, m_Packet);
-      if (ret >= 0) {
-        while (avcodec_receive_frame(m_AudioCodecContext, m_AudioFrame) == 0) {
-          // Audio Processing
-          if (!m_SwrContext) {
-            av_channel_layout_default(
-                &m_AudioFrame->ch_layout,
-                m_AudioCodecContext->ch_layout.nb_channels);
-            swr_alloc_set_opts2(&m_SwrContext, &m_AudioCodecContext->ch_layout,
-                                AV_SAMPLE_FMT_FLT,
-                                m_AudioCodecContext->sample_rate,
-                                &m_AudioCodecContext->ch_layout,
-                                m_AudioCodecContext->sample_fmt,
-                                m_AudioCodecContext->sample_rate, 0, nullptr);
-            swr_init(m_SwrContext);
-          }
-
-          if (m_SwrContext) {
-            int dstSamples = av_rescale_rnd(
-                swr_get_delay(m_SwrContext, m_AudioCodecContext->sample_rate) +
-                    m_AudioFrame->nb_samples,
-                m_AudioCodecContext->sample_rate,
-                m_AudioCodecContext->sample_rate, AV_ROUND_UP);
-
-            uint8_t **dstData = nullptr;
-            int linesize = 0;
-            av_samples_alloc_array_and_samples(
-                &dstData, &linesize, m_AudioCodecContext->ch_layout.nb_channels,
-                dstSamples, AV_SAMPLE_FMT_FLT, 0);
-
-            int convRet = swr_convert(m_SwrContext, dstData, dstSamples,
-                                      (const uint8_t **)m_AudioFrame->data,
-                                      m_AudioFrame->nb_samples);
-            if (convRet > 0) {
-              m_AudioContext.PushAudio((float *)dstData[0], convRet);
-            }
-
-            if (dstData) {
-              av_freep(&dstData[0]);
-              av_freep(&dstData);
-            }
-          }
-        }
+
+    // Scrub grain done: idle until the next seek
+    if (m_GrainLeft == 0) {
+      av_packet_unref(packet);
+      continue;
+    }
+
+    if (avcodec_send_packet(m_AudioCodecContext, packet) >= 0) {
+      while (avcodec_receive_frame(m_AudioCodecContext, m_AudioFrame) == 0) {
+        if (!QueueAudioFrame(serial))
+          break;
       }
     }
+    av_packet_unref(packet);
+  }
+
+  av_packet_free(&packet);
+}
+
+bool VideoPlayer::QueueAudioFrame(int serial) {
+  if (m_GrainLeft == 0)
+    return false; // Scrub grain finished with this packet
+
+  // Pre-roll from the keyframe before a seek target is not played, nor
+  // anything past the clip's out point: the voice would play it over the
+  // next clip, which queues right behind
+  int clipFrames = -1; // Engine frames left before the out point, -1 = all
+  if (m_AudioFrame->pts != AV_NOPTS_VALUE) {
+    AVStream *stream = m_FormatContext->streams[m_AudioStreamIndex];
+    double start = m_AudioFrame->pts * av_q2d(stream->time_base);
+    double end = start + (double)m_AudioFrame->nb_samples /
+                             m_AudioCodecContext->sample_rate;
+    if (end < m_AudioSkipUntil)
+      return true;
+
+    double clipEnd = GetAudioClipEnd();
+    if (clipEnd >= 0.0) {
+      if (start >= clipEnd)
+        return true;
+      clipFrames = static_cast<int>(
+          std::llround((clipEnd - start) * AudioEngine::kSampleRate));
+    }
+  }
+
+  // Resample to the engine format; the mixer only mixes
+  if (!m_SwrContext) {
+    av_channel_layout_default(&m_AudioFrame->ch_layout,
+                              m_AudioCodecContext->ch_layout.nb_channels);
+    AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+    swr_alloc_set_opts2(&m_SwrContext, &stereo, AV_SAMPLE_FMT_FLT,
+                        AudioEngine::kSampleRate,
+                        &m_AudioCodecContext->ch_layout,
+                        m_AudioCodecContext->sample_fmt,
+                        m_AudioCodecContext->sample_rate, 0, nullptr);
+    swr_init(m_SwrContext);
+  }
+  if (!m_SwrContext)
+    return true;
+
+  int dstSamples = av_rescale_rnd(
+      swr_get_delay(m_SwrContext, m_AudioCodecContext->sample_rate) +
+          m_AudioFrame->nb_samples,
+      AudioEngine::kSampleRate, m_AudioCodecContext->sample_rate,
+      AV_ROUND_UP);
+
+  // The device drains the voice in real time (not at all while paused):
+  // wait for room, giving up on stop or a newer seek (both wake the wait)
+  int needed = std::min(dstSamples, AudioEngine::kQueueFrames);
+  if (!AudioEngine::WaitWritable(m_AudioVoice, needed, [&] {
+        return m_StopThreads || serial != m_Serial;
+      }))
+    return false;
+
+  // Decode straight into the voice's queue when the frame fits before the
+  // ring wraps; otherwise through the staging buffer, which only grows, so
+  // steady state allocates nothing. Scrub grains go through the stretcher.
+  bool scrub = m_GrainLeft > 0;
+  int contiguous = 0;
+  float *dst = AudioEngine::AcquireWrite(m_AudioVoice, contiguous);
+  bool direct = !scrub && dst && contiguous >= dstSamples;
+  if (!direct) {
+    size_t size = static_cast<size_t>(dstSamples) * AudioEngine::kChannels;
+    if (m_AudioBuffer.size() < size)
+      m_AudioBuffer.resize(size);
+    dst = m_AudioBuffer.data();
+  }
+
+  uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+  int convRet = swr_convert(m_SwrContext, &out, dstSamples,
+                            (const uint8_t **)m_AudioFrame->data,
+                            m_AudioFrame->nb_samples);
+  if (clipFrames >= 0)
+    convRet = std::min(convRet, clipFrames);
+  if (convRet > 0) {
+    if (!scrub)
+      ApplyClipFades(dst, convRet);
+    if (scrub)
+      QueueScrubGrain(dst, convRet);
+    else if (direct)
+      AudioEngine::CommitWrite(m_AudioVoice, convRet);
+    else
+      AudioEngine::Write(m_AudioVoice, dst, convRet);
+  }
+  return true;
+}
+
+void VideoPlayer::ApplyClipFades(float *samples, int frames) {
+  AudioClip clip;
+  {
+    std::lock_guard<std::mutex> lock(m_AudioClipMutex);
+    clip = m_AudioClip;
+  }
+  if ((clip.fades.in <= 0.0f && clip.fades.out <= 0.0f) ||
+      m_AudioFrame->pts == AV_NOPTS_VALUE)
+    return;
+
+  // Playback queues the source at 1x; fades are in timeline seconds
+  AVStream *stream = m_FormatContext->streams[m_AudioStreamIndex];
+  double source = m_AudioFrame->pts * av_q2d(stream->time_base);
+  AudioEffectChain::ApplyFades(
+      samples, frames, (source - clip.inPoint) / clip.speed,
+      1.0 / (AudioEngine::kSampleRate * clip.speed),
+      (clip.outPoint - clip.inPoint) / clip.speed, clip.fades);
+}
+
+void VideoPlayer::QueueScrubGrain(const float *samples, int frames) {
+  m_Stretch->Push(samples, frames);
+
+  const int fadeFrames = std::min(kScrubFadeFrames, m_GrainLength);
+  while (m_GrainLeft > 0) {
+    int span = 0;
+    float *dst = AudioEngine::AcquireWrite(m_AudioVoice, span);
+    if (!dst)
+      break;
+    int pulled = m_Stretch->Pull(dst, std::min(span, m_GrainLeft));
+    if (pulled == 0)
+      break; // Needs more input
+
+    // Fade out the grain's end; the next one starts after a flush, which
+    // the engine fades in
+    int played = m_GrainLength - m_GrainLeft;
+    int fadeStart = m_GrainLength - fadeFrames;
+    for (int i = std::max(0, fadeStart - played); i < pulled; ++i) {
+      float gain = static_cast<float>(m_GrainLength - played - i - 1) /
+                   static_cast<float>(fadeFrames);
+      dst[i * AudioEngine::kChannels] *= gain;
+      dst[i * AudioEngine::kChannels + 1] *= gain;
+    }
+    AudioEngine::CommitWrite(m_AudioVoice, pulled);
+    m_GrainLeft -= pulled;
+  }
+}
+
+// ============================================================================
+// Video decode (caller's thread)
+// ============================================================================
+
+bool VideoPlayer::NextVideoPacket() {
+  int serial = 0;
+  while (m_VideoPackets->Pop(m_Packet, serial, true) ==
+         PacketQueue::Result::Packet) {
+    if (serial == m_Serial)
+      return true;
+    av_packet_unref(m_Packet); // Read before the last seek
+  }
+  return false;
+}
+
+bool VideoPlayer::DecodeNextFrame() {
+  if (!m_IsLoaded)
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_PacketMutex);
+
+  // Audio-only: no pictures, just advance the clock callers pace by
+  if (m_VideoStreamIndex == -1) {
+    if (m_CurrentTime >= m_Duration)
+      return false;
+    m_CurrentTime += 1.0 / m_FPS;
+    return true;
+  }
+
+  while (NextVideoPacket()) {
+    int ret = avcodec_send_packet(m_CodecContext, m_Packet);
+    if (ret < 0) {
+      av_packet_unref(m_Packet);
+      continue;
+    }
+
+    ret = avcodec_receive_frame(m_CodecContext, m_Frame);
+    if (ret == 0) {
+      if (!ConvertToRGB(m_Frame)) {
+        av_packet_unref(m_Packet);
+        return false;
+      }
+
+      m_CurrentTime =
+          m_Frame->pts *
+          av_q2d(m_FormatContext->streams[m_VideoStreamIndex]->time_base);
+      av_packet_unref(m_Packet);
+
+      return true;
+    }
 
     av_packet_unref(m_Packet);
   }
@@ -333,42 +759,111 @@ bool VideoPlayer::DecodeNextFrame() {
   return false;
 }
 
+bool VideoPlayer::ConvertToRGB(AVFrame *frame) {
+  // Hardware surfaces are downloaded first (NV12/P010 on most devices)
+  AVFrame *swFrame = nullptr;
+  if (DecoderBackend::IsHardwareFrame(frame)) {
+    swFrame = av_frame_alloc();
+    if (av_hwframe_transfer_data(swFrame, frame, 0) < 0) {
+      std::cerr << "Error transferring HW frame to CPU" << std::endl;
+      av_frame_free(&swFrame);
+      return false;
+    }
+    frame = swFrame;
+  }
+
+  // Re-init SWS if needed
+  m_SwsContext = sws_getCachedContext(
+      m_SwsContext, m_Width, m_Height, (AVPixelFormat)frame->format, m_Width,
+      m_Height, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, nullptr, nullptr,
+      nullptr);
+
+  if (m_SwsContext) {
+    sws_scale(m_SwsContext, frame->data, frame->linesize, 0, m_Height,
+              m_FrameRGB->data, m_FrameRGB->linesize);
+  }
+
+  if (swFrame)
+    av_frame_free(&swFrame);
+  return true;
+}
+
+void VideoPlayer::RequestSeek(double timestamp) {
+  {
+    std::lock_guard<std::mutex> lock(m_DemuxMutex);
+    m_SeekTarget = timestamp;
+    m_SeekPending = true;
+    m_AudioSkipUntil = timestamp;
+    m_Serial++;
+    // The voice stops playing the old position right away. Under the lock,
+    // so audio the demux thread reads after the seek is never dropped.
+    AudioEngine::Flush(m_AudioVoice);
+  }
+
+  // Wake a Push() of a stale packet waiting for room. Nothing is flushed
+  // here: the demux thread may have seeked already and queued the new
+  // keyframe; it flushes itself when it handles the seek.
+  m_VideoPackets->ExpireBefore(m_Serial);
+  m_AudioPackets->ExpireBefore(m_Serial);
+  m_DemuxWake.notify_one();
+}
+
+void VideoPlayer::PrepareScrubGrain(double timestamp, bool scrub) {
+  m_Scrubbing = scrub;
+  if (!scrub) {
+    m_ScrubFrames = 0;
+    AudioEngine::SetPaused(m_AudioVoice, !m_Playing);
+    return;
+  }
+
+  // Play as much audio as the drag covered, at the speed it moved
+  double now = WallSeconds();
+  double elapsed = now - m_LastScrubWall;
+  double grain = kScrubGrainMax;
+  float tempo = 1.0f;
+  if (m_LastScrubWall >= 0.0 && elapsed < kScrubIdle) {
+    grain = std::clamp(elapsed, kScrubGrainMin, kScrubGrainMax);
+    tempo = static_cast<float>(std::abs(timestamp - m_LastScrubTarget) /
+                               std::max(elapsed, 1e-3));
+  }
+  m_LastScrubWall = now;
+  m_LastScrubTarget = timestamp;
+
+  // Read by the audio thread once it sees the seek's serial
+  m_ScrubTempo = tempo;
+  m_ScrubFrames = static_cast<int>(grain * AudioEngine::kSampleRate);
+  AudioEngine::SetPaused(m_AudioVoice, false);
+}
+
 void VideoPlayer::Seek(double timestamp, bool fastMode) {
   if (!m_IsLoaded)
     return;
 
-  // Convert timestamp to PTS (Presentation Time Stamp)
-  AVStream *videoStream = m_FormatContext->streams[m_VideoStreamIndex];
-  int64_t seekTarget = (int64_t)(timestamp / av_q2d(videoStream->time_base));
+  std::lock_guard<std::mutex> lock(m_PacketMutex);
+  PrepareScrubGrain(timestamp, fastMode && !m_Playing && m_AudioVoice >= 0);
+  RequestSeek(timestamp);
 
-  // Seek to nearest keyframe before target
-  if (av_seek_frame(m_FormatContext, m_VideoStreamIndex, seekTarget,
-                    AVSEEK_FLAG_BACKWARD) < 0) {
-    std::cerr << "Error seeking to timestamp" << std::endl;
+  if (m_VideoStreamIndex == -1) {
+    m_CurrentTime = timestamp;
     return;
   }
 
   // Flush codec buffers to clear old frames
   avcodec_flush_buffers(m_CodecContext);
-  if (m_AudioCodecContext) {
-    avcodec_flush_buffers(m_AudioCodecContext);
-  }
-  m_AudioContext.Clear();
+
+  AVStream *videoStream = m_FormatContext->streams[m_VideoStreamIndex];
 
   if (fastMode) {
     // FAST MODE: Just decode one frame near the position (for scrubbing)
     // This is much faster but less precise
     int framesDecoded = 0;
-    while (av_read_frame(m_FormatContext, m_Packet) >= 0 && framesDecoded < 2) {
-      if (m_Packet->stream_index == m_VideoStreamIndex) {
-        if (avcodec_send_packet(m_CodecContext, m_Packet) >= 0) {
-          if (avcodec_receive_frame(m_CodecContext, m_Frame) == 0) {
-            framesDecoded++;
-            // Convert last frame to RGB
-            sws_scale(m_SwsContext, m_Frame->data, m_Frame->linesize, 0,
-                      m_Height, m_FrameRGB->data, m_FrameRGB->linesize);
-            m_CurrentTime = m_Frame->pts * av_q2d(videoStream->time_base);
-          }
+    while (framesDecoded < 2 && NextVideoPacket()) {
+      if (avcodec_send_packet(m_CodecContext, m_Packet) >= 0) {
+        if (avcodec_receive_frame(m_CodecContext, m_Frame) == 0) {
+          framesDecoded++;
+          // Convert last frame to RGB
+          ConvertToRGB(m_Frame);
+          m_CurrentTime = m_Frame->pts * av_q2d(videoStream->time_base);
         }
       }
       av_packet_unref(m_Packet);
@@ -379,28 +874,25 @@ void VideoPlayer::Seek(double timestamp, bool fastMode) {
     double frameDuration = 1.0 / m_FPS;
     double tolerance = frameDuration * 0.5;
 
-    while (av_read_frame(m_FormatContext, m_Packet) >= 0) {
-      if (m_Packet->stream_index == m_VideoStreamIndex) {
-        int ret = avcodec_send_packet(m_CodecContext, m_Packet);
-        if (ret < 0) {
-          av_packet_unref(m_Packet);
-          continue;
-        }
+    while (NextVideoPacket()) {
+      int ret = avcodec_send_packet(m_CodecContext, m_Packet);
+      if (ret < 0) {
+        av_packet_unref(m_Packet);
+        continue;
+      }
 
-        ret = avcodec_receive_frame(m_CodecContext, m_Frame);
-        if (ret == 0) {
-          double frameTime = m_Frame->pts * av_q2d(videoStream->time_base);
+      ret = avcodec_receive_frame(m_CodecContext, m_Frame);
+      if (ret == 0) {
+        double frameTime = m_Frame->pts * av_q2d(videoStream->time_base);
 
-          // If we've reached the target timestamp (within tolerance)
-          if (frameTime >= timestamp - tolerance) {
-            // Convert frame to RGB for display
-            sws_scale(m_SwsContext, m_Frame->data, m_Frame->linesize, 0,
-                      m_Height, m_FrameRGB->data, m_FrameRGB->linesize);
+        // If we've reached the target timestamp (within tolerance)
+        if (frameTime >= timestamp - tolerance) {
+          // Convert frame to RGB for display
+          ConvertToRGB(m_Frame);
 
-            m_CurrentTime = frameTime;
-            av_packet_unref(m_Packet);
-            break;
-          }
+          m_CurrentTime = frameTime;
+          av_packet_unref(m_Packet);
+          break;
         }
       }
       av_packet_unref(m_Packet);
@@ -410,9 +902,17 @@ void VideoPlayer::Seek(double timestamp, bool fastMode) {
 
 void VideoPlayer::Reset() { Seek(0.0); }
 
-void VideoPlayer::Close() { Cleanup(); }
+void VideoPlayer::Close() {
+  Cleanup();
+  AudioEngine::Flush(m_AudioVoice);
+}
 
 void VideoPlayer::Cleanup() {
+  // Threads first: they use everything below
+  StopThreads();
+  m_VideoPackets->Flush();
+  m_AudioPackets->Flush();
+
   // Free video resources
   if (m_SwsContext) {
     sws_freeContext(m_SwsContext);
@@ -440,6 +940,13 @@ void VideoPlayer::Cleanup() {
     av_packet_free(&m_Packet);
   }
 
+  if (m_DemuxPacket) {
+    av_packet_free(&m_DemuxPacket);
+  }
+  m_DemuxHasPacket = false;
+  m_DemuxEnded = false;
+  m_SeekPending = false;
+
   if (m_CodecContext) {
     avcodec_free_context(&m_CodecContext);
   }
@@ -452,7 +959,8 @@ void VideoPlayer::Cleanup() {
     swr_free(&m_SwrContext);
   }
 
-  m_AudioContext.Close();
+  // The voice is not flushed here: LoadVideo() on the next clip queues its
+  // audio right behind this one's tail, which stops at the out point
 
   if (m_HardwareDeviceContext) {
     av_buffer_unref(&m_HardwareDeviceContext);
@@ -463,6 +971,8 @@ void VideoPlayer::Cleanup() {
     avformat_close_input(&m_FormatContext);
   }
 
+  if (m_IsLoaded && m_VideoStreamIndex != -1)
+    DecoderBackend::RemoveDecoder();
   m_IsLoaded = false;
   m_VideoStreamIndex = -1;
   m_AudioStreamIndex = -1;
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <mutex>
+#include "../Audio/AudioEffectSettings.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -13,22 +18,54 @@ extern "C" {
 #include <libswresample/swresample.h>
 }
 
-#include "../Audio/AudioContext.h"
+class PacketQueue;
+class TimeStretch;
 
+// A demux thread splits packets into per-stream queues. Video is decoded on
+// the caller's thread (DecodeNextFrame/Seek), audio on its own thread into
+// the player's AudioEngine voice, so audio keeps flowing while video stalls.
+// Files with only an audio stream load too; they have no frame data.
+// A fast Seek() while paused is a scrub step: it plays one short grain of
+// audio at the playhead, time-stretched to the drag speed.
 class VideoPlayer {
 public:
     VideoPlayer();
     ~VideoPlayer();
 
-    // Video loading
-    bool LoadVideo(const std::string& filepath);
+    // Video loading. audioOutput = false decodes audio without feeding the
+    // audio engine (export, background opens); decodeVideo = false discards
+    // the video stream at the demuxer and opens no video decoder, so the
+    // file plays like an audio-only one (timeline clip audio).
+    bool LoadVideo(const std::string& filepath, bool audioOutput = true,
+                   bool decodeVideo = true);
     void Close();
 
+    // Exchange the opened file and decoder state with another player in
+    // O(1). The audio engine voice stays with this player, so the new
+    // clip's audio queues right behind the old one's.
+    void SwapDecoder(VideoPlayer& other);
+
     // Playback control
     bool DecodeNextFrame();
     void Seek(double timestamp, bool fastMode = false);
     void Reset();
 
+    // The audio thread decodes ahead on its own; the voice only plays while
+    // this is set (it starts paused). Starting after a scrub re-seeks audio
+    // to the current frame.
+    void SetPlaying(bool playing);
+
+    // Hold the voice until the engine clock reaches clockFrame (a clip
+    // that starts later); 0 plays as soon as audio is queued
+    void StartAt(uint64_t clockFrame);
+
+    // Audio engine bus (the clip's track) and the clip's window in the
+    // source with its track fades; applies to audio queued from now on.
+    // No audio past outPoint is queued. LoadVideo() and SwapDecoder() clear
+    // the window (outPoint <= inPoint = none).
+    void SetAudioClip(int bus, double inPoint, double outPoint, double speed,
+                      const AudioEffectSettings::Fades& fades);
+
     // Getters
     bool IsLoaded() const { return m_IsLoaded; }
     double GetDuration() const { return m_Duration; }
@@ -36,6 +73,8 @@ public:
     int GetWidth() const { return m_Width; }
     int GetHeight() const { return m_Height; }
     double GetFPS() const { return m_FPS; }
+    bool HasVideo() const { return m_VideoStreamIndex != -1; }
+    bool HasAudio() const { return m_AudioCodecContext != nullptr; }
     const uint8_t* GetFrameData() const { return m_FrameRGB ? m_FrameRGB->data[0] : nullptr; }
 
 private:
@@ -63,13 +102,72 @@ private:
     double m_CurrentTime;
     double m_FPS;
     bool m_IsLoaded;
+    bool m_AudioOutput; // Set by LoadVideo, not swapped
+    int m_AudioVoice;   // AudioEngine voice, -1 = none; not swapped
+    std::vector<float> m_AudioBuffer; // Resample staging when the ring wraps
+
+    // Set by the caller's thread, read by the audio thread; not swapped
+    struct AudioClip {
+        double inPoint = 0.0;
+        double outPoint = 0.0;
+        double speed = 1.0;
+        AudioEffectSettings::Fades fades;
+    };
+    std::mutex m_AudioClipMutex;
+    AudioClip m_AudioClip;
+    int m_AudioBus;
     
     // Thread safety for concurrent audio/video decode
     mutable std::mutex m_PacketMutex;
 
+    // Demux state, swapped with the decoder
+    std::unique_ptr<PacketQueue> m_VideoPackets;
+    std::unique_ptr<PacketQueue> m_AudioPackets;
+    AVPacket* m_DemuxPacket;  // Read but not queued yet when stopped
+    bool m_DemuxHasPacket;
+    bool m_DemuxEnded;
+    bool m_SeekPending;
+    double m_SeekTarget;
+    int m_AudioSerial;        // Seek the audio decoder state belongs to
+
+    // Threads (not swapped)
+    std::thread m_DemuxThread;
+    std::thread m_AudioThread;
+    std::mutex m_DemuxMutex;  // Seek request and end of stream
+    std::condition_variable m_DemuxWake;
+    std::atomic<bool> m_StopThreads;
+    std::atomic<int> m_Serial;  // Bumped by every seek, tags queued packets
+    std::atomic<double> m_AudioSkipUntil; // Audio pre-roll before a seek target
+    std::atomic<bool> m_Playing; // Not swapped
+
+    // Scrub audio (not swapped). The caller's thread sets the grain for the
+    // next seek; the audio thread plays it through m_Stretch, then parks.
+    std::unique_ptr<TimeStretch> m_Stretch;
+    std::atomic<bool> m_Scrubbing;  // Last seek was a scrub step
+    std::atomic<int> m_ScrubFrames; // Grain length for the next seek, 0 = none
+    std::atomic<float> m_ScrubTempo;
+    double m_LastScrubTarget;
+    double m_LastScrubWall;         // Seconds, steady clock
+    int m_GrainLeft;                // Audio thread: frames to queue, -1 = not scrubbing
+    int m_GrainLength;
+
     // Helper methods
     void Cleanup();
+    void OpenAudioOutput();
+    bool OpenVideoDecoder();
+    bool ConvertToRGB(AVFrame* frame); // Into m_FrameRGB, downloads HW frames
+    bool NextVideoPacket(); // Into m_Packet, false at end of stream
 
-    // Audio Subsystem
-    AudioContext m_AudioContext;
+    void StartThreads();
+    void StopThreads();
+    void DemuxThreadFunc();
+    void AudioThreadFunc();
+    void SeekDemuxer(double timestamp);
+    void RequestSeek(double timestamp);
+    void PrepareScrubGrain(double timestamp, bool scrub);
+    bool QueueAudioFrame(int serial); // False: stopped or seeked meanwhile
+    void QueueScrubGrain(const float* samples, int frames);
+    void ApplyClipFades(float* samples, int frames); // Of m_AudioFrame
+    void ResetAudioClip();
+    double GetAudioClipEnd(); // Out point, -1 without a clip window
 };